@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <string>
+#include <stdint.h>
 
 namespace phxpaxos
 {
@@ -46,6 +47,7 @@ public:
     virtual void AcceptNotPass() { }
     virtual void PrepareTimeout() { }
     virtual void AcceptTimeout() { }
+    virtual void ConflictBackoff(const int iBackoffMs) { }
 };
 
 class AcceptorBP
@@ -86,6 +88,10 @@ public:
     virtual void SenderAckTimeout() { }
     virtual void SenderAckDelay() { }
     virtual void SenderSendOnePaxosLog() { }
+    virtual void SendLearnValueBatch(const int iCount) { }
+    virtual void OnSendLearnValueBatch(const int iCount) { }
+    virtual void SenderWindowShrink(const int iWindowBytes) { }
+    virtual void SenderBackpressure() { }
 };
 
 class InstanceBP
@@ -122,12 +128,27 @@ public:
     virtual void NewValueGetLockOK(const int iUseTimeMs) { }
     virtual void NewValueCommitOK(const int iUseTimeMs) { }
     virtual void NewValueCommitFail() { }
+    virtual void NewValueWaitQueueDepth(const int iQueueDepth) { }
+    virtual void NewValueWaitSojournTimeMs(const int iSojournTimeMs) { }
 
     virtual void BatchPropose() { }
     virtual void BatchProposeOK() { }
     virtual void BatchProposeFail() { }
     virtual void BatchProposeWaitTimeMs(const int iWaitTimeMs) { }
     virtual void BatchProposeDoPropose(const int iBatchCount) { }
+    virtual void CoalescePropose(const int iCoalesceCount) { }
+
+    virtual void ForwardPropose() { }
+    virtual void ForwardProposeOK(const int iUseTimeMs) { }
+    virtual void ForwardProposeFail() { }
+    virtual void OnForwardPropose() { }
+    virtual void OnForwardProposeRejectByFullQueue() { }
+    virtual void OnForwardProposeRejectByNotMaster() { }
+
+    //Per second, latency of each CommitStage(def.h) of commits succeeded in the last period.
+    //Each group report its own, default metrics show the max of all groups.
+    virtual void CommitStageUseTimeUS(const int iGroupIdx, const int iStage, 
+            const uint64_t llP50UseTimeUS, const uint64_t llP99UseTimeUS, const uint64_t llMaxUseTimeUS) { }
 };
 
 class IOLoopBP
@@ -141,6 +162,10 @@ public:
     virtual void EnqueueRetryMsgRejectByFullQueue() { }
     virtual void OutQueueMsg() { }
     virtual void DealWithRetryMsg() { }
+    virtual void RunTask(const int iMsgCount) { }
+    virtual void StealTask() { }
+    virtual void MsgQueueAdd(const int iMsgClass) { }
+    virtual void MsgQueuePop(const int iMsgClass) { }
 };
 
 class NetworkBP
@@ -155,6 +180,9 @@ public:
     virtual void TcpOnReadMessageLenError() { }
     virtual void TcpReconnect() { }
     virtual void TcpOutQueue(const int iDelayMs) { }
+    virtual void TcpOutQueueDrop() { }
+    virtual void TcpCreditStall() { }
+    virtual void TcpCreditGrant(const int iGroupCount) { }
     virtual void SendRejectByTooLargeSize() { }
     virtual void Send(const std::string & sMessage) { }
     virtual void SendTcp(const std::string & sMessage) { }
@@ -163,6 +191,9 @@ public:
     virtual void UDPReceive(const int iRecvLen) { }
     virtual void UDPRealSend(const std::string & sMessage) { }
     virtual void UDPQueueFull() { }
+    virtual void SendCoalescedFrame(const int iMsgCount, const int iFrameLen) { }
+    virtual void ReceiveCoalescedFrame(const int iMsgCount) { }
+    virtual void ReceiveCoalescedFrameError() { }
 };
 
 class LogStorageBP
@@ -178,6 +209,9 @@ public:
     virtual void AppendDataFail() { }
     virtual void AppendDataOK(const int iWriteLen, const int iUseTimeMs) { }
     virtual void GetFileChecksumNotEquel() { }
+    virtual void ChosenValueCacheHit() { }
+    virtual void ChosenValueCacheMiss() { }
+    virtual void RebuildIndexStart(const int iFileID, const int iOffset) { }
 };
 
 class AlgorithmBaseBP
@@ -187,6 +221,10 @@ public:
     virtual void UnPackHeaderLenTooLong() { }
     virtual void UnPackChecksumNotSame() { }
     virtual void HeaderGidNotSame() { }
+    virtual void ValueCompress(const int iRawLen, const int iCompressLen, const int iUseTimeUs) { }
+    virtual void ValueCompressSkip(const int iRawLen) { }
+    virtual void ValueDecompress(const int iCompressLen, const int iRawLen, const int iUseTimeUs) { }
+    virtual void ValueDecompressFail() { }
 };
 
 class CheckpointBP
@@ -198,9 +236,14 @@ public:
     virtual void OnSendCheckpointOneBlock() { }
     virtual void SendCheckpointBegin() { }
     virtual void SendCheckpointEnd() { }
+    virtual void SendCheckpointResend() { }
+    virtual void SendCheckpointReuseFile() { }
+    virtual void SendCheckpointThroughput(const int iKBPerSecond) { }
     virtual void ReceiveCheckpointDone() { }
     virtual void ReceiveCheckpointAndLoadFail() { }
     virtual void ReceiveCheckpointAndLoadSucc() { }
+    virtual void ReplayerPlayBatch(const int iInstanceCount) { }
+    virtual void ReplayerLag(const uint64_t llLagInstanceCount) { }
 };
 
 class MasterBP
@@ -213,6 +256,39 @@ public:
     virtual void OtherBeMaster() { }
     virtual void DropMaster() { }
     virtual void MasterSMInconsistent() { }
+    virtual void RenewLeaseOK() { }
+    virtual void RenewLeaseFail() { }
+    virtual void QueryLeaseFail() { }
+    virtual void GrantLeaseReject() { }
+    virtual void CoordinatorRound(const int iRenewCount, const int iQueryCount) { }
+    virtual void RebalanceDropMaster() { }
+};
+
+enum MetricType
+{
+    MetricType_Counter = 1,
+    MetricType_Gauge = 2,
+    MetricType_Histogram = 3,
+};
+
+//One metric of built-in metrics, see Node::GetMetricsSnapshot.
+class MetricValue
+{
+public:
+    std::string m_sName;
+    std::string m_sHelp;
+    int m_iType;
+
+    //counter or gauge value, count of values for histogram.
+    uint64_t m_llValue;
+
+    //only for histogram.
+    uint64_t m_llSum;
+    uint64_t m_llMax;
+    uint64_t m_llP50;
+    uint64_t m_llP90;
+    uint64_t m_llP99;
+    uint64_t m_llP999;
 };
 
 #define BP (Breakpoint::Instance())
@@ -27,6 +27,7 @@ namespace phxpaxos
 #define SYSTEM_V_SMID 100000000
 #define MASTER_V_SMID 100000001
 #define BATCH_PROPOSE_SMID 100000002
+#define VALUE_CHUNK_SMID 100000003
 
 enum PaxosTryCommitRet
 {
@@ -37,14 +38,38 @@ enum PaxosTryCommitRet
     PaxosTryCommitRet_Follower_Cannot_Commit = 16,
     PaxosTryCommitRet_Im_Not_In_Membership  = 17,
     PaxosTryCommitRet_Value_Size_TooLarge = 18,
+    PaxosTryCommitRet_Value_Chunk_Fail = 19,
+    PaxosTryCommitRet_Not_Master = 20,
     PaxosTryCommitRet_Timeout = 404,
     PaxosTryCommitRet_TooManyThreadWaiting_Reject = 405,
 };
 
+//Stages of a local commit, traced in microseconds.
+enum CommitStage
+{
+    CommitStage_Queue = 0,      //wait for commit lock of the group
+    CommitStage_IOLoop = 1,     //wait for ioloop to start the commit
+    CommitStage_Prepare = 2,    //prepare until majority promised, 0 if skipped
+    CommitStage_Accept = 3,     //accept until majority accepted
+    CommitStage_Persist = 4,    //local acceptor write the accepted value
+    CommitStage_Learn = 5,      //majority accepted until learned locally
+    CommitStage_Execute = 6,    //state machine execute
+    CommitStage_Total = 7,
+    CommitStage_Count = 8,
+};
+
+//Checksum of paxos log chain and network message, chosen per group by Node::SetChecksumType.
+enum ChecksumType
+{
+    ChecksumType_Crc32 = 0,     //crc32 of sampled bytes, default
+    ChecksumType_Crc32C = 1,    //crc32c of all bytes, use sse4.2 if cpu support
+};
+
 enum PaxosNodeFunctionRet
 {
     Paxos_SystemError = -1,
     Paxos_GroupIdxWrong = -5,
+    Paxos_NetWorkBackpressure = -6,
     Paxos_MembershipOp_GidNotSame = -501,
     Paxos_MembershipOp_VersionConflit = -502,
     Paxos_MembershipOp_NoGid = 1001,
@@ -53,6 +78,7 @@ enum PaxosNodeFunctionRet
     Paxos_MembershipOp_Change_NoChange = 1004,
     Paxos_GetInstanceValue_Value_NotExist = 1005,
     Paxos_GetInstanceValue_Value_Not_Chosen_Yet = 1006,
+    Paxos_ChecksumOp_TypeNotSupport = 1007,
 };
 
 }
@@ -44,12 +44,15 @@ public:
     //If paxoslib call this function, network need to stop receive any message.
     virtual void StopNetWork() = 0;
 
+    //Return Paxos_NetWorkBackpressure if the peer can't take more bulk data (learn values,
+    //checkpoint chunks) of this group now, the caller should slow down and retry later.
     virtual int SendMessageTCP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage) = 0;
 
     virtual int SendMessageUDP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage) = 0;
 
     //When receive a message, call this funtion.
     //This funtion is async, just enqueue an return.
+    //Return non zero if the group's queue is full.
     int OnReceiveMessage(const char * pcMessage, const int iMessageLen);
 
 private:
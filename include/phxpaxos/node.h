@@ -124,6 +124,10 @@ public:
     //Change membership by one node to another node.
     virtual int ChangeMember(const int iGroupIdx, const NodeInfo & oFromNode, const NodeInfo & oToNode) = 0;
 
+    //Change checksum algorithm(ChecksumType on def.h) of paxos log chain and network message.
+    //Take effect on all nodes from the next instance, all nodes must support it before change.
+    virtual int SetChecksumType(const int iGroupIdx, const int iChecksumType) = 0;
+
     //Master
     
     //Check who is master.
@@ -139,6 +143,10 @@ public:
 
     virtual int DropMaster(const int iGroupIdx) = 0;
 
+    //Drop masters of groups which prefer other node by Options::eMasterDistributionPolicy,
+    //then the preferred nodes take them. Only work with Options::bUseMasterCoordinator.
+    virtual int RebalanceMaster() = 0;
+
     //Qos
 
     //If many threads propose same group, that some threads will be on waiting status.
@@ -147,6 +155,8 @@ public:
     virtual void SetMaxHoldThreads(const int iGroupIdx, const int iMaxHoldThreads) = 0;
 
     //To avoid threads be holded too long time, we use this threshold to reject some propose to control thread's wait time.
+    //Proposes wait in fifo order, once waiting time stay above threshold for 100ms, new proposes are rejected 
+    //until waiting time fall below it. Proposes that would time out before their turn are also rejected early.
     virtual void SetProposeWaitTimeThresholdMS(const int iGroupIdx, const int iWaitTimeThresholdMS) = 0;
 
     //write disk
@@ -158,6 +168,13 @@ public:
     virtual int GetInstanceValue(const int iGroupIdx, const uint64_t llInstanceID, 
             std::vector<std::pair<std::string, int> > & vecValues) = 0;
 
+    //Metrics, only work when Options::bUseMetrics is true.
+    //Counters, gauges and histogram percentiles of all breakpoint events.
+    virtual void GetMetricsSnapshot(std::vector<MetricValue> & vecMetricList) = 0;
+
+    //Same as GetMetricsSnapshot, but in prometheus text format.
+    virtual void DumpMetrics(std::string & sText) = 0;
+
 protected:
     friend class NetWork; 
 
@@ -80,6 +80,17 @@ typedef std::vector<FollowerNodeInfo> FollowerNodeInfoList;
 
 /////////////////////////////////////////////////
 
+//Which node a group's master prefers, see Options::bUseMasterCoordinator.
+enum MasterDistributionPolicy
+{
+    //no preference, any node may be master of any group.
+    MasterDistributionPolicy_None = 0,
+    //group i prefers the (i % N)th member in nodeid order, masters spread evenly on N nodes.
+    MasterDistributionPolicy_Even = 1,
+};
+
+/////////////////////////////////////////////////
+
 class GroupSMInfo
 {
 public:
@@ -99,6 +110,18 @@ public:
     //Default is false.
     bool bIsUseMaster;
 
+    //optional
+    //Paxos value which size >= iValueCompressThreshold will be compressed 
+    //before write to paxoslog and send to other nodes.
+    //Default is 0, means not compress.
+    int iValueCompressThreshold;
+
+    //optional
+    //Preset dictionary for value compress, help small values which share the
+    //same schema compress better. All nodes must use the same dictionary.
+    //Default is empty, means no dictionary.
+    std::string sValueCompressDict;
+
 };
 
 typedef std::vector<GroupSMInfo> GroupSMInfoList;
@@ -158,6 +181,29 @@ public:
     //Default is 1.
     int iIOThreadCount;
     
+    //optional
+    //Our default network io thread sleep in epoll until next timer or new message.
+    //If iTcpBusyPollUs > 0, io thread keep polling without sleep for iTcpBusyPollUs
+    //microseconds after last active, trade cpu for lower latency.
+    //Default is 0.
+    int iTcpBusyPollUs;
+
+    //optional
+    //If iCoalesceDelayUs > 0, our default network hold small messages to the same node
+    //for at most iCoalesceDelayUs microseconds, and send messages of many groups in one frame.
+    //All nodes must support coalesced frame before open it.
+    //Default is 0, no coalesce.
+    int iCoalesceDelayUs;
+
+    //optional
+    //If iTcpCreditWindowBytes > 0, our default network advertise this window to 
+    //every node connect to us, a node can only have iTcpCreditWindowBytes of one group
+    //not consumed by us. Past it, learn values and checkpoint chunks wait for credit,
+    //consensus messages are still queued and only counted.
+    //Nodes not support credit just ignore it.
+    //Default is 0, no flow control.
+    int iTcpCreditWindowBytes;
+    
     //optional
     //We support to run multi phxpaxos on one process.
     //One paxos group here means one independent phxpaxos. Any two phxpaxos(paxos group) only share network, no other.
@@ -165,6 +211,19 @@ public:
     //Default is 1.
     int iGroupCount;
 
+    //optional
+    //Each paxos group has its own ioloop thread by default,
+    //with many groups on one process, thread count and context switch grow with group count.
+    //If iIOLoopThreadCount > 0, all groups' ioloops share this number of worker threads,
+    //a group only take a worker when it has messages or timeouts to deal with.
+    //A group holds its worker while it runs, include StateMachine::Execute of chosen values,
+    //a slow Execute delays other groups on that worker until an idle worker steal them,
+    //so keep Execute fast or give more workers than the groups may execute slowly at once.
+    //Only the ioloop is shared, learner sender, checkpoint replayer and paxos log cleaner
+    //threads are still one per group.
+    //Default is 0, one ioloop thread per group.
+    int iIOLoopThreadCount;
+
     //required
     //Self node's ip/port.
     NodeInfo oMyNode;
@@ -202,6 +261,19 @@ public:
     //optional
     Breakpoint * poBreakpoint;
 
+    //optional
+    //Value which size > iValueChunkSize will be split into chunks and streamed
+    //to other nodes ahead, paxos only agree on a small manifest, so such value
+    //is not limited by max buffer size. Must small than max buffer size.
+    //BeforePropose is not called on chunked value.
+    //Memory is not bounded by chunk size, the whole value is held when propose,
+    //and assembled in memory on each node when execute. Received chunks wait for
+    //a chunk io thread per group with at most 64MB, more are dropped and asked again.
+    //Chunks of a value never chosen (proposal timeout or abandoned) are deleted
+    //by the paxos log cleaner an hour after it's last chunk arrived.
+    //Default is 0, means not split.
+    int iValueChunkSize;
+
     //optional
     //If use this mode, that means you propose large value(maybe large than 5M means large) much more. 
     //Large value means long latency, long timeout, this mode will fit it.
@@ -230,15 +302,84 @@ public:
     //Default is false;
     bool bUseCheckpointReplayer;
 
+    //optional
+    //If bUseCheckpointBulkTransfer is true, checkpoint sender read several files at once,
+    //keep much more chunks in flight, and resend from the last acked chunk when chunks lost,
+    //instead of restart the whole transfer.
+    //All nodes must support resend before open it.
+    //Default is false;
+    bool bUseCheckpointBulkTransfer;
+
     //optional
     //Only bUseBatchPropose is true can use API BatchPropose in node.h
     //Default is false;
     bool bUseBatchPropose;
 
+    //optional
+    //If bUseProposeCoalesce is true, Propose calls waiting on the same group are merged
+    //into one instance when the previous commit done, like BatchPropose but without api change.
+    //Every caller get the same instanceid and its own SMCtx result.
+    //Callers waiting to be merged only take one place in SetMaxHoldThreads, up to 
+    //(iMaxHoldThreads + 1) * 64 of them wait.
+    //Values are executed as batch, all nodes must support BatchPropose values.
+    //Default is false;
+    bool bUseProposeCoalesce;
+
+    //optional
+    //If bUseProposeForward is true, Propose on a node which is not master is sent to 
+    //the master of the group(need master enabled) and wait for the result, so only one node 
+    //propose and proposers won't conflict. If no master, propose by itself.
+    //If that node isn't master any more, forward once to the new master or propose by itself.
+    //Propose with SMCtx::m_pCtx is never forwarded, because execute context only exist locally.
+    //When return, value is executed on master but maybe not yet on this node.
+    //All nodes must support forward before open it.
+    //Default is false;
+    bool bUseProposeForward;
+
+    //optional
+    //Keep the most recent iChosenValueCacheCount chosen values in memory,
+    //learners catching up and GetInstanceValue read them without disk io.
+    //Memory cost is about iChosenValueCacheCount * your average value size.
+    //Default is 0, means no cache.
+    int iChosenValueCacheCount;
+
     //optional
     //Only bOpenChangeValueBeforePropose is true, that will callback sm's function(BeforePropose).
     //Default is false;
     bool bOpenChangeValueBeforePropose;
+
+    //optional
+    //If bUseMetrics is true and poBreakpoint is nullptr, use the built-in breakpoint,
+    //every breakpoint event is counted to per thread shards and aggregated on read,
+    //see Node::GetMetricsSnapshot and Node::DumpMetrics.
+    //Default is false;
+    bool bUseMetrics;
+
+    //optional
+    //Master renews its lease every (LeaseTime - 100) / 4 ms by proposing a paxos value,
+    //each renewal take an instanceid and a disk write on every group.
+    //If bUseMasterHeartbeatLease is true, master renews by heartbeat granted by the majority,
+    //in memory only, and only master change goes through paxos.
+    //A node tries to be master only when the majority hold no lease of other master.
+    //All nodes should use the same value.
+    //Default is false;
+    bool bUseMasterHeartbeatLease;
+
+    //optional
+    //Each group using master runs its own master thread.
+    //If bUseMasterCoordinator is true, one thread runs masters of all groups on this node,
+    //with bUseMasterHeartbeatLease, renew and query leases of all groups in one message,
+    //groups whose members differ from group 0's renew and query by their own messages.
+    //Paxos proposals of different groups in a round run in parallel.
+    //Default is false;
+    bool bUseMasterCoordinator;
+
+    //optional
+    //Only used with bUseMasterCoordinator. A node only takes a free group it doesn't prefer
+    //after the group stayed free for a lease time, so the preferred node gets it first.
+    //Node::RebalanceMaster drops masters this node doesn't prefer.
+    //Default is MasterDistributionPolicy_Even;
+    MasterDistributionPolicy eMasterDistributionPolicy;
 };
     
 }
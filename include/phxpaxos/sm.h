@@ -47,10 +47,20 @@ class CheckpointFileInfo
 public:
     std::string m_sFilePath;
     size_t m_llFileSize;
+    uint64_t m_llChecksum;
 };
 
 typedef std::vector<CheckpointFileInfo> CheckpointFileInfoList;
 
+class CheckpointValue
+{
+public:
+    uint64_t m_llInstanceID;
+    std::string m_sPaxosValue;
+};
+
+typedef std::vector<CheckpointValue> CheckpointValueList;
+
 /////////////////////////////////////////////
 
 const uint64_t NoCheckpoint = (uint64_t)-1; 
@@ -76,6 +86,16 @@ public:
     virtual bool ExecuteForCheckpoint(const int iGroupIdx, const uint64_t llInstanceID, 
             const std::string & sPaxosValue);
 
+    //Checkpoint replayer call this with values of this sm in instanceid order,
+    //one instance may have more than one value if it was batch proposed.
+    //Set iExecutedCount to how many values from the front are executed,
+    //return false to retry from the first value not executed.
+    //Executed values are never passed again, values of other sms after a failed one wait for the retry,
+    //so sms still execute in the same instance order as Execute.
+    //Default call ExecuteForCheckpoint one by one.
+    virtual bool ExecuteForCheckpointBatch(const int iGroupIdx, const CheckpointValueList & vecValueList,
+            size_t & iExecutedCount);
+
     //Only need to implement this function while you have checkpoint.
     //Return your checkpoint's max executed instanceid.
     //Notice PhxPaxos will call this function very frequently.
@@ -90,6 +110,19 @@ public:
             std::vector<std::string> & vecFileList); 
 
     virtual void UnLockCheckpointState();
+
+    //Only need to implement this function while you want delta checkpoint transfer.
+    //Return files that never change once created (like leveldb sst) under sDirPath,
+    //m_sFilePath is relative path, the same as GetCheckpointState return for this file,
+    //m_llChecksum is any content hash you like, but same content must get same hash on all nodes.
+    //A node ask for checkpoint advertise its files, sender skip files receiver already have
+    //(same path, size and checksum), and receiver link them to sCheckpointTmpFileDirPath
+    //before LoadCheckpointState. Sender call it while checkpoint state is locked.
+    //Receiver call it in paxos thread, only again after GetCheckpointInstanceID change
+    //or a reuse fail, so it may hash files but the first ask wait for it.
+    //Default have no file, all files are sent.
+    virtual int GetCheckpointImmutableFiles(const int iGroupIdx, std::string & sDirPath, 
+            CheckpointFileInfoList & vecFileInfoList);
     
     //Checkpoint file was on dir(sCheckpointTmpFileDirPath).
     //vecFileList is all the file in dir(sCheckpointTmpFileDirPath).
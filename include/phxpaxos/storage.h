@@ -51,6 +51,23 @@ public:
 
     virtual int Del(const WriteOptions & oWriteOptions, int iGroupIdx, const uint64_t llInstanceID) = 0;
 
+    //Delete all instances in [llBeginInstanceID, llEndInstanceID), old log cleaner call it in large batch.
+    //Implement it if your storage can delete a range cheaper than one by one.
+    virtual int DeleteRange(const WriteOptions & oWriteOptions, const int iGroupIdx, 
+            const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID)
+    {
+        for (uint64_t llInstanceID = llBeginInstanceID; llInstanceID < llEndInstanceID; llInstanceID++)
+        {
+            int ret = Del(oWriteOptions, iGroupIdx, llInstanceID);
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+
+        return 0;
+    }
+
     virtual int GetMaxInstanceID(const int iGroupIdx, uint64_t & llInstanceID) = 0;
 
     virtual int SetMinChosenInstanceID(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llMinInstanceID) = 0;
@@ -30,6 +30,12 @@ else
 	OPT = -O2
 endif
 
+ifeq ($(local_network),y)
+# src/test can run all nodes in one process on plugin's LocalNetWork, need libphxpaxos_plugin.a
+	TEST_LOCAL_NETWORK_CPPFLAGS = -DPHXPAXOS_TEST_LOCAL_NETWORK
+	TEST_LOCAL_NETWORK_LIB = $(PHXPAXOS_LIB_PATH)/libphxpaxos_plugin.a
+endif
+
 CXX=g++
 CXXFLAGS+=-std=c++11 $(OPT)
 CPPFLAGS+=-I$(SRC_BASE_PATH) -I$(PROTOBUF_INCLUDE_PATH) -I$(LEVELDB_INCLUDE_PATH)
@@ -0,0 +1,61 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include "phxpaxos/network.h"
+#include <string>
+#include <memory>
+
+namespace phxpaxos
+{
+
+//In process network, nodes in one process find each other by ip:port,
+//a message is handed to the receiver by pointer, no socket and no copy
+//before the receiver enqueue it.
+//Use it to run many nodes in one process for test and benchmark.
+//Need call StopNetWork before delete the node, paxoslib not own it.
+
+class LocalEndpoint;
+
+class LocalNetWork : public NetWork
+{
+public:
+    LocalNetWork(const std::string & sIP, const int iPort);
+    ~LocalNetWork();
+
+    void RunNetWork();
+
+    void StopNetWork();
+
+    int SendMessageTCP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage);
+
+    int SendMessageUDP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage);
+
+private:
+    int Send(const std::string & sIp, const int iPort, const std::string & sMessage);
+
+private:
+    std::string m_sAddr;
+    std::shared_ptr<LocalEndpoint> m_poEndpoint;
+};
+
+}
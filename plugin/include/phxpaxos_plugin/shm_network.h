@@ -0,0 +1,82 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include "phxpaxos/network.h"
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace phxpaxos
+{
+
+//Shared memory network for nodes on the same host.
+//Every node own a ring buffer in shared memory named by it's ip and port,
+//other processes write message into the ring directly, and the receive
+//thread handle message in place, no socket and no kernel copy.
+//Need call Init before run node, and StopNetWork before delete the node.
+
+class ShmRing;
+
+class ShmNetWork : public NetWork
+{
+public:
+    ShmNetWork(const std::string & sIP, const int iPort, const int iRingSize = 64 * 1024 * 1024);
+    ~ShmNetWork();
+
+    int Init();
+
+    void RunNetWork();
+
+    void StopNetWork();
+
+    int SendMessageTCP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage);
+
+    int SendMessageUDP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage);
+
+    static std::string GetRingName(const std::string & sIP, const int iPort);
+
+private:
+    void ReceiveLoop();
+
+    int Send(const std::string & sIp, const int iPort, const std::string & sMessage);
+
+    std::shared_ptr<ShmRing> GetPeerRing(const std::string & sIp, const int iPort);
+
+    void RemovePeerRing(const std::string & sIp, const int iPort);
+
+private:
+    std::string m_sIP;
+    int m_iPort;
+    int m_iRingSize;
+
+    std::shared_ptr<ShmRing> m_poRing;
+    std::thread * m_poReceiveThread;
+    volatile bool m_bIsEnd;
+
+    std::mutex m_oMutex;
+    std::map<std::string, std::shared_ptr<ShmRing> > m_mapPeerRing;
+};
+
+}
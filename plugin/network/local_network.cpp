@@ -0,0 +1,157 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "phxpaxos_plugin/local_network.h"
+#include <map>
+#include <mutex>
+#include <stdio.h>
+
+namespace phxpaxos
+{
+
+class LocalEndpoint
+{
+public:
+    LocalEndpoint(NetWork * poNetWork) : m_poNetWork(poNetWork) { }
+
+    //hold the lock while delivering, so stop wait all inflight messages.
+    std::mutex m_oMutex;
+    NetWork * m_poNetWork;
+};
+
+class LocalHub
+{
+public:
+    static LocalHub * Instance()
+    {
+        static LocalHub oLocalHub;
+        return &oLocalHub;
+    }
+
+    void Add(const std::string & sAddr, const std::shared_ptr<LocalEndpoint> & poEndpoint)
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+        m_mapEndpoint[sAddr] = poEndpoint;
+    }
+
+    void Remove(const std::string & sAddr, const std::shared_ptr<LocalEndpoint> & poEndpoint)
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+        auto it = m_mapEndpoint.find(sAddr);
+        if (it != end(m_mapEndpoint) && it->second == poEndpoint)
+        {
+            m_mapEndpoint.erase(it);
+        }
+    }
+
+    std::shared_ptr<LocalEndpoint> Find(const std::string & sAddr)
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+        auto it = m_mapEndpoint.find(sAddr);
+        if (it == end(m_mapEndpoint))
+        {
+            return nullptr;
+        }
+
+        return it->second;
+    }
+
+private:
+    std::mutex m_oMutex;
+    std::map<std::string, std::shared_ptr<LocalEndpoint> > m_mapEndpoint;
+};
+
+static std::string MakeAddr(const std::string & sIP, const int iPort)
+{
+    char sAddr[128] = {0};
+    snprintf(sAddr, sizeof(sAddr), "%s:%d", sIP.c_str(), iPort);
+    return sAddr;
+}
+
+//////////////////////////////////////////////////////////////
+
+LocalNetWork :: LocalNetWork(const std::string & sIP, const int iPort)
+    : m_sAddr(MakeAddr(sIP, iPort))
+{
+}
+
+LocalNetWork :: ~LocalNetWork()
+{
+    StopNetWork();
+}
+
+void LocalNetWork :: RunNetWork()
+{
+    if (m_poEndpoint != nullptr)
+    {
+        return;
+    }
+
+    m_poEndpoint = std::make_shared<LocalEndpoint>(this);
+    LocalHub::Instance()->Add(m_sAddr, m_poEndpoint);
+}
+
+void LocalNetWork :: StopNetWork()
+{
+    if (m_poEndpoint == nullptr)
+    {
+        return;
+    }
+
+    LocalHub::Instance()->Remove(m_sAddr, m_poEndpoint);
+
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_poEndpoint->m_oMutex);
+        m_poEndpoint->m_poNetWork = nullptr;
+    }
+
+    m_poEndpoint = nullptr;
+}
+
+int LocalNetWork :: SendMessageTCP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage)
+{
+    return Send(sIp, iPort, sMessage);
+}
+
+int LocalNetWork :: SendMessageUDP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage)
+{
+    return Send(sIp, iPort, sMessage);
+}
+
+int LocalNetWork :: Send(const std::string & sIp, const int iPort, const std::string & sMessage)
+{
+    std::shared_ptr<LocalEndpoint> poEndpoint = LocalHub::Instance()->Find(MakeAddr(sIp, iPort));
+    if (poEndpoint == nullptr)
+    {
+        //like a lost packet, paxos will retry.
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> oLockGuard(poEndpoint->m_oMutex);
+    if (poEndpoint->m_poNetWork == nullptr)
+    {
+        return -1;
+    }
+
+    return poEndpoint->m_poNetWork->OnReceiveMessage(sMessage.data(), (int)sMessage.size());
+}
+
+}
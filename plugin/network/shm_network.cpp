@@ -0,0 +1,168 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "phxpaxos_plugin/shm_network.h"
+#include "shm_ring.h"
+#include <stdio.h>
+
+namespace phxpaxos
+{
+
+ShmNetWork :: ShmNetWork(const std::string & sIP, const int iPort, const int iRingSize)
+    : m_sIP(sIP), m_iPort(iPort), m_iRingSize(iRingSize), 
+    m_poReceiveThread(nullptr), m_bIsEnd(false)
+{
+}
+
+ShmNetWork :: ~ShmNetWork()
+{
+    StopNetWork();
+}
+
+std::string ShmNetWork :: GetRingName(const std::string & sIP, const int iPort)
+{
+    char sName[128] = {0};
+    snprintf(sName, sizeof(sName), "/phxpaxos_%s_%d", sIP.c_str(), iPort);
+    return sName;
+}
+
+int ShmNetWork :: Init()
+{
+    if (m_iRingSize <= 0 || m_iRingSize % 8 != 0)
+    {
+        return -1;
+    }
+
+    m_poRing = std::make_shared<ShmRing>();
+    return m_poRing->Create(GetRingName(m_sIP, m_iPort), (uint32_t)m_iRingSize);
+}
+
+void ShmNetWork :: RunNetWork()
+{
+    if (m_poRing == nullptr || m_poReceiveThread != nullptr)
+    {
+        return;
+    }
+
+    m_bIsEnd = false;
+    m_poReceiveThread = new std::thread(&ShmNetWork::ReceiveLoop, this);
+}
+
+void ShmNetWork :: StopNetWork()
+{
+    if (m_poReceiveThread != nullptr)
+    {
+        m_bIsEnd = true;
+        m_poReceiveThread->join();
+        delete m_poReceiveThread;
+        m_poReceiveThread = nullptr;
+    }
+
+    if (m_poRing != nullptr)
+    {
+        m_poRing->Close();
+        m_poRing = nullptr;
+    }
+
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+    m_mapPeerRing.clear();
+}
+
+void ShmNetWork :: ReceiveLoop()
+{
+    while (!m_bIsEnd)
+    {
+        if (!m_poRing->Wait(100))
+        {
+            continue;
+        }
+
+        //handle message in place, the receiver copy it when enqueue.
+        const char * pcMessage = nullptr;
+        int iMessageLen = 0;
+        while (m_poRing->Front(pcMessage, iMessageLen))
+        {
+            OnReceiveMessage(pcMessage, iMessageLen);
+            m_poRing->Pop();
+        }
+
+        m_poRing->Commit();
+    }
+}
+
+int ShmNetWork :: SendMessageTCP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage)
+{
+    return Send(sIp, iPort, sMessage);
+}
+
+int ShmNetWork :: SendMessageUDP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage)
+{
+    return Send(sIp, iPort, sMessage);
+}
+
+int ShmNetWork :: Send(const std::string & sIp, const int iPort, const std::string & sMessage)
+{
+    std::shared_ptr<ShmRing> poPeerRing = GetPeerRing(sIp, iPort);
+    if (poPeerRing == nullptr)
+    {
+        //peer not start yet, like a lost packet, paxos will retry.
+        return -1;
+    }
+
+    int ret = poPeerRing->Push(sMessage.data(), (int)sMessage.size());
+    if (ret == -1 && poPeerRing->IsClosed())
+    {
+        //peer restarted, attach the new ring next time.
+        RemovePeerRing(sIp, iPort);
+    }
+
+    return ret;
+}
+
+std::shared_ptr<ShmRing> ShmNetWork :: GetPeerRing(const std::string & sIp, const int iPort)
+{
+    std::string sName = GetRingName(sIp, iPort);
+
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+
+    auto it = m_mapPeerRing.find(sName);
+    if (it != end(m_mapPeerRing))
+    {
+        return it->second;
+    }
+
+    std::shared_ptr<ShmRing> poPeerRing = std::make_shared<ShmRing>();
+    if (poPeerRing->Attach(sName) != 0)
+    {
+        return nullptr;
+    }
+
+    m_mapPeerRing[sName] = poPeerRing;
+    return poPeerRing;
+}
+
+void ShmNetWork :: RemovePeerRing(const std::string & sIp, const int iPort)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+    m_mapPeerRing.erase(GetRingName(sIp, iPort));
+}
+
+}
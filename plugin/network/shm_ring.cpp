@@ -0,0 +1,396 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "shm_ring.h"
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+namespace phxpaxos
+{
+
+#define SHM_RING_MAGIC 0x50584d52
+#define SHM_RING_PAD_RECORD 0xFFFFFFFF
+#define SHM_RING_HEADER_SIZE 4096
+
+struct ShmRing::Header
+{
+    uint32_t iMagic;
+    uint32_t iCapacity;
+    volatile uint32_t iClosed;
+    //changed when a new consumer retire this ring.
+    volatile uint32_t iGeneration;
+    pthread_mutex_t oMutex;
+    pthread_cond_t oCond;
+    uint64_t llReadPos;
+    uint64_t llWritePos;
+};
+
+static inline uint32_t AlignRecordLen(const int iLen)
+{
+    return ((uint32_t)iLen + sizeof(uint32_t) + 7) & ~7U;
+}
+
+ShmRing :: ShmRing()
+    : m_poHeader(nullptr), m_pcData(nullptr), m_iMapSize(0), m_iGeneration(0),
+    m_llReadPos(0), m_llWritePos(0), m_iFrontRecordLen(0)
+{
+    static_assert(sizeof(Header) <= SHM_RING_HEADER_SIZE, "shm ring header too large");
+}
+
+ShmRing :: ~ShmRing()
+{
+    Unmap();
+}
+
+int ShmRing :: Map(const int iFd, const size_t iMapSize)
+{
+    void * pMem = mmap(nullptr, iMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, iFd, 0);
+    if (pMem == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    m_poHeader = (Header *)pMem;
+    m_pcData = (char *)pMem + SHM_RING_HEADER_SIZE;
+    m_iMapSize = iMapSize;
+    return 0;
+}
+
+void ShmRing :: Unmap()
+{
+    if (m_poHeader != nullptr)
+    {
+        munmap(m_poHeader, m_iMapSize);
+        m_poHeader = nullptr;
+        m_pcData = nullptr;
+        m_iMapSize = 0;
+    }
+}
+
+uint32_t ShmRing :: RetireRing(const std::string & sName)
+{
+    int iFd = shm_open(sName.c_str(), O_RDWR, 0666);
+    if (iFd < 0)
+    {
+        return 0;
+    }
+
+    uint32_t iGeneration = 0;
+    struct stat oStat;
+    if (fstat(iFd, &oStat) == 0 && (size_t)oStat.st_size >= SHM_RING_HEADER_SIZE)
+    {
+        void * pMem = mmap(nullptr, SHM_RING_HEADER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, iFd, 0);
+        if (pMem != MAP_FAILED)
+        {
+            Header * poHeader = (Header *)pMem;
+            if (poHeader->iMagic == SHM_RING_MAGIC)
+            {
+                //no lock, the dead consumer may hold it.
+                iGeneration = __atomic_add_fetch(&poHeader->iGeneration, 1, __ATOMIC_SEQ_CST);
+            }
+            munmap(pMem, SHM_RING_HEADER_SIZE);
+        }
+    }
+    close(iFd);
+
+    //attached producers keep the old memory until they see the new generation.
+    shm_unlink(sName.c_str());
+
+    return iGeneration;
+}
+
+int ShmRing :: Create(const std::string & sName, const uint32_t iCapacity)
+{
+    if (iCapacity == 0 || iCapacity % 8 != 0)
+    {
+        return -1;
+    }
+
+    //producers of the old ring may still hold or wait on it's mutex,
+    //so never init it again in place, make a new one instead.
+    uint32_t iGeneration = RetireRing(sName) + 1;
+
+    int iFd = shm_open(sName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (iFd < 0)
+    {
+        return -1;
+    }
+
+    size_t iMapSize = SHM_RING_HEADER_SIZE + (size_t)iCapacity;
+    if (ftruncate(iFd, iMapSize) != 0 || Map(iFd, iMapSize) != 0)
+    {
+        close(iFd);
+        shm_unlink(sName.c_str());
+        return -1;
+    }
+    close(iFd);
+
+    m_sName = sName;
+
+    pthread_mutexattr_t oMutexAttr;
+    pthread_mutexattr_init(&oMutexAttr);
+    pthread_mutexattr_setpshared(&oMutexAttr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&oMutexAttr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&m_poHeader->oMutex, &oMutexAttr);
+    pthread_mutexattr_destroy(&oMutexAttr);
+
+    pthread_condattr_t oCondAttr;
+    pthread_condattr_init(&oCondAttr);
+    pthread_condattr_setpshared(&oCondAttr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&oCondAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_poHeader->oCond, &oCondAttr);
+    pthread_condattr_destroy(&oCondAttr);
+
+    m_poHeader->iCapacity = iCapacity;
+    m_poHeader->iGeneration = iGeneration;
+    m_poHeader->llReadPos = 0;
+    m_poHeader->llWritePos = 0;
+    m_iGeneration = iGeneration;
+    m_llReadPos = 0;
+    m_llWritePos = 0;
+
+    __sync_synchronize();
+    m_poHeader->iMagic = SHM_RING_MAGIC;
+
+    return 0;
+}
+
+int ShmRing :: Attach(const std::string & sName)
+{
+    int iFd = shm_open(sName.c_str(), O_RDWR, 0666);
+    if (iFd < 0)
+    {
+        return -1;
+    }
+
+    struct stat oStat;
+    if (fstat(iFd, &oStat) != 0 || (size_t)oStat.st_size <= SHM_RING_HEADER_SIZE
+            || Map(iFd, oStat.st_size) != 0)
+    {
+        close(iFd);
+        return -1;
+    }
+    close(iFd);
+
+    if (m_poHeader->iMagic != SHM_RING_MAGIC
+            || SHM_RING_HEADER_SIZE + (size_t)m_poHeader->iCapacity > m_iMapSize)
+    {
+        Unmap();
+        return -1;
+    }
+
+    m_sName = sName;
+    m_iGeneration = __atomic_load_n(&m_poHeader->iGeneration, __ATOMIC_SEQ_CST);
+    return 0;
+}
+
+void ShmRing :: Close()
+{
+    if (m_poHeader == nullptr)
+    {
+        return;
+    }
+
+    bool bRetired = __atomic_load_n(&m_poHeader->iGeneration, __ATOMIC_SEQ_CST) != m_iGeneration;
+    if (Lock() == 0)
+    {
+        m_poHeader->iClosed = 1;
+        Unlock();
+    }
+
+    //a retired ring's name already belongs to the new consumer.
+    if (!bRetired)
+    {
+        shm_unlink(m_sName.c_str());
+    }
+    Unmap();
+}
+
+const bool ShmRing :: IsClosed() const
+{
+    return m_poHeader == nullptr || m_poHeader->iClosed != 0
+        || __atomic_load_n(&m_poHeader->iGeneration, __ATOMIC_SEQ_CST) != m_iGeneration;
+}
+
+int ShmRing :: Lock()
+{
+    int ret = pthread_mutex_lock(&m_poHeader->oMutex);
+    if (ret == EOWNERDEAD)
+    {
+        //a producer died with the lock, the record it was writing is not 
+        //published yet, so the ring is still consistent.
+        pthread_mutex_consistent(&m_poHeader->oMutex);
+        ret = 0;
+    }
+
+    return ret;
+}
+
+void ShmRing :: Unlock()
+{
+    pthread_mutex_unlock(&m_poHeader->oMutex);
+}
+
+int ShmRing :: Push(const char * pcData, const int iLen)
+{
+    if (m_poHeader == nullptr)
+    {
+        return -1;
+    }
+
+    uint32_t iCapacity = m_poHeader->iCapacity;
+    uint32_t iRecordLen = AlignRecordLen(iLen);
+    if (iLen <= 0 || iRecordLen > iCapacity / 2)
+    {
+        return -1;
+    }
+
+    if (Lock() != 0)
+    {
+        return -1;
+    }
+
+    if (m_poHeader->iClosed != 0
+            || __atomic_load_n(&m_poHeader->iGeneration, __ATOMIC_SEQ_CST) != m_iGeneration)
+    {
+        Unlock();
+        return -1;
+    }
+
+    uint64_t llWritePos = m_poHeader->llWritePos;
+    uint64_t llFree = iCapacity - (llWritePos - m_poHeader->llReadPos);
+    uint32_t iOffset = (uint32_t)(llWritePos % iCapacity);
+    uint32_t iTail = iCapacity - iOffset;
+    uint32_t iNeed = iTail < iRecordLen ? iTail + iRecordLen : iRecordLen;
+
+    if (iNeed > llFree)
+    {
+        Unlock();
+        return -2;
+    }
+
+    if (iTail < iRecordLen)
+    {
+        uint32_t iPad = SHM_RING_PAD_RECORD;
+        memcpy(m_pcData + iOffset, &iPad, sizeof(uint32_t));
+        llWritePos += iTail;
+        iOffset = 0;
+    }
+
+    uint32_t iDataLen = (uint32_t)iLen;
+    memcpy(m_pcData + iOffset, &iDataLen, sizeof(uint32_t));
+    memcpy(m_pcData + iOffset + sizeof(uint32_t), pcData, iLen);
+
+    m_poHeader->llWritePos = llWritePos + iRecordLen;
+    pthread_cond_signal(&m_poHeader->oCond);
+
+    Unlock();
+
+    return 0;
+}
+
+bool ShmRing :: Wait(const int iTimeoutMs)
+{
+    if (m_llReadPos < m_llWritePos)
+    {
+        return true;
+    }
+
+    if (Lock() != 0)
+    {
+        return false;
+    }
+
+    if (m_poHeader->llWritePos == m_llReadPos)
+    {
+        struct timespec oAbsTime;
+        clock_gettime(CLOCK_MONOTONIC, &oAbsTime);
+        oAbsTime.tv_sec += iTimeoutMs / 1000;
+        oAbsTime.tv_nsec += (long)(iTimeoutMs % 1000) * 1000000;
+        if (oAbsTime.tv_nsec >= 1000000000)
+        {
+            oAbsTime.tv_sec++;
+            oAbsTime.tv_nsec -= 1000000000;
+        }
+
+        int ret = pthread_cond_timedwait(&m_poHeader->oCond, &m_poHeader->oMutex, &oAbsTime);
+        if (ret == EOWNERDEAD)
+        {
+            pthread_mutex_consistent(&m_poHeader->oMutex);
+        }
+    }
+
+    m_llWritePos = m_poHeader->llWritePos;
+
+    Unlock();
+
+    return m_llReadPos < m_llWritePos;
+}
+
+bool ShmRing :: Front(const char *& pcData, int & iLen)
+{
+    uint32_t iCapacity = m_poHeader->iCapacity;
+
+    while (m_llReadPos < m_llWritePos)
+    {
+        uint32_t iOffset = (uint32_t)(m_llReadPos % iCapacity);
+        uint32_t iDataLen = 0;
+        memcpy(&iDataLen, m_pcData + iOffset, sizeof(uint32_t));
+
+        if (iDataLen == SHM_RING_PAD_RECORD)
+        {
+            m_llReadPos += iCapacity - iOffset;
+            continue;
+        }
+
+        pcData = m_pcData + iOffset + sizeof(uint32_t);
+        iLen = (int)iDataLen;
+        m_iFrontRecordLen = AlignRecordLen(iLen);
+        return true;
+    }
+
+    return false;
+}
+
+void ShmRing :: Pop()
+{
+    m_llReadPos += m_iFrontRecordLen;
+    m_iFrontRecordLen = 0;
+}
+
+void ShmRing :: Commit()
+{
+    if (Lock() != 0)
+    {
+        return;
+    }
+
+    m_poHeader->llReadPos = m_llReadPos;
+    Unlock();
+}
+
+}
@@ -0,0 +1,95 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include <string>
+#include <inttypes.h>
+#include <stddef.h>
+
+namespace phxpaxos
+{
+
+//Multi producer single consumer ring in shared memory, 
+//producers may live in other processes.
+//Record: [uint32 len][data], aligned to 8 bytes. A record never wrap,
+//the tail is skipped by a pad record if there's not enough space.
+class ShmRing
+{
+public:
+    ShmRing();
+    ~ShmRing();
+
+    //consumer create the ring, a ring left by last consumer is retired, not reused.
+    int Create(const std::string & sName, const uint32_t iCapacity);
+
+    //producer attach to an exist ring.
+    int Attach(const std::string & sName);
+
+    //consumer mark the ring closed and unlink it, attached producers will see it.
+    void Close();
+
+public:
+    //return 0 ok, -2 ring full, -1 closed, retired or too large.
+    int Push(const char * pcData, const int iLen);
+
+    //consumer wait at most iTimeoutMs for new record, return true if has record.
+    bool Wait(const int iTimeoutMs);
+
+    //record is valid until Commit.
+    bool Front(const char *& pcData, int & iLen);
+
+    void Pop();
+
+    //give consumed space back to producers.
+    void Commit();
+
+    //closed by consumer or retired by a restarted consumer, producer should attach again.
+    const bool IsClosed() const;
+
+private:
+    struct Header;
+
+    //mark the ring of sName retired and unlink it, return it's generation, 0 if none.
+    static uint32_t RetireRing(const std::string & sName);
+
+    int Map(const int iFd, const size_t iMapSize);
+
+    void Unmap();
+
+    int Lock();
+
+    void Unlock();
+
+private:
+    std::string m_sName;
+    Header * m_poHeader;
+    char * m_pcData;
+    size_t m_iMapSize;
+    uint32_t m_iGeneration;
+
+    //consumer local cursor.
+    uint64_t m_llReadPos;
+    uint64_t m_llWritePos;
+    uint32_t m_iFrontRecordLen;
+};
+
+}
@@ -21,7 +21,6 @@ See the AUTHORS file for names of contributors.
 
 #include "acceptor.h"
 #include "paxos_log.h"
-#include "crc32.h"
 
 namespace phxpaxos
 {
@@ -89,7 +88,7 @@ int AcceptorState :: Persist(const uint64_t llInstanceID, const uint32_t iLastCh
     }
     else if (m_sAcceptedValue.size() > 0)
     {
-        m_iChecksum = crc32(iLastChecksum, (const uint8_t *)m_sAcceptedValue.data(), m_sAcceptedValue.size(), CRC32SKIP);
+        m_iChecksum = m_poConfig->ChainChecksum(iLastChecksum, m_sAcceptedValue);
     }
     
     AcceptorStateData oState;
@@ -116,7 +115,8 @@ int AcceptorState :: Persist(const uint64_t llInstanceID, const uint32_t iLastCh
         }
     }
 
-    int ret = m_oPaxosLog.WriteState(oWriteOptions, m_poConfig->GetMyGroupIdx(), llInstanceID, oState);
+    int ret = m_oPaxosLog.WriteState(oWriteOptions, m_poConfig->GetMyGroupIdx(), llInstanceID, oState,
+            m_poConfig->GetValueCompressThreshold(), m_poConfig->GetValueCompressDictID());
     if (ret != 0)
     {
         return ret;
@@ -312,7 +312,19 @@ void Acceptor :: OnAccept(const PaxosMsg & oPaxosMsg)
         m_oAcceptorState.SetAcceptedBallot(oBallot);
         m_oAcceptorState.SetAcceptedValue(oPaxosMsg.value());
         
+        bool bIsMyAccept = oPaxosMsg.nodeid() == m_poConfig->GetMyNodeID();
+        if (bIsMyAccept)
+        {
+            TraceCommitBegin(CommitStage_Persist);
+        }
+
         int ret = m_oAcceptorState.Persist(GetInstanceID(), GetLastChecksum());
+
+        if (bIsMyAccept)
+        {
+            TraceCommitEnd(CommitStage_Persist);
+        }
+
         if (ret != 0)
         {
             BP->GetAcceptorBP()->OnAcceptPersistFail();
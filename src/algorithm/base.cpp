@@ -63,10 +63,41 @@ const uint32_t Base :: GetLastChecksum() const
     return m_poInstance->GetLastChecksum();
 }
 
-int Base :: PackMsg(const PaxosMsg & oPaxosMsg, std::string & sBuffer)
+const bool Base :: IsValueNeedCompress(const PaxosMsg & oPaxosMsg) const
+{
+    int iCompressThreshold = m_poConfig->GetValueCompressThreshold();
+    return iCompressThreshold > 0 && (int)oPaxosMsg.value().size() >= iCompressThreshold;
+}
+
+int Base :: PackMsg(const PaxosMsg & oPaxosMsg, const bool bCompressValue, std::string & sBuffer)
 {
     std::string sBodyBuffer;
-    bool bSucc = oPaxosMsg.SerializeToString(&sBodyBuffer);
+    bool bSucc = false;
+
+    std::string sCompressValue;
+    uint64_t llBeginTimeUs = Time::GetSteadyClockUS();
+    int ret = bCompressValue ? 
+        ValueCompressor::Compress(m_poConfig->GetValueCompressDictID(), oPaxosMsg.value(), sCompressValue) : 1;
+    if (ret == 0)
+    {
+        BP->GetAlgorithmBaseBP()->ValueCompress(oPaxosMsg.value().size(), sCompressValue.size(), 
+                (int)(Time::GetSteadyClockUS() - llBeginTimeUs));
+
+        PaxosMsg oCompressMsg(oPaxosMsg);
+        oCompressMsg.set_value(sCompressValue);
+        oCompressMsg.set_flag(oPaxosMsg.flag() | PaxosMsgFlagType_ValueCompressed);
+        bSucc = oCompressMsg.SerializeToString(&sBodyBuffer);
+    }
+    else
+    {
+        if (bCompressValue)
+        {
+            BP->GetAlgorithmBaseBP()->ValueCompressSkip(oPaxosMsg.value().size());
+        }
+
+        bSucc = oPaxosMsg.SerializeToString(&sBodyBuffer);
+    }
+
     if (!bSucc)
     {
         PLGErr("PaxosMsg.SerializeToString fail, skip this msg");
@@ -95,6 +126,54 @@ int Base :: PackCheckpointMsg(const CheckpointMsg & oCheckpointMsg, std::string
     return 0;
 }
 
+int Base :: PackValueChunkMsg(const ValueChunkMsg & oValueChunkMsg, std::string & sBuffer)
+{
+    std::string sBodyBuffer;
+    bool bSucc = oValueChunkMsg.SerializeToString(&sBodyBuffer);
+    if (!bSucc)
+    {
+        PLGErr("ValueChunkMsg.SerializeToString fail, skip this msg");
+        return -1;
+    }
+
+    int iCmd = MsgCmd_ValueChunkMsg;
+    PackBaseMsg(sBodyBuffer, iCmd, sBuffer);
+
+    return 0;
+}
+
+int Base :: PackForwardMsg(const ForwardMsg & oForwardMsg, std::string & sBuffer)
+{
+    std::string sBodyBuffer;
+    bool bSucc = oForwardMsg.SerializeToString(&sBodyBuffer);
+    if (!bSucc)
+    {
+        PLGErr("ForwardMsg.SerializeToString fail, skip this msg");
+        return -1;
+    }
+
+    int iCmd = MsgCmd_ForwardMsg;
+    PackBaseMsg(sBodyBuffer, iCmd, sBuffer);
+
+    return 0;
+}
+
+int Base :: PackMasterLeaseMsg(const MasterLeaseMsg & oMasterLeaseMsg, std::string & sBuffer)
+{
+    std::string sBodyBuffer;
+    bool bSucc = oMasterLeaseMsg.SerializeToString(&sBodyBuffer);
+    if (!bSucc)
+    {
+        PLGErr("MasterLeaseMsg.SerializeToString fail, skip this msg");
+        return -1;
+    }
+
+    int iCmd = MsgCmd_MasterLeaseMsg;
+    PackBaseMsg(sBodyBuffer, iCmd, sBuffer);
+
+    return 0;
+}
+
 void Base :: PackBaseMsg(const std::string & sBodyBuffer, const int iCmd, std::string & sBuffer)
 {
     char sGroupIdx[GROUPIDXLEN] = {0};
@@ -105,7 +184,13 @@ void Base :: PackBaseMsg(const std::string & sBodyBuffer, const int iCmd, std::s
     oHeader.set_gid(m_poConfig->GetGid());
     oHeader.set_rid(0);
     oHeader.set_cmdid(iCmd);
-    oHeader.set_version(1);
+    oHeader.set_version(HEADER_VERSION_VALUE_COMPRESS);
+
+    int iChecksumType = m_poConfig->GetChecksumType();
+    if (iChecksumType != ChecksumType_Crc32)
+    {
+        oHeader.set_checksumtype(iChecksumType);
+    }
 
     std::string sHeaderBuffer;
     bool bSucc = oHeader.SerializeToString(&sHeaderBuffer);
@@ -122,13 +207,23 @@ void Base :: PackBaseMsg(const std::string & sBodyBuffer, const int iCmd, std::s
     sBuffer = string(sGroupIdx, sizeof(sGroupIdx)) + string(sHeaderLen, sizeof(sHeaderLen)) + sHeaderBuffer + sBodyBuffer;
 
     //check sum
-    uint32_t iBufferChecksum = crc32(0, (const uint8_t *)sBuffer.data(), sBuffer.size(), NET_CRC32SKIP);
+    uint32_t iBufferChecksum = BufferChecksum(iChecksumType, sBuffer.data(), sBuffer.size());
     char sBufferChecksum[CHECKSUM_LEN] = {0};
     memcpy(sBufferChecksum, &iBufferChecksum, sizeof(sBufferChecksum));
 
     sBuffer += string(sBufferChecksum, sizeof(sBufferChecksum));
 }
 
+uint32_t Base :: BufferChecksum(const int iChecksumType, const char * pcBuffer, const size_t iBufferLen)
+{
+    if (iChecksumType == ChecksumType_Crc32C)
+    {
+        return crc32c(0, (const uint8_t *)pcBuffer, iBufferLen);
+    }
+
+    return crc32(0, (const uint8_t *)pcBuffer, iBufferLen, NET_CRC32SKIP);
+}
+
 int Base :: UnPackBaseMsg(const std::string & sBuffer, Header & oHeader, size_t & iBodyStartPos, size_t & iBodyLen)
 {
     uint16_t iHeaderLen = 0;
@@ -167,7 +262,7 @@ int Base :: UnPackBaseMsg(const std::string & sBuffer, Header & oHeader, size_t
         uint32_t iBufferChecksum = 0;
         memcpy(&iBufferChecksum, sBuffer.data() + sBuffer.size() - CHECKSUM_LEN, CHECKSUM_LEN);
         
-        uint32_t iNewCalBufferChecksum = crc32(0, (const uint8_t *)sBuffer.data(), sBuffer.size() - CHECKSUM_LEN, NET_CRC32SKIP);
+        uint32_t iNewCalBufferChecksum = BufferChecksum(oHeader.checksumtype(), sBuffer.data(), sBuffer.size() - CHECKSUM_LEN);
         if (iNewCalBufferChecksum != iBufferChecksum)
         {
             BP->GetAlgorithmBaseBP()->UnPackChecksumNotSame();
@@ -206,6 +301,93 @@ int Base :: SendMessage(const nodeid_t iSendtoNodeID, const CheckpointMsg & oChe
     return m_poMsgTransport->SendMessage(m_poConfig->GetMyGroupIdx(), iSendtoNodeID, sBuffer, iSendType);
 }
 
+int Base :: SendMessage(const nodeid_t iSendtoNodeID, const ValueChunkMsg & oValueChunkMsg, const int iSendType)
+{
+    if (iSendtoNodeID == m_poConfig->GetMyNodeID())
+    {
+        return 0; 
+    }
+    
+    string sBuffer;
+    int ret = PackValueChunkMsg(oValueChunkMsg, sBuffer);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    return m_poMsgTransport->SendMessage(m_poConfig->GetMyGroupIdx(), iSendtoNodeID, sBuffer, iSendType);
+}
+
+int Base :: SendMessage(const nodeid_t iSendtoNodeID, const ForwardMsg & oForwardMsg, const int iSendType)
+{
+    if (iSendtoNodeID == m_poConfig->GetMyNodeID())
+    {
+        return 0; 
+    }
+    
+    string sBuffer;
+    int ret = PackForwardMsg(oForwardMsg, sBuffer);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    return m_poMsgTransport->SendMessage(m_poConfig->GetMyGroupIdx(), iSendtoNodeID, sBuffer, iSendType);
+}
+
+int Base :: SendMessage(const nodeid_t iSendtoNodeID, const MasterLeaseMsg & oMasterLeaseMsg, const int iSendType)
+{
+    if (iSendtoNodeID == m_poConfig->GetMyNodeID())
+    {
+        return 0; 
+    }
+    
+    string sBuffer;
+    int ret = PackMasterLeaseMsg(oMasterLeaseMsg, sBuffer);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    return m_poMsgTransport->SendMessage(m_poConfig->GetMyGroupIdx(), iSendtoNodeID, sBuffer, iSendType);
+}
+
+int Base :: BroadcastMasterLeaseMsg(const MasterLeaseMsg & oMasterLeaseMsg, const int iSendType)
+{
+    string sBuffer;
+    int ret = PackMasterLeaseMsg(oMasterLeaseMsg, sBuffer);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    ret = m_poMsgTransport->BroadcastMessage(m_poConfig->GetMyGroupIdx(), sBuffer, iSendType);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    return m_poMsgTransport->BroadcastMessageFollower(m_poConfig->GetMyGroupIdx(), sBuffer, iSendType);
+}
+
+int Base :: BroadcastValueChunkMsg(const ValueChunkMsg & oValueChunkMsg, const int iSendType)
+{
+    string sBuffer;
+    int ret = PackValueChunkMsg(oValueChunkMsg, sBuffer);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    ret = m_poMsgTransport->BroadcastMessage(m_poConfig->GetMyGroupIdx(), sBuffer, iSendType);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    return m_poMsgTransport->BroadcastMessageFollower(m_poConfig->GetMyGroupIdx(), sBuffer, iSendType);
+}
+
 int Base :: SendMessage(const nodeid_t iSendtoNodeID, const PaxosMsg & oPaxosMsg, const int iSendType)
 {
     if (m_bIsTestMode)
@@ -221,8 +403,10 @@ int Base :: SendMessage(const nodeid_t iSendtoNodeID, const PaxosMsg & oPaxosMsg
         return 0; 
     }
     
+    bool bCompressValue = IsValueNeedCompress(oPaxosMsg) && m_poConfig->IsNodeValueCompressSupport(iSendtoNodeID);
+
     string sBuffer;
-    int ret = PackMsg(oPaxosMsg, sBuffer);
+    int ret = PackMsg(oPaxosMsg, bCompressValue, sBuffer);
     if (ret != 0)
     {
         return ret;
@@ -248,8 +432,10 @@ int Base :: BroadcastMessage(const PaxosMsg & oPaxosMsg, const int iRunType, con
         }
     }
     
+    bool bCompressValue = IsValueNeedCompress(oPaxosMsg) && m_poConfig->IsAllMemberValueCompressSupport();
+
     string sBuffer;
-    int ret = PackMsg(oPaxosMsg, sBuffer);
+    int ret = PackMsg(oPaxosMsg, bCompressValue, sBuffer);
     if (ret != 0)
     {
         return ret;
@@ -268,7 +454,7 @@ int Base :: BroadcastMessage(const PaxosMsg & oPaxosMsg, const int iRunType, con
 int Base :: BroadcastMessageToFollower(const PaxosMsg & oPaxosMsg, const int iSendType)
 {
     string sBuffer;
-    int ret = PackMsg(oPaxosMsg, sBuffer);
+    int ret = PackMsg(oPaxosMsg, false, sBuffer);
     if (ret != 0)
     {
         return ret;
@@ -280,7 +466,7 @@ int Base :: BroadcastMessageToFollower(const PaxosMsg & oPaxosMsg, const int iSe
 int Base :: BroadcastMessageToTempNode(const PaxosMsg & oPaxosMsg, const int iSendType)
 {
     string sBuffer;
-    int ret = PackMsg(oPaxosMsg, sBuffer);
+    int ret = PackMsg(oPaxosMsg, false, sBuffer);
     if (ret != 0)
     {
         return ret;
@@ -295,6 +481,22 @@ void Base :: SetAsTestMode()
 {
     m_bIsTestMode = true;
 }
+
+void Base :: TraceCommitBegin(const int iStage)
+{
+    if (m_poInstance != nullptr)
+    {
+        m_poInstance->GetCommitCtx()->TraceBegin(iStage, GetInstanceID());
+    }
+}
+
+void Base :: TraceCommitEnd(const int iStage)
+{
+    if (m_poInstance != nullptr)
+    {
+        m_poInstance->GetCommitCtx()->TraceEnd(iStage, GetInstanceID());
+    }
+}
     
 }
 
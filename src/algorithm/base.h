@@ -33,6 +33,9 @@ namespace phxpaxos
 #define HEADLEN_LEN (sizeof(uint16_t))
 #define CHECKSUM_LEN (sizeof(uint32_t))
 
+//header version >= 2 means sender can decompress PaxosMsg value.
+#define HEADER_VERSION_VALUE_COMPRESS 2
+
 
 class BallotNumber
 {
@@ -121,10 +124,19 @@ public:
 
     void SetInstanceID(const uint64_t llInstanceID);
 
-    int PackMsg(const PaxosMsg & oPaxosMsg, std::string & sBuffer);
+    const bool IsValueNeedCompress(const PaxosMsg & oPaxosMsg) const;
+
+    int PackMsg(const PaxosMsg & oPaxosMsg, const bool bCompressValue, std::string & sBuffer);
+
     
     int PackCheckpointMsg(const CheckpointMsg & oCheckpointMsg, std::string & sBuffer);
 
+    int PackValueChunkMsg(const ValueChunkMsg & oValueChunkMsg, std::string & sBuffer);
+
+    int PackForwardMsg(const ForwardMsg & oForwardMsg, std::string & sBuffer);
+
+    int PackMasterLeaseMsg(const MasterLeaseMsg & oMasterLeaseMsg, std::string & sBuffer);
+
 public:
     const uint32_t GetLastChecksum() const;
     
@@ -132,8 +144,17 @@ public:
 
     static int UnPackBaseMsg(const std::string & sBuffer, Header & oHeader, size_t & iBodyStartPos, size_t & iBodyLen);
 
+    //sender set ChecksumType in header, so receiver can check any type.
+    static uint32_t BufferChecksum(const int iChecksumType, const char * pcBuffer, const size_t iBufferLen);
+
     void SetAsTestMode();
 
+protected:
+    //Latency trace of my commit on current instance.
+    void TraceCommitBegin(const int iStage);
+
+    void TraceCommitEnd(const int iStage);
+
 protected:
     virtual int SendMessage(const nodeid_t iSendtoNodeID, const PaxosMsg & oPaxosMsg, const int iSendType = Message_SendType_UDP);
 
@@ -154,6 +175,24 @@ protected:
     int SendMessage(const nodeid_t iSendtoNodeID, const CheckpointMsg & oCheckpointMsg, 
             const int iSendType = Message_SendType_TCP);
 
+protected:
+    int SendMessage(const nodeid_t iSendtoNodeID, const ValueChunkMsg & oValueChunkMsg, 
+            const int iSendType = Message_SendType_TCP);
+
+    int SendMessage(const nodeid_t iSendtoNodeID, const ForwardMsg & oForwardMsg, 
+            const int iSendType = Message_SendType_TCP);
+
+    int SendMessage(const nodeid_t iSendtoNodeID, const MasterLeaseMsg & oMasterLeaseMsg, 
+            const int iSendType = Message_SendType_UDP);
+
+    //send to all members except me and followers, followers extend their view of the lease too.
+    int BroadcastMasterLeaseMsg(const MasterLeaseMsg & oMasterLeaseMsg, 
+            const int iSendType = Message_SendType_UDP);
+
+    //send to all members and followers.
+    int BroadcastValueChunkMsg(const ValueChunkMsg & oValueChunkMsg, 
+            const int iSendType = Message_SendType_TCP);
+
 protected:
     Config * m_poConfig;
     MsgTransport * m_poMsgTransport;
@@ -21,6 +21,7 @@ See the AUTHORS file for names of contributors.
 
 #include "checkpoint_receiver.h"
 #include "comm_include.h"
+#include "sm_base.h"
 #include <vector>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -32,18 +33,27 @@ namespace phxpaxos
 {
 
 CheckpointReceiver :: CheckpointReceiver(Config * poConfig, LogStorage * poLogStorage) :
-    m_poConfig(poConfig), m_poLogStorage(poLogStorage)
+    m_poConfig(poConfig), m_poLogStorage(poLogStorage), 
+    m_bIsReuseFileValid(false), m_bIsListingReuseFile(false), m_poListThread(nullptr)
 {
     Reset();
 }
 
 CheckpointReceiver :: ~CheckpointReceiver()
 {
+    if (m_poListThread != nullptr)
+    {
+        m_poListThread->join();
+        delete m_poListThread;
+    }
 }
 
 void CheckpointReceiver :: Reset()
 {
+    m_oWriter.Reset();
+
     m_mapHasInitDir.clear();
+    m_mapFileOffset.clear();
     
     m_iSenderNodeID = nullnode;
     m_llUUID = 0;
@@ -52,6 +62,9 @@ void CheckpointReceiver :: Reset()
 
 int CheckpointReceiver :: NewReceiver(const nodeid_t iSenderNodeID, const uint64_t llUUID)
 {
+    //chunks of last receive must not write to files after we clear them.
+    m_oWriter.Reset();
+
     int ret = ClearCheckpointTmp();
     if (ret != 0)
     {
@@ -67,6 +80,7 @@ int CheckpointReceiver :: NewReceiver(const nodeid_t iSenderNodeID, const uint64
     }
     
     m_mapHasInitDir.clear();
+    m_mapFileOffset.clear();
 
     m_iSenderNodeID = iSenderNodeID;
     m_llUUID = llUUID;
@@ -126,6 +140,19 @@ const bool CheckpointReceiver :: IsReceiverFinish(const nodeid_t iSenderNodeID,
     }
 }
 
+const bool CheckpointReceiver :: IsSequenceGap(const nodeid_t iSenderNodeID, 
+        const uint64_t llUUID, const uint64_t llSequence)
+{
+    return iSenderNodeID == m_iSenderNodeID
+        && llUUID == m_llUUID
+        && llSequence > m_llSequence + 1;
+}
+
+const uint64_t CheckpointReceiver :: GetExpectSequence() const
+{
+    return m_llSequence + 1;
+}
+
 const std::string CheckpointReceiver :: GetTmpDirPath(const int iSMID)
 {
     string sLogStoragePath = m_poLogStorage->GetLogStorageDirPath(m_poConfig->GetMyGroupIdx());
@@ -208,7 +235,7 @@ int CheckpointReceiver :: CreateDir(const std::string & sDirPath)
     return 0;
 }
 
-int CheckpointReceiver :: ReceiveCheckpoint(const CheckpointMsg & oCheckpointMsg)
+int CheckpointReceiver :: CheckSequence(const CheckpointMsg & oCheckpointMsg)
 {
     if (oCheckpointMsg.nodeid() != m_iSenderNodeID
             || oCheckpointMsg.uuid() != m_llUUID)
@@ -218,11 +245,12 @@ int CheckpointReceiver :: ReceiveCheckpoint(const CheckpointMsg & oCheckpointMsg
         return -2;
     }
 
-    if (oCheckpointMsg.sequence() == m_llSequence)
+    //sender resend from the lost one, chunks received before are skipped.
+    if (oCheckpointMsg.sequence() <= m_llSequence)
     {
         PLGErr("msg already receive, skip, Msg.Sequence %lu Receiver.Sequence %lu",
                 oCheckpointMsg.sequence(), m_llSequence);
-        return 0;
+        return 1;
     }
 
     if (oCheckpointMsg.sequence() != m_llSequence + 1)
@@ -232,41 +260,211 @@ int CheckpointReceiver :: ReceiveCheckpoint(const CheckpointMsg & oCheckpointMsg
         return -2;
     }
 
+    return 0;
+}
+
+int CheckpointReceiver :: ReceiveCheckpoint(const CheckpointMsg & oCheckpointMsg)
+{
+    int ret = CheckSequence(oCheckpointMsg);
+    if (ret != 0)
+    {
+        return ret == 1 ? 0 : ret;
+    }
+
     string sFilePath = GetTmpDirPath(oCheckpointMsg.smid()) + "/" + oCheckpointMsg.filepath();
     string sFormatFilePath;
-    int ret = InitFilePath(sFilePath, sFormatFilePath);
+    ret = InitFilePath(sFilePath, sFormatFilePath);
     if (ret != 0)
     {
         return -1;
     }
 
-    int iFd = open(sFormatFilePath.c_str(), O_CREAT | O_RDWR | O_APPEND, S_IWRITE | S_IREAD);
-    if (iFd == -1)
+    uint64_t & llFileOffset = m_mapFileOffset[sFormatFilePath];
+    if (llFileOffset != oCheckpointMsg.offset())
+    {
+        PLGErr("file.offset %lu not equal to msg.offset %lu", llFileOffset, oCheckpointMsg.offset());
+        return -2;
+    }
+
+    //checksum and disk write are done by writer thread, ioloop only check order.
+    ret = m_oWriter.AddChunk(sFormatFilePath, oCheckpointMsg.offset(), oCheckpointMsg.filesize(),
+            oCheckpointMsg.checksum(), oCheckpointMsg.buffer());
+    if (ret != 0)
     {
-        PLGErr("open file fail, filepath %s", sFormatFilePath.c_str());
+        PLGErr("AddChunk fail, ret %d filepath %s", ret, sFormatFilePath.c_str());
         return -1;
     }
 
-    size_t llFileOffset = lseek(iFd, 0, SEEK_END);
-    if ((uint64_t)llFileOffset != oCheckpointMsg.offset())
+    llFileOffset += oCheckpointMsg.buffer().size();
+    m_llSequence++;
+
+    PLGImp("END ok, writelen %zu", oCheckpointMsg.buffer().size());
+
+    return 0;
+}
+
+int CheckpointReceiver :: ReceiveReuseFile(const CheckpointMsg & oCheckpointMsg)
+{
+    int ret = CheckSequence(oCheckpointMsg);
+    if (ret != 0)
+    {
+        return ret == 1 ? 0 : ret;
+    }
+
+    CheckpointFileInfo oLocalFile;
+    bool bHasFile = false;
     {
-        PLGErr("file.offset %zu not equal to msg.offset %lu", llFileOffset, oCheckpointMsg.offset());
-        close(iFd);
+        std::lock_guard<std::mutex> oLock(m_oReuseMutex);
+        auto it = m_mapReuseFile.find(make_pair(oCheckpointMsg.smid(), oCheckpointMsg.filepath()));
+        if (it != end(m_mapReuseFile)
+                && it->second.m_llFileSize == oCheckpointMsg.filesize()
+                && it->second.m_llChecksum == oCheckpointMsg.filechecksum())
+        {
+            oLocalFile = it->second;
+            bHasFile = true;
+        }
+    }
+
+    if (!bHasFile)
+    {
+        PLGErr("we not have this file, smid %d filepath %s filesize %lu filechecksum %lu",
+                oCheckpointMsg.smid(), oCheckpointMsg.filepath().c_str(), 
+                oCheckpointMsg.filesize(), oCheckpointMsg.filechecksum());
+        InvalidReuseFiles();
         return -2;
     }
 
-    size_t iWriteLen = write(iFd, oCheckpointMsg.buffer().data(), oCheckpointMsg.buffer().size());
-    if (iWriteLen != oCheckpointMsg.buffer().size())
+    string sFilePath = GetTmpDirPath(oCheckpointMsg.smid()) + "/" + oCheckpointMsg.filepath();
+    string sFormatFilePath;
+    ret = InitFilePath(sFilePath, sFormatFilePath);
+    if (ret != 0)
+    {
+        return -1;
+    }
+
+    ret = m_oWriter.AddLink(oLocalFile.m_sFilePath, sFormatFilePath, oLocalFile.m_llFileSize);
+    if (ret != 0)
     {
-        PLGImp("write fail, writelen %zu buffer size %zu", iWriteLen, oCheckpointMsg.buffer().size());
-        close(iFd);
+        PLGErr("AddLink fail, ret %d filepath %s", ret, sFormatFilePath.c_str());
+        InvalidReuseFiles();
         return -1;
     }
 
     m_llSequence++;
-    close(iFd);
 
-    PLGImp("END ok, writelen %zu", iWriteLen);
+    PLGImp("END ok, reuse %s", oLocalFile.m_sFilePath.c_str());
+
+    return 0;
+}
+
+int CheckpointReceiver :: PrepareReuseFiles(SMFac * poSMFac, std::string & sCheckpointFiles)
+{
+    sCheckpointFiles.clear();
+
+    //list and hash files may be slow, same checkpoint has the same files.
+    std::vector<uint64_t> vecCheckpointInstanceID;
+    for (auto & poSM : poSMFac->GetSMList())
+    {
+        vecCheckpointInstanceID.push_back(poSM->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx()));
+    }
+
+    std::lock_guard<std::mutex> oLock(m_oReuseMutex);
+
+    if (m_bIsReuseFileValid && vecCheckpointInstanceID == m_vecReuseCheckpointInstanceID)
+    {
+        sCheckpointFiles = m_sReuseCheckpointFiles;
+        PLGImp("ok, checkpoint not change, reuse file count %zu", m_mapReuseFile.size());
+        return 0;
+    }
+
+    if (!m_bIsListingReuseFile)
+    {
+        //last listing is done, it's thread is exiting.
+        if (m_poListThread != nullptr)
+        {
+            m_poListThread->join();
+            delete m_poListThread;
+        }
+
+        m_bIsListingReuseFile = true;
+        m_poListThread = new std::thread(&CheckpointReceiver::ListReuseFiles, this, poSMFac, vecCheckpointInstanceID);
+    }
+
+    PLGImp("reuse files not ready");
+
+    return 1;
+}
+
+void CheckpointReceiver :: ListReuseFiles(SMFac * poSMFac, const std::vector<uint64_t> & vecCheckpointInstanceID)
+{
+    std::map<std::pair<int, std::string>, CheckpointFileInfo> mapReuseFile;
+    CheckpointFileList oFileList;
+    for (auto & poSM : poSMFac->GetSMList())
+    {
+        string sDirPath;
+        CheckpointFileInfoList vecFileInfoList;
+        int ret = poSM->GetCheckpointImmutableFiles(m_poConfig->GetMyGroupIdx(), sDirPath, vecFileInfoList);
+        if (ret != 0)
+        {
+            PLGErr("GetCheckpointImmutableFiles fail, ret %d smid %d", ret, poSM->SMID());
+            continue;
+        }
+
+        for (auto & oFileInfo : vecFileInfoList)
+        {
+            CheckpointFile * poFile = oFileList.add_files();
+            poFile->set_smid(poSM->SMID());
+            poFile->set_filepath(oFileInfo.m_sFilePath);
+            poFile->set_filesize(oFileInfo.m_llFileSize);
+            poFile->set_filechecksum(oFileInfo.m_llChecksum);
+
+            CheckpointFileInfo oLocalFile = oFileInfo;
+            oLocalFile.m_sFilePath = sDirPath + "/" + oFileInfo.m_sFilePath;
+            mapReuseFile[make_pair(poSM->SMID(), oFileInfo.m_sFilePath)] = oLocalFile;
+        }
+    }
+
+    string sCheckpointFiles;
+    bool bSucc = true;
+    if (oFileList.files_size() > 0)
+    {
+        bSucc = oFileList.SerializeToString(&sCheckpointFiles);
+        if (!bSucc)
+        {
+            PLGErr("CheckpointFileList.SerializeToString fail");
+            mapReuseFile.clear();
+            sCheckpointFiles.clear();
+        }
+    }
+
+    std::lock_guard<std::mutex> oLock(m_oReuseMutex);
+
+    m_mapReuseFile.swap(mapReuseFile);
+    m_sReuseCheckpointFiles = sCheckpointFiles;
+    m_vecReuseCheckpointInstanceID = vecCheckpointInstanceID;
+    m_bIsReuseFileValid = bSucc;
+    m_bIsListingReuseFile = false;
+
+    PLGImp("ok, reuse file count %d", oFileList.files_size());
+}
+
+void CheckpointReceiver :: InvalidReuseFiles()
+{
+    std::lock_guard<std::mutex> oLock(m_oReuseMutex);
+    m_bIsReuseFileValid = false;
+}
+
+int CheckpointReceiver :: FinishReceive()
+{
+    string sLogStoragePath = m_poLogStorage->GetLogStorageDirPath(m_poConfig->GetMyGroupIdx());
+    int ret = m_oWriter.Finish(sLogStoragePath);
+    if (ret != 0)
+    {
+        //a reused file may be gone, list them again next time.
+        InvalidReuseFiles();
+        PLGErr("Finish fail, ret %d", ret);
+        return ret;
+    }
 
     return 0;
 }
@@ -22,16 +22,21 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <map>
+#include <mutex>
+#include <thread>
 #include <string>
+#include <vector>
 #include "phxpaxos/options.h"
 #include "comm_include.h"
 #include "config_include.h"
+#include "checkpoint_writer.h"
 
 namespace phxpaxos
 {
 
 class Config;
 class LogStorage;
+class SMFac;
 
 class CheckpointReceiver
 {
@@ -45,13 +50,32 @@ public:
 
     const bool IsReceiverFinish(const nodeid_t iSenderNodeID, const uint64_t llUUID, const uint64_t llEndSequence);
 
+    const bool IsSequenceGap(const nodeid_t iSenderNodeID, const uint64_t llUUID, const uint64_t llSequence);
+
+    const uint64_t GetExpectSequence() const;
+
     const std::string GetTmpDirPath(const int iSMID);
 
     int ReceiveCheckpoint(const CheckpointMsg & oCheckpointMsg);
 
+    int ReceiveReuseFile(const CheckpointMsg & oCheckpointMsg);
+
+    //Advertise files we have, sender can skip them.
+    //Files are listed again only after checkpoint of any sm change or a reuse fail.
+    //Listing may be slow, so it run on a background thread, return 1 and empty files until it done.
+    int PrepareReuseFiles(SMFac * poSMFac, std::string & sCheckpointFiles);
+
+    int FinishReceive();
+
     int InitFilePath(const std::string & sFilePath, std::string & sFormatFilePath);
 private:
 
+    int CheckSequence(const CheckpointMsg & oCheckpointMsg);
+
+    void ListReuseFiles(SMFac * poSMFac, const std::vector<uint64_t> & vecCheckpointInstanceID);
+
+    void InvalidReuseFiles();
+
     int ClearCheckpointTmp();
 
     int CreateDir(const std::string & sDirPath);
@@ -67,6 +91,17 @@ private:
 
 private:
     std::map<std::string, bool> m_mapHasInitDir;
+    std::map<std::string, uint64_t> m_mapFileOffset;
+    CheckpointWriter m_oWriter;
+
+private:
+    std::mutex m_oReuseMutex;
+    std::map<std::pair<int, std::string>, CheckpointFileInfo> m_mapReuseFile;
+    bool m_bIsReuseFileValid;
+    bool m_bIsListingReuseFile;
+    std::thread * m_poListThread;
+    std::vector<uint64_t> m_vecReuseCheckpointInstanceID;
+    std::string m_sReuseCheckpointFiles;
 };
     
 }
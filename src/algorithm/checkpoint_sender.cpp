@@ -25,6 +25,8 @@ See the AUTHORS file for names of contributors.
 #include "sm_base.h"
 #include "cp_mgr.h"
 #include "crc32.h"
+#include "credit_notifier.h"
+#include <algorithm>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -53,6 +55,15 @@ CheckpointSender :: CheckpointSender(
 
     m_llAckSequence = 0;
     m_llAbsLastAckTime = 0;
+    m_llNeedResendSequence = 0;
+    m_llLastResendSequence = 0;
+    m_llLastResendTime = 0;
+
+    m_llSendBytes = 0;
+    m_llReuseBytes = 0;
+    m_llStartTime = 0;
+    m_llLastReportSendBytes = 0;
+    m_llLastReportTime = 0;
 }
 
 CheckpointSender :: ~CheckpointSender()
@@ -82,6 +93,8 @@ void CheckpointSender :: run()
 {
     m_bIsStarted = true;
     m_llAbsLastAckTime = Time::GetSteadyClockMS();
+    m_llStartTime = m_llAbsLastAckTime;
+    m_llLastReportTime = m_llAbsLastAckTime;
 
     //pause checkpoint replayer
     bool bNeedContinue = false;
@@ -184,6 +197,13 @@ void CheckpointSender :: SendCheckpoint()
         }
     }
 
+    //all chunks must be received before end, receiver check end sequence.
+    if (!CheckAck(m_llSequence, 0))
+    {
+        PLGErr("wait all chunks ack fail, sequence %lu", m_llSequence);
+        return;
+    }
+
     ret = m_poLearner->SendCheckpointEnd(
             m_iSendNodeID, m_llUUID, m_llSequence, 
             m_poSMFac->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx()));
@@ -192,6 +212,7 @@ void CheckpointSender :: SendCheckpoint()
         PLGErr("SendCheckpointEnd fail, sequence %lu ret %d", m_llSequence, ret);
     }
     
+    ReportThroughput(true);
     BP->GetCheckpointBP()->SendCheckpointEnd();
 }
 
@@ -218,87 +239,289 @@ int CheckpointSender :: SendCheckpointFofaSM(StateMachine * poSM)
         sDirPath += '/';
     }
 
-    for (auto & sFilePath : vecFileList)
+    std::map<std::string, CheckpointFileInfo> mapReuseFile;
+    ret = GetReuseFiles(poSM, mapReuseFile);
+    if (ret != 0)
     {
-        ret = SendFile(poSM, sDirPath, sFilePath);
-        if (ret != 0)
+        return -1;
+    }
+
+    //send several files at once, one chunk from each file in turn,
+    //kernel readahead of all these files run in parallel.
+    std::vector<CheckpointSendingFile> vecSendingFile;
+    size_t iNextFileIdx = 0;
+    while (ret == 0 && (iNextFileIdx < vecFileList.size() || vecSendingFile.size() > 0))
+    {
+        while ((int)vecSendingFile.size() < Checkpoint_SEND_PARALLEL_FILES
+                && iNextFileIdx < vecFileList.size())
         {
-            PLGErr("SendFile fail, ret %d smid %d", ret , poSM->SMID());
-            return -1;
+            const std::string & sFilePath = vecFileList[iNextFileIdx++];
+            if (m_mapAlreadySendedFile.find(sDirPath + sFilePath) != end(m_mapAlreadySendedFile))
+            {
+                PLGErr("file already send, filepath %s", (sDirPath + sFilePath).c_str());
+                continue;
+            }
+
+            auto itReuse = mapReuseFile.find(sFilePath);
+            if (itReuse != end(mapReuseFile))
+            {
+                ret = SendReuseFile(poSM, sDirPath, itReuse->second);
+                if (ret != 0)
+                {
+                    break;
+                }
+
+                continue;
+            }
+
+            CheckpointSendingFile oFile;
+            ret = OpenFile(sDirPath, sFilePath, oFile);
+            if (ret != 0)
+            {
+                break;
+            }
+
+            vecSendingFile.push_back(oFile);
+        }
+
+        for (auto it = vecSendingFile.begin(); ret == 0 && it != vecSendingFile.end();)
+        {
+            bool bIsFileEnd = false;
+            ret = SendFileChunk(poSM, *it, bIsFileEnd);
+            if (ret != 0)
+            {
+                break;
+            }
+
+            if (bIsFileEnd)
+            {
+                PLGImp("file send ok, filepath %s size %lu", it->sPath.c_str(), it->llOffset);
+
+                m_mapAlreadySendedFile[it->sPath] = true;
+                close(it->iFD);
+                it = vecSendingFile.erase(it);
+            }
+            else
+            {
+                it++;
+            }
         }
     }
 
+    for (auto & oFile : vecSendingFile)
+    {
+        close(oFile.iFD);
+    }
+
+    if (ret != 0)
+    {
+        PLGErr("SendFile fail, ret %d smid %d", ret , poSM->SMID());
+        return -1;
+    }
+
     PLGImp("END, send ok, smid %d filelistcount %zu", poSM->SMID(), vecFileList.size());
     return 0;
 }
 
-int CheckpointSender :: SendFile(const StateMachine * poSM, const std::string & sDirPath, const std::string & sFilePath)
+int CheckpointSender :: SetReceiverFiles(const std::string & sCheckpointFiles)
 {
-    PLGHead("START smid %d dirpath %s filepath %s", poSM->SMID(), sDirPath.c_str(), sFilePath.c_str());
+    CheckpointFileList oFileList;
+    bool bSucc = oFileList.ParseFromArray(sCheckpointFiles.data(), sCheckpointFiles.size());
+    if (!bSucc)
+    {
+        PLGErr("CheckpointFileList.ParseFromArray fail, send all files");
+        return -1;
+    }
 
-    string sPath = sDirPath + sFilePath;
+    for (int i = 0; i < oFileList.files_size(); i++)
+    {
+        const CheckpointFile & oFile = oFileList.files(i);
+
+        CheckpointFileInfo oFileInfo;
+        oFileInfo.m_sFilePath = oFile.filepath();
+        oFileInfo.m_llFileSize = oFile.filesize();
+        oFileInfo.m_llChecksum = oFile.filechecksum();
+        m_mapReceiverFile[make_pair(oFile.smid(), oFile.filepath())] = oFileInfo;
+    }
 
-    if (m_mapAlreadySendedFile.find(sPath) != end(m_mapAlreadySendedFile))
+    PLGHead("receiver file count %d", oFileList.files_size());
+
+    return 0;
+}
+
+int CheckpointSender :: GetReuseFiles(StateMachine * poSM, std::map<std::string, CheckpointFileInfo> & mapReuseFile)
+{
+    if (m_mapReceiverFile.size() == 0)
     {
-        PLGErr("file already send, filepath %s", sPath.c_str());
         return 0;
     }
 
-    int iFD = open(sPath.c_str(), O_RDWR, S_IREAD);
-
-    if (iFD == -1)
+    std::string sDirPath;
+    CheckpointFileInfoList vecFileInfoList;
+    int ret = poSM->GetCheckpointImmutableFiles(m_poConfig->GetMyGroupIdx(), sDirPath, vecFileInfoList);
+    if (ret != 0)
     {
-        PLGErr("Open file fail, filepath %s", sPath.c_str());
+        PLGErr("GetCheckpointImmutableFiles fail ret %d, smid %d", ret, poSM->SMID());
         return -1;
     }
 
-    ssize_t iReadLen = 0;
-    size_t llOffset = 0;
-    while (true)
+    //only files both side have with the same size and checksum can skip.
+    for (auto & oFileInfo : vecFileInfoList)
     {
-        iReadLen = read(iFD, m_sTmpBuffer, sizeof(m_sTmpBuffer));
-        if (iReadLen == 0)
+        auto it = m_mapReceiverFile.find(make_pair(poSM->SMID(), oFileInfo.m_sFilePath));
+        if (it != end(m_mapReceiverFile)
+                && it->second.m_llFileSize == oFileInfo.m_llFileSize
+                && it->second.m_llChecksum == oFileInfo.m_llChecksum)
         {
-            break;
+            mapReuseFile[oFileInfo.m_sFilePath] = oFileInfo;
         }
+    }
 
-        if (iReadLen < 0)
-        {
-            close(iFD);
-            return -1;
-        }
+    PLGImp("smid %d immutable file count %zu reuse file count %zu", 
+            poSM->SMID(), vecFileInfoList.size(), mapReuseFile.size());
 
-        int ret = SendBuffer(poSM->SMID(), poSM->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx()), 
-                sFilePath, llOffset, string(m_sTmpBuffer, iReadLen));
-        if (ret != 0)
-        {
-            close(iFD);
-            return ret;
-        }
+    return 0;
+}
 
-        PLGDebug("Send ok, offset %zu readlen %d", llOffset, iReadLen);
+int CheckpointSender :: SendReuseFile(const StateMachine * poSM, const std::string & sDirPath, 
+        const CheckpointFileInfo & oFileInfo)
+{
+    CheckpointChunk oChunk;
+    oChunk.llSequence = 0;
+    oChunk.iSMID = poSM->SMID();
+    oChunk.llCheckpointInstanceID = poSM->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx());
+    oChunk.sFilePath = oFileInfo.m_sFilePath;
+    oChunk.sPath = sDirPath + oFileInfo.m_sFilePath;
+    oChunk.llOffset = 0;
+    oChunk.llFileSize = oFileInfo.m_llFileSize;
+    oChunk.iLen = 0;
+    oChunk.bIsReuse = true;
+    oChunk.llFileChecksum = oFileInfo.m_llChecksum;
+
+    int ret = SendBuffer(oChunk, "");
+    if (ret != 0)
+    {
+        return ret;
+    }
 
-        if (iReadLen < (ssize_t)sizeof(m_sTmpBuffer))
-        {
-            break;
-        }
+    BP->GetCheckpointBP()->SendCheckpointReuseFile();
 
-        llOffset += iReadLen;
+    m_mapAlreadySendedFile[oChunk.sPath] = true;
+    m_llReuseBytes += oChunk.llFileSize;
+
+    PLGImp("receiver have this file, skip, filepath %s size %lu", oChunk.sPath.c_str(), oChunk.llFileSize);
+
+    return 0;
+}
+
+int CheckpointSender :: OpenFile(const std::string & sDirPath, const std::string & sFilePath, CheckpointSendingFile & oFile)
+{
+    PLGHead("START dirpath %s filepath %s", sDirPath.c_str(), sFilePath.c_str());
+
+    oFile.sFilePath = sFilePath;
+    oFile.sPath = sDirPath + sFilePath;
+    oFile.llOffset = 0;
+
+    oFile.iFD = open(oFile.sPath.c_str(), O_RDONLY);
+    if (oFile.iFD == -1)
+    {
+        PLGErr("Open file fail, filepath %s", oFile.sPath.c_str());
+        return -1;
     }
 
-    m_mapAlreadySendedFile[sPath] = true;
+    //receiver preallocate by file size.
+    struct stat oStat;
+    if (fstat(oFile.iFD, &oStat) != 0)
+    {
+        PLGErr("fstat fail, filepath %s", oFile.sPath.c_str());
+        close(oFile.iFD);
+        return -1;
+    }
 
-    close(iFD);
-    PLGImp("END");
+    oFile.llFileSize = oStat.st_size;
+
+    posix_fadvise(oFile.iFD, 0, 0, POSIX_FADV_SEQUENTIAL);
 
     return 0;
 }
 
-int CheckpointSender :: SendBuffer(const int iSMID, const uint64_t llCheckpointInstanceID, 
-        const std::string & sFilePath, const uint64_t llOffset, const std::string & sBuffer)
+int CheckpointSender :: SendFileChunk(const StateMachine * poSM, CheckpointSendingFile & oFile, bool & bIsFileEnd)
 {
-    uint32_t iChecksum = crc32(0, (const uint8_t *)sBuffer.data(), sBuffer.size(), CRC32SKIP);
+    ssize_t iReadLen = read(oFile.iFD, m_sTmpBuffer, sizeof(m_sTmpBuffer));
+    if (iReadLen < 0)
+    {
+        PLGErr("read file fail, filepath %s offset %lu", oFile.sPath.c_str(), oFile.llOffset);
+        return -1;
+    }
+
+    if (iReadLen == 0)
+    {
+        bIsFileEnd = true;
+        return 0;
+    }
+
+    CheckpointChunk oChunk;
+    oChunk.llSequence = 0;
+    oChunk.iSMID = poSM->SMID();
+    oChunk.llCheckpointInstanceID = poSM->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx());
+    oChunk.sFilePath = oFile.sFilePath;
+    oChunk.sPath = oFile.sPath;
+    oChunk.llOffset = oFile.llOffset;
+    oChunk.llFileSize = oFile.llFileSize;
+    oChunk.iLen = iReadLen;
+    oChunk.bIsReuse = false;
+    oChunk.llFileChecksum = 0;
+
+    int ret = SendBuffer(oChunk, string(m_sTmpBuffer, iReadLen));
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    PLGDebug("Send ok, offset %lu readlen %zd", oFile.llOffset, iReadLen);
+
+    oFile.llOffset += iReadLen;
+    bIsFileEnd = iReadLen < (ssize_t)sizeof(m_sTmpBuffer);
 
+    if (!bIsFileEnd)
+    {
+        //next chunk of this file, read by kernel while we send other files.
+        posix_fadvise(oFile.iFD, oFile.llOffset, sizeof(m_sTmpBuffer), POSIX_FADV_WILLNEED);
+    }
+
+    return 0;
+}
+
+int CheckpointSender :: SendBuffer(const CheckpointChunk & oChunk, const std::string & sBuffer)
+{
+    if (!CheckAck(m_llSequence, Checkpoint_ACK_LEAD))
+    {
+        return -1;
+    }
+
+    CheckpointChunk oSendChunk = oChunk;
+    oSendChunk.llSequence = m_llSequence;
+
+    int ret = SendChunk(oSendChunk, sBuffer);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    m_dequeInflight.push_back(oSendChunk);
+    m_llSequence++;
+    m_llSendBytes += sBuffer.size();
+
+    ReportThroughput(false);
+
+    return 0;
+}
+
+int CheckpointSender :: SendChunk(const CheckpointChunk & oChunk, const std::string & sBuffer)
+{
+    uint32_t iChecksum = oChunk.bIsReuse ? 0 : crc32(0, (const uint8_t *)sBuffer.data(), sBuffer.size(), CRC32SKIP);
+
+    uint64_t llBeginTime = Time::GetSteadyClockMS();
     int ret = 0;
     while (true)
     {
@@ -306,33 +529,109 @@ int CheckpointSender :: SendBuffer(const int iSMID, const uint64_t llCheckpointI
         {
             return -1;
         }
-        
-        if (!CheckAck(m_llSequence))
+
+        uint64_t llCreditVersion = CreditNotifier::Instance()->GetVersion();
+        if (oChunk.bIsReuse)
         {
-            return -1;
+            ret = m_poLearner->SendCheckpointReuseFile(
+                    m_iSendNodeID, m_llUUID, oChunk.llSequence, oChunk.llCheckpointInstanceID,
+                    oChunk.sFilePath, oChunk.iSMID, oChunk.llFileSize, oChunk.llFileChecksum);
+        }
+        else
+        {
+            ret = m_poLearner->SendCheckpoint(
+                    m_iSendNodeID, m_llUUID, oChunk.llSequence, oChunk.llCheckpointInstanceID,
+                    iChecksum, oChunk.sFilePath, oChunk.iSMID, oChunk.llOffset, oChunk.llFileSize, sBuffer);
         }
-        
-        ret = m_poLearner->SendCheckpoint(
-                m_iSendNodeID, m_llUUID, m_llSequence, llCheckpointInstanceID,
-                iChecksum, sFilePath, iSMID, llOffset, sBuffer);
 
         BP->GetCheckpointBP()->SendCheckpointOneBlock();
 
         if (ret == 0)
         {
-            m_llSequence++;
             break;
         }
+
+        uint64_t llNowTime = Time::GetSteadyClockMS();
+        if (llNowTime > llBeginTime && llNowTime - llBeginTime >= Checkpoint_ACK_TIMEOUT)
+        {
+            PLGErr("SendCheckpoint fail too long, ret %d sequence %lu", ret, oChunk.llSequence);
+            return -1;
+        }
+
+        if (ret == Paxos_NetWorkBackpressure)
+        {
+            //short wait to check m_bIsEnd at times.
+            CreditNotifier::Instance()->Wait(llCreditVersion, Checkpoint_CREDIT_WAIT_MS);
+        }
         else
         {
-            PLGErr("SendCheckpoint fail, ret %d need sleep 30s", ret);
-            Time::MsSleep(30000);
+            PLGErr("SendCheckpoint fail, ret %d need sleep %dms", ret, Checkpoint_SEND_RETRY_TIMEMS);
+            Time::MsSleep(Checkpoint_SEND_RETRY_TIMEMS);
         }
     }
 
     return ret;
 }
 
+int CheckpointSender :: ReadChunk(const CheckpointChunk & oChunk, std::string & sBuffer)
+{
+    if (oChunk.bIsReuse)
+    {
+        sBuffer.clear();
+        return 0;
+    }
+
+    int iFD = open(oChunk.sPath.c_str(), O_RDONLY);
+    if (iFD == -1)
+    {
+        PLGErr("Open file fail, filepath %s", oChunk.sPath.c_str());
+        return -1;
+    }
+
+    sBuffer.resize(oChunk.iLen);
+    ssize_t iReadLen = pread(iFD, &sBuffer[0], oChunk.iLen, oChunk.llOffset);
+    close(iFD);
+
+    if (iReadLen != (ssize_t)oChunk.iLen)
+    {
+        PLGErr("pread fail, filepath %s offset %lu len %zu readlen %zd",
+                oChunk.sPath.c_str(), oChunk.llOffset, oChunk.iLen, iReadLen);
+        return -1;
+    }
+
+    return 0;
+}
+
+int CheckpointSender :: ResendFrom(const uint64_t llSequence)
+{
+    PLGHead("START resend sequence %lu sendsequence %lu", llSequence, m_llSequence);
+
+    BP->GetCheckpointBP()->SendCheckpointResend();
+
+    std::string sBuffer;
+    for (auto & oChunk : m_dequeInflight)
+    {
+        if (oChunk.llSequence < llSequence)
+        {
+            continue;
+        }
+
+        int ret = ReadChunk(oChunk, sBuffer);
+        if (ret != 0)
+        {
+            return ret;
+        }
+
+        ret = SendChunk(oChunk, sBuffer);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
 void CheckpointSender :: Ack(const nodeid_t iSendNodeID, const uint64_t llUUID, const uint64_t llSequence)
 {
     if (iSendNodeID != m_iSendNodeID)
@@ -347,42 +646,150 @@ void CheckpointSender :: Ack(const nodeid_t iSendNodeID, const uint64_t llUUID,
         return;
     }
 
-    if (llSequence != m_llAckSequence)
+    m_oAckLock.Lock();
+
+    //receiver ack in order, so an ack means all chunks before it are received.
+    if (llSequence < m_llAckSequence)
+    {
+        PLGDebug("ack_sequence already acked, ack.ack_sequence %lu self.ack_sequence %lu", llSequence, m_llAckSequence);
+    }
+    else
     {
-        PLGErr("ack_sequence not same, ack.ack_sequence %lu self.ack_sequence %lu", llSequence, m_llAckSequence);
+        m_llAckSequence = llSequence + 1;
+        m_llAbsLastAckTime = Time::GetSteadyClockMS();
+        m_oAckLock.Interupt();
+    }
+
+    m_oAckLock.UnLock();
+}
+
+void CheckpointSender :: Resend(const nodeid_t iSendNodeID, const uint64_t llUUID, const uint64_t llSequence)
+{
+    if (iSendNodeID != m_iSendNodeID || llUUID != m_llUUID)
+    {
+        PLGErr("resend not match, sendnodeid %lu uuid %lu self.sendnodeid %lu self.uuid %lu",
+                iSendNodeID, llUUID, m_iSendNodeID, m_llUUID);
         return;
     }
 
-    m_llAckSequence++;
-    m_llAbsLastAckTime = Time::GetSteadyClockMS();
+    m_oAckLock.Lock();
+
+    //receiver expect llSequence, all chunks before it are received.
+    if (llSequence >= m_llAckSequence)
+    {
+        if (llSequence > m_llAckSequence)
+        {
+            m_llAckSequence = llSequence;
+            m_llAbsLastAckTime = Time::GetSteadyClockMS();
+        }
+
+        m_llNeedResendSequence = llSequence;
+        m_oAckLock.Interupt();
+    }
+
+    m_oAckLock.UnLock();
 }
 
-const bool CheckpointSender :: CheckAck(const uint64_t llSendSequence)
+const bool CheckpointSender :: CheckAck(const uint64_t llSendSequence, const int iAckLead)
 {
-    while (llSendSequence > m_llAckSequence + Checkpoint_ACK_LEAD)
+    m_oAckLock.Lock();
+
+    while (true)
     {
+        if (m_bIsEnd)
+        {
+            break;
+        }
+
+        while (m_dequeInflight.size() > 0 && m_dequeInflight.front().llSequence < m_llAckSequence)
+        {
+            m_dequeInflight.pop_front();
+        }
+
         uint64_t llNowTime = Time::GetSteadyClockMS();
         uint64_t llPassTime = llNowTime > m_llAbsLastAckTime ? llNowTime - m_llAbsLastAckTime : 0;
 
-        if (m_bIsEnd)
+        //many chunks after a lost one ask for the same resend, only resend once,
+        //if the resend chunks lost again, resend by timeout.
+        bool bNeedResend = false;
+        if (m_llNeedResendSequence > 0)
+        {
+            bNeedResend = m_llNeedResendSequence == m_llAckSequence
+                && m_llNeedResendSequence != m_llLastResendSequence;
+            m_llNeedResendSequence = 0;
+        }
+
+        uint64_t llLastActiveTime = std::max(m_llAbsLastAckTime, m_llLastResendTime);
+        if (Checkpoint_RESEND_TIMEOUT > 0 && llNowTime > llLastActiveTime
+                && llNowTime - llLastActiveTime >= (uint64_t)Checkpoint_RESEND_TIMEOUT)
+        {
+            bNeedResend = true;
+        }
+
+        if (bNeedResend && m_dequeInflight.size() > 0)
+        {
+            uint64_t llResendSequence = m_llAckSequence;
+            m_llLastResendSequence = llResendSequence;
+
+            m_oAckLock.UnLock();
+            int ret = ResendFrom(llResendSequence);
+            m_oAckLock.Lock();
+
+            m_llLastResendTime = Time::GetSteadyClockMS();
+            if (ret != 0)
+            {
+                PLGErr("ResendFrom fail, ret %d sequence %lu", ret, llResendSequence);
+                break;
+            }
+
+            continue;
+        }
+
+        if (llSendSequence <= m_llAckSequence + iAckLead)
         {
-            return false;
+            m_oAckLock.UnLock();
+            return true;
         }
 
         if (llPassTime >= Checkpoint_ACK_TIMEOUT)
         {       
             PLGErr("Ack timeout, last acktime %lu", m_llAbsLastAckTime);
-            return false;
+            break;
         }       
 
-        //PLGErr("Need sleep to slow down send speed, sendsequence %lu acksequence %lu",
-                //llSendSequence, m_llAckSequence);
-        Time::MsSleep(20);
+        m_oAckLock.WaitTime(20);
     }
 
-    return true;
-}
-    
+    m_oAckLock.UnLock();
+    return false;
 }
 
+void CheckpointSender :: ReportThroughput(const bool bIsEnd)
+{
+    uint64_t llNowTime = Time::GetSteadyClockMS();
 
+    if (bIsEnd)
+    {
+        uint64_t llCostTime = llNowTime > m_llStartTime ? llNowTime - m_llStartTime : 1;
+        PLGHead("Checkpoint send bytes %lu reuse bytes %lu costtime %lums avg speed %luKB/s",
+                m_llSendBytes, m_llReuseBytes, llCostTime, m_llSendBytes * 1000 / 1024 / llCostTime);
+        return;
+    }
+
+    if (llNowTime < m_llLastReportTime + Checkpoint_THROUGHPUT_REPORT_INTERVAL)
+    {
+        return;
+    }
+
+    uint64_t llPassTime = llNowTime - m_llLastReportTime;
+    int iKBPerSecond = (int)((m_llSendBytes - m_llLastReportSendBytes) * 1000 / 1024 / llPassTime);
+
+    BP->GetCheckpointBP()->SendCheckpointThroughput(iKBPerSecond);
+    PLGImp("Checkpoint send bytes %lu speed %dKB/s inflight %zu",
+            m_llSendBytes, iKBPerSecond, m_dequeInflight.size());
+
+    m_llLastReportSendBytes = m_llSendBytes;
+    m_llLastReportTime = llNowTime;
+}
+    
+}
@@ -21,6 +21,8 @@ See the AUTHORS file for names of contributors.
 
 #pragma once
 
+#include <deque>
+#include <vector>
 #include "utils_include.h"
 #include "phxpaxos/options.h"
 #include "phxpaxos/sm.h"
@@ -34,7 +36,33 @@ class SMFac;
 class CheckpointMgr;
 
 #define Checkpoint_ACK_TIMEOUT 120000
-#define Checkpoint_ACK_LEAD 10 
+#define Checkpoint_CREDIT_WAIT_MS 100
+#define Checkpoint_THROUGHPUT_REPORT_INTERVAL 1000
+
+class CheckpointChunk
+{
+public:
+    uint64_t llSequence;
+    int iSMID;
+    uint64_t llCheckpointInstanceID;
+    std::string sFilePath;
+    std::string sPath;
+    uint64_t llOffset;
+    uint64_t llFileSize;
+    size_t iLen;
+    bool bIsReuse;
+    uint64_t llFileChecksum;
+};
+
+class CheckpointSendingFile
+{
+public:
+    std::string sFilePath;
+    std::string sPath;
+    int iFD;
+    uint64_t llOffset;
+    uint64_t llFileSize;
+};
 
 class CheckpointSender : public Thread
 {
@@ -58,6 +86,11 @@ public:
 
     void Ack(const nodeid_t iSendNodeID, const uint64_t llUUID, const uint64_t llSequence);
 
+    void Resend(const nodeid_t iSendNodeID, const uint64_t llUUID, const uint64_t llSequence);
+
+    //Files receiver already have, must set before start.
+    int SetReceiverFiles(const std::string & sCheckpointFiles);
+
 private:
     void SendCheckpoint();
 
@@ -67,12 +100,25 @@ private:
 
     int SendCheckpointFofaSM(StateMachine * poSM);
 
-    int SendFile(const StateMachine * poSM, const std::string & sDirPath, const std::string & sFilePath);
+    int GetReuseFiles(StateMachine * poSM, std::map<std::string, CheckpointFileInfo> & mapReuseFile);
+
+    int SendReuseFile(const StateMachine * poSM, const std::string & sDirPath, const CheckpointFileInfo & oFileInfo);
 
-    int SendBuffer(const int iSMID, const uint64_t llCheckpointInstanceID, const std::string & sFilePath,
-            const uint64_t llOffset, const std::string & sBuffer);
+    int OpenFile(const std::string & sDirPath, const std::string & sFilePath, CheckpointSendingFile & oFile);
 
-    const bool CheckAck(const uint64_t llSendSequence);
+    int SendFileChunk(const StateMachine * poSM, CheckpointSendingFile & oFile, bool & bIsFileEnd);
+
+    int SendBuffer(const CheckpointChunk & oChunk, const std::string & sBuffer);
+
+    int SendChunk(const CheckpointChunk & oChunk, const std::string & sBuffer);
+
+    int ReadChunk(const CheckpointChunk & oChunk, std::string & sBuffer);
+
+    int ResendFrom(const uint64_t llSequence);
+
+    const bool CheckAck(const uint64_t llSendSequence, const int iAckLead);
+
+    void ReportThroughput(const bool bIsEnd);
 
 private:
     nodeid_t m_iSendNodeID;
@@ -91,13 +137,28 @@ private:
     uint64_t m_llSequence;
 
 private:
+    SerialLock m_oAckLock;
     uint64_t m_llAckSequence;
     uint64_t m_llAbsLastAckTime;
+    uint64_t m_llNeedResendSequence;
+    uint64_t m_llLastResendSequence;
+    uint64_t m_llLastResendTime;
+    std::deque<CheckpointChunk> m_dequeInflight;
+
+private:
+    uint64_t m_llSendBytes;
+    uint64_t m_llStartTime;
+    uint64_t m_llLastReportSendBytes;
+    uint64_t m_llLastReportTime;
 
 private:
     char m_sTmpBuffer[1048576];
     
     std::map<std::string, bool> m_mapAlreadySendedFile;
+
+private:
+    std::map<std::pair<int, std::string>, CheckpointFileInfo> m_mapReceiverFile;
+    uint64_t m_llReuseBytes;
 };
     
 }
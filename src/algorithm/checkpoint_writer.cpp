@@ -0,0 +1,529 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "checkpoint_writer.h"
+#include "comm_include.h"
+#include "crc32.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace phxpaxos
+{
+
+CheckpointWriter :: CheckpointWriter()
+{
+    m_bIsStarted = false;
+    m_llQueueBytes = 0;
+    m_bIsTaskDone = false;
+    m_iTaskRet = 0;
+    m_iWriteRet = 0;
+    m_iOpenFileCount = 0;
+    m_llUseTime = 0;
+}
+
+CheckpointWriter :: ~CheckpointWriter()
+{
+    Stop();
+}
+
+void CheckpointWriter :: Stop()
+{
+    if (!m_bIsStarted)
+    {
+        return;
+    }
+
+    CheckpointWriteTask * poTask = new CheckpointWriteTask();
+    poTask->iType = CheckpointWriteTaskType_Stop;
+    AddTask(poTask);
+
+    join();
+    m_bIsStarted = false;
+}
+
+void CheckpointWriter :: run()
+{
+    while (true)
+    {
+        CheckpointWriteTask * poTask = nullptr;
+
+        m_oTaskQueue.lock();
+        m_oTaskQueue.peek(poTask);
+        m_oTaskQueue.pop();
+        m_oTaskQueue.unlock();
+
+        int iType = poTask->iType;
+        size_t iBufferSize = poTask->sBuffer.size();
+
+        int ret = DoTask(poTask);
+        delete poTask;
+
+        m_oDoneLock.Lock();
+
+        if (iType == CheckpointWriteTaskType_Write || iType == CheckpointWriteTaskType_Link)
+        {
+            m_llQueueBytes -= iBufferSize;
+            if (ret != 0 && m_iWriteRet == 0)
+            {
+                m_iWriteRet = ret;
+            }
+        }
+        else
+        {
+            if (iType == CheckpointWriteTaskType_Reset)
+            {
+                m_iWriteRet = 0;
+            }
+            else if (iType == CheckpointWriteTaskType_Finish && m_iWriteRet != 0)
+            {
+                ret = m_iWriteRet;
+            }
+
+            m_iTaskRet = ret;
+            m_bIsTaskDone = true;
+        }
+
+        m_oDoneLock.Interupt();
+        m_oDoneLock.UnLock();
+
+        if (iType == CheckpointWriteTaskType_Stop)
+        {
+            break;
+        }
+    }
+}
+
+void CheckpointWriter :: AddTask(CheckpointWriteTask * poTask)
+{
+    if (!m_bIsStarted)
+    {
+        start();
+        m_bIsStarted = true;
+    }
+
+    m_oTaskQueue.lock();
+    m_oTaskQueue.add(poTask);
+    m_oTaskQueue.unlock();
+}
+
+int CheckpointWriter :: WaitTask(CheckpointWriteTask * poTask)
+{
+    m_oDoneLock.Lock();
+    m_bIsTaskDone = false;
+    m_oDoneLock.UnLock();
+
+    AddTask(poTask);
+
+    m_oDoneLock.Lock();
+    while (!m_bIsTaskDone)
+    {
+        m_oDoneLock.WaitTime(1000);
+    }
+    int ret = m_iTaskRet;
+    m_oDoneLock.UnLock();
+
+    return ret;
+}
+
+int CheckpointWriter :: AddChunk(const std::string & sFilePath, const uint64_t llOffset, const uint64_t llFileSize,
+        const uint32_t iChecksum, const std::string & sBuffer)
+{
+    m_oDoneLock.Lock();
+
+    //disk slower than network, hold ioloop here like write in ioloop directly.
+    while (m_iWriteRet == 0 && m_llQueueBytes > CheckpointWriter_MAX_QUEUE_BYTES)
+    {
+        m_oDoneLock.WaitTime(1000);
+    }
+
+    int ret = m_iWriteRet;
+    if (ret == 0)
+    {
+        m_llQueueBytes += sBuffer.size();
+    }
+
+    m_oDoneLock.UnLock();
+
+    if (ret != 0)
+    {
+        PLErr("last write fail, ret %d", ret);
+        return ret;
+    }
+
+    CheckpointWriteTask * poTask = new CheckpointWriteTask();
+    poTask->iType = CheckpointWriteTaskType_Write;
+    poTask->sFilePath = sFilePath;
+    poTask->llOffset = llOffset;
+    poTask->llFileSize = llFileSize;
+    poTask->iChecksum = iChecksum;
+    poTask->sBuffer = sBuffer;
+
+    AddTask(poTask);
+
+    return 0;
+}
+
+int CheckpointWriter :: AddLink(const std::string & sSrcPath, const std::string & sFilePath, const uint64_t llFileSize)
+{
+    m_oDoneLock.Lock();
+    int ret = m_iWriteRet;
+    m_oDoneLock.UnLock();
+
+    if (ret != 0)
+    {
+        PLErr("last write fail, ret %d", ret);
+        return ret;
+    }
+
+    CheckpointWriteTask * poTask = new CheckpointWriteTask();
+    poTask->iType = CheckpointWriteTaskType_Link;
+    poTask->sFilePath = sFilePath;
+    poTask->sSrcPath = sSrcPath;
+    poTask->llOffset = 0;
+    poTask->llFileSize = llFileSize;
+    poTask->iChecksum = 0;
+
+    AddTask(poTask);
+
+    return 0;
+}
+
+void CheckpointWriter :: Reset()
+{
+    if (!m_bIsStarted)
+    {
+        return;
+    }
+
+    CheckpointWriteTask * poTask = new CheckpointWriteTask();
+    poTask->iType = CheckpointWriteTaskType_Reset;
+    WaitTask(poTask);
+}
+
+int CheckpointWriter :: Finish(const std::string & sDirPath)
+{
+    if (!m_bIsStarted)
+    {
+        return 0;
+    }
+
+    CheckpointWriteTask * poTask = new CheckpointWriteTask();
+    poTask->iType = CheckpointWriteTaskType_Finish;
+    poTask->sFilePath = sDirPath;
+    return WaitTask(poTask);
+}
+
+int CheckpointWriter :: DoTask(CheckpointWriteTask * poTask)
+{
+    int ret = 0;
+    switch (poTask->iType)
+    {
+    case CheckpointWriteTaskType_Write:
+        //after a write fail, skip all chunks until reset.
+        ret = m_iWriteRet != 0 ? m_iWriteRet : Write(poTask);
+        break;
+    case CheckpointWriteTaskType_Link:
+        ret = m_iWriteRet != 0 ? m_iWriteRet : Link(poTask);
+        break;
+    case CheckpointWriteTaskType_Reset:
+    case CheckpointWriteTaskType_Stop:
+        CloseAll(false);
+        break;
+    case CheckpointWriteTaskType_Finish:
+        ret = CloseAll(true);
+        if (ret == 0)
+        {
+            ret = SyncDir(poTask->sFilePath);
+        }
+        break;
+    }
+
+    return ret;
+}
+
+int CheckpointWriter :: Write(CheckpointWriteTask * poTask)
+{
+    uint32_t iChecksum = crc32(0, (const uint8_t *)poTask->sBuffer.data(), poTask->sBuffer.size(), CRC32SKIP);
+    if (iChecksum != poTask->iChecksum)
+    {
+        PLErr("checksum not same, filepath %s offset %lu msg.checksum %u cal.checksum %u",
+                poTask->sFilePath.c_str(), poTask->llOffset, poTask->iChecksum, iChecksum);
+        return -2;
+    }
+
+    auto it = m_mapFile.find(poTask->sFilePath);
+    if (it == end(m_mapFile))
+    {
+        CheckpointWriteFile oFile;
+        oFile.iFD = -1;
+        oFile.llWriteOffset = 0;
+        oFile.llFileSize = poTask->llFileSize;
+        oFile.llLastUseTime = 0;
+        it = m_mapFile.insert(make_pair(poTask->sFilePath, oFile)).first;
+    }
+
+    CheckpointWriteFile & oFile = it->second;
+    if (poTask->llOffset != oFile.llWriteOffset + oFile.sBuffer.size())
+    {
+        PLErr("offset not continue, filepath %s offset %lu file.offset %lu",
+                poTask->sFilePath.c_str(), poTask->llOffset, oFile.llWriteOffset + oFile.sBuffer.size());
+        return -2;
+    }
+
+    if (oFile.iFD == -1)
+    {
+        int ret = OpenFile(poTask->sFilePath, oFile);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+
+    oFile.llLastUseTime = ++m_llUseTime;
+    oFile.sBuffer.append(poTask->sBuffer);
+
+    bool bIsFileEnd = oFile.llFileSize > 0 && oFile.llWriteOffset + oFile.sBuffer.size() >= oFile.llFileSize;
+    if (oFile.sBuffer.size() >= CheckpointWriter_BUFFER_SIZE || bIsFileEnd)
+    {
+        int ret = Flush(poTask->sFilePath, oFile);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+
+    if (bIsFileEnd)
+    {
+        PLDebug("file write done, filepath %s size %lu", poTask->sFilePath.c_str(), oFile.llWriteOffset);
+
+        close(oFile.iFD);
+        oFile.iFD = -1;
+        m_iOpenFileCount--;
+        std::string().swap(oFile.sBuffer);
+    }
+
+    return 0;
+}
+
+int CheckpointWriter :: Link(CheckpointWriteTask * poTask)
+{
+    struct stat oStat;
+    if (stat(poTask->sSrcPath.c_str(), &oStat) != 0 || (uint64_t)oStat.st_size != poTask->llFileSize)
+    {
+        PLErr("src file changed, srcpath %s filesize %lu", poTask->sSrcPath.c_str(), poTask->llFileSize);
+        return -2;
+    }
+
+    if (link(poTask->sSrcPath.c_str(), poTask->sFilePath.c_str()) == 0)
+    {
+        PLDebug("link ok, srcpath %s filepath %s", poTask->sSrcPath.c_str(), poTask->sFilePath.c_str());
+        return 0;
+    }
+
+    PLImp("link fail, srcpath %s filepath %s errno %d, copy it",
+            poTask->sSrcPath.c_str(), poTask->sFilePath.c_str(), errno);
+
+    return CopyFile(poTask->sSrcPath, poTask->sFilePath);
+}
+
+int CheckpointWriter :: CopyFile(const std::string & sSrcPath, const std::string & sFilePath)
+{
+    int iSrcFD = open(sSrcPath.c_str(), O_RDONLY);
+    if (iSrcFD == -1)
+    {
+        PLErr("open file fail, filepath %s errno %d", sSrcPath.c_str(), errno);
+        return -1;
+    }
+
+    CheckpointWriteFile oFile;
+    oFile.iFD = -1;
+    oFile.llWriteOffset = 0;
+    oFile.llFileSize = 0;
+    oFile.llLastUseTime = 0;
+
+    int ret = OpenFile(sFilePath, oFile);
+    if (ret != 0)
+    {
+        close(iSrcFD);
+        return ret;
+    }
+
+    oFile.sBuffer.resize(CheckpointWriter_BUFFER_SIZE);
+    while (true)
+    {
+        ssize_t iReadLen = read(iSrcFD, &oFile.sBuffer[0], CheckpointWriter_BUFFER_SIZE);
+        if (iReadLen <= 0)
+        {
+            if (iReadLen < 0)
+            {
+                PLErr("read file fail, filepath %s errno %d", sSrcPath.c_str(), errno);
+                ret = -1;
+            }
+            break;
+        }
+
+        oFile.sBuffer.resize(iReadLen);
+        ret = Flush(sFilePath, oFile);
+        if (ret != 0)
+        {
+            break;
+        }
+        oFile.sBuffer.resize(CheckpointWriter_BUFFER_SIZE);
+    }
+
+    close(iSrcFD);
+    close(oFile.iFD);
+    m_iOpenFileCount--;
+
+    return ret;
+}
+
+int CheckpointWriter :: OpenFile(const std::string & sFilePath, CheckpointWriteFile & oFile)
+{
+    if (m_iOpenFileCount >= CheckpointWriter_MAX_OPEN_FILES)
+    {
+        //close the least recently used one, sender send only a few files at the same time.
+        auto itLRU = end(m_mapFile);
+        for (auto it = m_mapFile.begin(); it != end(m_mapFile); it++)
+        {
+            if (it->second.iFD != -1
+                    && (itLRU == end(m_mapFile) || it->second.llLastUseTime < itLRU->second.llLastUseTime))
+            {
+                itLRU = it;
+            }
+        }
+
+        if (itLRU != end(m_mapFile))
+        {
+            int ret = Flush(itLRU->first, itLRU->second);
+            if (ret != 0)
+            {
+                return ret;
+            }
+
+            close(itLRU->second.iFD);
+            itLRU->second.iFD = -1;
+            m_iOpenFileCount--;
+            std::string().swap(itLRU->second.sBuffer);
+        }
+    }
+
+    oFile.iFD = open(sFilePath.c_str(), O_CREAT | O_WRONLY, S_IWRITE | S_IREAD);
+    if (oFile.iFD == -1)
+    {
+        PLErr("open file fail, filepath %s errno %d", sFilePath.c_str(), errno);
+        return -1;
+    }
+
+    m_iOpenFileCount++;
+
+    if (oFile.llWriteOffset == 0 && oFile.llFileSize > 0)
+    {
+        //keep size, then a broken file not look like a complete one.
+        if (fallocate(oFile.iFD, FALLOC_FL_KEEP_SIZE, 0, oFile.llFileSize) != 0)
+        {
+            PLImp("fallocate fail, filepath %s size %lu errno %d", sFilePath.c_str(), oFile.llFileSize, errno);
+        }
+    }
+
+    return 0;
+}
+
+int CheckpointWriter :: Flush(const std::string & sFilePath, CheckpointWriteFile & oFile)
+{
+    size_t iPos = 0;
+    while (iPos < oFile.sBuffer.size())
+    {
+        ssize_t iWriteLen = pwrite(oFile.iFD, oFile.sBuffer.data() + iPos, 
+                oFile.sBuffer.size() - iPos, oFile.llWriteOffset + iPos);
+        if (iWriteLen < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            PLErr("write fail, filepath %s offset %lu errno %d", sFilePath.c_str(), oFile.llWriteOffset + iPos, errno);
+            return -1;
+        }
+
+        iPos += iWriteLen;
+    }
+
+    oFile.llWriteOffset += oFile.sBuffer.size();
+    oFile.sBuffer.clear();
+
+    return 0;
+}
+
+int CheckpointWriter :: CloseAll(const bool bNeedFlush)
+{
+    int ret = 0;
+    for (auto & it : m_mapFile)
+    {
+        if (it.second.iFD == -1)
+        {
+            continue;
+        }
+
+        if (bNeedFlush && ret == 0)
+        {
+            ret = Flush(it.first, it.second);
+        }
+
+        close(it.second.iFD);
+    }
+
+    m_mapFile.clear();
+    m_iOpenFileCount = 0;
+
+    return ret;
+}
+
+int CheckpointWriter :: SyncDir(const std::string & sDirPath)
+{
+    int iFD = open(sDirPath.c_str(), O_RDONLY | O_DIRECTORY);
+    if (iFD == -1)
+    {
+        PLErr("open dir fail, dirpath %s errno %d", sDirPath.c_str(), errno);
+        return -1;
+    }
+
+    //one sync for all files and dirs, instead of fsync them one by one.
+    int ret = syncfs(iFD);
+    close(iFD);
+
+    if (ret != 0)
+    {
+        PLErr("syncfs fail, dirpath %s errno %d", sDirPath.c_str(), errno);
+        return -1;
+    }
+
+    PLImp("ok, dirpath %s", sDirPath.c_str());
+
+    return 0;
+}
+    
+}
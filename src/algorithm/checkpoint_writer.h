@@ -0,0 +1,130 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include "utils_include.h"
+
+namespace phxpaxos
+{
+
+#define CheckpointWriter_BUFFER_SIZE (4 * 1024 * 1024)
+#define CheckpointWriter_MAX_QUEUE_BYTES (64 * 1024 * 1024)
+#define CheckpointWriter_MAX_OPEN_FILES 16
+
+enum CheckpointWriteTaskType
+{
+    CheckpointWriteTaskType_Write = 1,
+    CheckpointWriteTaskType_Reset = 2,
+    CheckpointWriteTaskType_Finish = 3,
+    CheckpointWriteTaskType_Stop = 4,
+    CheckpointWriteTaskType_Link = 5,
+};
+
+class CheckpointWriteTask
+{
+public:
+    int iType;
+    std::string sFilePath;
+    std::string sSrcPath;
+    uint64_t llOffset;
+    uint64_t llFileSize;
+    uint32_t iChecksum;
+    std::string sBuffer;
+};
+
+class CheckpointWriteFile
+{
+public:
+    int iFD;
+    uint64_t llWriteOffset;
+    uint64_t llFileSize;
+    uint64_t llLastUseTime;
+    std::string sBuffer;
+};
+
+//Write checkpoint chunks out of ioloop thread, verify chunk checksum,
+//keep files open and merge chunks to large writes, sync once at finish.
+class CheckpointWriter : public Thread
+{
+public:
+    CheckpointWriter();
+    ~CheckpointWriter();
+
+    void Stop();
+
+    void run();
+
+    //Return nonzero if a chunk write fail after last Reset.
+    //Block while too many bytes wait for writing.
+    int AddChunk(const std::string & sFilePath, const uint64_t llOffset, const uint64_t llFileSize,
+            const uint32_t iChecksum, const std::string & sBuffer);
+
+    //Link(or copy if can't) a local file of llFileSize to sFilePath.
+    int AddLink(const std::string & sSrcPath, const std::string & sFilePath, const uint64_t llFileSize);
+
+    //Wait all chunks before done, close all files, drop write error.
+    void Reset();
+
+    //Wait all chunks written, close all files and sync the filesystem of sDirPath.
+    int Finish(const std::string & sDirPath);
+
+private:
+    int WaitTask(CheckpointWriteTask * poTask);
+
+    void AddTask(CheckpointWriteTask * poTask);
+
+    int DoTask(CheckpointWriteTask * poTask);
+
+    int Write(CheckpointWriteTask * poTask);
+
+    int Link(CheckpointWriteTask * poTask);
+
+    int CopyFile(const std::string & sSrcPath, const std::string & sFilePath);
+
+    int OpenFile(const std::string & sFilePath, CheckpointWriteFile & oFile);
+
+    int Flush(const std::string & sFilePath, CheckpointWriteFile & oFile);
+
+    int CloseAll(const bool bNeedFlush);
+
+    int SyncDir(const std::string & sDirPath);
+
+private:
+    bool m_bIsStarted;
+    Queue<CheckpointWriteTask *> m_oTaskQueue;
+
+    SerialLock m_oDoneLock;
+    uint64_t m_llQueueBytes;
+    bool m_bIsTaskDone;
+    int m_iTaskRet;
+    int m_iWriteRet;
+
+private:
+    std::map<std::string, CheckpointWriteFile> m_mapFile;
+    int m_iOpenFileCount;
+    uint64_t m_llUseTime;
+};
+    
+}
@@ -47,6 +47,13 @@ void CommitCtx :: NewCommit(std::string * psValue, SMCtx * poSMCtx, const int iT
     m_psValue = psValue;
     m_poSMCtx = poSMCtx;
 
+    m_llNewCommitTimeUS = Time::GetSteadyClockUS();
+    for (int i = 0; i < CommitStage_Count; i++)
+    {
+        m_arrTraceBeginUS[i] = 0;
+        m_arrTraceUseUS[i] = 0;
+    }
+
     if (psValue != nullptr)
     {
         PLGHead("OK, valuesize %zu", psValue->size());
@@ -70,6 +77,8 @@ void CommitCtx :: StartCommit(const uint64_t llInstanceID)
 {
     m_oSerialLock.Lock();
     m_llInstanceID = llInstanceID;
+    uint64_t llNowTimeUS = Time::GetSteadyClockUS();
+    m_arrTraceUseUS[CommitStage_IOLoop] = llNowTimeUS > m_llNewCommitTimeUS ? llNowTimeUS - m_llNewCommitTimeUS : 0;
     m_oSerialLock.UnLock();
 }
 
@@ -159,6 +168,47 @@ const int CommitCtx :: GetTimeoutMs() const
     return m_iTimeoutMs;
 }
 
+////////////////////////////////////////////////////////
+
+void CommitCtx :: TraceBegin(const int iStage, const uint64_t llInstanceID)
+{
+    //only ioloop thread call trace and end commit, no need lock.
+    if (m_bIsCommitEnd || m_psValue == nullptr || m_llInstanceID != llInstanceID)
+    {
+        return;
+    }
+
+    uint64_t llNowTimeUS = Time::GetSteadyClockUS();
+    if (m_arrTraceBeginUS[iStage] != 0 && llNowTimeUS > m_arrTraceBeginUS[iStage])
+    {
+        //a retry begin again without end, sum the round it leave.
+        m_arrTraceUseUS[iStage] += llNowTimeUS - m_arrTraceBeginUS[iStage];
+    }
+    m_arrTraceBeginUS[iStage] = llNowTimeUS;
+}
+
+void CommitCtx :: TraceEnd(const int iStage, const uint64_t llInstanceID)
+{
+    if (m_bIsCommitEnd || m_psValue == nullptr || m_llInstanceID != llInstanceID
+            || m_arrTraceBeginUS[iStage] == 0)
+    {
+        return;
+    }
+
+    uint64_t llNowTimeUS = Time::GetSteadyClockUS();
+    if (llNowTimeUS > m_arrTraceBeginUS[iStage])
+    {
+        //prepare and accept may retry, sum all rounds.
+        m_arrTraceUseUS[iStage] += llNowTimeUS - m_arrTraceBeginUS[iStage];
+    }
+    m_arrTraceBeginUS[iStage] = 0;
+}
+
+const uint64_t CommitCtx :: GetTraceUseTimeUS(const int iStage) const
+{
+    return m_arrTraceUseUS[iStage];
+}
+
 }
 
 
@@ -56,6 +56,15 @@ public:
 public:
     const int GetTimeoutMs() const;
 
+public:
+    //Trace commit stages of llInstanceID, ignored if it's not my commit.
+    void TraceBegin(const int iStage, const uint64_t llInstanceID);
+
+    void TraceEnd(const int iStage, const uint64_t llInstanceID);
+
+    //Call after GetResult.
+    const uint64_t GetTraceUseTimeUS(const int iStage) const;
+
 private:
     Config * m_poConfig;
 
@@ -67,5 +76,9 @@ private:
     std::string * m_psValue;
     SMCtx * m_poSMCtx;
     SerialLock m_oSerialLock;
+
+    uint64_t m_llNewCommitTimeUS;
+    uint64_t m_arrTraceBeginUS[CommitStage_Count];
+    uint64_t m_arrTraceUseUS[CommitStage_Count];
 };
 }
@@ -20,17 +20,22 @@ See the AUTHORS file for names of contributors.
 */
 
 #include "committer.h"
+#include <algorithm>
 #include "commitctx.h"
 #include "ioloop.h"
+#include "value_chunk_mgr.h"
 #include "commdef.h"
 
 namespace phxpaxos
 {
 
-Committer :: Committer(Config * poConfig, CommitCtx * poCommitCtx, IOLoop * poIOLoop, SMFac * poSMFac)
-    : m_poConfig(poConfig), m_poCommitCtx(poCommitCtx), m_poIOLoop(poIOLoop), m_poSMFac(poSMFac), m_iTimeoutMs(-1)
+Committer :: Committer(Config * poConfig, CommitCtx * poCommitCtx, IOLoop * poIOLoop, SMFac * poSMFac, 
+        ValueChunkMgr * poValueChunkMgr, const bool bUseCoalesce)
+    : m_poConfig(poConfig), m_poCommitCtx(poCommitCtx), m_poIOLoop(poIOLoop), m_poSMFac(poSMFac), 
+    m_poValueChunkMgr(poValueChunkMgr), m_iTimeoutMs(-1), m_iMaxHoldThreads(-1), 
+    m_bUseCoalesce(bUseCoalesce), m_bHasCoalesceLeader(false),
+    m_llLastLogTime(Time::GetSteadyClockMS()), m_iTraceIndex(0)
 {
-    m_llLastLogTime = Time::GetSteadyClockMS();
 }
 
 Committer :: ~Committer()
@@ -49,9 +54,35 @@ int Committer :: NewValueGetID(const std::string & sValue, uint64_t & llInstance
 }
 
 int Committer :: NewValueGetID(const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx)
+{
+    return NewValueGetID(sValue, llInstanceID, poSMCtx, m_iTimeoutMs);
+}
+
+int Committer :: NewValueGetID(const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx, const int iTimeoutMs)
 {
     BP->GetCommiterBP()->NewValue();
 
+    int iSMID = poSMCtx != nullptr ? poSMCtx->m_iSMID : 0;
+
+    //large value, paxos only agree on the manifest, chunks are streamed to other nodes ahead.
+    std::string sManifest;
+    if (m_poValueChunkMgr->NeedSplit(sValue))
+    {
+        string sPackSMIDValue = sValue;
+        m_poSMFac->PackPaxosValue(sPackSMIDValue, iSMID);
+
+        int ret = m_poValueChunkMgr->SplitValue(sPackSMIDValue, sManifest);
+        if (ret != 0)
+        {
+            BP->GetCommiterBP()->NewValueCommitFail();
+            return PaxosTryCommitRet_Value_Chunk_Fail;
+        }
+
+        iSMID = VALUE_CHUNK_SMID;
+    }
+
+    const std::string & sProposeValue = iSMID == VALUE_CHUNK_SMID ? sManifest : sValue;
+
     int iRetryCount = 3;
     int ret = PaxosTryCommitRet_OK;
     while(iRetryCount--)
@@ -59,7 +90,7 @@ int Committer :: NewValueGetID(const std::string & sValue, uint64_t & llInstance
         TimeStat oTimeStat;
         oTimeStat.Point();
 
-        ret = NewValueGetIDNoRetry(sValue, llInstanceID, poSMCtx);
+        ret = NewValueGetIDNoRetry(sProposeValue, iSMID, llInstanceID, poSMCtx, iTimeoutMs);
         if (ret != PaxosTryCommitRet_Conflict)
         {
             if (ret == 0)
@@ -82,19 +113,51 @@ int Committer :: NewValueGetID(const std::string & sValue, uint64_t & llInstance
         }
     }
 
+    if (ret == PaxosTryCommitRet_Conflict && iSMID == VALUE_CHUNK_SMID)
+    {
+        //instance chosen other value, this manifest will never be chosen.
+        m_poValueChunkMgr->DropValue(sManifest);
+    }
+
     return ret;
 }
 
-int Committer :: NewValueGetIDNoRetry(const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx)
+int Committer :: NewValueGetIDNoRetry(const std::string & sValue, const int iSMID, uint64_t & llInstanceID, 
+        SMCtx * poSMCtx, const int iTimeoutMs)
 {
     LogStatus();
 
+    if (m_bUseCoalesce && CanCoalesce(iSMID))
+    {
+        return CoalesceNewValue(sValue, iSMID, llInstanceID, poSMCtx, iTimeoutMs);
+    }
+
+    uint64_t llBeginTimeUS = Time::GetSteadyClockUS();
+
+    int iLeftTimeoutMs = -1;
+    int ret = GetLock(iTimeoutMs, iLeftTimeoutMs);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    ret = Commit(sValue, iSMID, poSMCtx, iLeftTimeoutMs, llBeginTimeUS, llInstanceID);
+
+    m_oWaitLock.UnLock();
+    return ret;
+}
+
+int Committer :: GetLock(const int iTimeoutMs, int & iLeftTimeoutMs)
+{
+    BP->GetCommiterBP()->NewValueWaitQueueDepth(m_oWaitLock.GetNowHoldThreadCount());
+
     int iLockUseTimeMs = 0;
-    bool bHasLock = m_oWaitLock.Lock(m_iTimeoutMs, iLockUseTimeMs);
+    bool bHasLock = m_oWaitLock.Lock(iTimeoutMs, iLockUseTimeMs);
     if (!bHasLock)
     {
         if (iLockUseTimeMs > 0)
         {
+            BP->GetCommiterBP()->NewValueWaitSojournTimeMs(iLockUseTimeMs);
             BP->GetCommiterBP()->NewValueGetLockTimeout();
             PLGErr("Try get lock, but timeout, lockusetime %dms", iLockUseTimeMs);
             return PaxosTryCommitRet_Timeout; 
@@ -107,11 +170,11 @@ int Committer :: NewValueGetIDNoRetry(const std::string & sValue, uint64_t & llI
         }
     }
 
-    int iLeftTimeoutMs = -1;
-    if (m_iTimeoutMs > 0)
+    iLeftTimeoutMs = -1;
+    if (iTimeoutMs > 0)
     {
-        iLeftTimeoutMs = m_iTimeoutMs > iLockUseTimeMs ? m_iTimeoutMs - iLockUseTimeMs : 0;
-        if (iLeftTimeoutMs < 200)
+        iLeftTimeoutMs = iTimeoutMs > iLockUseTimeMs ? iTimeoutMs - iLockUseTimeMs : 0;
+        if (iLeftTimeoutMs < COMMITTER_MIN_LEFT_TIMEOUT_MS)
         {
             PLGErr("Get lock ok, but lockusetime %dms too long, lefttimeout %dms", iLockUseTimeMs, iLeftTimeoutMs);
 
@@ -125,10 +188,17 @@ int Committer :: NewValueGetIDNoRetry(const std::string & sValue, uint64_t & llI
     PLGImp("GetLock ok, use time %dms", iLockUseTimeMs);
     
     BP->GetCommiterBP()->NewValueGetLockOK(iLockUseTimeMs);
+    BP->GetCommiterBP()->NewValueWaitSojournTimeMs(iLockUseTimeMs);
+
+    return 0;
+}
+
+int Committer :: Commit(const std::string & sValue, const int iSMID, SMCtx * poSMCtx, 
+        const int iLeftTimeoutMs, const uint64_t llBeginTimeUS, uint64_t & llInstanceID)
+{
+    uint64_t llLockTimeUS = Time::GetSteadyClockUS();
 
     //pack smid to value
-    int iSMID = poSMCtx != nullptr ? poSMCtx->m_iSMID : 0;
-    
     string sPackSMIDValue = sValue;
     m_poSMFac->PackPaxosValue(sPackSMIDValue, iSMID);
 
@@ -136,11 +206,251 @@ int Committer :: NewValueGetIDNoRetry(const std::string & sValue, uint64_t & llI
     m_poIOLoop->AddNotify();
 
     int ret = m_poCommitCtx->GetResult(llInstanceID);
+    if (ret == 0)
+    {
+        AddTrace(llBeginTimeUS, llLockTimeUS);
+    }
+
+    return ret;
+}
+
+void Committer :: AddTrace(const uint64_t llBeginTimeUS, const uint64_t llLockTimeUS)
+{
+    uint64_t llEndTimeUS = Time::GetSteadyClockUS();
+
+    //a trace race with the switch may fall in the retired one, stat only, let it go.
+    Histogram * poHistogram = m_arrTraceHistogram[m_iTraceIndex.load()];
+
+    poHistogram[CommitStage_Queue].Add(llLockTimeUS > llBeginTimeUS ? llLockTimeUS - llBeginTimeUS : 0);
+    for (int iStage = CommitStage_IOLoop; iStage < CommitStage_Total; iStage++)
+    {
+        poHistogram[iStage].Add(m_poCommitCtx->GetTraceUseTimeUS(iStage));
+    }
+    poHistogram[CommitStage_Total].Add(llEndTimeUS > llBeginTimeUS ? llEndTimeUS - llBeginTimeUS : 0);
+}
+
+////////////////////////////////////////////////////
+
+const bool Committer :: CanCoalesce(const int iSMID) const
+{
+    //system, master, batch and chunk manifest values keep their own instance.
+    return iSMID < SYSTEM_V_SMID;
+}
+
+int Committer :: CoalesceNewValue(const std::string & sValue, const int iSMID, uint64_t & llInstanceID, 
+        SMCtx * poSMCtx, const int iTimeoutMs)
+{
+    CoalesceProposal oProposal;
+    oProposal.psValue = &sValue;
+    oProposal.iSMID = iSMID;
+    oProposal.poSMCtx = poSMCtx;
+    oProposal.llAbsTimeoutMs = iTimeoutMs > 0 ? Time::GetSteadyClockMS() + iTimeoutMs : 0;
+    oProposal.bIsTaken = false;
+    oProposal.bIsDone = false;
+    oProposal.iRet = 0;
+    oProposal.llInstanceID = 0;
+
+    uint64_t llBeginTimeUS = Time::GetSteadyClockUS();
+
+    //only one proposer(the leader) wait WaitLock for all queued proposals, others wait here,
+    //so WaitLock's hold threads and wait time estimate only count the real commits.
+    {
+        std::unique_lock<std::mutex> oLock(m_oCoalesceMutex);
+        if (m_iMaxHoldThreads != -1 
+                && (int)m_dequeProposal.size() >= (m_iMaxHoldThreads + 1) * COMMITTER_COALESCE_MAX_COUNT)
+        {
+            BP->GetCommiterBP()->NewValueGetLockReject();
+            PLGErr("Too many proposal waiting coalesce, reject");
+            return PaxosTryCommitRet_TooManyThreadWaiting_Reject;
+        }
+
+        m_dequeProposal.push_back(&oProposal);
+
+        while (!oProposal.bIsDone)
+        {
+            if (!oProposal.bIsTaken && !m_bHasCoalesceLeader)
+            {
+                m_bHasCoalesceLeader = true;
+                break;
+            }
+
+            if (oProposal.bIsTaken || oProposal.llAbsTimeoutMs == 0)
+            {
+                //taken one can wait the whole commit, see PluckProposal.
+                m_oCoalesceCond.wait(oLock);
+                continue;
+            }
+
+            uint64_t llNowTimeMs = Time::GetSteadyClockMS();
+            if (llNowTimeMs >= oProposal.llAbsTimeoutMs)
+            {
+                RemoveProposal(&oProposal);
+                BP->GetCommiterBP()->NewValueGetLockTimeout();
+                PLGErr("Wait coalesce leader timeout");
+                return PaxosTryCommitRet_Timeout;
+            }
+
+            m_oCoalesceCond.wait_for(oLock, std::chrono::milliseconds(oProposal.llAbsTimeoutMs - llNowTimeMs));
+        }
+
+        if (oProposal.bIsDone)
+        {
+            llInstanceID = oProposal.llInstanceID;
+            return oProposal.iRet;
+        }
+    }
+
+    int iLockTimeoutMs = iTimeoutMs;
+    if (oProposal.llAbsTimeoutMs != 0)
+    {
+        uint64_t llNowTimeMs = Time::GetSteadyClockMS();
+        iLockTimeoutMs = oProposal.llAbsTimeoutMs > llNowTimeMs ? (int)(oProposal.llAbsTimeoutMs - llNowTimeMs) : 0;
+    }
+
+    int iLeftTimeoutMs = -1;
+    int ret = GetLock(iLockTimeoutMs, iLeftTimeoutMs);
+
+    std::vector<CoalesceProposal *> vecProposal;
+    {
+        std::lock_guard<std::mutex> oLock(m_oCoalesceMutex);
+        m_bHasCoalesceLeader = false;
+        if (ret != 0)
+        {
+            //nobody pluck without lock, my proposal is still queued.
+            RemoveProposal(&oProposal);
+        }
+        else
+        {
+            PluckProposal(&oProposal, iLeftTimeoutMs, vecProposal);
+        }
+    }
+    //proposals not plucked elect the next leader.
+    m_oCoalesceCond.notify_all();
+
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    uint64_t llCommitInstanceID = 0;
+    ret = CoalesceCommit(vecProposal, iLeftTimeoutMs, llBeginTimeUS, llCommitInstanceID);
+
+    {
+        std::lock_guard<std::mutex> oLock(m_oCoalesceMutex);
+        for (auto & poProposal : vecProposal)
+        {
+            poProposal->iRet = ret;
+            poProposal->llInstanceID = llCommitInstanceID;
+            poProposal->bIsDone = true;
+        }
+    }
+    m_oCoalesceCond.notify_all();
 
     m_oWaitLock.UnLock();
+
+    llInstanceID = llCommitInstanceID;
     return ret;
 }
 
+void Committer :: RemoveProposal(CoalesceProposal * poProposal)
+{
+    for (auto it = m_dequeProposal.begin(); it != m_dequeProposal.end(); it++)
+    {
+        if (*it == poProposal)
+        {
+            m_dequeProposal.erase(it);
+            break;
+        }
+    }
+}
+
+void Committer :: PluckProposal(CoalesceProposal * poMyProposal, const int iLeftTimeoutMs, 
+        std::vector<CoalesceProposal *> & vecProposal)
+{
+    int iMaxSize = std::min(COMMITTER_COALESCE_MAX_SIZE, MAX_VALUE_SIZE);
+    uint64_t llNowTimeMs = Time::GetSteadyClockMS();
+
+    poMyProposal->bIsTaken = true;
+    vecProposal.push_back(poMyProposal);
+    int iPluckSize = (int)poMyProposal->psValue->size();
+
+    auto it = m_dequeProposal.begin();
+    while (it != m_dequeProposal.end())
+    {
+        CoalesceProposal * poProposal = *it;
+        if (poProposal == poMyProposal)
+        {
+            it = m_dequeProposal.erase(it);
+            continue;
+        }
+
+        if ((int)vecProposal.size() >= COMMITTER_COALESCE_MAX_COUNT
+                || iPluckSize + (int)poProposal->psValue->size() > iMaxSize)
+        {
+            it++;
+            continue;
+        }
+
+        //the commit run with my timeout, plucked ones must be able to wait that long.
+        //Ones about to expire stay queued and time out by themselves.
+        if (poProposal->llAbsTimeoutMs != 0)
+        {
+            int iProposalLeftMs = poProposal->llAbsTimeoutMs > llNowTimeMs ? 
+                (int)(poProposal->llAbsTimeoutMs - llNowTimeMs) : 0;
+            if (iLeftTimeoutMs == -1 || iProposalLeftMs < std::max(iLeftTimeoutMs, COMMITTER_MIN_LEFT_TIMEOUT_MS))
+            {
+                it++;
+                continue;
+            }
+        }
+
+        poProposal->bIsTaken = true;
+        vecProposal.push_back(poProposal);
+        iPluckSize += (int)poProposal->psValue->size();
+        it = m_dequeProposal.erase(it);
+    }
+}
+
+int Committer :: CoalesceCommit(std::vector<CoalesceProposal *> & vecProposal, const int iLeftTimeoutMs, 
+        const uint64_t llBeginTimeUS, uint64_t & llInstanceID)
+{
+    //PluckProposal only take proposals which can wait my whole timeout.
+    int iCommitTimeoutMs = iLeftTimeoutMs;
+
+    if (vecProposal.size() == 1)
+    {
+        CoalesceProposal * poProposal = vecProposal[0];
+        return Commit(*poProposal->psValue, poProposal->iSMID, poProposal->poSMCtx, 
+                iCommitTimeoutMs, llBeginTimeUS, llInstanceID);
+    }
+
+    BP->GetCommiterBP()->CoalescePropose((int)vecProposal.size());
+
+    BatchPaxosValues oBatchValues;
+    BatchSMCtx oBatchSMCtx;
+    for (auto & poProposal : vecProposal)
+    {
+        PaxosValue * poValue = oBatchValues.add_values();
+        poValue->set_smid(poProposal->iSMID);
+        poValue->set_value(*poProposal->psValue);
+
+        oBatchSMCtx.m_vecSMCtxList.push_back(poProposal->poSMCtx);
+    }
+
+    string sBuffer;
+    bool bSucc = oBatchValues.SerializeToString(&sBuffer);
+    if (!bSucc)
+    {
+        PLGErr("BatchValues SerializeToString fail");
+        return Paxos_SystemError;
+    }
+
+    PLGImp("coalesce %zu values to one instance", vecProposal.size());
+
+    SMCtx oCtx(BATCH_PROPOSE_SMID, (void *)&oBatchSMCtx);
+    return Commit(sBuffer, BATCH_PROPOSE_SMID, &oCtx, iCommitTimeoutMs, llBeginTimeUS, llInstanceID);
+}
+
 ////////////////////////////////////////////////////
 
 void Committer :: SetTimeoutMs(const int iTimeoutMs)
@@ -148,8 +458,14 @@ void Committer :: SetTimeoutMs(const int iTimeoutMs)
     m_iTimeoutMs = iTimeoutMs;
 }
 
+const int Committer :: GetTimeoutMs() const
+{
+    return m_iTimeoutMs;
+}
+
 void Committer :: SetMaxHoldThreads(const int iMaxHoldThreads)
 {
+    m_iMaxHoldThreads = iMaxHoldThreads;
     m_oWaitLock.SetMaxWaitLockCount(iMaxHoldThreads);
 }
 
@@ -163,13 +479,46 @@ void Committer :: SetProposeWaitTimeThresholdMS(const int iWaitTimeThresholdMS)
 void Committer :: LogStatus()
 {
     uint64_t llNowTime = Time::GetSteadyClockMS();
-    if (llNowTime > m_llLastLogTime
-            && llNowTime - m_llLastLogTime > 1000)
+    uint64_t llLastLogTime = m_llLastLogTime.load();
+    if (llNowTime <= llLastLogTime || llNowTime - llLastLogTime <= 1000)
+    {
+        return;
+    }
+
+    //only one thread report each period.
+    if (!m_llLastLogTime.compare_exchange_strong(llLastLogTime, llNowTime))
+    {
+        return;
+    }
+
+    PLGStatus("wait threads %d avg thread wait ms %d reject rate %d",
+            m_oWaitLock.GetNowHoldThreadCount(), m_oWaitLock.GetNowAvgThreadWaitTime(),
+            m_oWaitLock.GetNowRejectRate());
+
+    int iTraceIndex = m_iTraceIndex.fetch_xor(1);
+    ReportTrace(iTraceIndex);
+}
+
+void Committer :: ReportTrace(const int iTraceIndex)
+{
+    Histogram * poHistogram = m_arrTraceHistogram[iTraceIndex];
+    if (poHistogram[CommitStage_Total].GetCount() == 0)
+    {
+        return;
+    }
+
+    PLGStatus("commit count %lu p50 %luus p99 %luus max %luus",
+            poHistogram[CommitStage_Total].GetCount(),
+            poHistogram[CommitStage_Total].GetPercentile(50),
+            poHistogram[CommitStage_Total].GetPercentile(99),
+            poHistogram[CommitStage_Total].GetMax());
+
+    for (int iStage = 0; iStage < CommitStage_Count; iStage++)
     {
-        m_llLastLogTime = llNowTime;
-        PLGStatus("wait threads %d avg thread wait ms %d reject rate %d",
-                m_oWaitLock.GetNowHoldThreadCount(), m_oWaitLock.GetNowAvgThreadWaitTime(),
-                m_oWaitLock.GetNowRejectRate());
+        Histogram & oHistogram = poHistogram[iStage];
+        BP->GetCommiterBP()->CommitStageUseTimeUS(m_poConfig->GetMyGroupIdx(), iStage,
+                oHistogram.GetPercentile(50), oHistogram.GetPercentile(99), oHistogram.GetMax());
+        oHistogram.Reset();
     }
 }
     
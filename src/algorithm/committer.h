@@ -22,6 +22,11 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <string>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <inttypes.h>
 #include "comm_include.h"
 #include "sm_base.h"
@@ -32,30 +37,83 @@ namespace phxpaxos
 
 class CommitCtx;
 class IOLoop;
+class ValueChunkMgr;
+
+#define COMMITTER_COALESCE_MAX_COUNT 64
+#define COMMITTER_COALESCE_MAX_SIZE (512 * 1024)
+//a commit with less time left than this can hardly succeed.
+#define COMMITTER_MIN_LEFT_TIMEOUT_MS 200
+
+class CoalesceProposal
+{
+public:
+    const std::string * psValue;
+    int iSMID;
+    SMCtx * poSMCtx;
+    //steady clock ms the proposer stop waiting, 0 if no timeout.
+    uint64_t llAbsTimeoutMs;
+
+    bool bIsTaken;
+    bool bIsDone;
+
+    //return parameter
+    int iRet;
+    uint64_t llInstanceID;
+};
 
 class Committer
 {
 public:
-    Committer(Config * poConfig, CommitCtx * poCommitCtx, IOLoop * poIOLoop, SMFac * poSMFac);
+    Committer(Config * poConfig, CommitCtx * poCommitCtx, IOLoop * poIOLoop, SMFac * poSMFac, 
+            ValueChunkMgr * poValueChunkMgr, const bool bUseCoalesce);
     ~Committer();
 
 public:
     int NewValueGetID(const std::string & sValue, uint64_t & llInstanceID);
     
     int NewValueGetID(const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx);
+
+    //iTimeoutMs instead of SetTimeoutMs's, -1 means no timeout.
+    int NewValueGetID(const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx, const int iTimeoutMs);
     
-    int NewValueGetIDNoRetry(const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx);
+    int NewValueGetIDNoRetry(const std::string & sValue, const int iSMID, uint64_t & llInstanceID, 
+            SMCtx * poSMCtx, const int iTimeoutMs);
 
     int NewValue(const std::string & sValue);
 
 public:
     void SetTimeoutMs(const int iTimeoutMs);
 
+    const int GetTimeoutMs() const;
+
     void SetMaxHoldThreads(const int iMaxHoldThreads);
 
     void SetProposeWaitTimeThresholdMS(const int iWaitTimeThresholdMS);
 
 private:
+    int GetLock(const int iTimeoutMs, int & iLeftTimeoutMs);
+
+    int Commit(const std::string & sValue, const int iSMID, SMCtx * poSMCtx, 
+            const int iLeftTimeoutMs, const uint64_t llBeginTimeUS, uint64_t & llInstanceID);
+
+    void AddTrace(const uint64_t llBeginTimeUS, const uint64_t llLockTimeUS);
+
+    //report and reset the histograms of iTraceIndex.
+    void ReportTrace(const int iTraceIndex);
+
+    const bool CanCoalesce(const int iSMID) const;
+
+    int CoalesceNewValue(const std::string & sValue, const int iSMID, uint64_t & llInstanceID, 
+            SMCtx * poSMCtx, const int iTimeoutMs);
+
+    void PluckProposal(CoalesceProposal * poMyProposal, const int iLeftTimeoutMs, 
+            std::vector<CoalesceProposal *> & vecProposal);
+
+    void RemoveProposal(CoalesceProposal * poProposal);
+
+    int CoalesceCommit(std::vector<CoalesceProposal *> & vecProposal, const int iLeftTimeoutMs, 
+            const uint64_t llBeginTimeUS, uint64_t & llInstanceID);
+
     void LogStatus();
 
 private:
@@ -63,11 +121,25 @@ private:
     CommitCtx * m_poCommitCtx;
     IOLoop * m_poIOLoop;
     SMFac * m_poSMFac;
+    ValueChunkMgr * m_poValueChunkMgr;
 
     WaitLock m_oWaitLock;
     int m_iTimeoutMs;
+    int m_iMaxHoldThreads;
+
+    bool m_bUseCoalesce;
+    bool m_bHasCoalesceLeader;
+    std::mutex m_oCoalesceMutex;
+    std::condition_variable m_oCoalesceCond;
+    std::deque<CoalesceProposal *> m_dequeProposal;
+
+    //proposer threads add trace without lock, the one win m_llLastLogTime 
+    //switch m_iTraceIndex, then report and reset the retired histograms.
+    std::atomic<uint64_t> m_llLastLogTime;
+    std::atomic<int> m_iTraceIndex;
 
-    uint64_t m_llLastLogTime;
+    //commit latency of each CommitStage, double buffered by m_iTraceIndex.
+    Histogram m_arrTraceHistogram[2][CommitStage_Count];
 };
     
 }
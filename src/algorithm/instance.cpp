@@ -34,12 +34,19 @@ Instance :: Instance(
         const Options & oOptions)
     : m_oSMFac(poConfig->GetMyGroupIdx()),
     m_oIOLoop((Config *)poConfig, this),
+    m_oChosenValueCache(poLogStorage, oOptions.iChosenValueCacheCount),
     m_oAcceptor(poConfig, poMsgTransport, this, poLogStorage), 
-    m_oLearner(poConfig, poMsgTransport, this, &m_oAcceptor, poLogStorage, &m_oIOLoop, &m_oCheckpointMgr, &m_oSMFac),
+    m_oLearner(poConfig, poMsgTransport, this, &m_oAcceptor, poLogStorage, &m_oIOLoop, &m_oCheckpointMgr, &m_oSMFac,
+            &m_oChosenValueCache),
     m_oProposer(poConfig, poMsgTransport, this, &m_oLearner, &m_oIOLoop),
     m_oPaxosLog(poLogStorage),
+    m_oChunkStore(poLogStorage),
+    m_oValueChunkMgr(poConfig, poMsgTransport, this, &m_oChunkStore, oOptions.iValueChunkSize),
     m_oCommitCtx((Config *)poConfig),
-    m_oCommitter((Config *)poConfig, &m_oCommitCtx, &m_oIOLoop, &m_oSMFac),
+    m_oCommitter((Config *)poConfig, &m_oCommitCtx, &m_oIOLoop, &m_oSMFac, &m_oValueChunkMgr, 
+            oOptions.bUseProposeCoalesce),
+    m_oProposeForwarder(poConfig, poMsgTransport, this, &m_oCommitter),
+    m_oMasterLeaser(poConfig, poMsgTransport, this),
     m_oCheckpointMgr((Config *)poConfig, &m_oSMFac, (LogStorage *)poLogStorage, oOptions.bUseCheckpointReplayer),
     m_oOptions(oOptions), m_bStarted(false)
 {
@@ -56,8 +63,18 @@ Instance :: ~Instance()
 
 int Instance :: Init()
 {
+    //chunks of large value are needed when playlog.
+    int ret = m_oChunkStore.Init(m_poConfig->GetMyGroupIdx());
+    if (ret != 0)
+    {
+        PLGErr("ChunkStore.Init fail, ret %d", ret);
+        return ret;
+    }
+
+    m_oSMFac.SetChunkStore(&m_oChunkStore);
+
     //Must init acceptor first, because the max instanceid is record in acceptor state.
-    int ret = m_oAcceptor.Init();
+    ret = m_oAcceptor.Init();
     if (ret != 0)
     {
         PLGErr("Acceptor.Init fail, ret %d", ret);
@@ -130,18 +147,26 @@ void Instance :: Start()
     //start learner sender
     m_oLearner.StartLearnerSender();
     //start ioloop
-    m_oIOLoop.start();
+    m_oIOLoop.Start();
     //start checkpoint replayer and cleaner
     m_oCheckpointMgr.Start();
 
     m_bStarted = true;
 }
 
+void Instance :: SetIOLoopScheduler(IOLoopScheduler * poIOLoopScheduler)
+{
+    m_oIOLoop.SetScheduler(poIOLoopScheduler);
+}
+
 void Instance :: Stop()
 {
     if (m_bStarted)
     {
+        //forwarded proposes in flight need ioloop to finish.
+        m_oProposeForwarder.Stop();
         m_oIOLoop.Stop();
+        m_oValueChunkMgr.Stop();
         m_oCheckpointMgr.Stop();
         m_oLearner.Stop();
     }
@@ -275,6 +300,21 @@ Committer * Instance :: GetCommitter()
     return &m_oCommitter;
 }
 
+ProposeForwarder * Instance :: GetProposeForwarder()
+{
+    return &m_oProposeForwarder;
+}
+
+MasterLeaser * Instance :: GetMasterLeaser()
+{
+    return &m_oMasterLeaser;
+}
+
+CommitCtx * Instance :: GetCommitCtx()
+{
+    return &m_oCommitCtx;
+}
+
 Cleaner * Instance :: GetCheckpointCleaner()
 {
     return m_oCheckpointMgr.GetCleaner();
@@ -350,6 +390,7 @@ void Instance :: CheckNewValue()
         if (m_oOptions.bOpenChangeValueBeforePropose) {
             m_oSMFac.BeforePropose(m_poConfig->GetMyGroupIdx(), m_oCommitCtx.GetCommitValue());
         }
+
         m_oProposer.NewValue(m_oCommitCtx.GetCommitValue());
     }
 }
@@ -368,9 +409,7 @@ void Instance :: OnNewValueCommitTimeout()
 
 int Instance :: OnReceiveMessage(const char * pcMessage, const int iMessageLen)
 {
-    m_oIOLoop.AddMessage(pcMessage, iMessageLen);
-
-    return 0;
+    return m_oIOLoop.AddMessage(pcMessage, iMessageLen);
 }
 
 bool Instance :: ReceiveMsgHeaderCheck(const Header & oHeader, const nodeid_t iFromNodeID)
@@ -391,6 +430,34 @@ bool Instance :: ReceiveMsgHeaderCheck(const Header & oHeader, const nodeid_t iF
     return true;
 }
 
+int Instance :: DecompressMsgValue(PaxosMsg & oPaxosMsg)
+{
+    if (!(oPaxosMsg.flag() & PaxosMsgFlagType_ValueCompressed))
+    {
+        return 0;
+    }
+
+    uint64_t llBeginTimeUs = Time::GetSteadyClockUS();
+
+    std::string sValue;
+    int ret = ValueCompressor::Decompress(oPaxosMsg.value(), MAX_VALUE_SIZE, sValue);
+    if (ret != 0)
+    {
+        BP->GetAlgorithmBaseBP()->ValueDecompressFail();
+        PLGErr("Decompress fail, msg.from_nodeid %lu valuelen %zu, maybe dictionary not registered",
+                oPaxosMsg.nodeid(), oPaxosMsg.value().size());
+        return -1;
+    }
+
+    BP->GetAlgorithmBaseBP()->ValueDecompress(oPaxosMsg.value().size(), sValue.size(),
+            (int)(Time::GetSteadyClockUS() - llBeginTimeUs));
+
+    oPaxosMsg.set_value(sValue);
+    oPaxosMsg.set_flag(oPaxosMsg.flag() & ~PaxosMsgFlagType_ValueCompressed);
+
+    return 0;
+}
+
 void Instance :: OnReceive(const std::string & sBuffer)
 {
     BP->GetInstanceBP()->OnReceive();
@@ -433,6 +500,14 @@ void Instance :: OnReceive(const std::string & sBuffer)
         {
             return;
         }
+
+        m_poConfig->SetNodeValueCompressSupport(oPaxosMsg.nodeid(), 
+                oHeader.version() >= HEADER_VERSION_VALUE_COMPRESS);
+
+        if (DecompressMsgValue(oPaxosMsg) != 0)
+        {
+            return;
+        }
         
         OnReceivePaxosMsg(oPaxosMsg);
     }
@@ -454,6 +529,85 @@ void Instance :: OnReceive(const std::string & sBuffer)
         
         OnReceiveCheckpointMsg(oCheckpointMsg);
     }
+    else if (iCmd == MsgCmd_ValueChunkMsg)
+    {
+        ValueChunkMsg oValueChunkMsg;
+        bool bSucc = oValueChunkMsg.ParseFromArray(sBuffer.data() + iBodyStartPos, iBodyLen);
+        if (!bSucc)
+        {
+            BP->GetInstanceBP()->OnReceiveParseError();
+            PLGErr("ValueChunkMsg.ParseFromArray fail, skip this msg");
+            return;
+        }
+
+        if (!ReceiveMsgHeaderCheck(oHeader, oValueChunkMsg.nodeid()))
+        {
+            return;
+        }
+
+        OnReceiveValueChunkMsg(oValueChunkMsg);
+    }
+    else if (iCmd == MsgCmd_ForwardMsg)
+    {
+        ForwardMsg oForwardMsg;
+        bool bSucc = oForwardMsg.ParseFromArray(sBuffer.data() + iBodyStartPos, iBodyLen);
+        if (!bSucc)
+        {
+            BP->GetInstanceBP()->OnReceiveParseError();
+            PLGErr("ForwardMsg.ParseFromArray fail, skip this msg");
+            return;
+        }
+
+        if (!ReceiveMsgHeaderCheck(oHeader, oForwardMsg.nodeid()))
+        {
+            return;
+        }
+
+        OnReceiveForwardMsg(oForwardMsg);
+    }
+    else if (iCmd == MsgCmd_MasterLeaseMsg)
+    {
+        MasterLeaseMsg oMasterLeaseMsg;
+        bool bSucc = oMasterLeaseMsg.ParseFromArray(sBuffer.data() + iBodyStartPos, iBodyLen);
+        if (!bSucc)
+        {
+            BP->GetInstanceBP()->OnReceiveParseError();
+            PLGErr("MasterLeaseMsg.ParseFromArray fail, skip this msg");
+            return;
+        }
+
+        if (!ReceiveMsgHeaderCheck(oHeader, oMasterLeaseMsg.nodeid()))
+        {
+            return;
+        }
+
+        OnReceiveMasterLeaseMsg(oMasterLeaseMsg);
+    }
+}
+
+void Instance :: OnReceiveValueChunkMsg(const ValueChunkMsg & oValueChunkMsg)
+{
+    PLGDebug("Now.InstanceID %lu MsgType %d Msg.from_nodeid %lu valueid %lu chunkidx %d buffsize %zu",
+            m_oAcceptor.GetInstanceID(), oValueChunkMsg.msgtype(), oValueChunkMsg.nodeid(),
+            oValueChunkMsg.valueid(), oValueChunkMsg.chunkidx(), oValueChunkMsg.buffer().size());
+
+    m_oValueChunkMgr.OnValueChunkMsg(oValueChunkMsg);
+}
+
+void Instance :: OnReceiveForwardMsg(const ForwardMsg & oForwardMsg)
+{
+    PLGDebug("MsgType %d Msg.from_nodeid %lu requestid %lu",
+            oForwardMsg.msgtype(), oForwardMsg.nodeid(), oForwardMsg.requestid());
+
+    m_oProposeForwarder.OnForwardMsg(oForwardMsg);
+}
+
+void Instance :: OnReceiveMasterLeaseMsg(const MasterLeaseMsg & oMasterLeaseMsg)
+{
+    PLGDebug("MsgType %d Msg.from_nodeid %lu requestid %lu",
+            oMasterLeaseMsg.msgtype(), oMasterLeaseMsg.nodeid(), oMasterLeaseMsg.requestid());
+
+    m_oMasterLeaser.OnMasterLeaseMsg(oMasterLeaseMsg);
 }
 
 void Instance :: OnReceiveCheckpointMsg(const CheckpointMsg & oCheckpointMsg)
@@ -530,7 +684,8 @@ int Instance :: OnReceivePaxosMsg(const PaxosMsg & oPaxosMsg, const bool bIsRetr
             || oPaxosMsg.msgtype() == MsgType_PaxosLearner_ComfirmAskforLearn
             || oPaxosMsg.msgtype() == MsgType_PaxosLearner_SendNowInstanceID
             || oPaxosMsg.msgtype() == MsgType_PaxosLearner_SendLearnValue_Ack
-            || oPaxosMsg.msgtype() == MsgType_PaxosLearner_AskforCheckpoint)
+            || oPaxosMsg.msgtype() == MsgType_PaxosLearner_AskforCheckpoint
+            || oPaxosMsg.msgtype() == MsgType_PaxosLearner_SendLearnValueBatch)
     {
         ChecksumLogic(oPaxosMsg);
         return ReceiveMsgForLearner(oPaxosMsg);
@@ -626,6 +781,12 @@ int Instance :: ReceiveMsgForAcceptor(const PaxosMsg & oPaxosMsg, const bool bIs
         }
         else if (oPaxosMsg.msgtype() == MsgType_PaxosAccept)
         {
+            if (!m_oValueChunkMgr.IsChunkReady(oPaxosMsg))
+            {
+                //hold, redo accept after missing chunks arrived.
+                return 0;
+            }
+
             m_oAcceptor.OnAccept(oPaxosMsg);
         }
     }
@@ -660,8 +821,57 @@ int Instance :: ReceiveMsgForAcceptor(const PaxosMsg & oPaxosMsg, const bool bIs
     return 0;
 }
 
+int Instance :: ReceiveLearnValueBatch(const PaxosMsg & oPaxosMsg)
+{
+    BP->GetLearnerBP()->OnSendLearnValueBatch(oPaxosMsg.learnedvalues_size());
+
+    PLGHead("START Msg.InstanceID %lu Now.InstanceID %lu Msg.Count %d",
+            oPaxosMsg.instanceid(), m_oLearner.GetInstanceID(), oPaxosMsg.learnedvalues_size());
+
+    for (int i = 0; i < oPaxosMsg.learnedvalues_size(); i++)
+    {
+        const LearnedValue & oLearnedValue = oPaxosMsg.learnedvalues(i);
+        if (oLearnedValue.instanceid() < m_oLearner.GetInstanceID())
+        {
+            continue;
+        }
+
+        if (oLearnedValue.instanceid() > m_oLearner.GetInstanceID())
+        {
+            PLGErr("[Latest Msg] i can't learn, Msg.InstanceID %lu Now.InstanceID %lu",
+                    oLearnedValue.instanceid(), m_oLearner.GetInstanceID());
+            break;
+        }
+
+        PaxosMsg oLearnMsg;
+        oLearnMsg.set_msgtype(MsgType_PaxosLearner_SendLearnValue);
+        oLearnMsg.set_instanceid(oLearnedValue.instanceid());
+        oLearnMsg.set_nodeid(oPaxosMsg.nodeid());
+        oLearnMsg.set_proposalid(oLearnedValue.proposalid());
+        oLearnMsg.set_proposalnodeid(oLearnedValue.proposalnodeid());
+        oLearnMsg.set_value(oLearnedValue.value());
+        oLearnMsg.set_lastchecksum(oLearnedValue.lastchecksum());
+
+        ChecksumLogic(oLearnMsg);
+        if (ReceiveMsgForLearner(oLearnMsg) != 0)
+        {
+            break;
+        }
+    }
+
+    //cumulative ack, tell sender where i am.
+    m_oLearner.SendLearnValueBatch_Ack(oPaxosMsg.nodeid());
+
+    return 0;
+}
+
 int Instance :: ReceiveMsgForLearner(const PaxosMsg & oPaxosMsg)
 {
+    if (oPaxosMsg.msgtype() == MsgType_PaxosLearner_SendLearnValueBatch)
+    {
+        return ReceiveLearnValueBatch(oPaxosMsg);
+    }
+
     if (oPaxosMsg.msgtype() == MsgType_PaxosLearner_AskforLearn)
     {
         m_oLearner.OnAskforLearn(oPaxosMsg);
@@ -708,13 +918,22 @@ int Instance :: ReceiveMsgForLearner(const PaxosMsg & oPaxosMsg)
             int iUseTimeMs = m_oTimeStat.Point();
             BP->GetInstanceBP()->OnInstanceLearnedIsMyCommit(iUseTimeMs);
             PLGHead("My commit ok, usetime %dms", iUseTimeMs);
+
+            m_oCommitCtx.TraceEnd(CommitStage_Learn, m_oLearner.GetInstanceID());
+            m_oCommitCtx.TraceBegin(CommitStage_Execute, m_oLearner.GetInstanceID());
         }
 
-        if (!SMExecute(m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue(), bIsMyCommit, poSMCtx))
+        bool bExecuteRet = SMExecute(m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue(), bIsMyCommit, poSMCtx);
+        m_oCommitCtx.TraceEnd(CommitStage_Execute, m_oLearner.GetInstanceID());
+
+        if (!bExecuteRet)
         {
             BP->GetInstanceBP()->OnInstanceLearnedSMExecuteFail();
 
             PLGErr("SMExecute fail, instanceid %lu, not increase instanceid", m_oLearner.GetInstanceID());
+
+            //large value may miss chunks, ask all nodes for them, will retry execute later.
+            m_oValueChunkMgr.AskforMissingChunks(m_oLearner.GetLearnValue(), nullnode);
             m_oCommitCtx.SetResult(PaxosTryCommitRet_ExecuteFail, 
                     m_oLearner.GetInstanceID(), m_oLearner.GetLearnValue());
 
@@ -861,7 +1080,7 @@ int Instance :: GetInstanceValue(const uint64_t llInstanceID, std::string & sVal
     }
 
     AcceptorStateData oState; 
-    int ret = m_oPaxosLog.ReadState(m_poConfig->GetMyGroupIdx(), llInstanceID, oState);
+    int ret = m_oChosenValueCache.ReadState(m_poConfig->GetMyGroupIdx(), llInstanceID, oState);
     if (ret != 0 && ret != 1)
     {
         return -1;
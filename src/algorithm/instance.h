@@ -34,6 +34,9 @@ See the AUTHORS file for names of contributors.
 #include "commitctx.h"
 #include "committer.h"
 #include "cp_mgr.h"
+#include "value_chunk_mgr.h"
+#include "propose_forwarder.h"
+#include "master_leaser.h"
 
 namespace phxpaxos
 {
@@ -54,6 +57,8 @@ public:
 
     void Stop();
 
+    void SetIOLoopScheduler(IOLoopScheduler * poIOLoopScheduler);
+
     int InitLastCheckSum();
 
     const uint64_t GetNowInstanceID();
@@ -67,6 +72,12 @@ public:
 public:
     Committer * GetCommitter();
 
+    ProposeForwarder * GetProposeForwarder();
+
+    MasterLeaser * GetMasterLeaser();
+
+    CommitCtx * GetCommitCtx();
+
     Cleaner * GetCheckpointCleaner();
 
     Replayer * GetCheckpointReplayer();
@@ -85,6 +96,12 @@ public:
     
     void OnReceiveCheckpointMsg(const CheckpointMsg & oCheckpointMsg);
 
+    void OnReceiveValueChunkMsg(const ValueChunkMsg & oValueChunkMsg);
+
+    void OnReceiveForwardMsg(const ForwardMsg & oForwardMsg);
+
+    void OnReceiveMasterLeaseMsg(const MasterLeaseMsg & oMasterLeaseMsg);
+
     int OnReceivePaxosMsg(const PaxosMsg & oPaxosMsg, const bool bIsRetry = false);
     
     int ReceiveMsgForProposer(const PaxosMsg & oPaxosMsg);
@@ -92,6 +109,8 @@ public:
     int ReceiveMsgForAcceptor(const PaxosMsg & oPaxosMsg, const bool bIsRetry);
     
     int ReceiveMsgForLearner(const PaxosMsg & oPaxosMsg);
+    
+    int ReceiveLearnValueBatch(const PaxosMsg & oPaxosMsg);
 
 public:
     void OnTimeout(const uint32_t iTimerID, const int iType);
@@ -112,6 +131,8 @@ private:
 
     bool ReceiveMsgHeaderCheck(const Header & oHeader, const nodeid_t iFromNodeID);
 
+    int DecompressMsgValue(PaxosMsg & oPaxosMsg);
+
     int ProtectionLogic_IsCheckpointInstanceIDCorrect(const uint64_t llCPInstanceID, const uint64_t llLogMaxInstanceID);
 
 private:
@@ -125,12 +146,17 @@ private:
 
     IOLoop m_oIOLoop;
 
+    ChosenValueCache m_oChosenValueCache;
+
     Acceptor m_oAcceptor;
     Learner m_oLearner;
     Proposer m_oProposer;
 
     PaxosLog m_oPaxosLog;
 
+    ChunkStore m_oChunkStore;
+    ValueChunkMgr m_oValueChunkMgr;
+
     uint32_t m_iLastChecksum;
 
 private:
@@ -139,6 +165,10 @@ private:
 
     Committer m_oCommitter;
 
+    ProposeForwarder m_oProposeForwarder;
+
+    MasterLeaser m_oMasterLeaser;
+
 private:
     CheckpointMgr m_oCheckpointMgr;
 
@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #include "ioloop.h"
 #include "utils_include.h"
 #include "instance.h"
+#include "msg_class.h"
 
 using namespace std;
 
@@ -29,12 +30,11 @@ namespace phxpaxos
 {
 
 IOLoop :: IOLoop(Config * poConfig, Instance * poInstance)
-    : m_poConfig(poConfig), m_poInstance(poInstance)
+    : m_oMessageQueue(QUEUE_MAXLENGTH, MAX_QUEUE_MEM_SIZE), m_poConfig(poConfig), m_poInstance(poInstance), 
+    m_poScheduler(nullptr)
 {
     m_bIsEnd = false;
     m_bIsStart = false;
-
-    m_iQueueMemSize = 0;
 }
 
 IOLoop :: ~IOLoop()
@@ -65,40 +65,124 @@ void IOLoop :: run()
     }
 }
 
+void IOLoop :: Start()
+{
+    if (m_poScheduler == nullptr)
+    {
+        start();
+        return;
+    }
+
+    m_bIsEnd = false;
+    m_bIsStart = true;
+    StartTask(m_poScheduler);
+}
+
+void IOLoop :: SetScheduler(IOLoopScheduler * poScheduler)
+{
+    m_poScheduler = poScheduler;
+}
+
+void IOLoop :: DoRunTask()
+{
+    BP->GetIOLoopBP()->OneLoop();
+
+    int iNextTimeout = IOLOOP_TASK_IDLE_WAKEUP_MS;
+    DealwithTimeout(iNextTimeout);
+
+    int iMsgCount = 0;
+    do
+    {
+        OneLoop(0);
+        iMsgCount++;
+    }
+    while (iMsgCount < IOLOOP_TASK_MAX_MSG_COUNT && HasReadyWork());
+
+    BP->GetIOLoopBP()->RunTask(iMsgCount);
+
+    iNextTimeout = m_oTimer.GetNextTimeout();
+    if (iNextTimeout < 0 || iNextTimeout > IOLOOP_TASK_IDLE_WAKEUP_MS)
+    {
+        iNextTimeout = IOLOOP_TASK_IDLE_WAKEUP_MS;
+    }
+
+    AddWakeup(iNextTimeout);
+}
+
+bool IOLoop :: HasReadyWork()
+{
+    return !m_oMessageQueue.Empty();
+}
+
 void IOLoop :: AddNotify()
 {
-    m_oMessageQueue.lock();
-    m_oMessageQueue.add(nullptr);
-    m_oMessageQueue.unlock();
+    int iDepth = 0;
+    m_oMessageQueue.Add(IOLoopMsgClass_Consensus, nullptr, iDepth);
+
+    Schedule();
 }
 
-int IOLoop :: AddMessage(const char * pcMessage, const int iMessageLen)
+int IOLoop :: GetMsgClass(const char * pcMessage, const int iMessageLen)
 {
-    m_oMessageQueue.lock();
+    Header oHeader;
+    int iBodyStartPos = MsgClass::ParseHeader(pcMessage, iMessageLen, oHeader);
+    if (iBodyStartPos < 0)
+    {
+        return IOLoopMsgClass_Consensus;
+    }
 
-    BP->GetIOLoopBP()->EnqueueMsg();
+    if (oHeader.cmdid() == MsgCmd_CheckpointMsg)
+    {
+        return IOLoopMsgClass_Checkpoint;
+    }
 
-    if ((int)m_oMessageQueue.size() > QUEUE_MAXLENGTH)
+    if (oHeader.cmdid() != MsgCmd_PaxosMsg)
     {
-        BP->GetIOLoopBP()->EnqueueMsgRejectByFullQueue();
+        return IOLoopMsgClass_Consensus;
+    }
 
-        PLGErr("Queue full, skip msg");
-        m_oMessageQueue.unlock();
-        return -2;
+    int iMsgType = 0;
+    if (!MsgClass::PeekBodyMsgType(pcMessage, iMessageLen, iBodyStartPos, iMsgType))
+    {
+        return IOLoopMsgClass_Consensus;
     }
 
-    if (m_iQueueMemSize > MAX_QUEUE_MEM_SIZE)
+    switch (iMsgType)
     {
-        PLErr("queue memsize %d too large, can't enqueue", m_iQueueMemSize);
-        m_oMessageQueue.unlock();
-        return -2;
+    case MsgType_PaxosLearner_AskforLearn:
+    case MsgType_PaxosLearner_SendLearnValue:
+    case MsgType_PaxosLearner_SendNowInstanceID:
+    case MsgType_PaxosLearner_ComfirmAskforLearn:
+    case MsgType_PaxosLearner_SendLearnValue_Ack:
+    case MsgType_PaxosLearner_AskforCheckpoint:
+    case MsgType_PaxosLearner_OnAskforCheckpoint:
+    case MsgType_PaxosLearner_SendLearnValueBatch:
+        return IOLoopMsgClass_Learn;
+    default:
+        return IOLoopMsgClass_Consensus;
     }
-    
-    m_oMessageQueue.add(new string(pcMessage, iMessageLen));
+}
+
+int IOLoop :: AddMessage(const char * pcMessage, const int iMessageLen)
+{
+    BP->GetIOLoopBP()->EnqueueMsg();
+
+    int iMsgClass = GetMsgClass(pcMessage, iMessageLen);
+
+    string * psMessage = new string(pcMessage, iMessageLen);
+    int iDepth = 0;
+    int ret = m_oMessageQueue.Add(iMsgClass, psMessage, iDepth);
+    if (ret != 0)
+    {
+        BP->GetIOLoopBP()->EnqueueMsgRejectByFullQueue();
 
-    m_iQueueMemSize += iMessageLen;
+        PLGErr("Queue full, skip msg. msgclass %d classsize %d memsize %d", 
+                iMsgClass, m_oMessageQueue.GetSize(iMsgClass), m_oMessageQueue.GetMemSize());
+        delete psMessage;
+        return ret;
+    }
 
-    m_oMessageQueue.unlock();
+    Schedule();
 
     return 0;
 }
@@ -120,10 +204,20 @@ int IOLoop :: AddRetryPaxosMsg(const PaxosMsg & oPaxosMsg)
 void IOLoop :: Stop()
 {
     m_bIsEnd = true;
-    if (m_bIsStart)
+    if (!m_bIsStart)
+    {
+        return;
+    }
+
+    if (m_poScheduler == nullptr)
     {
         join();
+        return;
     }
+
+    StopTask();
+
+    PLGHead("IOLoop [End]");
 }
 
 void IOLoop :: ClearRetryQueue()
@@ -178,22 +272,14 @@ void IOLoop :: DealWithRetry()
 void IOLoop :: OneLoop(const int iTimeoutMs)
 {
     std::string * psMessage = nullptr;
+    int iMsgClass = 0;
+    int iDepth = 0;
 
-    m_oMessageQueue.lock();
-    bool bSucc = m_oMessageQueue.peek(psMessage, iTimeoutMs);
-    
-    if (!bSucc)
+    bool bSucc = m_oMessageQueue.Pop(psMessage, iMsgClass, iDepth, iTimeoutMs);
+    if (bSucc)
     {
-        m_oMessageQueue.unlock();
-    }
-    else
-    {
-        m_oMessageQueue.pop();
-        m_oMessageQueue.unlock();
-
         if (psMessage != nullptr && psMessage->size() > 0)
         {
-            m_iQueueMemSize -= psMessage->size();
             m_poInstance->OnReceive(*psMessage);
         }
 
@@ -28,6 +28,8 @@ See the AUTHORS file for names of contributors.
 #include "comm_include.h"
 #include <queue>
 #include "config_include.h"
+#include "ioloop_msg_queue.h"
+#include "ioloop_scheduler.h"
 
 namespace phxpaxos
 {
@@ -36,7 +38,7 @@ namespace phxpaxos
 
 class Instance;
 
-class IOLoop : public Thread
+class IOLoop : public Thread, public IOLoopTask
 {
 public:
     IOLoop(Config * poConfig, Instance * poInstance);
@@ -44,8 +46,14 @@ public:
 
     void run();
 
+    //run on own thread, or on the scheduler's worker threads if set.
+    void Start();
+
     void Stop();
 
+public:
+    void SetScheduler(IOLoopScheduler * poScheduler);
+
     void OneLoop(const int iTimeoutMs);
 
     void DealWithRetry();
@@ -59,6 +67,9 @@ public:
 
     void AddNotify();
 
+    //classify a received message by its header and paxos msgtype, without parsing the whole body.
+    static int GetMsgClass(const char * pcMessage, const int iMessageLen);
+
 public:
     virtual bool AddTimer(const int iTimeout, const int iType, uint32_t & iTimerID);
 
@@ -68,19 +79,25 @@ public:
 
     void DealwithTimeoutOne(const uint32_t iTimerID, const int iType);
 
+protected:
+    //scheduler worker thread, deal with timeouts and a batch of messages.
+    void DoRunTask();
+
+    bool HasReadyWork();
+
 private:
     bool m_bIsEnd;
     bool m_bIsStart;
     Timer m_oTimer;
     std::map<uint32_t, bool> m_mapTimerIDExist;
 
-    Queue<std::string *> m_oMessageQueue;
+    IOLoopMsgQueue m_oMessageQueue;
     std::queue<PaxosMsg> m_oRetryQueue;
 
-    int m_iQueueMemSize;
-
     Config * m_poConfig;
     Instance * m_poInstance;
+
+    IOLoopScheduler * m_poScheduler;
 };
     
 }
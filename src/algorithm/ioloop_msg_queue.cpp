@@ -0,0 +1,163 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "ioloop_msg_queue.h"
+#include "comm_include.h"
+
+namespace phxpaxos
+{
+
+static const int s_arrMsgClassWeight[IOLoopMsgClass_Count] = 
+{
+    IOLOOP_MSG_WEIGHT_CONSENSUS,
+    IOLOOP_MSG_WEIGHT_LEARN,
+    IOLOOP_MSG_WEIGHT_CHECKPOINT,
+};
+
+IOLoopMsgQueue :: IOLoopMsgQueue(const int iMaxLength, const int iMaxMemSize)
+    : m_iMaxLength(iMaxLength), m_iMaxMemSize(iMaxMemSize), m_iSize(0), m_iMemSize(0)
+{
+    for (int i = 0; i < IOLoopMsgClass_Count; i++)
+    {
+        m_arrCredit[i] = s_arrMsgClassWeight[i];
+        m_arrMemSize[i] = 0;
+    }
+}
+
+IOLoopMsgQueue :: ~IOLoopMsgQueue()
+{
+    for (int i = 0; i < IOLoopMsgClass_Count; i++)
+    {
+        for (auto & psMessage : m_arrQueue[i])
+        {
+            BP->GetIOLoopBP()->MsgQueuePop(i);
+            delete psMessage;
+        }
+    }
+}
+
+int IOLoopMsgQueue :: Add(const int iMsgClass, std::string * psMessage, int & iDepth)
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    std::deque<std::string *> & dequeMsg = m_arrQueue[iMsgClass];
+
+    if (psMessage != nullptr)
+    {
+        //consensus has its own length and memory budget, others share the whole queue's.
+        bool bIsConsensus = iMsgClass == IOLoopMsgClass_Consensus;
+        int iLength = bIsConsensus ? (int)dequeMsg.size() : m_iSize;
+        int iMemSize = bIsConsensus ? m_arrMemSize[iMsgClass] : m_iMemSize;
+        if (iLength > m_iMaxLength || iMemSize > m_iMaxMemSize)
+        {
+            return -2;
+        }
+
+        m_iMemSize += (int)psMessage->size();
+        m_arrMemSize[iMsgClass] += (int)psMessage->size();
+    }
+
+    dequeMsg.push_back(psMessage);
+    m_iSize++;
+    iDepth = (int)dequeMsg.size();
+
+    BP->GetIOLoopBP()->MsgQueueAdd(iMsgClass);
+
+    m_oCond.notify_one();
+
+    return 0;
+}
+
+bool IOLoopMsgQueue :: Pop(std::string *& psMessage, int & iMsgClass, int & iDepth, const int iTimeoutMs)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    if (m_iSize == 0 && iTimeoutMs > 0)
+    {
+        m_oCond.wait_for(oLock, std::chrono::milliseconds(iTimeoutMs), [this]() { return m_iSize > 0; });
+    }
+
+    if (m_iSize == 0)
+    {
+        return false;
+    }
+
+    iMsgClass = PickClass();
+
+    std::deque<std::string *> & dequeMsg = m_arrQueue[iMsgClass];
+    psMessage = dequeMsg.front();
+    dequeMsg.pop_front();
+    m_iSize--;
+    iDepth = (int)dequeMsg.size();
+
+    if (psMessage != nullptr)
+    {
+        m_iMemSize -= (int)psMessage->size();
+        m_arrMemSize[iMsgClass] -= (int)psMessage->size();
+    }
+
+    BP->GetIOLoopBP()->MsgQueuePop(iMsgClass);
+
+    return true;
+}
+
+int IOLoopMsgQueue :: PickClass()
+{
+    //higher priority class first while it has credit,
+    //when no waiting class has credit left, refill all and pick again.
+    while (true)
+    {
+        for (int i = 0; i < IOLoopMsgClass_Count; i++)
+        {
+            if (!m_arrQueue[i].empty() && m_arrCredit[i] > 0)
+            {
+                m_arrCredit[i]--;
+                return i;
+            }
+        }
+
+        for (int i = 0; i < IOLoopMsgClass_Count; i++)
+        {
+            m_arrCredit[i] = s_arrMsgClassWeight[i];
+        }
+    }
+}
+
+const bool IOLoopMsgQueue :: Empty()
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    return m_iSize == 0;
+}
+
+const int IOLoopMsgQueue :: GetSize(const int iMsgClass)
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    return (int)m_arrQueue[iMsgClass].size();
+}
+
+const int IOLoopMsgQueue :: GetMemSize()
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    return m_iMemSize;
+}
+    
+}
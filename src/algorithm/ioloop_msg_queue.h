@@ -0,0 +1,80 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include "commdef.h"
+
+namespace phxpaxos
+{
+
+//share of each class when all classes have messages waiting,
+//so learner catch up and checkpoint still make progress under heavy consensus traffic.
+#define IOLOOP_MSG_WEIGHT_CONSENSUS 8
+#define IOLOOP_MSG_WEIGHT_LEARN 2
+#define IOLOOP_MSG_WEIGHT_CHECKPOINT 1
+
+//Ioloop message queue with one fifo queue per IOLoopMsgClass,
+//pop the higher priority class first, weighted by the class's credit.
+class IOLoopMsgQueue
+{
+public:
+    IOLoopMsgQueue(const int iMaxLength, const int iMaxMemSize);
+    ~IOLoopMsgQueue();
+
+    //psMessage nullptr is a notify, never rejected.
+    //return 0 ok, -2 queue full.
+    //consensus class has its own length and memory budget, other classes' backlog won't block it,
+    //so the whole queue hold at most 2 * iMaxMemSize.
+    int Add(const int iMsgClass, std::string * psMessage, int & iDepth);
+
+    //wait at most iTimeoutMs, return false if no message.
+    bool Pop(std::string *& psMessage, int & iMsgClass, int & iDepth, const int iTimeoutMs);
+
+    const bool Empty();
+
+    const int GetSize(const int iMsgClass);
+
+    const int GetMemSize();
+
+private:
+    int PickClass();
+
+private:
+    int m_iMaxLength;
+    int m_iMaxMemSize;
+
+    std::mutex m_oMutex;
+    std::condition_variable m_oCond;
+
+    std::deque<std::string *> m_arrQueue[IOLoopMsgClass_Count];
+    int m_arrCredit[IOLoopMsgClass_Count];
+    int m_arrMemSize[IOLoopMsgClass_Count];
+    int m_iSize;
+    int m_iMemSize;
+};
+    
+}
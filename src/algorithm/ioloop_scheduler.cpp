@@ -0,0 +1,371 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "ioloop_scheduler.h"
+#include "comm_include.h"
+
+namespace phxpaxos
+{
+
+//worker thread local, ready task added by a worker go to its own queue first.
+static thread_local IOLoopScheduler * t_poWorkerScheduler = nullptr;
+static thread_local int t_iWorkerIdx = -1;
+
+IOLoopTask :: IOLoopTask()
+    : m_poTaskScheduler(nullptr), m_llTaskID(0), m_iTaskState(IOLoopTaskState_Idle), 
+    m_bStopTask(false), m_llWakeupTimeMs(0)
+{
+}
+
+IOLoopTask :: ~IOLoopTask()
+{
+}
+
+void IOLoopTask :: StartTask(IOLoopScheduler * poScheduler)
+{
+    m_llTaskID = poScheduler->Register(this);
+    m_poTaskScheduler = poScheduler;
+    Schedule();
+}
+
+void IOLoopTask :: Schedule()
+{
+    IOLoopScheduler * poScheduler = m_poTaskScheduler;
+    if (poScheduler == nullptr)
+    {
+        return;
+    }
+
+    int iState = IOLoopTaskState_Idle;
+    if (m_iTaskState.compare_exchange_strong(iState, IOLoopTaskState_Scheduled))
+    {
+        poScheduler->AddTask(this);
+    }
+}
+
+void IOLoopTask :: RunTask()
+{
+    //stop wait this lock, task won't be released when running.
+    std::lock_guard<std::mutex> oLock(m_oTaskMutex);
+    if (m_iTaskState != IOLoopTaskState_Scheduled)
+    {
+        return;
+    }
+
+    //stopping, the worker only take it out of queue.
+    if (m_bStopTask)
+    {
+        m_iTaskState = IOLoopTaskState_Stopped;
+        return;
+    }
+
+    m_iTaskState = IOLoopTaskState_Running;
+
+    DoRunTask();
+
+    m_iTaskState = IOLoopTaskState_Idle;
+
+    if (HasReadyWork())
+    {
+        Schedule();
+    }
+}
+
+void IOLoopTask :: StopTask()
+{
+    IOLoopScheduler * poScheduler = m_poTaskScheduler;
+    if (poScheduler == nullptr)
+    {
+        return;
+    }
+
+    m_bStopTask = true;
+    poScheduler->UnRegister(m_llTaskID);
+
+    //a scheduled task is still in worker queue, wait the worker take it out.
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> oLock(m_oTaskMutex);
+            if (m_iTaskState != IOLoopTaskState_Scheduled)
+            {
+                m_iTaskState = IOLoopTaskState_Stopped;
+                break;
+            }
+        }
+
+        Time::MsSleep(1);
+    }
+}
+
+void IOLoopTask :: AddWakeup(const int iTimeoutMs)
+{
+    IOLoopScheduler * poScheduler = m_poTaskScheduler;
+    if (poScheduler == nullptr)
+    {
+        return;
+    }
+
+    uint64_t llNowTimeMs = Time::GetSteadyClockMS();
+    uint64_t llWakeupTimeMs = llNowTimeMs + iTimeoutMs;
+
+    //a later wakeup already on the scheduler is harmless, only add the earlier one.
+    if (m_llWakeupTimeMs > llNowTimeMs && m_llWakeupTimeMs <= llWakeupTimeMs)
+    {
+        return;
+    }
+
+    m_llWakeupTimeMs = llWakeupTimeMs;
+    poScheduler->AddWakeup(m_llTaskID, llWakeupTimeMs);
+}
+
+////////////////////////////////////////////////////////////////
+
+IOLoopScheduler :: IOLoopScheduler(const int iThreadCount)
+    : m_iThreadCount(iThreadCount > 0 ? iThreadCount : 1), m_bIsStart(false), m_bIsEnd(false),
+    m_iNextWorkerIdx(0), m_iReadyCount(0), m_llNextTaskID(1), m_poTimerThread(nullptr)
+{
+    for (int i = 0; i < m_iThreadCount; i++)
+    {
+        m_vecWorkerQueue.push_back(new IOLoopWorkerQueue());
+    }
+}
+
+IOLoopScheduler :: ~IOLoopScheduler()
+{
+    Stop();
+
+    for (auto & poWorkerQueue : m_vecWorkerQueue)
+    {
+        delete poWorkerQueue;
+    }
+}
+
+void IOLoopScheduler :: Start()
+{
+    if (m_bIsStart)
+    {
+        return;
+    }
+
+    m_bIsStart = true;
+
+    for (int i = 0; i < m_iThreadCount; i++)
+    {
+        m_vecWorkerThread.push_back(new std::thread(&IOLoopScheduler::WorkerRun, this, i));
+    }
+
+    m_poTimerThread = new std::thread(&IOLoopScheduler::TimerRun, this);
+
+    PLHead("OK, worker thread count %d", m_iThreadCount);
+}
+
+void IOLoopScheduler :: Stop()
+{
+    if (!m_bIsStart)
+    {
+        return;
+    }
+
+    m_bIsStart = false;
+
+    {
+        std::lock_guard<std::mutex> oIdleLock(m_oIdleMutex);
+        std::lock_guard<std::mutex> oTimerLock(m_oTimerMutex);
+        m_bIsEnd = true;
+    }
+
+    m_oIdleCond.notify_all();
+    m_oTimerCond.notify_all();
+
+    for (auto & poThread : m_vecWorkerThread)
+    {
+        poThread->join();
+        delete poThread;
+    }
+    m_vecWorkerThread.clear();
+
+    if (m_poTimerThread != nullptr)
+    {
+        m_poTimerThread->join();
+        delete m_poTimerThread;
+        m_poTimerThread = nullptr;
+    }
+
+    PLHead("END");
+}
+
+const int IOLoopScheduler :: GetThreadCount() const
+{
+    return m_iThreadCount;
+}
+
+const uint64_t IOLoopScheduler :: Register(IOLoopTask * poTask)
+{
+    std::lock_guard<std::mutex> oLock(m_oTimerMutex);
+    uint64_t llTaskID = m_llNextTaskID++;
+    m_mapTask[llTaskID] = poTask;
+    return llTaskID;
+}
+
+void IOLoopScheduler :: UnRegister(const uint64_t llTaskID)
+{
+    std::lock_guard<std::mutex> oLock(m_oTimerMutex);
+    m_mapTask.erase(llTaskID);
+}
+
+void IOLoopScheduler :: AddTask(IOLoopTask * poTask)
+{
+    int iWorkerIdx = 0;
+    if (t_poWorkerScheduler == this)
+    {
+        iWorkerIdx = t_iWorkerIdx;
+    }
+    else
+    {
+        iWorkerIdx = m_iNextWorkerIdx++ % m_iThreadCount;
+    }
+
+    {
+        IOLoopWorkerQueue * poWorkerQueue = m_vecWorkerQueue[iWorkerIdx];
+        std::lock_guard<std::mutex> oLock(poWorkerQueue->m_oMutex);
+        poWorkerQueue->m_dequeTask.push_back(poTask);
+    }
+
+    {
+        std::lock_guard<std::mutex> oIdleLock(m_oIdleMutex);
+        m_iReadyCount++;
+    }
+
+    m_oIdleCond.notify_one();
+}
+
+void IOLoopScheduler :: AddWakeup(const uint64_t llTaskID, const uint64_t llAbsTimeMs)
+{
+    bool bIsEarliest = false;
+
+    {
+        std::lock_guard<std::mutex> oLock(m_oTimerMutex);
+        bIsEarliest = m_oWakeupHeap.empty() || llAbsTimeMs < m_oWakeupHeap.top().first;
+        m_oWakeupHeap.push(std::make_pair(llAbsTimeMs, llTaskID));
+    }
+
+    if (bIsEarliest)
+    {
+        m_oTimerCond.notify_one();
+    }
+}
+
+IOLoopTask * IOLoopScheduler :: PopTask(const int iWorkerIdx)
+{
+    IOLoopTask * poTask = nullptr;
+
+    //own queue first in fifo order, then steal the newest task from others.
+    for (int i = 0; i < m_iThreadCount && poTask == nullptr; i++)
+    {
+        IOLoopWorkerQueue * poWorkerQueue = m_vecWorkerQueue[(iWorkerIdx + i) % m_iThreadCount];
+        std::lock_guard<std::mutex> oLock(poWorkerQueue->m_oMutex);
+        if (poWorkerQueue->m_dequeTask.empty())
+        {
+            continue;
+        }
+
+        if (i == 0)
+        {
+            poTask = poWorkerQueue->m_dequeTask.front();
+            poWorkerQueue->m_dequeTask.pop_front();
+        }
+        else
+        {
+            poTask = poWorkerQueue->m_dequeTask.back();
+            poWorkerQueue->m_dequeTask.pop_back();
+            BP->GetIOLoopBP()->StealTask();
+        }
+    }
+
+    if (poTask != nullptr)
+    {
+        std::lock_guard<std::mutex> oIdleLock(m_oIdleMutex);
+        m_iReadyCount--;
+    }
+
+    return poTask;
+}
+
+void IOLoopScheduler :: WorkerRun(const int iWorkerIdx)
+{
+    t_poWorkerScheduler = this;
+    t_iWorkerIdx = iWorkerIdx;
+
+    while (true)
+    {
+        IOLoopTask * poTask = PopTask(iWorkerIdx);
+        if (poTask != nullptr)
+        {
+            poTask->RunTask();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> oIdleLock(m_oIdleMutex);
+        while (!m_bIsEnd && m_iReadyCount <= 0)
+        {
+            m_oIdleCond.wait(oIdleLock);
+        }
+
+        if (m_bIsEnd)
+        {
+            break;
+        }
+    }
+}
+
+void IOLoopScheduler :: TimerRun()
+{
+    std::unique_lock<std::mutex> oLock(m_oTimerMutex);
+    while (!m_bIsEnd)
+    {
+        if (m_oWakeupHeap.empty())
+        {
+            m_oTimerCond.wait(oLock);
+            continue;
+        }
+
+        uint64_t llNowTimeMs = Time::GetSteadyClockMS();
+        WakeupItem oItem = m_oWakeupHeap.top();
+        if (oItem.first > llNowTimeMs)
+        {
+            m_oTimerCond.wait_for(oLock, std::chrono::milliseconds(oItem.first - llNowTimeMs));
+            continue;
+        }
+
+        m_oWakeupHeap.pop();
+
+        //hold the timer lock, so unregister wait until the schedule finish.
+        auto it = m_mapTask.find(oItem.second);
+        if (it != end(m_mapTask))
+        {
+            it->second->Schedule();
+        }
+    }
+}
+    
+}
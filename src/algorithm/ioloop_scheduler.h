@@ -0,0 +1,156 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <inttypes.h>
+
+namespace phxpaxos
+{
+
+class IOLoopScheduler;
+
+enum IOLoopTaskState
+{
+    IOLoopTaskState_Idle = 0,
+    IOLoopTaskState_Scheduled = 1,
+    IOLoopTaskState_Running = 2,
+    IOLoopTaskState_Stopped = 3,
+};
+
+//max messages one ioloop task deal with before give up the worker thread,
+//so other groups on the same worker won't starve.
+#define IOLOOP_TASK_MAX_MSG_COUNT 64
+//ioloop task wake up at least once in this time even if no timer.
+#define IOLOOP_TASK_IDLE_WAKEUP_MS 1000
+
+//Work run by the scheduler, at most one worker runs a task at a time,
+//so the task keeps its single threaded assumptions.
+class IOLoopTask
+{
+public:
+    IOLoopTask();
+    virtual ~IOLoopTask();
+
+    //any thread, put this task on the scheduler if it's idle.
+    void Schedule();
+
+    //scheduler worker thread.
+    void RunTask();
+
+protected:
+    void StartTask(IOLoopScheduler * poScheduler);
+
+    //wait the task in worker queue or running done, then never run again.
+    void StopTask();
+
+    //schedule this task again after iTimeoutMs even if nothing arrive.
+    void AddWakeup(const int iTimeoutMs);
+
+    //deal with the ready work once, in worker thread.
+    virtual void DoRunTask() = 0;
+
+    //work arrive while running can't schedule, check it after run.
+    virtual bool HasReadyWork() = 0;
+
+private:
+    std::atomic<IOLoopScheduler *> m_poTaskScheduler;
+    uint64_t m_llTaskID;
+    std::atomic<int> m_iTaskState;
+    std::atomic<bool> m_bStopTask;
+    std::mutex m_oTaskMutex;
+    uint64_t m_llWakeupTimeMs;
+};
+
+class IOLoopWorkerQueue
+{
+public:
+    std::mutex m_oMutex;
+    std::deque<IOLoopTask *> m_dequeTask;
+};
+
+//Run many groups' ioloops on a fixed number of worker threads,
+//instead of one ioloop thread per group.
+//A ioloop is scheduled when a message arrives or its timer expires,
+//idle worker steals ready ioloops from the others.
+class IOLoopScheduler
+{
+public:
+    IOLoopScheduler(const int iThreadCount);
+    ~IOLoopScheduler();
+
+    void Start();
+
+    void Stop();
+
+    const int GetThreadCount() const;
+
+public:
+    const uint64_t Register(IOLoopTask * poTask);
+
+    //after unregister, timer won't schedule this task any more.
+    void UnRegister(const uint64_t llTaskID);
+
+    //put a ready task to worker queue.
+    void AddTask(IOLoopTask * poTask);
+
+    //schedule the task at llAbsTimeMs.
+    void AddWakeup(const uint64_t llTaskID, const uint64_t llAbsTimeMs);
+
+private:
+    void WorkerRun(const int iWorkerIdx);
+
+    IOLoopTask * PopTask(const int iWorkerIdx);
+
+    void TimerRun();
+
+private:
+    int m_iThreadCount;
+    bool m_bIsStart;
+    std::atomic<bool> m_bIsEnd;
+
+    std::vector<IOLoopWorkerQueue *> m_vecWorkerQueue;
+    std::vector<std::thread *> m_vecWorkerThread;
+    std::atomic<uint32_t> m_iNextWorkerIdx;
+
+    std::mutex m_oIdleMutex;
+    std::condition_variable m_oIdleCond;
+    int m_iReadyCount;
+
+    typedef std::pair<uint64_t, uint64_t> WakeupItem;
+    std::mutex m_oTimerMutex;
+    std::condition_variable m_oTimerCond;
+    std::priority_queue<WakeupItem, std::vector<WakeupItem>, std::greater<WakeupItem> > m_oWakeupHeap;
+    std::map<uint64_t, IOLoopTask *> m_mapTask;
+    uint64_t m_llNextTaskID;
+    std::thread * m_poTimerThread;
+};
+    
+}
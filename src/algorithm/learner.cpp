@@ -21,17 +21,17 @@ See the AUTHORS file for names of contributors.
 
 #include "learner.h"
 #include "acceptor.h"
-#include "crc32.h"
 #include "cp_mgr.h"
 #include "sm_base.h"
 
 namespace phxpaxos
 {
 
-LearnerState :: LearnerState(const Config * poConfig, const LogStorage * poLogStorage)
+LearnerState :: LearnerState(const Config * poConfig, const LogStorage * poLogStorage, const ChosenValueCache * poChosenValueCache)
     : m_oPaxosLog(poLogStorage)
 {
     m_poConfig = (Config *)poConfig;
+    m_poChosenValueCache = (ChosenValueCache *)poChosenValueCache;
 
     Init();
 }
@@ -61,16 +61,9 @@ void LearnerState :: LearnValueWithoutWrite(const uint64_t llInstanceID,
 }
 
 int LearnerState :: LearnValue(const uint64_t llInstanceID, const BallotNumber & oLearnedBallot, 
-        const std::string & sValue, const uint32_t iLastChecksum)
+        const std::string & sValue, const uint32_t iNewChecksum)
 {
-    if (llInstanceID > 0 && iLastChecksum == 0)
-    {
-        m_iNewChecksum = 0;
-    }
-    else if (sValue.size() > 0)
-    {
-        m_iNewChecksum = crc32(iLastChecksum, (const uint8_t *)sValue.data(), sValue.size(), CRC32SKIP);
-    }
+    m_iNewChecksum = iNewChecksum;
     
     AcceptorStateData oState;
     oState.set_instanceid(llInstanceID);
@@ -84,7 +77,8 @@ int LearnerState :: LearnValue(const uint64_t llInstanceID, const BallotNumber &
     WriteOptions oWriteOptions;
     oWriteOptions.bSync = false;
 
-    int ret = m_oPaxosLog.WriteState(oWriteOptions, m_poConfig->GetMyGroupIdx(), llInstanceID, oState);
+    int ret = m_oPaxosLog.WriteState(oWriteOptions, m_poConfig->GetMyGroupIdx(), llInstanceID, oState,
+            m_poConfig->GetValueCompressThreshold(), m_poConfig->GetValueCompressDictID());
     if (ret != 0)
     {
         PLGErr("LogStorage.WriteLog fail, InstanceID %lu ValueLen %zu ret %d",
@@ -92,6 +86,8 @@ int LearnerState :: LearnValue(const uint64_t llInstanceID, const BallotNumber &
         return ret;
     }
 
+    m_poChosenValueCache->Add(oState);
+
     LearnValueWithoutWrite(llInstanceID, sValue, m_iNewChecksum);
 
     PLGDebug("OK, InstanceID %lu ValueLen %zu checksum %u",
@@ -120,12 +116,14 @@ Learner :: Learner(
         const LogStorage * poLogStorage,
         const IOLoop * poIOLoop,
         const CheckpointMgr * poCheckpointMgr,
-        const SMFac * poSMFac)
-    : Base(poConfig, poMsgTransport, poInstance), m_oLearnerState(poConfig, poLogStorage), 
-    m_oPaxosLog(poLogStorage), m_oLearnerSender((Config *)poConfig, this, &m_oPaxosLog),
+        const SMFac * poSMFac,
+        const ChosenValueCache * poChosenValueCache)
+    : Base(poConfig, poMsgTransport, poInstance), m_oLearnerState(poConfig, poLogStorage, poChosenValueCache), 
+    m_oLearnerSender((Config *)poConfig, this, poChosenValueCache),
     m_oCheckpointReceiver((Config *)poConfig, (LogStorage *)poLogStorage)
 {
     m_poAcceptor = (Acceptor *)poAcceptor;
+    m_poChosenValueCache = (ChosenValueCache *)poChosenValueCache;
     InitForNewPaxosInstance();
 
     m_iAskforlearn_noopTimerID = 0;
@@ -294,7 +292,7 @@ void Learner :: OnAskforLearn(const PaxosMsg & oPaxosMsg)
                 PLGImp("InstanceID only difference one, just send this value to other.");
                 //send one value
                 AcceptorStateData oState;
-                int ret = m_oPaxosLog.ReadState(m_poConfig->GetMyGroupIdx(), oPaxosMsg.instanceid(), oState);
+                int ret = m_poChosenValueCache->ReadState(m_poConfig->GetMyGroupIdx(), oPaxosMsg.instanceid(), oState);
                 if (ret == 0)
                 {
                     BallotNumber oBallot(oState.acceptedid(), oState.acceptednodeid());
@@ -412,6 +410,7 @@ void Learner :: ComfirmAskForLearn(const nodeid_t iSendNodeID)
     oPaxosMsg.set_instanceid(GetInstanceID());
     oPaxosMsg.set_nodeid(m_poConfig->GetMyNodeID());
     oPaxosMsg.set_msgtype(MsgType_PaxosLearner_ComfirmAskforLearn);
+    oPaxosMsg.set_flag(PaxosMsgFlagType_ComfirmAskforLearn_Batch);
 
     PLGHead("END InstanceID %lu MyNodeID %lu", GetInstanceID(), oPaxosMsg.nodeid());
 
@@ -426,7 +425,8 @@ void Learner :: OnComfirmAskForLearn(const PaxosMsg & oPaxosMsg)
 
     PLGHead("START Msg.InstanceID %lu Msg.from_nodeid %lu", oPaxosMsg.instanceid(), oPaxosMsg.nodeid());
 
-    if (!m_oLearnerSender.Comfirm(oPaxosMsg.instanceid(), oPaxosMsg.nodeid()))
+    bool bIsBatch = (oPaxosMsg.flag() & PaxosMsgFlagType_ComfirmAskforLearn_Batch) != 0;
+    if (!m_oLearnerSender.Comfirm(oPaxosMsg.instanceid(), oPaxosMsg.nodeid(), bIsBatch))
     {
         BP->GetLearnerBP()->OnComfirmAskForLearnGetLockFail();
 
@@ -486,7 +486,8 @@ void Learner :: OnSendLearnValue(const PaxosMsg & oPaxosMsg)
     {
         //learn value
         BallotNumber oBallot(oPaxosMsg.proposalid(), oPaxosMsg.proposalnodeid());
-        int ret = m_oLearnerState.LearnValue(oPaxosMsg.instanceid(), oBallot, oPaxosMsg.value(), GetLastChecksum());
+        uint32_t iNewChecksum = GetLearnChecksum(oPaxosMsg.instanceid(), oBallot, oPaxosMsg.value());
+        int ret = m_oLearnerState.LearnValue(oPaxosMsg.instanceid(), oBallot, oPaxosMsg.value(), iNewChecksum);
         if (ret != 0)
         {
             PLGErr("LearnState.LearnValue fail, ret %d", ret);
@@ -506,6 +507,43 @@ void Learner :: OnSendLearnValue(const PaxosMsg & oPaxosMsg)
     }
 }
 
+const uint32_t Learner :: GetLearnChecksum(const uint64_t llInstanceID, const BallotNumber & oBallot, 
+        const std::string & sValue)
+{
+    //value accepted by myself already has it's checksum, no need to compute again.
+    if (m_poAcceptor->GetInstanceID() == llInstanceID
+            && !oBallot.isnull()
+            && m_poAcceptor->GetAcceptorState()->GetAcceptedBallot() == oBallot)
+    {
+        return m_poAcceptor->GetAcceptorState()->GetChecksum();
+    }
+
+    uint32_t iLastChecksum = GetLastChecksum();
+    if (llInstanceID > 0 && iLastChecksum == 0)
+    {
+        return 0;
+    }
+    
+    if (sValue.size() == 0)
+    {
+        return m_oLearnerState.GetNewChecksum();
+    }
+
+    return m_poConfig->ChainChecksum(iLastChecksum, sValue);
+}
+
+int Learner :: SendLearnValueBatch(const nodeid_t iSendNodeID, PaxosMsg & oPaxosMsg)
+{
+    BP->GetLearnerBP()->SendLearnValueBatch(oPaxosMsg.learnedvalues_size());
+
+    oPaxosMsg.set_msgtype(MsgType_PaxosLearner_SendLearnValueBatch);
+    oPaxosMsg.set_instanceid(oPaxosMsg.learnedvalues(0).instanceid());
+    oPaxosMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oPaxosMsg.set_flag(PaxosMsgFlagType_SendLearnValue_NeedAck);
+
+    return SendMessage(iSendNodeID, oPaxosMsg, Message_SendType_TCP);
+}
+
 void Learner :: SendLearnValue_Ack(const nodeid_t iSendNodeID)
 {
     PLGHead("START LastAck.Instanceid %lu Now.Instanceid %lu", m_llLastAckInstanceID, GetInstanceID());
@@ -530,6 +568,23 @@ void Learner :: SendLearnValue_Ack(const nodeid_t iSendNodeID)
     PLGHead("End. ok");
 }
 
+void Learner :: SendLearnValueBatch_Ack(const nodeid_t iSendNodeID)
+{
+    //every batch need ack, sender's window move forward by acks.
+    Reset_AskforLearn_Noop();
+
+    BP->GetLearnerBP()->SendLearnValue_Ack();
+
+    m_llLastAckInstanceID = GetInstanceID();
+
+    PaxosMsg oPaxosMsg;
+    oPaxosMsg.set_instanceid(GetInstanceID());
+    oPaxosMsg.set_msgtype(MsgType_PaxosLearner_SendLearnValue_Ack);
+    oPaxosMsg.set_nodeid(m_poConfig->GetMyNodeID());
+
+    SendMessage(iSendNodeID, oPaxosMsg);
+}
+
 void Learner :: OnSendLearnValue_Ack(const PaxosMsg & oPaxosMsg)
 {
     BP->GetLearnerBP()->OnSendLearnValue_Ack();
@@ -623,6 +678,17 @@ void Learner :: OnProposerSendSuccess(const PaxosMsg & oPaxosMsg)
             oPaxosMsg.instanceid(),
             m_poAcceptor->GetAcceptorState()->GetAcceptedValue(),
             m_poAcceptor->GetAcceptorState()->GetChecksum());
+
+    //acceptor already persisted it, just keep a copy for learners.
+    AcceptorStateData oState;
+    oState.set_instanceid(oPaxosMsg.instanceid());
+    oState.set_promiseid(m_poAcceptor->GetAcceptorState()->GetPromiseBallot().m_llProposalID);
+    oState.set_promisenodeid(m_poAcceptor->GetAcceptorState()->GetPromiseBallot().m_llNodeID);
+    oState.set_acceptedid(oBallot.m_llProposalID);
+    oState.set_acceptednodeid(oBallot.m_llNodeID);
+    oState.set_acceptedvalue(m_poAcceptor->GetAcceptorState()->GetAcceptedValue());
+    oState.set_checksum(m_poAcceptor->GetAcceptorState()->GetChecksum());
+    m_poChosenValueCache->Add(oState);
     
     BP->GetLearnerBP()->OnProposerSendSuccessSuccessLearn();
 
@@ -649,6 +715,14 @@ void Learner :: AskforCheckpoint(const nodeid_t iSendNodeID)
     oPaxosMsg.set_nodeid(m_poConfig->GetMyNodeID());
     oPaxosMsg.set_msgtype(MsgType_PaxosLearner_AskforCheckpoint);
 
+    string sCheckpointFiles;
+    //not ready yet, ask without files, next ask may carry them.
+    ret = m_oCheckpointReceiver.PrepareReuseFiles(m_poSMFac, sCheckpointFiles);
+    if (ret == 0 && sCheckpointFiles.size() > 0)
+    {
+        oPaxosMsg.set_checkpointfiles(sCheckpointFiles);
+    }
+
     PLGHead("END InstanceID %lu MyNodeID %lu", GetInstanceID(), oPaxosMsg.nodeid());
     
     SendMessage(iSendNodeID, oPaxosMsg);
@@ -659,6 +733,11 @@ void Learner :: OnAskforCheckpoint(const PaxosMsg & oPaxosMsg)
     CheckpointSender * poCheckpointSender = GetNewCheckpointSender(oPaxosMsg.nodeid());
     if (poCheckpointSender != nullptr)
     {
+        if (oPaxosMsg.has_checkpointfiles())
+        {
+            poCheckpointSender->SetReceiverFiles(oPaxosMsg.checkpointfiles());
+        }
+
         poCheckpointSender->start();
         PLGHead("new checkpoint sender started, send to nodeid %lu", oPaxosMsg.nodeid());
     }
@@ -719,6 +798,7 @@ int Learner :: SendCheckpoint(
         const std::string & sFilePath,
         const int iSMID,
         const uint64_t llOffset,
+        const uint64_t llFileSize,
         const std::string & sBuffer)
 {
     CheckpointMsg oCheckpointMsg;
@@ -733,6 +813,7 @@ int Learner :: SendCheckpoint(
     oCheckpointMsg.set_filepath(sFilePath);
     oCheckpointMsg.set_smid(iSMID);
     oCheckpointMsg.set_offset(llOffset);
+    oCheckpointMsg.set_filesize(llFileSize);
     oCheckpointMsg.set_buffer(sBuffer);
 
     PLGImp("END, SendNodeID %lu uuid %lu sequence %lu cpi %lu checksum %u smid %d offset %lu buffsize %zu filepath %s",
@@ -742,6 +823,36 @@ int Learner :: SendCheckpoint(
     return SendMessage(iSendNodeID, oCheckpointMsg, Message_SendType_TCP);
 }
 
+int Learner :: SendCheckpointReuseFile(
+        const nodeid_t iSendNodeID,
+        const uint64_t llUUID,
+        const uint64_t llSequence,
+        const uint64_t llCheckpointInstanceID,
+        const std::string & sFilePath,
+        const int iSMID,
+        const uint64_t llFileSize,
+        const uint64_t llFileChecksum)
+{
+    CheckpointMsg oCheckpointMsg;
+
+    oCheckpointMsg.set_msgtype(CheckpointMsgType_SendFile);
+    oCheckpointMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oCheckpointMsg.set_flag(CheckpointSendFileFlag_REUSE);
+    oCheckpointMsg.set_uuid(llUUID);
+    oCheckpointMsg.set_sequence(llSequence);
+    oCheckpointMsg.set_checkpointinstanceid(llCheckpointInstanceID);
+    oCheckpointMsg.set_filepath(sFilePath);
+    oCheckpointMsg.set_smid(iSMID);
+    oCheckpointMsg.set_filesize(llFileSize);
+    oCheckpointMsg.set_filechecksum(llFileChecksum);
+
+    PLGImp("END, SendNodeID %lu uuid %lu sequence %lu cpi %lu smid %d filesize %lu filepath %s",
+            iSendNodeID, llUUID, llSequence, llCheckpointInstanceID, 
+            iSMID, llFileSize, sFilePath.c_str());
+
+    return SendMessage(iSendNodeID, oCheckpointMsg, Message_SendType_TCP);
+}
+
 int Learner :: OnSendCheckpoint_Begin(const CheckpointMsg & oCheckpointMsg)
 {
     int ret = m_oCheckpointReceiver.NewReceiver(oCheckpointMsg.nodeid(), oCheckpointMsg.uuid());
@@ -749,6 +860,9 @@ int Learner :: OnSendCheckpoint_Begin(const CheckpointMsg & oCheckpointMsg)
     {
         PLGImp("NewReceiver ok");
 
+        //all log was cleared by NewReceiver, the cached states are gone with it.
+        m_poChosenValueCache->Clear();
+
         ret = m_poCheckpointMgr->SetMinChosenInstanceID(oCheckpointMsg.checkpointinstanceid());
         if (ret != 0)
         {
@@ -776,6 +890,13 @@ int Learner :: OnSendCheckpoint_End(const CheckpointMsg & oCheckpointMsg)
         PLGErr("receive end msg but receiver not finish");
         return -1;
     }
+
+    //all files must be on disk before sm load them.
+    int ret = m_oCheckpointReceiver.FinishReceive();
+    if (ret != 0)
+    {
+        return ret;
+    }
     
     BP->GetCheckpointBP()->ReceiveCheckpointDone();
 
@@ -793,7 +914,7 @@ int Learner :: OnSendCheckpoint_End(const CheckpointMsg & oCheckpointMsg)
         string sTmpDirPath = m_oCheckpointReceiver.GetTmpDirPath(poSM->SMID());
         std::vector<std::string> vecFilePathList;
 
-        int ret = FileUtils :: IterDir(sTmpDirPath, vecFilePathList);
+        ret = FileUtils :: IterDir(sTmpDirPath, vecFilePathList);
         if (ret != 0)
         {
             PLGErr("IterDir fail, dirpath %s", sTmpDirPath.c_str());
@@ -833,6 +954,16 @@ void Learner :: OnSendCheckpoint(const CheckpointMsg & oCheckpointMsg)
             oCheckpointMsg.offset(), oCheckpointMsg.buffer().size(), oCheckpointMsg.filepath().c_str());
 
     int ret = 0;
+
+    if (m_oCheckpointReceiver.IsSequenceGap(oCheckpointMsg.nodeid(), oCheckpointMsg.uuid(), oCheckpointMsg.sequence()))
+    {
+        //some chunks lost, ask sender resend from the one we expect, keep what we already have.
+        PLGErr("sequence gap, msg.sequence %lu, ask for resend", oCheckpointMsg.sequence());
+        SendCheckpointAck(oCheckpointMsg.nodeid(), oCheckpointMsg.uuid(), 
+                m_oCheckpointReceiver.GetExpectSequence(), CheckpointSendFileAckFlag_Resend);
+        Reset_AskforLearn_Noop(120000);
+        return;
+    }
     
     if (oCheckpointMsg.flag() == CheckpointSendFileFlag_BEGIN)
     {
@@ -842,6 +973,10 @@ void Learner :: OnSendCheckpoint(const CheckpointMsg & oCheckpointMsg)
     {
         ret = OnSendCheckpoint_Ing(oCheckpointMsg);
     }
+    else if (oCheckpointMsg.flag() == CheckpointSendFileFlag_REUSE)
+    {
+        ret = m_oCheckpointReceiver.ReceiveReuseFile(oCheckpointMsg);
+    }
     else if (oCheckpointMsg.flag() == CheckpointSendFileFlag_END)
     {
         ret = OnSendCheckpoint_End(oCheckpointMsg);
@@ -890,6 +1025,10 @@ void Learner :: OnSendCheckpointAck(const CheckpointMsg & oCheckpointMsg)
         {
             m_poCheckpointSender->Ack(oCheckpointMsg.nodeid(), oCheckpointMsg.uuid(), oCheckpointMsg.sequence());
         }
+        else if (oCheckpointMsg.flag() == CheckpointSendFileAckFlag_Resend)
+        {
+            m_poCheckpointSender->Resend(oCheckpointMsg.nodeid(), oCheckpointMsg.uuid(), oCheckpointMsg.sequence());
+        }
         else
         {
             m_poCheckpointSender->End();
@@ -26,6 +26,7 @@ See the AUTHORS file for names of contributors.
 #include "commdef.h"
 #include "comm_include.h"
 #include "paxos_log.h"
+#include "chosen_value_cache.h"
 #include "ioloop.h"
 #include "learner_sender.h"
 #include "checkpoint_sender.h"
@@ -37,7 +38,7 @@ namespace phxpaxos
 class LearnerState
 {
 public:
-    LearnerState(const Config * poConfig, const LogStorage * poLogStorage);
+    LearnerState(const Config * poConfig, const LogStorage * poLogStorage, const ChosenValueCache * poChosenValueCache);
     ~LearnerState();
 
     void Init();
@@ -61,6 +62,7 @@ private:
 
     Config * m_poConfig;
     PaxosLog m_oPaxosLog;
+    ChosenValueCache * m_poChosenValueCache;
 };
 
 ///////////////////////////////////////////////////////
@@ -81,7 +83,8 @@ public:
             const LogStorage * poLogStorage,
             const IOLoop * poIOLoop,
             const CheckpointMgr * poCheckpointMgr,
-            const SMFac * poSMFac);
+            const SMFac * poSMFac,
+            const ChosenValueCache * poChosenValueCache);
     virtual ~Learner();
 
     void StartLearnerSender();
@@ -124,8 +127,15 @@ public:
 
     void OnSendLearnValue(const PaxosMsg & oPaxosMsg);
 
+    const uint32_t GetLearnChecksum(const uint64_t llInstanceID, const BallotNumber & oBallot, 
+            const std::string & sValue);
+
+    int SendLearnValueBatch(const nodeid_t iSendNodeID, PaxosMsg & oPaxosMsg);
+
     void SendLearnValue_Ack(const nodeid_t iSendNodeID);
 
+    void SendLearnValueBatch_Ack(const nodeid_t iSendNodeID);
+
     void OnSendLearnValue_Ack(const PaxosMsg & oPaxosMsg);
 
     //success learn
@@ -158,8 +168,19 @@ public:
             const std::string & sFilePath,
             const int iSMID,
             const uint64_t llOffset,
+            const uint64_t llFileSize,
             const std::string & sBuffer);
     
+    int SendCheckpointReuseFile(
+            const nodeid_t iSendNodeID,
+            const uint64_t llUUID,
+            const uint64_t llSequence,
+            const uint64_t llCheckpointInstanceID,
+            const std::string & sFilePath,
+            const int iSMID,
+            const uint64_t llFileSize,
+            const uint64_t llFileChecksum);
+
     int SendCheckpointEnd(
             const nodeid_t iSendNodeID,
             const uint64_t llUUID,
@@ -195,7 +216,7 @@ private:
     LearnerState m_oLearnerState;
 
     Acceptor * m_poAcceptor;
-    PaxosLog m_oPaxosLog;
+    ChosenValueCache * m_poChosenValueCache;
 
     uint32_t m_iAskforlearn_noopTimerID;
     IOLoop * m_poIOLoop;
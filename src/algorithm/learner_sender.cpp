@@ -21,12 +21,14 @@ See the AUTHORS file for names of contributors.
 
 #include "learner_sender.h"
 #include "learner.h"
+#include "credit_notifier.h"
+#include <algorithm>
 
 namespace phxpaxos
 {
 
-LearnerSender :: LearnerSender(Config * poConfig, Learner * poLearner, PaxosLog * poPaxosLog)
-    : m_poConfig(poConfig), m_poLearner(poLearner), m_poPaxosLog(poPaxosLog)
+LearnerSender :: LearnerSender(Config * poConfig, Learner * poLearner, const ChosenValueCache * poChosenValueCache)
+    : m_poConfig(poConfig), m_poLearner(poLearner), m_poChosenValueCache((ChosenValueCache *)poChosenValueCache)
 {
     m_iAckLead = LearnerSender_ACK_LEAD; 
     m_bIsEnd = false;
@@ -61,7 +63,14 @@ void LearnerSender :: run()
             return;
         }
 
-        SendLearnedValue(m_llBeginInstanceID, m_iSendToNodeID);
+        if (m_bIsBatch)
+        {
+            SendLearnedValueBatch(m_llBeginInstanceID, m_iSendToNodeID);
+        }
+        else
+        {
+            SendLearnedValue(m_llBeginInstanceID, m_iSendToNodeID);
+        }
 
         SendDone();
     }
@@ -74,6 +83,25 @@ void LearnerSender :: ReleshSending()
     m_llAbsLastSendTime = Time::GetSteadyClockMS();
 }
 
+bool LearnerSender :: WaitCredit(const uint64_t llStallBeginTime, const uint64_t llCreditVersion)
+{
+    uint64_t llNowTime = Time::GetSteadyClockMS();
+    int iStallMs = llNowTime > llStallBeginTime ? (int)(llNowTime - llStallBeginTime) : 0;
+    if (iStallMs >= LearnerSender_ACK_TIMEOUT)
+    {
+        return false;
+    }
+
+    BP->GetLearnerBP()->SenderBackpressure();
+
+    //wake up at times to keep sending state alive.
+    CreditNotifier::Instance()->Wait(llCreditVersion, 
+            std::min(LearnerSender_ACK_TIMEOUT - iStallMs, LearnerSender_CREDIT_WAIT_MS));
+    ReleshSending();
+
+    return true;
+}
+
 const bool LearnerSender :: IsIMSending()
 {
     if (!m_bIsIMSending)
@@ -163,7 +191,7 @@ const bool LearnerSender :: Prepare(const uint64_t llBeginInstanceID, const node
     return bPrepareRet;
 }
 
-const bool LearnerSender :: Comfirm(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID)
+const bool LearnerSender :: Comfirm(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID, const bool bIsBatch)
 {
     m_oLock.Lock();
 
@@ -176,6 +204,7 @@ const bool LearnerSender :: Comfirm(const uint64_t llBeginInstanceID, const node
             bComfirmRet = true;
 
             m_bIsComfirmed = true;
+            m_bIsBatch = bIsBatch;
             m_oLock.Interupt();
         }
     }
@@ -197,6 +226,7 @@ void LearnerSender :: Ack(const uint64_t llAckInstanceID, const nodeid_t iFromNo
             {
                 m_llAckInstanceID = llAckInstanceID;
                 m_llAbsLastAckTime = Time::GetSteadyClockMS();
+                m_llLastAckTimeUs = Time::GetSteadyClockUS();
                 m_oLock.Interupt();
             }
         }
@@ -275,7 +305,7 @@ int LearnerSender :: SendOne(const uint64_t llSendInstanceID, const nodeid_t iSe
     BP->GetLearnerBP()->SenderSendOnePaxosLog();
 
     AcceptorStateData oState;
-    int ret = m_poPaxosLog->ReadState(m_poConfig->GetMyGroupIdx(), llSendInstanceID, oState);
+    int ret = m_poChosenValueCache->ReadState(m_poConfig->GetMyGroupIdx(), llSendInstanceID, oState);
     if (ret != 0)
     {
         return ret;
@@ -283,9 +313,20 @@ int LearnerSender :: SendOne(const uint64_t llSendInstanceID, const nodeid_t iSe
 
     BallotNumber oBallot(oState.acceptedid(), oState.acceptednodeid());
 
+    //peer has no credit for our group, wait it drain instead of losing the value.
+    uint64_t llStallBeginTime = Time::GetSteadyClockMS();
+    uint64_t llCreditVersion = CreditNotifier::Instance()->GetVersion();
     ret = m_poLearner->SendLearnValue(iSendToNodeID, llSendInstanceID, oBallot, oState.acceptedvalue(), iLastChecksum);
+    while (ret == Paxos_NetWorkBackpressure && WaitCredit(llStallBeginTime, llCreditVersion))
+    {
+        llCreditVersion = CreditNotifier::Instance()->GetVersion();
+        ret = m_poLearner->SendLearnValue(iSendToNodeID, llSendInstanceID, oBallot, oState.acceptedvalue(), iLastChecksum);
+    }
 
-    iLastChecksum = oState.checksum();
+    if (ret == 0)
+    {
+        iLastChecksum = oState.checksum();
+    }
 
     return ret;
 }
@@ -303,9 +344,265 @@ void LearnerSender :: SendDone()
     m_llAckInstanceID = 0;
     m_llAbsLastAckTime = 0;
 
+    m_bIsBatch = false;
+    m_llLastAckTimeUs = 0;
+
     m_oLock.UnLock();
 }
 
+///////////////////////////////////////////////
+
+LearnerSendWindow :: LearnerSendWindow()
+{
+    Reset(0, 0);
+}
+
+LearnerSendWindow :: ~LearnerSendWindow()
+{
+}
+
+void LearnerSendWindow :: Reset(const int iBatchBytes, const int iMaxWindowBytes)
+{
+    m_dqInflight.clear();
+    m_iInflightBytes = 0;
+    m_iMinWindowBytes = iBatchBytes;
+    m_iMaxWindowBytes = std::max(iMaxWindowBytes, iBatchBytes);
+    m_iWindowBytes = std::min(iBatchBytes * 4, m_iMaxWindowBytes);
+    m_llMinRttUs = 0;
+    m_llLastShrinkTimeUs = 0;
+}
+
+void LearnerSendWindow :: AddInflight(const uint64_t llEndInstanceID, const int iBytes, const uint64_t llSendTimeUs)
+{
+    InflightBatch oBatch;
+    oBatch.llEndInstanceID = llEndInstanceID;
+    oBatch.iBytes = iBytes;
+    oBatch.llSendTimeUs = llSendTimeUs;
+    m_dqInflight.push_back(oBatch);
+    m_iInflightBytes += iBytes;
+}
+
+int LearnerSendWindow :: OnAck(const uint64_t llAckInstanceID, const uint64_t llAckTimeUs)
+{
+    int iAckedBytes = 0;
+    uint64_t llRttUs = 0;
+
+    while (!m_dqInflight.empty() && m_dqInflight.front().llEndInstanceID <= llAckInstanceID)
+    {
+        iAckedBytes += m_dqInflight.front().iBytes;
+        llRttUs = llAckTimeUs > m_dqInflight.front().llSendTimeUs ? llAckTimeUs - m_dqInflight.front().llSendTimeUs : 0;
+        m_dqInflight.pop_front();
+    }
+
+    if (iAckedBytes == 0)
+    {
+        return 0;
+    }
+
+    m_iInflightBytes -= iAckedBytes;
+
+    if (m_llMinRttUs == 0 || llRttUs < m_llMinRttUs)
+    {
+        m_llMinRttUs = llRttUs;
+    }
+
+    //rtt grow far from the base rtt means batches queue up in network or 
+    //learner is slow to execute, cut window at most once per rtt.
+    if (llRttUs > m_llMinRttUs * 2 + 1000)
+    {
+        if (llAckTimeUs > m_llLastShrinkTimeUs + llRttUs)
+        {
+            m_iWindowBytes = std::max(m_iWindowBytes / 2, m_iMinWindowBytes);
+            m_llLastShrinkTimeUs = llAckTimeUs;
+            BP->GetLearnerBP()->SenderWindowShrink(m_iWindowBytes);
+        }
+    }
+    else
+    {
+        m_iWindowBytes = std::min(m_iWindowBytes + iAckedBytes, m_iMaxWindowBytes);
+    }
+
+    return iAckedBytes;
+}
+
+const bool LearnerSendWindow :: CanSend() const
+{
+    return m_dqInflight.empty() || m_iInflightBytes < m_iWindowBytes;
+}
+
+const int LearnerSendWindow :: GetWindowBytes() const
+{
+    return m_iWindowBytes;
+}
+
+const int LearnerSendWindow :: GetInflightBytes() const
+{
+    return m_iInflightBytes;
+}
+
+const uint64_t LearnerSendWindow :: GetMinRttUs() const
+{
+    return m_llMinRttUs;
+}
+
+///////////////////////////////////////////////
+
+const int LearnerSender :: GetBatchBytes()
+{
+    return std::min(LearnerSender_BATCH_BYTES, MAX_VALUE_SIZE / 2);
+}
+
+const bool LearnerSender :: WaitWindow(const uint64_t llSendInstanceID)
+{
+    m_oLock.Lock();
+
+    while (true)
+    {
+        if (m_oWindow.OnAck(m_llAckInstanceID, m_llLastAckTimeUs) > 0)
+        {
+            ReleshSending();
+        }
+
+        if (llSendInstanceID < m_llAckInstanceID)
+        {
+            PLGImp("Already catch up, ack instanceid %lu now send instanceid %lu", 
+                    m_llAckInstanceID, llSendInstanceID);
+            m_oLock.UnLock();
+            return false;
+        }
+
+        if (m_oWindow.CanSend())
+        {
+            break;
+        }
+
+        uint64_t llNowTime = Time::GetSteadyClockMS();
+        int iPassTime = llNowTime > m_llAbsLastAckTime ? (int)(llNowTime - m_llAbsLastAckTime) : 0;
+
+        if (iPassTime >= LearnerSender_ACK_TIMEOUT)
+        {
+            BP->GetLearnerBP()->SenderAckTimeout();
+            PLGErr("Ack timeout, last acktime %lu now send instanceid %lu inflight bytes %d window bytes %d", 
+                    m_llAbsLastAckTime, llSendInstanceID, m_oWindow.GetInflightBytes(), m_oWindow.GetWindowBytes());
+            m_oLock.UnLock();
+            return false;
+        }
+
+        if (m_bIsEnd)
+        {
+            m_oLock.UnLock();
+            return false;
+        }
+
+        BP->GetLearnerBP()->SenderAckDelay();
+
+        //wake up by ack.
+        m_oLock.WaitTime(std::min(LearnerSender_ACK_TIMEOUT - iPassTime, 100));
+    }
+
+    m_oLock.UnLock();
+
+    return true;
+}
+
+int LearnerSender :: PackBatch(uint64_t & llSendInstanceID, uint32_t & iLastChecksum, PaxosMsg & oPaxosMsg, int & iBatchBytes)
+{
+    iBatchBytes = 0;
+
+    int iMaxBatchBytes = GetBatchBytes();
+    uint64_t llMaxInstanceID = m_poLearner->GetInstanceID();
+
+    while (llSendInstanceID < llMaxInstanceID 
+            && oPaxosMsg.learnedvalues_size() < LearnerSender_BATCH_COUNT
+            && iBatchBytes < iMaxBatchBytes)
+    {
+        AcceptorStateData oState;
+        int ret = m_poChosenValueCache->ReadState(m_poConfig->GetMyGroupIdx(), llSendInstanceID, oState);
+        if (ret != 0)
+        {
+            return ret;
+        }
+
+        if (oPaxosMsg.learnedvalues_size() > 0 
+                && iBatchBytes + (int)oState.acceptedvalue().size() + LEARNED_VALUE_HEAD_LEN > iMaxBatchBytes)
+        {
+            //large value go with next batch.
+            break;
+        }
+
+        BP->GetLearnerBP()->SenderSendOnePaxosLog();
+
+        LearnedValue * poLearnedValue = oPaxosMsg.add_learnedvalues();
+        poLearnedValue->set_instanceid(llSendInstanceID);
+        poLearnedValue->set_proposalid(oState.acceptedid());
+        poLearnedValue->set_proposalnodeid(oState.acceptednodeid());
+        poLearnedValue->set_value(oState.acceptedvalue());
+        poLearnedValue->set_lastchecksum(iLastChecksum);
+
+        iLastChecksum = oState.checksum();
+        iBatchBytes += oState.acceptedvalue().size() + LEARNED_VALUE_HEAD_LEN;
+        llSendInstanceID++;
+    }
+
+    return 0;
+}
+
+void LearnerSender :: SendLearnedValueBatch(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID)
+{
+    PLGHead("BeginInstanceID %lu SendToNodeID %lu", llBeginInstanceID, iSendToNodeID);
+
+    m_oWindow.Reset(GetBatchBytes(), LearnerSender_MAX_WINDOW_BYTES);
+
+    uint64_t llSendInstanceID = llBeginInstanceID;
+    uint32_t iLastChecksum = 0;
+
+    while (llSendInstanceID < m_poLearner->GetInstanceID())
+    {
+        if (!WaitWindow(llSendInstanceID))
+        {
+            return;
+        }
+
+        PaxosMsg oPaxosMsg;
+        int iBatchBytes = 0;
+        int ret = PackBatch(llSendInstanceID, iLastChecksum, oPaxosMsg, iBatchBytes);
+        if (ret != 0)
+        {
+            PLGErr("PackBatch fail, SendInstanceID %lu SendToNodeID %lu ret %d",
+                    llSendInstanceID, iSendToNodeID, ret);
+            return;
+        }
+
+        if (oPaxosMsg.learnedvalues_size() == 0)
+        {
+            break;
+        }
+
+        uint64_t llStallBeginTime = Time::GetSteadyClockMS();
+        uint64_t llCreditVersion = CreditNotifier::Instance()->GetVersion();
+        ret = m_poLearner->SendLearnValueBatch(iSendToNodeID, oPaxosMsg);
+        while (ret == Paxos_NetWorkBackpressure && WaitCredit(llStallBeginTime, llCreditVersion))
+        {
+            llCreditVersion = CreditNotifier::Instance()->GetVersion();
+            ret = m_poLearner->SendLearnValueBatch(iSendToNodeID, oPaxosMsg);
+        }
+
+        if (ret != 0)
+        {
+            PLGErr("SendLearnValueBatch fail, SendInstanceID %lu SendToNodeID %lu ret %d",
+                    llSendInstanceID, iSendToNodeID, ret);
+            return;
+        }
+
+        m_oWindow.AddInflight(llSendInstanceID, iBatchBytes, Time::GetSteadyClockUS());
+
+        ReleshSending();
+    }
+
+    PLGImp("SendDone, SendEndInstanceID %lu WindowBytes %d MinRttUs %lu", 
+            llSendInstanceID, m_oWindow.GetWindowBytes(), m_oWindow.GetMinRttUs());
+}
+
     
 }
 
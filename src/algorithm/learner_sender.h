@@ -24,17 +24,64 @@ See the AUTHORS file for names of contributors.
 #include "utils_include.h"
 #include "comm_include.h"
 #include "config_include.h"
-#include "paxos_log.h"
+#include "chosen_value_cache.h"
+#include <deque>
 
 namespace phxpaxos
 {
 
+//max serialized size of LearnedValue's fields except value.
+#define LEARNED_VALUE_HEAD_LEN 40
+
+//max wait for credit before refresh the sending state.
+#define LearnerSender_CREDIT_WAIT_MS 100
+
 class Learner;
 
+//Send window of batched learn, grow by acked bytes, cut by half once per rtt 
+//when rtt inflate, always in [batch bytes, max window bytes].
+class LearnerSendWindow
+{
+public:
+    LearnerSendWindow();
+    ~LearnerSendWindow();
+
+    void Reset(const int iBatchBytes, const int iMaxWindowBytes);
+
+    void AddInflight(const uint64_t llEndInstanceID, const int iBytes, const uint64_t llSendTimeUs);
+
+    //slide by batches acked, return acked bytes.
+    int OnAck(const uint64_t llAckInstanceID, const uint64_t llAckTimeUs);
+
+    const bool CanSend() const;
+
+    const int GetWindowBytes() const;
+
+    const int GetInflightBytes() const;
+
+    const uint64_t GetMinRttUs() const;
+
+private:
+    struct InflightBatch
+    {
+        uint64_t llEndInstanceID;
+        int iBytes;
+        uint64_t llSendTimeUs;
+    };
+
+    std::deque<InflightBatch> m_dqInflight;
+    int m_iInflightBytes;
+    int m_iWindowBytes;
+    int m_iMinWindowBytes;
+    int m_iMaxWindowBytes;
+    uint64_t m_llMinRttUs;
+    uint64_t m_llLastShrinkTimeUs;
+};
+
 class LearnerSender : public Thread
 {
 public:
-    LearnerSender(Config * poConfig, Learner * poLearner, PaxosLog * poPaxosLog);
+    LearnerSender(Config * poConfig, Learner * poLearner, const ChosenValueCache * poChosenValueCache);
     ~LearnerSender();
 
     void run();
@@ -44,7 +91,7 @@ public:
 public:
     const bool Prepare(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID);
 
-    const bool Comfirm(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID);
+    const bool Comfirm(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID, const bool bIsBatch = false);
 
     void Ack(const uint64_t llAckInstanceID, const nodeid_t iFromNodeID);
 
@@ -55,12 +102,24 @@ private:
 
     int SendOne(const uint64_t llSendInstanceID, const nodeid_t iSendToNodeID, uint32_t & iLastChecksum);
 
+    //pipeline many instances in one message, window control by acked bytes and rtt.
+    void SendLearnedValueBatch(const uint64_t llBeginInstanceID, const nodeid_t iSendToNodeID);
+
+    int PackBatch(uint64_t & llSendInstanceID, uint32_t & iLastChecksum, PaxosMsg & oPaxosMsg, int & iBatchBytes);
+
+    const bool WaitWindow(const uint64_t llSendInstanceID);
+
+    static const int GetBatchBytes();
+
     void SendDone();
 
     const bool IsIMSending();
 
     void ReleshSending();
 
+    //block until credit come back, return false if stalled too long since llStallBeginTime.
+    bool WaitCredit(const uint64_t llStallBeginTime, const uint64_t llCreditVersion);
+
     const bool CheckAck(const uint64_t llSendInstanceID);
 
     void CutAckLead();
@@ -68,7 +127,7 @@ private:
 private:
     Config * m_poConfig;
     Learner * m_poLearner;
-    PaxosLog * m_poPaxosLog;
+    ChosenValueCache * m_poChosenValueCache;
     SerialLock m_oLock;
 
     bool m_bIsIMSending;
@@ -83,6 +142,11 @@ private:
     uint64_t m_llAbsLastAckTime;
     int m_iAckLead;
 
+    bool m_bIsBatch;
+    uint64_t m_llLastAckTimeUs;
+
+    LearnerSendWindow m_oWindow;
+
     bool m_bIsEnd;
     bool m_bIsStart;
 };
@@ -0,0 +1,323 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "master_leaser.h"
+#include "instance.h"
+
+namespace phxpaxos
+{
+
+MasterLeaser :: MasterLeaser(
+        const Config * poConfig, 
+        const MsgTransport * poMsgTransport,
+        const Instance * poInstance)
+    : Base(poConfig, poMsgTransport, poInstance), m_llRequestID(0), m_iMajorityCount(0), m_iNodeCount(0)
+{
+}
+
+MasterLeaser :: ~MasterLeaser()
+{
+}
+
+int MasterLeaser :: RenewLease(const nodeid_t iMasterNodeID, const uint64_t llMasterVersion, 
+        const int iLeaseTimeMs, const int iTimeoutMs)
+{
+    MasterLeaseMsg oMasterLeaseMsg;
+    oMasterLeaseMsg.set_msgtype(MasterLeaseMsgType_Renew);
+    oMasterLeaseMsg.set_masternodeid(iMasterNodeID);
+    oMasterLeaseMsg.set_masterversion(llMasterVersion);
+    oMasterLeaseMsg.set_leasetime(iLeaseTimeMs);
+
+    std::vector<bool> vecItemSucc;
+    RunRound(oMasterLeaseMsg, 1, iTimeoutMs, false, vecItemSucc);
+
+    return vecItemSucc[0] ? 0 : -1;
+}
+
+int MasterLeaser :: QueryLease(const nodeid_t iNodeID, const int iTimeoutMs)
+{
+    MasterLeaseMsg oMasterLeaseMsg;
+    oMasterLeaseMsg.set_msgtype(MasterLeaseMsgType_Query);
+
+    std::vector<bool> vecItemSucc;
+    RunRound(oMasterLeaseMsg, 1, iTimeoutMs, true, vecItemSucc);
+
+    return vecItemSucc[0] ? 0 : -1;
+}
+
+void MasterLeaser :: RenewLeaseBatch(const nodeid_t iMasterNodeID, 
+        std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs)
+{
+    MasterLeaseMsg oMasterLeaseMsg;
+    oMasterLeaseMsg.set_msgtype(MasterLeaseMsgType_BatchRenew);
+    oMasterLeaseMsg.set_masternodeid(iMasterNodeID);
+    for (auto & oGroup : vecGroup)
+    {
+        MasterLeaseGroupItem * poItem = oMasterLeaseMsg.add_groupitems();
+        poItem->set_groupidx(oGroup.iGroupIdx);
+        poItem->set_masterversion(oGroup.llMasterVersion);
+        poItem->set_leasetime(oGroup.iLeaseTimeMs);
+    }
+
+    std::vector<bool> vecItemSucc;
+    RunRound(oMasterLeaseMsg, (int)vecGroup.size(), iTimeoutMs, false, vecItemSucc);
+
+    for (size_t i = 0; i < vecGroup.size(); i++)
+    {
+        vecGroup[i].bIsSucc = vecItemSucc[i];
+    }
+}
+
+void MasterLeaser :: QueryLeaseBatch(const nodeid_t iNodeID, 
+        std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs)
+{
+    MasterLeaseMsg oMasterLeaseMsg;
+    oMasterLeaseMsg.set_msgtype(MasterLeaseMsgType_BatchQuery);
+    for (auto & oGroup : vecGroup)
+    {
+        MasterLeaseGroupItem * poItem = oMasterLeaseMsg.add_groupitems();
+        poItem->set_groupidx(oGroup.iGroupIdx);
+    }
+
+    std::vector<bool> vecItemSucc;
+    RunRound(oMasterLeaseMsg, (int)vecGroup.size(), iTimeoutMs, true, vecItemSucc);
+
+    for (size_t i = 0; i < vecGroup.size(); i++)
+    {
+        vecGroup[i].bIsSucc = vecItemSucc[i];
+    }
+}
+
+bool MasterLeaser :: IsItemDone(const int iItem, const bool bFailOnRefuse)
+{
+    if ((int)m_vecAgreeNodeID[iItem].size() + 1 >= m_iMajorityCount)
+    {
+        return true;
+    }
+
+    return bFailOnRefuse ? m_vecRefuseNodeID[iItem].size() > 0
+        : (int)m_vecRefuseNodeID[iItem].size() > m_iNodeCount - m_iMajorityCount;
+}
+
+void MasterLeaser :: RunRound(MasterLeaseMsg & oMasterLeaseMsg, const int iItemCount, const int iTimeoutMs, 
+        const bool bFailOnRefuse, std::vector<bool> & vecItemSucc)
+{
+    vecItemSucc.assign(iItemCount, false);
+
+    uint64_t llRequestID = 0;
+    {
+        std::lock_guard<std::mutex> oLock(m_oMutex);
+        llRequestID = ++m_llRequestID;
+        m_iMajorityCount = m_poConfig->GetMajorityCount();
+        m_iNodeCount = m_poConfig->GetNodeCount();
+        m_vecAgreeNodeID.assign(iItemCount, std::set<nodeid_t>());
+        m_vecRefuseNodeID.assign(iItemCount, std::set<nodeid_t>());
+    }
+
+    oMasterLeaseMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oMasterLeaseMsg.set_requestid(llRequestID);
+
+    int ret = BroadcastMasterLeaseMsg(oMasterLeaseMsg);
+    if (ret != 0)
+    {
+        PLGErr("broadcast fail, ret %d", ret);
+        return;
+    }
+
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+    m_oCond.wait_for(oLock, std::chrono::milliseconds(iTimeoutMs), [&]()
+    {
+        for (int i = 0; i < iItemCount; i++)
+        {
+            if (!IsItemDone(i, bFailOnRefuse))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    });
+
+    int iSuccCount = 0;
+    for (int i = 0; i < iItemCount; i++)
+    {
+        int iAgreeCount = (int)m_vecAgreeNodeID[i].size() + 1;
+        int iRefuseCount = (int)m_vecRefuseNodeID[i].size();
+        vecItemSucc[i] = iAgreeCount >= m_iMajorityCount && !(bFailOnRefuse && iRefuseCount > 0);
+        iSuccCount += vecItemSucc[i] ? 1 : 0;
+    }
+
+    //late replies of this round are ignored.
+    m_llRequestID++;
+
+    if (iSuccCount < iItemCount)
+    {
+        PLGImp("msgtype %d itemcount %d succcount %d majority %d", 
+                oMasterLeaseMsg.msgtype(), iItemCount, iSuccCount, m_iMajorityCount);
+    }
+}
+
+void MasterLeaser :: OnMasterLeaseMsg(const MasterLeaseMsg & oMasterLeaseMsg)
+{
+    switch (oMasterLeaseMsg.msgtype())
+    {
+    case MasterLeaseMsgType_Renew:
+        OnRenew(oMasterLeaseMsg);
+        break;
+    case MasterLeaseMsgType_Query:
+        OnQuery(oMasterLeaseMsg);
+        break;
+    case MasterLeaseMsgType_BatchRenew:
+        OnBatchRenew(oMasterLeaseMsg);
+        break;
+    case MasterLeaseMsgType_BatchQuery:
+        OnBatchQuery(oMasterLeaseMsg);
+        break;
+    case MasterLeaseMsgType_RenewReply:
+    case MasterLeaseMsgType_QueryReply:
+    case MasterLeaseMsgType_BatchRenewReply:
+    case MasterLeaseMsgType_BatchQueryReply:
+        OnReply(oMasterLeaseMsg);
+        break;
+    default:
+        break;
+    }
+}
+
+void MasterLeaser :: OnRenew(const MasterLeaseMsg & oMasterLeaseMsg)
+{
+    MasterLeaseGrantor * poGrantor = m_poConfig->GetMasterLeaseGrantor();
+    bool bGrant = poGrantor != nullptr && poGrantor->GrantLease(
+            oMasterLeaseMsg.masternodeid(), oMasterLeaseMsg.masterversion(), oMasterLeaseMsg.leasetime());
+
+    MasterLeaseMsg oReplyMsg;
+    oReplyMsg.set_msgtype(MasterLeaseMsgType_RenewReply);
+    oReplyMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oReplyMsg.set_requestid(oMasterLeaseMsg.requestid());
+    oReplyMsg.set_result(bGrant ? 0 : 1);
+
+    SendMessage(oMasterLeaseMsg.nodeid(), oReplyMsg);
+}
+
+void MasterLeaser :: OnQuery(const MasterLeaseMsg & oMasterLeaseMsg)
+{
+    //a node without grantor never granted a heartbeat lease.
+    MasterLeaseGrantor * poGrantor = m_poConfig->GetMasterLeaseGrantor();
+    bool bHeld = poGrantor != nullptr && poGrantor->IsLeaseHeldByOther(oMasterLeaseMsg.nodeid());
+
+    MasterLeaseMsg oReplyMsg;
+    oReplyMsg.set_msgtype(MasterLeaseMsgType_QueryReply);
+    oReplyMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oReplyMsg.set_requestid(oMasterLeaseMsg.requestid());
+    oReplyMsg.set_result(bHeld ? 1 : 0);
+
+    SendMessage(oMasterLeaseMsg.nodeid(), oReplyMsg);
+}
+
+void MasterLeaser :: OnBatchRenew(const MasterLeaseMsg & oMasterLeaseMsg)
+{
+    MasterLeaseGrantorSet * poGrantorSet = m_poConfig->GetMasterLeaseGrantorSet();
+
+    MasterLeaseMsg oReplyMsg;
+    oReplyMsg.set_msgtype(MasterLeaseMsgType_BatchRenewReply);
+    oReplyMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oReplyMsg.set_requestid(oMasterLeaseMsg.requestid());
+
+    for (auto & oItem : oMasterLeaseMsg.groupitems())
+    {
+        MasterLeaseGrantor * poGrantor = poGrantorSet != nullptr ? 
+            poGrantorSet->GetMasterLeaseGrantor(oItem.groupidx()) : nullptr;
+        bool bGrant = poGrantor != nullptr && poGrantor->GrantLease(
+                oMasterLeaseMsg.masternodeid(), oItem.masterversion(), oItem.leasetime());
+
+        MasterLeaseGroupItem * poReplyItem = oReplyMsg.add_groupitems();
+        poReplyItem->set_groupidx(oItem.groupidx());
+        poReplyItem->set_result(bGrant ? 0 : 1);
+    }
+
+    SendMessage(oMasterLeaseMsg.nodeid(), oReplyMsg);
+}
+
+void MasterLeaser :: OnBatchQuery(const MasterLeaseMsg & oMasterLeaseMsg)
+{
+    MasterLeaseGrantorSet * poGrantorSet = m_poConfig->GetMasterLeaseGrantorSet();
+
+    MasterLeaseMsg oReplyMsg;
+    oReplyMsg.set_msgtype(MasterLeaseMsgType_BatchQueryReply);
+    oReplyMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oReplyMsg.set_requestid(oMasterLeaseMsg.requestid());
+
+    for (auto & oItem : oMasterLeaseMsg.groupitems())
+    {
+        MasterLeaseGrantor * poGrantor = poGrantorSet != nullptr ? 
+            poGrantorSet->GetMasterLeaseGrantor(oItem.groupidx()) : nullptr;
+        bool bHeld = poGrantor != nullptr && poGrantor->IsLeaseHeldByOther(oMasterLeaseMsg.nodeid());
+
+        MasterLeaseGroupItem * poReplyItem = oReplyMsg.add_groupitems();
+        poReplyItem->set_groupidx(oItem.groupidx());
+        poReplyItem->set_result(bHeld ? 1 : 0);
+    }
+
+    SendMessage(oMasterLeaseMsg.nodeid(), oReplyMsg);
+}
+
+void MasterLeaser :: OnReply(const MasterLeaseMsg & oMasterLeaseMsg)
+{
+    //only members count for majority.
+    if (!m_poConfig->IsValidNodeID(oMasterLeaseMsg.nodeid()))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    if (oMasterLeaseMsg.requestid() != m_llRequestID)
+    {
+        return;
+    }
+
+    bool bIsBatch = oMasterLeaseMsg.msgtype() == MasterLeaseMsgType_BatchRenewReply
+        || oMasterLeaseMsg.msgtype() == MasterLeaseMsgType_BatchQueryReply;
+    int iItemCount = bIsBatch ? oMasterLeaseMsg.groupitems_size() : 1;
+    if (iItemCount != (int)m_vecAgreeNodeID.size())
+    {
+        PLGErr("item count %d not same as request %zu", iItemCount, m_vecAgreeNodeID.size());
+        return;
+    }
+
+    //reply items in the same order as request.
+    for (int i = 0; i < iItemCount; i++)
+    {
+        int iResult = bIsBatch ? oMasterLeaseMsg.groupitems(i).result() : oMasterLeaseMsg.result();
+        if (iResult == 0)
+        {
+            m_vecAgreeNodeID[i].insert(oMasterLeaseMsg.nodeid());
+        }
+        else
+        {
+            m_vecRefuseNodeID[i].insert(oMasterLeaseMsg.nodeid());
+        }
+    }
+
+    m_oCond.notify_one();
+}
+    
+}
@@ -0,0 +1,95 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include "base.h"
+#include "master_lease.h"
+#include <set>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+namespace phxpaxos
+{
+
+//Renew master lease and ask whether the lease is free by heartbeat to members,
+//answer other node's renew and query by the local MasterLeaseGrantor.
+class MasterLeaser : public Base, public MasterLeaseRenewer
+{
+public:
+    MasterLeaser(
+            const Config * poConfig, 
+            const MsgTransport * poMsgTransport,
+            const Instance * poInstance);
+    ~MasterLeaser();
+
+    void InitForNewPaxosInstance() { }
+
+public:
+    //master thread, one round at a time.
+    int RenewLease(const nodeid_t iMasterNodeID, const uint64_t llMasterVersion, 
+            const int iLeaseTimeMs, const int iTimeoutMs);
+
+    int QueryLease(const nodeid_t iNodeID, const int iTimeoutMs);
+
+    void RenewLeaseBatch(const nodeid_t iMasterNodeID, 
+            std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs);
+
+    void QueryLeaseBatch(const nodeid_t iNodeID, 
+            std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs);
+
+public:
+    //ioloop thread.
+    void OnMasterLeaseMsg(const MasterLeaseMsg & oMasterLeaseMsg);
+
+private:
+    //one item for single group message, one per group item for multi-group message.
+    //self counted as agreed, vecItemSucc[i] is true if majority agreed item i,
+    //query fail on any refuse, a grant somewhere may still be valid.
+    void RunRound(MasterLeaseMsg & oMasterLeaseMsg, const int iItemCount, const int iTimeoutMs, 
+            const bool bFailOnRefuse, std::vector<bool> & vecItemSucc);
+
+    bool IsItemDone(const int iItem, const bool bFailOnRefuse);
+
+    void OnRenew(const MasterLeaseMsg & oMasterLeaseMsg);
+
+    void OnQuery(const MasterLeaseMsg & oMasterLeaseMsg);
+
+    void OnBatchRenew(const MasterLeaseMsg & oMasterLeaseMsg);
+
+    void OnBatchQuery(const MasterLeaseMsg & oMasterLeaseMsg);
+
+    void OnReply(const MasterLeaseMsg & oMasterLeaseMsg);
+
+private:
+    std::mutex m_oMutex;
+    std::condition_variable m_oCond;
+
+    uint64_t m_llRequestID;
+    int m_iMajorityCount;
+    int m_iNodeCount;
+    std::vector<std::set<nodeid_t> > m_vecAgreeNodeID;
+    std::vector<std::set<nodeid_t> > m_vecRefuseNodeID;
+};
+    
+}
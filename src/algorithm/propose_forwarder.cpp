@@ -0,0 +1,254 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "propose_forwarder.h"
+#include "committer.h"
+#include "instance.h"
+
+namespace phxpaxos
+{
+
+ProposeForwarder :: ProposeForwarder(
+        const Config * poConfig, 
+        const MsgTransport * poMsgTransport,
+        const Instance * poInstance,
+        Committer * poCommitter)
+    : Base(poConfig, poMsgTransport, poInstance), m_poCommitter(poCommitter), 
+    m_llNextRequestID(0), m_bIsEnd(false)
+{
+}
+
+ProposeForwarder :: ~ProposeForwarder()
+{
+    Stop();
+}
+
+void ProposeForwarder :: Stop()
+{
+    std::deque<ForwardMsg> dequePropose;
+    {
+        std::lock_guard<std::mutex> oLock(m_oWorkerMutex);
+        m_bIsEnd = true;
+        dequePropose.swap(m_dequePropose);
+        m_oWorkerCond.notify_all();
+    }
+
+    //let the senders propose elsewhere instead of waiting them timeout.
+    for (auto & oForwardMsg : dequePropose)
+    {
+        SendProposeReply(oForwardMsg.nodeid(), oForwardMsg.requestid(), PaxosTryCommitRet_Not_Master, 0);
+    }
+
+    //workers' commits are bounded by GetForwardTimeoutMs.
+    for (auto & poWorker : m_vecWorker)
+    {
+        poWorker->join();
+        delete poWorker;
+    }
+
+    m_vecWorker.clear();
+}
+
+int ProposeForwarder :: NewValueGetID(const nodeid_t iMasterNodeID, const std::string & sValue, 
+        uint64_t & llInstanceID, SMCtx * poSMCtx)
+{
+    BP->GetCommiterBP()->ForwardPropose();
+
+    TimeStat oTimeStat;
+    oTimeStat.Point();
+
+    ForwardRequest oRequest;
+    uint64_t llRequestID = 0;
+    {
+        std::lock_guard<std::mutex> oLock(m_oRequestMutex);
+        llRequestID = ++m_llNextRequestID;
+        m_mapRequest[llRequestID] = &oRequest;
+    }
+
+    ForwardMsg oForwardMsg;
+    oForwardMsg.set_msgtype(ForwardMsgType_Propose);
+    oForwardMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oForwardMsg.set_requestid(llRequestID);
+    oForwardMsg.set_smid(poSMCtx != nullptr ? poSMCtx->m_iSMID : 0);
+    oForwardMsg.set_value(sValue);
+
+    int ret = SendMessage(iMasterNodeID, oForwardMsg);
+    if (ret != 0)
+    {
+        {
+            std::lock_guard<std::mutex> oLock(m_oRequestMutex);
+            m_mapRequest.erase(llRequestID);
+        }
+
+        PLGErr("send to master fail, ret %d, master nodeid %lu, propose by myself", ret, iMasterNodeID);
+        return m_poCommitter->NewValueGetID(sValue, llInstanceID, poSMCtx);
+    }
+
+    std::unique_lock<std::mutex> oLock(m_oRequestMutex);
+    oRequest.oCond.wait_for(oLock, std::chrono::milliseconds(GetForwardTimeoutMs()), [&]() { return oRequest.bIsDone; });
+    m_mapRequest.erase(llRequestID);
+
+    if (oRequest.iRet == 0)
+    {
+        llInstanceID = oRequest.llInstanceID;
+        BP->GetCommiterBP()->ForwardProposeOK(oTimeStat.Point());
+    }
+    else
+    {
+        PLGErr("forward propose fail, ret %d, master nodeid %lu", oRequest.iRet, iMasterNodeID);
+        BP->GetCommiterBP()->ForwardProposeFail();
+    }
+
+    return oRequest.iRet;
+}
+
+void ProposeForwarder :: OnForwardMsg(const ForwardMsg & oForwardMsg)
+{
+    if (oForwardMsg.msgtype() == ForwardMsgType_Propose)
+    {
+        OnPropose(oForwardMsg);
+    }
+    else if (oForwardMsg.msgtype() == ForwardMsgType_ProposeReply)
+    {
+        OnProposeReply(oForwardMsg);
+    }
+}
+
+void ProposeForwarder :: OnPropose(const ForwardMsg & oForwardMsg)
+{
+    BP->GetCommiterBP()->OnForwardPropose();
+
+    bool bIsEnd = false;
+    {
+        std::lock_guard<std::mutex> oLock(m_oWorkerMutex);
+        bIsEnd = m_bIsEnd;
+        if (!m_bIsEnd && (int)m_dequePropose.size() < FORWARD_MAX_QUEUE_LEN)
+        {
+            if (m_vecWorker.empty())
+            {
+                //most nodes never be master, start worker when first needed.
+                StartWorker();
+            }
+
+            m_dequePropose.push_back(oForwardMsg);
+            m_oWorkerCond.notify_one();
+            return;
+        }
+    }
+
+    if (bIsEnd)
+    {
+        BP->GetCommiterBP()->OnForwardProposeRejectByNotMaster();
+        SendProposeReply(oForwardMsg.nodeid(), oForwardMsg.requestid(), PaxosTryCommitRet_Not_Master, 0);
+        return;
+    }
+
+    BP->GetCommiterBP()->OnForwardProposeRejectByFullQueue();
+    PLGErr("forward queue full, reject, from nodeid %lu requestid %lu", 
+            oForwardMsg.nodeid(), oForwardMsg.requestid());
+
+    SendProposeReply(oForwardMsg.nodeid(), oForwardMsg.requestid(), 
+            PaxosTryCommitRet_TooManyThreadWaiting_Reject, 0);
+}
+
+void ProposeForwarder :: OnProposeReply(const ForwardMsg & oForwardMsg)
+{
+    std::lock_guard<std::mutex> oLock(m_oRequestMutex);
+    auto it = m_mapRequest.find(oForwardMsg.requestid());
+    if (it == end(m_mapRequest))
+    {
+        //caller already timeout.
+        return;
+    }
+
+    ForwardRequest * poRequest = it->second;
+    poRequest->iRet = oForwardMsg.result();
+    poRequest->llInstanceID = oForwardMsg.instanceid();
+    poRequest->bIsDone = true;
+    poRequest->oCond.notify_one();
+}
+
+void ProposeForwarder :: SendProposeReply(const nodeid_t iSendtoNodeID, const uint64_t llRequestID, 
+        const int iRet, const uint64_t llInstanceID)
+{
+    ForwardMsg oForwardMsg;
+    oForwardMsg.set_msgtype(ForwardMsgType_ProposeReply);
+    oForwardMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oForwardMsg.set_requestid(llRequestID);
+    oForwardMsg.set_result(iRet);
+    oForwardMsg.set_instanceid(llInstanceID);
+
+    SendMessage(iSendtoNodeID, oForwardMsg);
+}
+
+void ProposeForwarder :: StartWorker()
+{
+    for (int i = 0; i < FORWARD_WORKER_COUNT; i++)
+    {
+        m_vecWorker.push_back(new std::thread(&ProposeForwarder::WorkerRun, this));
+    }
+}
+
+void ProposeForwarder :: WorkerRun()
+{
+    while (true)
+    {
+        ForwardMsg oForwardMsg;
+        {
+            std::unique_lock<std::mutex> oLock(m_oWorkerMutex);
+            m_oWorkerCond.wait(oLock, [&]() { return m_bIsEnd || !m_dequePropose.empty(); });
+            if (m_bIsEnd)
+            {
+                break;
+            }
+
+            oForwardMsg.Swap(&m_dequePropose.front());
+            m_dequePropose.pop_front();
+        }
+
+        //master may changed after the sender choose me, tell it to find the new one.
+        const MasterInfo * poMasterInfo = m_poConfig->GetMasterInfo();
+        if (poMasterInfo == nullptr || !poMasterInfo->IsIMMaster())
+        {
+            BP->GetCommiterBP()->OnForwardProposeRejectByNotMaster();
+            PLGErr("i'm not master, reject, from nodeid %lu requestid %lu",
+                    oForwardMsg.nodeid(), oForwardMsg.requestid());
+
+            SendProposeReply(oForwardMsg.nodeid(), oForwardMsg.requestid(), PaxosTryCommitRet_Not_Master, 0);
+            continue;
+        }
+
+        //sender stop waiting after the same timeout, and Stop join this thread.
+        SMCtx oSMCtx(oForwardMsg.smid(), nullptr);
+        uint64_t llInstanceID = 0;
+        int ret = m_poCommitter->NewValueGetID(oForwardMsg.value(), llInstanceID, &oSMCtx, GetForwardTimeoutMs());
+
+        SendProposeReply(oForwardMsg.nodeid(), oForwardMsg.requestid(), ret, llInstanceID);
+    }
+}
+
+const int ProposeForwarder :: GetForwardTimeoutMs() const
+{
+    return m_poCommitter->GetTimeoutMs() > 0 ? m_poCommitter->GetTimeoutMs() : FORWARD_DEFAULT_TIMEOUT_MS;
+}
+
+}
@@ -0,0 +1,110 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include "base.h"
+#include <map>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace phxpaxos
+{
+
+class Committer;
+
+#define FORWARD_WORKER_COUNT 4
+#define FORWARD_MAX_QUEUE_LEN 1000
+#define FORWARD_DEFAULT_TIMEOUT_MS 3000
+
+class ForwardRequest
+{
+public:
+    ForwardRequest() : bIsDone(false), iRet(PaxosTryCommitRet_Timeout), llInstanceID(0) { }
+
+    std::condition_variable oCond;
+    bool bIsDone;
+
+    //return parameter
+    int iRet;
+    uint64_t llInstanceID;
+};
+
+//Non master node send propose to master and wait for the result,
+//so only master propose on this group and proposers won't duel.
+class ProposeForwarder : public Base
+{
+public:
+    ProposeForwarder(
+            const Config * poConfig, 
+            const MsgTransport * poMsgTransport,
+            const Instance * poInstance,
+            Committer * poCommitter);
+    ~ProposeForwarder();
+
+    void InitForNewPaxosInstance() { }
+
+    void Stop();
+
+public:
+    //caller thread, propose on master node iMasterNodeID, 
+    //propose by myself if the value can't be sent.
+    //return PaxosTryCommitRet_Not_Master if iMasterNodeID isn't master now.
+    int NewValueGetID(const nodeid_t iMasterNodeID, const std::string & sValue, 
+            uint64_t & llInstanceID, SMCtx * poSMCtx);
+
+public:
+    //ioloop thread.
+    void OnForwardMsg(const ForwardMsg & oForwardMsg);
+
+private:
+    void OnPropose(const ForwardMsg & oForwardMsg);
+
+    void OnProposeReply(const ForwardMsg & oForwardMsg);
+
+    void SendProposeReply(const nodeid_t iSendtoNodeID, const uint64_t llRequestID, 
+            const int iRet, const uint64_t llInstanceID);
+
+    void StartWorker();
+
+    void WorkerRun();
+
+    const int GetForwardTimeoutMs() const;
+
+private:
+    Committer * m_poCommitter;
+
+    std::mutex m_oRequestMutex;
+    uint64_t m_llNextRequestID;
+    std::map<uint64_t, ForwardRequest *> m_mapRequest;
+
+    std::mutex m_oWorkerMutex;
+    std::condition_variable m_oWorkerCond;
+    std::deque<ForwardMsg> m_dequePropose;
+    std::vector<std::thread *> m_vecWorker;
+    bool m_bIsEnd;
+};
+
+}
@@ -141,6 +141,9 @@ Proposer :: Proposer(
     m_iLastAcceptTimeoutMs = m_poConfig->GetAcceptTimeoutMs();
 
     m_bWasRejectBySomeone = false;
+
+    m_llLastRejectByPromiseID = 0;
+    m_iConflictCount = 0;
 }
 
 Proposer :: ~Proposer()
@@ -157,6 +160,9 @@ void Proposer :: InitForNewPaxosInstance()
     m_oMsgCounter.StartNewRound();
     m_oProposerState.Init();
 
+    //a duel lost on the last instance should not slow down the next one.
+    m_iConflictCount = 0;
+
     ExitPrepare();
     ExitAccept();
 }
@@ -286,6 +292,7 @@ void Proposer :: Prepare(const bool bNeedNewBallot)
 
     BP->GetProposerBP()->Prepare();
     m_oTimeStat.Point();
+    TraceCommitBegin(CommitStage_Prepare);
     
     ExitAccept();
     m_bIsPreparing = true;
@@ -349,14 +356,14 @@ void Proposer :: OnPrepareReply(const PaxosMsg & oPaxosMsg)
     {
         PLGDebug("[Reject] RejectByPromiseID %lu", oPaxosMsg.rejectbypromiseid());
         m_oMsgCounter.AddReject(oPaxosMsg.nodeid());
-        m_bWasRejectBySomeone = true;
-        m_oProposerState.SetOtherProposalID(oPaxosMsg.rejectbypromiseid());
+        OnReject(oPaxosMsg.rejectbypromiseid());
     }
 
     if (m_oMsgCounter.IsPassedOnThisRound())
     {
         int iUseTimeMs = m_oTimeStat.Point();
         BP->GetProposerBP()->PreparePass(iUseTimeMs);
+        TraceCommitEnd(CommitStage_Prepare);
         PLGImp("[Pass] start accept, usetime %dms", iUseTimeMs);
         m_bCanSkipPrepare = true;
         Accept();
@@ -365,8 +372,9 @@ void Proposer :: OnPrepareReply(const PaxosMsg & oPaxosMsg)
             || m_oMsgCounter.IsAllReceiveOnThisRound())
     {
         BP->GetProposerBP()->PrepareNotPass();
-        PLGImp("[Not Pass] wait 30ms and restart prepare");
-        AddPrepareTimer(OtherUtils::FastRand() % 30 + 10);
+        int iBackoffMs = GetBackoffTimeMs();
+        PLGImp("[Not Pass] wait %dms and restart prepare", iBackoffMs);
+        AddPrepareTimer(iBackoffMs);
     }
 
     PLGHead("END");
@@ -377,8 +385,7 @@ void Proposer :: OnExpiredPrepareReply(const PaxosMsg & oPaxosMsg)
     if (oPaxosMsg.rejectbypromiseid() != 0)
     {
         PLGDebug("[Expired Prepare Reply Reject] RejectByPromiseID %lu", oPaxosMsg.rejectbypromiseid());
-        m_bWasRejectBySomeone = true;
-        m_oProposerState.SetOtherProposalID(oPaxosMsg.rejectbypromiseid());
+        OnReject(oPaxosMsg.rejectbypromiseid());
     }
 }
 
@@ -389,6 +396,7 @@ void Proposer :: Accept()
 
     BP->GetProposerBP()->Accept();
     m_oTimeStat.Point();
+    TraceCommitBegin(CommitStage_Accept);
     
     ExitPrepare();
     m_bIsAccepting = true;
@@ -444,9 +452,7 @@ void Proposer :: OnAcceptReply(const PaxosMsg & oPaxosMsg)
         PLGDebug("[Reject]");
         m_oMsgCounter.AddReject(oPaxosMsg.nodeid());
 
-        m_bWasRejectBySomeone = true;
-
-        m_oProposerState.SetOtherProposalID(oPaxosMsg.rejectbypromiseid());
+        OnReject(oPaxosMsg.rejectbypromiseid());
     }
 
     if (m_oMsgCounter.IsPassedOnThisRound())
@@ -454,6 +460,9 @@ void Proposer :: OnAcceptReply(const PaxosMsg & oPaxosMsg)
         int iUseTimeMs = m_oTimeStat.Point();
         BP->GetProposerBP()->AcceptPass(iUseTimeMs);
         PLGImp("[Pass] Start send learn, usetime %dms", iUseTimeMs);
+        TraceCommitEnd(CommitStage_Accept);
+        TraceCommitBegin(CommitStage_Learn);
+        m_iConflictCount = 0;
         ExitAccept();
         m_poLearner->ProposerSendSuccess(GetInstanceID(), m_oProposerState.GetProposalID());
     }
@@ -461,8 +470,9 @@ void Proposer :: OnAcceptReply(const PaxosMsg & oPaxosMsg)
             || m_oMsgCounter.IsAllReceiveOnThisRound())
     {
         BP->GetProposerBP()->AcceptNotPass();
-        PLGImp("[Not pass] wait 30ms and Restart prepare");
-        AddAcceptTimer(OtherUtils::FastRand() % 30 + 10);
+        int iBackoffMs = GetBackoffTimeMs();
+        PLGImp("[Not pass] wait %dms and Restart prepare", iBackoffMs);
+        AddAcceptTimer(iBackoffMs);
     }
 
     PLGHead("END");
@@ -473,11 +483,35 @@ void Proposer :: OnExpiredAcceptReply(const PaxosMsg & oPaxosMsg)
     if (oPaxosMsg.rejectbypromiseid() != 0)
     {
         PLGDebug("[Expired Accept Reply Reject] RejectByPromiseID %lu", oPaxosMsg.rejectbypromiseid());
-        m_bWasRejectBySomeone = true;
-        m_oProposerState.SetOtherProposalID(oPaxosMsg.rejectbypromiseid());
+        OnReject(oPaxosMsg.rejectbypromiseid());
     }
 }
 
+void Proposer :: OnReject(const uint64_t llRejectByPromiseID)
+{
+    m_bWasRejectBySomeone = true;
+    m_oProposerState.SetOtherProposalID(llRejectByPromiseID);
+
+    //acceptors of one round usually reject by the same proposal, count once.
+    if (llRejectByPromiseID > m_llLastRejectByPromiseID)
+    {
+        m_llLastRejectByPromiseID = llRejectByPromiseID;
+        if (m_iConflictCount <= PROPOSER_BACKOFF_MAX_SHIFT)
+        {
+            m_iConflictCount++;
+        }
+    }
+}
+
+const int Proposer :: GetBackoffTimeMs()
+{
+    int iShift = m_iConflictCount > 1 ? m_iConflictCount - 1 : 0;
+    int iBackoffMs = PROPOSER_BACKOFF_MIN_MS + OtherUtils::FastRand() % (PROPOSER_BACKOFF_RANGE_MS << iShift);
+
+    BP->GetProposerBP()->ConflictBackoff(iBackoffMs);
+    return iBackoffMs;
+}
+
 void Proposer :: OnPrepareTimeout()
 {
     PLGHead("OK");
@@ -29,6 +29,12 @@ See the AUTHORS file for names of contributors.
 namespace phxpaxos
 {
 
+//Wait before restart prepare when rejected, the random range doubles on each newer
+//proposal of others seen, and reset when my value is chosen.
+#define PROPOSER_BACKOFF_MIN_MS 10
+#define PROPOSER_BACKOFF_RANGE_MS 30
+#define PROPOSER_BACKOFF_MAX_SHIFT 5
+
 class ProposerState
 {
 public:
@@ -118,6 +124,10 @@ public:
     
     void AddAcceptTimer(const int iTimeoutMs = 0);
 
+    void OnReject(const uint64_t llRejectByPromiseID);
+
+    const int GetBackoffTimeMs();
+
 public:
     ProposerState m_oProposerState;
     MsgCounter m_oMsgCounter;
@@ -138,6 +148,9 @@ public:
 
     bool m_bWasRejectBySomeone;
 
+    uint64_t m_llLastRejectByPromiseID;
+    int m_iConflictCount;
+
     TimeStat m_oTimeStat;
 };
     
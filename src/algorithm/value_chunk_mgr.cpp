@@ -0,0 +1,525 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "value_chunk_mgr.h"
+#include "instance.h"
+#include "crc32.h"
+
+namespace phxpaxos
+{
+
+ValueChunkIO :: ValueChunkIO(ValueChunkMgr * poValueChunkMgr)
+    : m_poValueChunkMgr(poValueChunkMgr), m_bIsStarted(false), m_llQueueBytes(0)
+{
+}
+
+ValueChunkIO :: ~ValueChunkIO()
+{
+    Stop();
+}
+
+void ValueChunkIO :: Stop()
+{
+    if (!m_bIsStarted)
+    {
+        return;
+    }
+
+    //nullptr is the stop task.
+    m_oTaskQueue.lock();
+    m_oTaskQueue.add(nullptr);
+    m_oTaskQueue.unlock();
+
+    join();
+    m_bIsStarted = false;
+
+    while (!m_oTaskQueue.empty())
+    {
+        delete m_oTaskQueue.peek();
+        m_oTaskQueue.pop();
+    }
+}
+
+void ValueChunkIO :: run()
+{
+    while (true)
+    {
+        ValueChunkMsg * poValueChunkMsg = nullptr;
+
+        m_oTaskQueue.lock();
+        m_oTaskQueue.peek(poValueChunkMsg);
+        m_oTaskQueue.pop();
+        m_oTaskQueue.unlock();
+
+        if (poValueChunkMsg == nullptr)
+        {
+            break;
+        }
+
+        m_poValueChunkMgr->DoChunkIO(*poValueChunkMsg);
+
+        m_llQueueBytes -= poValueChunkMsg->buffer().size();
+        delete poValueChunkMsg;
+    }
+}
+
+const bool ValueChunkIO :: AddTask(const ValueChunkMsg & oValueChunkMsg)
+{
+    //drop only delete files, always take it, or chunks leak.
+    if (oValueChunkMsg.msgtype() != ValueChunkMsgType_DropValue
+            && m_llQueueBytes + oValueChunkMsg.buffer().size() > VALUE_CHUNK_IO_MAX_QUEUE_BYTES)
+    {
+        return false;
+    }
+
+    if (!m_bIsStarted)
+    {
+        start();
+        m_bIsStarted = true;
+    }
+
+    m_llQueueBytes += oValueChunkMsg.buffer().size();
+
+    m_oTaskQueue.lock();
+    m_oTaskQueue.add(new ValueChunkMsg(oValueChunkMsg));
+    m_oTaskQueue.unlock();
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////
+
+ValueChunkMgr :: ValueChunkMgr(
+        const Config * poConfig, 
+        const MsgTransport * poMsgTransport,
+        const Instance * poInstance,
+        ChunkStore * poChunkStore,
+        const int iChunkSize)
+    : Base(poConfig, poMsgTransport, poInstance), 
+    m_poChunkStore(poChunkStore), m_iChunkSize(iChunkSize),
+    m_llLastAskValueID(0), m_llLastAskTimeMs(0), m_oChunkIO(this)
+{
+}
+
+ValueChunkMgr :: ~ValueChunkMgr()
+{
+}
+
+void ValueChunkMgr :: Stop()
+{
+    m_oChunkIO.Stop();
+}
+
+const bool ValueChunkMgr :: NeedSplit(const std::string & sValue) const
+{
+    return m_iChunkSize > 0 && (int)sValue.size() > m_iChunkSize;
+}
+
+int ValueChunkMgr :: SplitValue(const std::string & sPackValue, std::string & sManifest)
+{
+    ValueChunkManifest oManifest;
+    oManifest.set_valueid(OtherUtils::GenGid(m_poConfig->GetMyNodeID()));
+    oManifest.set_valuesize(sPackValue.size());
+    oManifest.set_chunksize(m_iChunkSize);
+
+    uint32_t iValueChecksum = 0;
+    int iChunkIdx = 0;
+    for (size_t iOffset = 0; iOffset < sPackValue.size(); iOffset += m_iChunkSize, iChunkIdx++)
+    {
+        std::string sChunk = sPackValue.substr(iOffset, m_iChunkSize);
+
+        oManifest.add_chunkchecksum(crc32(0, (const uint8_t *)sChunk.data(), sChunk.size()));
+        iValueChecksum = crc32(iValueChecksum, (const uint8_t *)sChunk.data(), sChunk.size());
+
+        int ret = m_poChunkStore->PutChunk(oManifest.valueid(), iChunkIdx, sChunk, m_poConfig->LogSync());
+        if (ret != 0)
+        {
+            PLGErr("PutChunk fail, valueid %lu chunkidx %d ret %d", oManifest.valueid(), iChunkIdx, ret);
+            m_poChunkStore->DelValue(oManifest.valueid(), oManifest.chunkchecksum_size());
+            return ret;
+        }
+    }
+
+    oManifest.set_valuechecksum(iValueChecksum);
+
+    bool bSucc = oManifest.SerializeToString(&sManifest);
+    if (!bSucc)
+    {
+        PLGErr("Manifest.SerializeToString fail");
+        m_poChunkStore->DelValue(oManifest.valueid(), oManifest.chunkchecksum_size());
+        return -1;
+    }
+
+    PLGHead("OK, valueid %lu valuesize %zu chunkcount %d", 
+            oManifest.valueid(), sPackValue.size(), oManifest.chunkchecksum_size());
+
+    StreamChunks(sPackValue, oManifest);
+
+    return 0;
+}
+
+void ValueChunkMgr :: StreamChunks(const std::string & sPackValue, const ValueChunkManifest & oManifest)
+{
+    //chunks go ahead of the accept which the ioloop send later on the same connection.
+    ValueChunkMsg oValueChunkMsg;
+    oValueChunkMsg.set_msgtype(ValueChunkMsgType_SendChunk);
+    oValueChunkMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oValueChunkMsg.set_valueid(oManifest.valueid());
+
+    for (int i = 0; i < oManifest.chunkchecksum_size(); i++)
+    {
+        oValueChunkMsg.set_chunkidx(i);
+        oValueChunkMsg.set_checksum(oManifest.chunkchecksum(i));
+        oValueChunkMsg.set_buffer(sPackValue.substr((size_t)i * m_iChunkSize, m_iChunkSize));
+
+        BroadcastValueChunkMsg(oValueChunkMsg);
+    }
+
+    PLGImp("OK, valueid %lu chunkcount %d", oManifest.valueid(), oManifest.chunkchecksum_size());
+}
+
+void ValueChunkMgr :: DropValue(const std::string & sManifest)
+{
+    ValueChunkManifest oManifest;
+    bool bSucc = oManifest.ParseFromArray(sManifest.data(), sManifest.size());
+    if (!bSucc)
+    {
+        return;
+    }
+
+    ValueChunkMsg oValueChunkMsg;
+    oValueChunkMsg.set_msgtype(ValueChunkMsgType_DropValue);
+    oValueChunkMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oValueChunkMsg.set_valueid(oManifest.valueid());
+    for (int i = 0; i < oManifest.chunkchecksum_size(); i++)
+    {
+        oValueChunkMsg.add_askchunkidx(i);
+    }
+
+    //pass to ioloop, it will broadcast to other nodes.
+    std::string sBuffer;
+    int ret = PackValueChunkMsg(oValueChunkMsg, sBuffer);
+    if (ret != 0)
+    {
+        return;
+    }
+
+    m_poInstance->OnReceiveMessage(sBuffer.data(), sBuffer.size());
+}
+
+////////////////////////////////////////////////////////////
+
+const bool ValueChunkMgr :: IsChunkReady(const PaxosMsg & oPaxosMsg)
+{
+    ValueChunkManifest oManifest;
+    if (!SMFac::GetChunkManifest(oPaxosMsg.value(), oManifest))
+    {
+        return true;
+    }
+
+    std::vector<int> vecChunkIdx;
+    m_poChunkStore->GetMissingChunks(oManifest, vecChunkIdx);
+    if (vecChunkIdx.size() == 0)
+    {
+        return true;
+    }
+
+    PLGImp("chunk not ready, hold this accept, valueid %lu missing chunk count %zu from nodeid %lu",
+            oManifest.valueid(), vecChunkIdx.size(), oPaxosMsg.nodeid());
+
+    AddPendingAccept(oPaxosMsg, oManifest);
+
+    AskforMissingChunks(oPaxosMsg.value(), oPaxosMsg.nodeid());
+
+    return false;
+}
+
+void ValueChunkMgr :: AddPendingAccept(const PaxosMsg & oPaxosMsg, const ValueChunkManifest & oManifest)
+{
+    //accepts of finished instances are useless.
+    for (auto it = m_mapPendingAccept.begin(); it != m_mapPendingAccept.end();)
+    {
+        if (it->second.oAcceptMsg.instanceid() < oPaxosMsg.instanceid())
+        {
+            it = m_mapPendingAccept.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    if ((int)m_mapPendingAccept.size() >= VALUE_CHUNK_MAX_PENDING_ACCEPT
+            && m_mapPendingAccept.find(oManifest.valueid()) == end(m_mapPendingAccept))
+    {
+        //proposer will retry the dropped one after timeout.
+        PLGErr("too many pending accepts, drop valueid %lu", m_mapPendingAccept.begin()->first);
+        m_mapPendingAccept.erase(m_mapPendingAccept.begin());
+    }
+
+    ValueChunkPendingAccept & oPendingAccept = m_mapPendingAccept[oManifest.valueid()];
+    oPendingAccept.oAcceptMsg = oPaxosMsg;
+    oPendingAccept.oManifest = oManifest;
+}
+
+void ValueChunkMgr :: RedoPendingAccept(const uint64_t llValueID)
+{
+    auto it = m_mapPendingAccept.find(llValueID);
+    if (it == end(m_mapPendingAccept))
+    {
+        return;
+    }
+
+    std::vector<int> vecChunkIdx;
+    m_poChunkStore->GetMissingChunks(it->second.oManifest, vecChunkIdx);
+    if (vecChunkIdx.size() > 0)
+    {
+        return;
+    }
+
+    PLGHead("all chunks ready, redo accept, valueid %lu", llValueID);
+
+    PaxosMsg oPaxosMsg = it->second.oAcceptMsg;
+    m_mapPendingAccept.erase(it);
+    m_poInstance->OnReceivePaxosMsg(oPaxosMsg);
+}
+
+void ValueChunkMgr :: AskforMissingChunks(const std::string & sPaxosValue, const nodeid_t iAskNodeID)
+{
+    ValueChunkManifest oManifest;
+    if (!SMFac::GetChunkManifest(sPaxosValue, oManifest))
+    {
+        return;
+    }
+
+    uint64_t llNowTimeMs = Time::GetSteadyClockMS();
+    if (oManifest.valueid() == m_llLastAskValueID 
+            && llNowTimeMs < m_llLastAskTimeMs + VALUE_CHUNK_ASK_INTERVAL_MS)
+    {
+        return;
+    }
+
+    std::vector<int> vecMissingChunkIdx;
+    m_poChunkStore->GetMissingChunks(oManifest, vecMissingChunkIdx);
+
+    //chunks already arrived and wait for chunk io, no need to ask.
+    std::vector<int> vecChunkIdx;
+    for (auto & iChunkIdx : vecMissingChunkIdx)
+    {
+        if (m_setStoringChunk.find(std::make_pair(oManifest.valueid(), iChunkIdx)) == end(m_setStoringChunk))
+        {
+            vecChunkIdx.push_back(iChunkIdx);
+        }
+    }
+
+    if (vecChunkIdx.size() == 0)
+    {
+        return;
+    }
+
+    m_llLastAskValueID = oManifest.valueid();
+    m_llLastAskTimeMs = llNowTimeMs;
+
+    ValueChunkMsg oValueChunkMsg;
+    oValueChunkMsg.set_msgtype(ValueChunkMsgType_AskforChunk);
+    oValueChunkMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oValueChunkMsg.set_valueid(oManifest.valueid());
+    for (auto & iChunkIdx : vecChunkIdx)
+    {
+        oValueChunkMsg.add_askchunkidx(iChunkIdx);
+    }
+
+    PLGHead("valueid %lu missing chunk count %zu asknodeid %lu", 
+            oManifest.valueid(), vecChunkIdx.size(), iAskNodeID);
+
+    if (iAskNodeID != nullnode)
+    {
+        SendMessage(iAskNodeID, oValueChunkMsg);
+    }
+    else
+    {
+        BroadcastValueChunkMsg(oValueChunkMsg);
+    }
+}
+
+////////////////////////////////////////////////////////////
+
+void ValueChunkMgr :: OnValueChunkMsg(const ValueChunkMsg & oValueChunkMsg)
+{
+    if (oValueChunkMsg.msgtype() == ValueChunkMsgType_SendChunk)
+    {
+        OnSendChunk(oValueChunkMsg);
+    }
+    else if (oValueChunkMsg.msgtype() == ValueChunkMsgType_AskforChunk)
+    {
+        OnAskforChunk(oValueChunkMsg);
+    }
+    else if (oValueChunkMsg.msgtype() == ValueChunkMsgType_DropValue)
+    {
+        OnDropValue(oValueChunkMsg);
+    }
+    else if (oValueChunkMsg.msgtype() == ValueChunkMsgType_ChunkStored)
+    {
+        OnChunkStored(oValueChunkMsg);
+    }
+}
+
+void ValueChunkMgr :: OnSendChunk(const ValueChunkMsg & oValueChunkMsg)
+{
+    if (oValueChunkMsg.chunkidx() < 0)
+    {
+        return;
+    }
+
+    std::pair<uint64_t, int> oChunkKey(oValueChunkMsg.valueid(), oValueChunkMsg.chunkidx());
+    if (m_setStoringChunk.find(oChunkKey) != end(m_setStoringChunk))
+    {
+        return;
+    }
+
+    if (!m_oChunkIO.AddTask(oValueChunkMsg))
+    {
+        PLGErr("chunk io busy, skip chunk, valueid %lu chunkidx %d", 
+                oValueChunkMsg.valueid(), oValueChunkMsg.chunkidx());
+        return;
+    }
+
+    m_setStoringChunk.insert(oChunkKey);
+}
+
+void ValueChunkMgr :: OnAskforChunk(const ValueChunkMsg & oValueChunkMsg)
+{
+    if (!m_oChunkIO.AddTask(oValueChunkMsg))
+    {
+        PLGErr("chunk io busy, skip ask, valueid %lu from nodeid %lu", 
+                oValueChunkMsg.valueid(), oValueChunkMsg.nodeid());
+    }
+}
+
+void ValueChunkMgr :: OnChunkStored(const ValueChunkMsg & oValueChunkMsg)
+{
+    if (oValueChunkMsg.nodeid() != m_poConfig->GetMyNodeID())
+    {
+        return;
+    }
+
+    m_setStoringChunk.erase(std::make_pair(oValueChunkMsg.valueid(), oValueChunkMsg.chunkidx()));
+
+    RedoPendingAccept(oValueChunkMsg.valueid());
+}
+
+////////////////////////////////////////////////////////////
+
+void ValueChunkMgr :: DoChunkIO(const ValueChunkMsg & oValueChunkMsg)
+{
+    if (oValueChunkMsg.msgtype() == ValueChunkMsgType_SendChunk)
+    {
+        StoreChunk(oValueChunkMsg);
+    }
+    else if (oValueChunkMsg.msgtype() == ValueChunkMsgType_AskforChunk)
+    {
+        for (int i = 0; i < oValueChunkMsg.askchunkidx_size(); i++)
+        {
+            SendChunk(oValueChunkMsg.nodeid(), oValueChunkMsg.valueid(), oValueChunkMsg.askchunkidx(i));
+        }
+    }
+    else if (oValueChunkMsg.msgtype() == ValueChunkMsgType_DropValue)
+    {
+        m_poChunkStore->DelValue(oValueChunkMsg.valueid(), oValueChunkMsg.askchunkidx_size());
+    }
+}
+
+void ValueChunkMgr :: StoreChunk(const ValueChunkMsg & oValueChunkMsg)
+{
+    if (!m_poChunkStore->HasChunk(oValueChunkMsg.valueid(), oValueChunkMsg.chunkidx()))
+    {
+        uint32_t iChecksum = crc32(0, (const uint8_t *)oValueChunkMsg.buffer().data(), oValueChunkMsg.buffer().size());
+        if (iChecksum != oValueChunkMsg.checksum())
+        {
+            PLGErr("chunk checksum not same, valueid %lu chunkidx %d cal checksum %u msg checksum %u",
+                    oValueChunkMsg.valueid(), oValueChunkMsg.chunkidx(), iChecksum, oValueChunkMsg.checksum());
+        }
+        else
+        {
+            int ret = m_poChunkStore->PutChunk(oValueChunkMsg.valueid(), oValueChunkMsg.chunkidx(), 
+                    oValueChunkMsg.buffer(), m_poConfig->LogSync());
+            if (ret != 0)
+            {
+                PLGErr("PutChunk fail, valueid %lu chunkidx %d ret %d", 
+                        oValueChunkMsg.valueid(), oValueChunkMsg.chunkidx(), ret);
+            }
+        }
+    }
+
+    //tell ioloop even if fail, the chunk can be asked again.
+    ValueChunkMsg oStoredMsg;
+    oStoredMsg.set_msgtype(ValueChunkMsgType_ChunkStored);
+    oStoredMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oStoredMsg.set_valueid(oValueChunkMsg.valueid());
+    oStoredMsg.set_chunkidx(oValueChunkMsg.chunkidx());
+
+    std::string sBuffer;
+    int ret = PackValueChunkMsg(oStoredMsg, sBuffer);
+    if (ret != 0)
+    {
+        return;
+    }
+
+    m_poInstance->OnReceiveMessage(sBuffer.data(), sBuffer.size());
+}
+
+void ValueChunkMgr :: SendChunk(const nodeid_t iSendtoNodeID, const uint64_t llValueID, const int iChunkIdx)
+{
+    std::string sChunk;
+    int ret = m_poChunkStore->GetChunk(llValueID, iChunkIdx, sChunk);
+    if (ret != 0)
+    {
+        return;
+    }
+
+    ValueChunkMsg oValueChunkMsg;
+    oValueChunkMsg.set_msgtype(ValueChunkMsgType_SendChunk);
+    oValueChunkMsg.set_nodeid(m_poConfig->GetMyNodeID());
+    oValueChunkMsg.set_valueid(llValueID);
+    oValueChunkMsg.set_chunkidx(iChunkIdx);
+    oValueChunkMsg.set_checksum(crc32(0, (const uint8_t *)sChunk.data(), sChunk.size()));
+    oValueChunkMsg.set_buffer(sChunk);
+
+    SendMessage(iSendtoNodeID, oValueChunkMsg);
+}
+
+void ValueChunkMgr :: OnDropValue(const ValueChunkMsg & oValueChunkMsg)
+{
+    m_oChunkIO.AddTask(oValueChunkMsg);
+
+    m_mapPendingAccept.erase(oValueChunkMsg.valueid());
+
+    if (oValueChunkMsg.nodeid() == m_poConfig->GetMyNodeID())
+    {
+        BroadcastValueChunkMsg(oValueChunkMsg);
+    }
+
+    PLGImp("OK, valueid %lu chunkcount %d from nodeid %lu", 
+            oValueChunkMsg.valueid(), oValueChunkMsg.askchunkidx_size(), oValueChunkMsg.nodeid());
+}
+
+}
@@ -0,0 +1,150 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include "base.h"
+#include "chunk_store.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <atomic>
+
+namespace phxpaxos
+{
+
+#define VALUE_CHUNK_ASK_INTERVAL_MS 1000
+#define VALUE_CHUNK_IO_MAX_QUEUE_BYTES (64 * 1024 * 1024)
+#define VALUE_CHUNK_MAX_PENDING_ACCEPT 8
+
+class ValueChunkMgr;
+
+//Chunk disk io out of ioloop thread, store received chunks,
+//read and send asked chunks, delete dropped values.
+class ValueChunkIO : public Thread
+{
+public:
+    ValueChunkIO(ValueChunkMgr * poValueChunkMgr);
+    ~ValueChunkIO();
+
+    void Stop();
+
+    void run();
+
+    //ioloop thread, start thread at first task.
+    //Return false if too many chunk bytes wait for io, the chunk will be asked again.
+    const bool AddTask(const ValueChunkMsg & oValueChunkMsg);
+
+private:
+    ValueChunkMgr * m_poValueChunkMgr;
+    bool m_bIsStarted;
+    Queue<ValueChunkMsg *> m_oTaskQueue;
+    std::atomic<uint64_t> m_llQueueBytes;
+};
+
+class ValueChunkPendingAccept
+{
+public:
+    PaxosMsg oAcceptMsg;
+    ValueChunkManifest oManifest;
+};
+
+//Large value is split into chunks and streamed to other nodes ahead,
+//paxos only agree on a small manifest (smid VALUE_CHUNK_SMID),
+//chunks are assembled when execute.
+class ValueChunkMgr : public Base
+{
+public:
+    ValueChunkMgr(
+            const Config * poConfig, 
+            const MsgTransport * poMsgTransport,
+            const Instance * poInstance,
+            ChunkStore * poChunkStore,
+            const int iChunkSize);
+    ~ValueChunkMgr();
+
+    void InitForNewPaxosInstance() { }
+
+public:
+    //committer thread.
+    const bool NeedSplit(const std::string & sValue) const;
+
+    //save chunks of sPackValue to local chunk store and stream them to other nodes
+    //from memory, ahead of the accept, output manifest.
+    int SplitValue(const std::string & sPackValue, std::string & sManifest);
+
+    //value with this manifest won't be chosen anymore, drop it's chunks.
+    void DropValue(const std::string & sManifest);
+
+    void Stop();
+
+public:
+    //ioloop thread.
+    //acceptor only accept manifest when all chunks are stored, so chosen value
+    //always can be assembled from a majority. If not ready, the accept msg is
+    //hold and will be redo when missing chunks arrived.
+    const bool IsChunkReady(const PaxosMsg & oPaxosMsg);
+
+    void AskforMissingChunks(const std::string & sPaxosValue, const nodeid_t iAskNodeID);
+
+    void OnValueChunkMsg(const ValueChunkMsg & oValueChunkMsg);
+
+public:
+    //chunk io thread.
+    void DoChunkIO(const ValueChunkMsg & oValueChunkMsg);
+
+private:
+    void StreamChunks(const std::string & sPackValue, const ValueChunkManifest & oManifest);
+
+    void OnSendChunk(const ValueChunkMsg & oValueChunkMsg);
+
+    void OnAskforChunk(const ValueChunkMsg & oValueChunkMsg);
+
+    void OnDropValue(const ValueChunkMsg & oValueChunkMsg);
+
+    void OnChunkStored(const ValueChunkMsg & oValueChunkMsg);
+
+    void AddPendingAccept(const PaxosMsg & oPaxosMsg, const ValueChunkManifest & oManifest);
+
+    void RedoPendingAccept(const uint64_t llValueID);
+
+    void StoreChunk(const ValueChunkMsg & oValueChunkMsg);
+
+    void SendChunk(const nodeid_t iSendtoNodeID, const uint64_t llValueID, const int iChunkIdx);
+
+private:
+    ChunkStore * m_poChunkStore;
+    int m_iChunkSize;
+
+    uint64_t m_llLastAskValueID;
+    uint64_t m_llLastAskTimeMs;
+
+    //accepts of different values may wait chunks at the same time, key is valueid.
+    std::map<uint64_t, ValueChunkPendingAccept> m_mapPendingAccept;
+    //chunks wait for chunk io, don't ask them again.
+    std::set<std::pair<uint64_t, int> > m_setStoringChunk;
+
+    ValueChunkIO m_oChunkIO;
+};
+
+}
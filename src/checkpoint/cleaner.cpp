@@ -25,6 +25,8 @@ See the AUTHORS file for names of contributors.
 #include "config_include.h"
 #include "cp_mgr.h"
 #include "sm_base.h"
+#include "paxos_log.h"
+#include <algorithm>
 
 namespace phxpaxos
 {
@@ -38,12 +40,12 @@ Cleaner :: Cleaner(
     m_poSMFac(poSMFac), 
     m_poLogStorage(poLogStorage), 
     m_poCheckpointMgr(poCheckpointMgr),
-    m_llLastSave(0),
     m_bCanrun(false),
     m_bIsPaused(true),
     m_bIsEnd(false),
     m_bIsStart(false),
-    m_llHoldCount(CAN_DELETE_DELTA)
+    m_llHoldCount(CAN_DELETE_DELTA),
+    m_llLastChunkGCTimeMs(0)
 {
 }
 
@@ -81,14 +83,6 @@ void Cleaner :: run()
     m_bIsStart = true;
     Continue();
 
-    //control delete speed to avoid affecting the io too much.
-    int iDeleteQps = Cleaner_DELETE_QPS;
-    int iSleepMs = iDeleteQps > 1000 ? 1 : 1000 / iDeleteQps;
-    int iDeleteInterval = iDeleteQps > 1000 ? iDeleteQps / 1000 + 1 : 1; 
-
-    PLGDebug("DeleteQps %d SleepMs %d DeleteInterval %d",
-            iDeleteQps, iSleepMs, iDeleteInterval);
-
     while (true)
     {
         if (m_bIsEnd)
@@ -109,29 +103,32 @@ void Cleaner :: run()
         uint64_t llCPInstanceID = m_poSMFac->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx()) + 1;
         uint64_t llMaxChosenInstanceID = m_poCheckpointMgr->GetMaxChosenInstanceID();
 
-        int iDeleteCount = 0;
         while ((llInstanceID + m_llHoldCount < llCPInstanceID)
-                && (llInstanceID + m_llHoldCount < llMaxChosenInstanceID))
+                && (llInstanceID + m_llHoldCount < llMaxChosenInstanceID)
+                && !m_bIsEnd && m_bCanrun)
         {
-            bool bDeleteRet = DeleteOne(llInstanceID);
-            if (bDeleteRet)
-            {
-                //PLGImp("delete one done, instanceid %lu", llInstanceID);
-                llInstanceID++;
-                iDeleteCount++;
-                if (iDeleteCount >= iDeleteInterval)
-                {
-                    iDeleteCount = 0;
-                    Time::MsSleep(iSleepMs);
-                }
-            }
-            else
+            uint64_t llEndInstanceID = std::min(llCPInstanceID, llMaxChosenInstanceID) - m_llHoldCount;
+            llEndInstanceID = std::min(llEndInstanceID, llInstanceID + DELETE_SAVE_INTERVAL);
+
+            uint64_t llBeginTime = Time::GetSteadyClockMS();
+            bool bDeleteRet = DeleteRange(llInstanceID, llEndInstanceID);
+            if (!bDeleteRet)
             {
                 PLGDebug("delete system fail, instanceid %lu", llInstanceID);
                 break;
             }
+
+            llInstanceID = llEndInstanceID;
+
+            //sleep as long as this batch took, a slow disk get slower deleting,
+            //and foreground io always have at least half of the time.
+            uint64_t llEndTime = Time::GetSteadyClockMS();
+            uint64_t llCostTime = llEndTime > llBeginTime ? llEndTime - llBeginTime : 0;
+            Time::MsSleep((int)std::max((uint64_t)1, std::min(llCostTime, (uint64_t)DELETE_MAX_SLEEP_MS)));
         }
 
+        GCValueChunks();
+
         if (llCPInstanceID == 0)
         {
             PLGStatus("sleep a while, max deleted instanceid %lu checkpoint instanceid (no checkpoint) now instanceid %lu",
@@ -191,35 +188,110 @@ int Cleaner :: FixMinChosenInstanceID(const uint64_t llOldMinChosenInstanceID)
     return 0;
 }
 
-bool Cleaner :: DeleteOne(const uint64_t llInstanceID)
+bool Cleaner :: DeleteRange(const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID)
 {
+    //advance minchosen first, so instance never serve learners the range being deleted.
+    int ret = m_poCheckpointMgr->SetMinChosenInstanceID(llEndInstanceID);
+    if (ret != 0)
+    {
+        PLGErr("SetMinChosenInstanceID fail, now delete instanceid %lu", llEndInstanceID - 1);
+        return false;
+    }
+
+    for (uint64_t llInstanceID = llBeginInstanceID; llInstanceID < llEndInstanceID; llInstanceID++)
+    {
+        DeleteValueChunks(llInstanceID);
+    }
+
     WriteOptions oWriteOptions;
     oWriteOptions.bSync = false;
 
-    int ret = m_poLogStorage->Del(oWriteOptions, m_poConfig->GetMyGroupIdx(), llInstanceID);
+    ret = m_poLogStorage->DeleteRange(oWriteOptions, m_poConfig->GetMyGroupIdx(), llBeginInstanceID, llEndInstanceID);
     if (ret != 0)
     {
+        PLGErr("DeleteRange fail, ret %d begin instanceid %lu end instanceid %lu", 
+                ret, llBeginInstanceID, llEndInstanceID);
         return false;
     }
 
-    m_poCheckpointMgr->SetMinChosenInstanceIDCache(llInstanceID);
+    PLGImp("delete %lu instance done, now minchosen instanceid %lu", 
+            llEndInstanceID - llBeginInstanceID, llEndInstanceID);
+
+    return true;
+}
+
+void Cleaner :: DeleteValueChunks(const uint64_t llInstanceID)
+{
+    ChunkStore * poChunkStore = m_poSMFac->GetChunkStore();
+    if (poChunkStore == nullptr || !poChunkStore->HasAnyChunk())
+    {
+        return;
+    }
 
-    if (llInstanceID >= m_llLastSave + DELETE_SAVE_INTERVAL)
+    PaxosLog oPaxosLog(m_poLogStorage);
+    AcceptorStateData oState;
+    int ret = oPaxosLog.ReadState(m_poConfig->GetMyGroupIdx(), llInstanceID, oState);
+    if (ret != 0)
     {
-        int ret = m_poCheckpointMgr->SetMinChosenInstanceID(llInstanceID + 1);
+        return;
+    }
+
+    ValueChunkManifest oManifest;
+    if (SMFac::GetChunkManifest(oState.acceptedvalue(), oManifest))
+    {
+        poChunkStore->DelValue(oManifest.valueid(), oManifest.chunkchecksum_size());
+        PLGImp("delete value chunks, instanceid %lu valueid %lu chunkcount %d",
+                llInstanceID, oManifest.valueid(), oManifest.chunkchecksum_size());
+    }
+}
+
+void Cleaner :: GCValueChunks()
+{
+    ChunkStore * poChunkStore = m_poSMFac->GetChunkStore();
+    if (poChunkStore == nullptr || !poChunkStore->HasAnyChunk())
+    {
+        return;
+    }
+
+    uint64_t llNowTimeMs = Time::GetSteadyClockMS();
+    if (llNowTimeMs < m_llLastChunkGCTimeMs + VALUE_CHUNK_GC_INTERVAL_MS)
+    {
+        return;
+    }
+    m_llLastChunkGCTimeMs = llNowTimeMs;
+
+    //value accepted on the instance not chosen yet may still be chosen, keep it.
+    std::set<uint64_t> setKeepValueID;
+    PaxosLog oPaxosLog(m_poLogStorage);
+    uint64_t llNowInstanceID = m_poCheckpointMgr->GetMaxChosenInstanceID();
+    for (uint64_t llInstanceID = llNowInstanceID; llInstanceID <= llNowInstanceID + 1; llInstanceID++)
+    {
+        AcceptorStateData oState;
+        int ret = oPaxosLog.ReadState(m_poConfig->GetMyGroupIdx(), llInstanceID, oState);
         if (ret != 0)
         {
-            PLGErr("SetMinChosenInstanceID fail, now delete instanceid %lu", llInstanceID);
-            return false;
+            continue;
         }
 
-        m_llLastSave = llInstanceID;
+        ValueChunkManifest oManifest;
+        if (SMFac::GetChunkManifest(oState.acceptedvalue(), oManifest))
+        {
+            setKeepValueID.insert(oManifest.valueid());
+        }
+    }
 
-        PLGImp("delete %d instance done, now minchosen instanceid %lu", 
-                DELETE_SAVE_INTERVAL, llInstanceID + 1);
+    int iDelCount = 0;
+    int ret = poChunkStore->GCValues(VALUE_CHUNK_GC_AGE_MS, setKeepValueID, iDelCount);
+    if (ret != 0)
+    {
+        PLGErr("GCValues fail, ret %d", ret);
+        return;
     }
 
-    return true;
+    if (iDelCount > 0)
+    {
+        PLGImp("delete %d values never chosen", iDelCount);
+    }
 }
 
 void Cleaner :: SetHoldPaxosLogCount(const uint64_t llHoldCount)
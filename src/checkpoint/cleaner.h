@@ -28,7 +28,9 @@ namespace phxpaxos
 {
 
 #define CAN_DELETE_DELTA 1000000 
-#define DELETE_SAVE_INTERVAL 100
+#define DELETE_SAVE_INTERVAL 10000
+#define DELETE_MAX_SLEEP_MS 1000
+#define VALUE_CHUNK_GC_INTERVAL_MS (60 * 1000)
 
 class Config;
 class SMFac;
@@ -62,7 +64,11 @@ public:
     int FixMinChosenInstanceID(const uint64_t llOldMinChosenInstanceID);
 
 private:
-    bool DeleteOne(const uint64_t llInstanceID);
+    bool DeleteRange(const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID);
+
+    void DeleteValueChunks(const uint64_t llInstanceID);
+
+    void GCValueChunks();
 
 private:
     Config * m_poConfig;
@@ -70,8 +76,6 @@ private:
     LogStorage * m_poLogStorage;
     CheckpointMgr * m_poCheckpointMgr;
 
-    uint64_t m_llLastSave;
-
     bool m_bCanrun;
     bool m_bIsPaused;
 
@@ -79,6 +83,7 @@ private:
     bool m_bIsStart;
 
     uint64_t m_llHoldCount;
+    uint64_t m_llLastChunkGCTimeMs;
 };
     
 }
@@ -166,11 +166,6 @@ int CheckpointMgr :: SetMinChosenInstanceID(const uint64_t llMinChosenInstanceID
     return 0;
 }
 
-void CheckpointMgr :: SetMinChosenInstanceIDCache(const uint64_t llMinChosenInstanceID)
-{
-    m_llMinChosenInstanceID = llMinChosenInstanceID;
-}
-
 void CheckpointMgr :: SetMaxChosenInstanceID(const uint64_t llMaxChosenInstanceID)
 {
     m_llMaxChosenInstanceID = llMaxChosenInstanceID;
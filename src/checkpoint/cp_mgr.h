@@ -61,8 +61,6 @@ public:
     const uint64_t GetMinChosenInstanceID() const;
     
     int SetMinChosenInstanceID(const uint64_t llMinChosenInstanceID);
-    
-    void SetMinChosenInstanceIDCache(const uint64_t llMinChosenInstanceID);
 
     const uint64_t GetCheckpointInstanceID() const;
 
@@ -20,6 +20,7 @@ See the AUTHORS file for names of contributors.
 */
 
 #include "replayer.h"
+#include <algorithm>
 #include "phxpaxos/storage.h"
 #include "sm_base.h"
 #include "comm_include.h"
@@ -29,6 +30,148 @@ See the AUTHORS file for names of contributors.
 namespace phxpaxos
 {
 
+ReplayReader :: ReplayReader(
+    Config * poConfig, 
+    LogStorage * poLogStorage, 
+    CheckpointMgr * poCheckpointMgr)
+    : m_poConfig(poConfig), 
+    m_oPaxosLog(poLogStorage), 
+    m_poCheckpointMgr(poCheckpointMgr),
+    m_llInstanceID(0),
+    m_bIsStarted(false),
+    m_bIsEnd(false)
+{
+}
+
+ReplayReader :: ~ReplayReader()
+{
+    for (auto & poBatch : m_dequeBatch)
+    {
+        delete poBatch;
+    }
+}
+
+void ReplayReader :: Start(const uint64_t llInstanceID)
+{
+    m_llInstanceID = llInstanceID;
+    m_bIsStarted = true;
+    start();
+}
+
+void ReplayReader :: Stop()
+{
+    if (m_bIsStarted)
+    {
+        m_bIsEnd = true;
+        m_oLock.Lock();
+        m_oLock.Interupt();
+        m_oLock.UnLock();
+        join();
+        m_bIsStarted = false;
+    }
+}
+
+ReplayBatch * ReplayReader :: GetBatch(const int iTimeoutMS)
+{
+    ReplayBatch * poBatch = nullptr;
+
+    m_oLock.Lock();
+    if (m_dequeBatch.empty())
+    {
+        m_oLock.WaitTime(iTimeoutMS);
+    }
+
+    if (!m_dequeBatch.empty())
+    {
+        poBatch = m_dequeBatch.front();
+        m_dequeBatch.pop_front();
+        m_oLock.Interupt();
+    }
+    m_oLock.UnLock();
+
+    return poBatch;
+}
+
+void ReplayReader :: run()
+{
+    int iIdleSleepMs = REPLAYER_MIN_IDLE_SLEEP_MS;
+
+    while (true)
+    {
+        if (m_bIsEnd)
+        {
+            return;
+        }
+
+        m_oLock.Lock();
+        if ((int)m_dequeBatch.size() >= REPLAYER_READAHEAD_BATCH_COUNT)
+        {
+            m_oLock.WaitTime(REPLAYER_MAX_IDLE_SLEEP_MS);
+            m_oLock.UnLock();
+            continue;
+        }
+        m_oLock.UnLock();
+
+        //the further behind, the more instances read at once; when catch up,
+        //back off until new instances chosen.
+        uint64_t llMaxChosenInstanceID = m_poCheckpointMgr->GetMaxChosenInstanceID();
+        if (m_llInstanceID >= llMaxChosenInstanceID)
+        {
+            Time::MsSleep(iIdleSleepMs);
+            iIdleSleepMs = std::min(iIdleSleepMs * 2, REPLAYER_MAX_IDLE_SLEEP_MS);
+            continue;
+        }
+
+        iIdleSleepMs = REPLAYER_MIN_IDLE_SLEEP_MS;
+
+        ReplayBatch * poBatch = new ReplayBatch();
+        poBatch->llBeginInstanceID = m_llInstanceID;
+        int ret = ReadBatch(llMaxChosenInstanceID, poBatch);
+
+        if (poBatch->vecPaxosValue.empty())
+        {
+            delete poBatch;
+        }
+        else
+        {
+            m_llInstanceID += poBatch->vecPaxosValue.size();
+
+            m_oLock.Lock();
+            m_dequeBatch.push_back(poBatch);
+            m_oLock.Interupt();
+            m_oLock.UnLock();
+        }
+
+        if (ret != 0)
+        {
+            Time::MsSleep(500);
+        }
+    }
+}
+
+int ReplayReader :: ReadBatch(const uint64_t llMaxChosenInstanceID, ReplayBatch * poBatch)
+{
+    uint64_t llEndInstanceID = std::min(llMaxChosenInstanceID, 
+            poBatch->llBeginInstanceID + REPLAYER_MAX_BATCH_COUNT);
+
+    for (uint64_t llInstanceID = poBatch->llBeginInstanceID; llInstanceID < llEndInstanceID; llInstanceID++)
+    {
+        AcceptorStateData oState; 
+        int ret = m_oPaxosLog.ReadState(m_poConfig->GetMyGroupIdx(), llInstanceID, oState);
+        if (ret != 0)
+        {
+            PLGErr("ReadState fail, ret %d instanceid %lu", ret, llInstanceID);
+            return ret;
+        }
+
+        poBatch->vecPaxosValue.push_back(oState.acceptedvalue());
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////
+
 Replayer :: Replayer(
     Config * poConfig, 
     SMFac * poSMFac, 
@@ -36,8 +179,8 @@ Replayer :: Replayer(
     CheckpointMgr * poCheckpointMgr)
     : m_poConfig(poConfig), 
     m_poSMFac(poSMFac), 
-    m_oPaxosLog(poLogStorage), 
     m_poCheckpointMgr(poCheckpointMgr),
+    m_oReader(poConfig, poLogStorage, poCheckpointMgr),
     m_bCanrun(false),
     m_bIsPaused(true),
     m_bIsEnd(false)
@@ -52,6 +195,7 @@ void Replayer :: Stop()
 {
     m_bIsEnd = true;
     join();
+    m_oReader.Stop();
 }
 
 void Replayer :: Pause()
@@ -74,11 +218,15 @@ void Replayer :: run()
 {
     PLGHead("Checkpoint.Replayer [START]");
     uint64_t llInstanceID = m_poSMFac->GetCheckpointInstanceID(m_poConfig->GetMyGroupIdx()) + 1;
+    m_oReader.Start(llInstanceID);
+
+    ReplayBatch * poBatch = nullptr;
 
     while (true)
     {
         if (m_bIsEnd)
         {
+            delete poBatch;
             PLGHead("Checkpoint.Replayer [END]");
             return;
         }
@@ -90,44 +238,48 @@ void Replayer :: run()
             Time::MsSleep(1000);
             continue;
         }
-        
-        if (llInstanceID >= m_poCheckpointMgr->GetMaxChosenInstanceID())
+
+        if (poBatch == nullptr)
         {
-            //PLGImp("now maxchosen instanceid %lu small than excute instanceid %lu, wait", 
-                    //m_poCheckpointMgr->GetMaxChosenInstanceID(), llInstanceID);
-            Time::MsSleep(1000);
-            continue;
+            poBatch = m_oReader.GetBatch(REPLAYER_MAX_IDLE_SLEEP_MS);
+            if (poBatch == nullptr)
+            {
+                continue;
+            }
         }
         
-        bool bPlayRet = PlayOne(llInstanceID);
+        size_t iExecutedCount = 0;
+        bool bPlayRet = PlayBatch(poBatch, iExecutedCount);
+        llInstanceID += iExecutedCount;
+
+        uint64_t llMaxChosenInstanceID = m_poCheckpointMgr->GetMaxChosenInstanceID();
+        BP->GetCheckpointBP()->ReplayerLag(
+                llMaxChosenInstanceID > llInstanceID ? llMaxChosenInstanceID - llInstanceID : 0);
+
         if (bPlayRet)
         {
-            PLGImp("Play one done, instanceid %lu", llInstanceID);
-            llInstanceID++;
+            PLGImp("Play batch done, instanceid %lu count %zu", 
+                    poBatch->llBeginInstanceID, iExecutedCount);
+            delete poBatch;
+            poBatch = nullptr;
         }
         else
         {
-            PLGErr("Play one fail, instanceid %lu", llInstanceID);
+            PLGErr("Play batch fail, instanceid %lu", llInstanceID);
+            poBatch->llBeginInstanceID += iExecutedCount;
+            poBatch->vecPaxosValue.erase(poBatch->vecPaxosValue.begin(), 
+                    poBatch->vecPaxosValue.begin() + iExecutedCount);
             Time::MsSleep(500);
         }
     }
 }
 
-bool Replayer :: PlayOne(const uint64_t llInstanceID)
+bool Replayer :: PlayBatch(ReplayBatch * poBatch, size_t & iExecutedCount)
 {
-    AcceptorStateData oState; 
-    int ret = m_oPaxosLog.ReadState(m_poConfig->GetMyGroupIdx(), llInstanceID, oState);
-    if (ret != 0)
-    {
-        return false;
-    }
+    bool bExecuteRet = m_poSMFac->ExecuteForCheckpointBatch(m_poConfig->GetMyGroupIdx(), 
+            poBatch->llBeginInstanceID, poBatch->vecPaxosValue, iExecutedCount, poBatch->iPartialValueCount);
 
-    bool bExecuteRet = m_poSMFac->ExecuteForCheckpoint(
-            m_poConfig->GetMyGroupIdx(), llInstanceID, oState.acceptedvalue());
-    if (!bExecuteRet)
-    {
-        PLGErr("Checkpoint sm excute fail, instanceid %lu", llInstanceID);
-    }
+    BP->GetCheckpointBP()->ReplayerPlayBatch(iExecutedCount);
 
     return bExecuteRet;
 }
@@ -21,16 +21,69 @@ See the AUTHORS file for names of contributors.
 
 #pragma once
 
+#include <deque>
 #include "utils_include.h"
 #include "paxos_log.h"
 
 namespace phxpaxos
 {
 
+#define REPLAYER_MAX_BATCH_COUNT 100
+#define REPLAYER_READAHEAD_BATCH_COUNT 4
+#define REPLAYER_MIN_IDLE_SLEEP_MS 10
+#define REPLAYER_MAX_IDLE_SLEEP_MS 1000
+
 class Config;
 class SMFac;
 class LogStorage;
 class CheckpointMgr;
+
+class ReplayBatch
+{
+public:
+    ReplayBatch() : llBeginInstanceID(0), iPartialValueCount(0) { }
+
+    uint64_t llBeginInstanceID;
+    //values of instance llBeginInstanceID already executed by a failed play.
+    int iPartialValueCount;
+    std::vector<std::string> vecPaxosValue;
+};
+
+//Read chosen values ahead of replayer, so reading paxos log and executing overlap.
+class ReplayReader : public Thread
+{
+public:
+    ReplayReader(
+            Config * poConfig,
+            LogStorage * poLogStorage,
+            CheckpointMgr * poCheckpointMgr);
+
+    ~ReplayReader();
+
+    void Start(const uint64_t llInstanceID);
+
+    void Stop();
+
+    void run();
+
+    //Return nullptr if no batch read in iTimeoutMS, caller own the batch.
+    ReplayBatch * GetBatch(const int iTimeoutMS);
+
+private:
+    int ReadBatch(const uint64_t llMaxChosenInstanceID, ReplayBatch * poBatch);
+
+private:
+    Config * m_poConfig;
+    PaxosLog m_oPaxosLog;
+    CheckpointMgr * m_poCheckpointMgr;
+
+    SerialLock m_oLock;
+    std::deque<ReplayBatch *> m_dequeBatch;
+
+    uint64_t m_llInstanceID;
+    bool m_bIsStarted;
+    bool m_bIsEnd;
+};
     
 class Replayer : public Thread
 {
@@ -54,13 +107,13 @@ public:
     const bool IsPaused() const;
 
 private:
-    bool PlayOne(const uint64_t llInstanceID);
+    bool PlayBatch(ReplayBatch * poBatch, size_t & iExecutedCount);
 
 private:
     Config * m_poConfig;
     SMFac * m_poSMFac;
-    PaxosLog m_oPaxosLog;
     CheckpointMgr * m_poCheckpointMgr;
+    ReplayReader m_oReader;
 
     bool m_bCanrun;
     bool m_bIsPaused;
@@ -64,6 +64,10 @@ namespace phxpaxos
 #define HEADLEN_LEN (sizeof(uint16_t))
 #define CHECKSUM_LEN (sizeof(uint32_t))
 
+//tcp credit flow control
+#define TCP_CREDIT_GROUPIDX -2
+#define TCP_CREDIT_FLUSH_TIMEMS 10
+
 //max queue memsize
 #define MAX_QUEUE_MEM_SIZE 209715200
 
@@ -71,6 +75,9 @@ enum MsgCmd
 {
     MsgCmd_PaxosMsg = 1,
     MsgCmd_CheckpointMsg = 2,
+    MsgCmd_ValueChunkMsg = 3,
+    MsgCmd_ForwardMsg = 4,
+    MsgCmd_MasterLeaseMsg = 5,
 };
 
 enum PaxosMsgType
@@ -88,11 +95,57 @@ enum PaxosMsgType
     MsgType_PaxosLearner_SendLearnValue_Ack = 11,
     MsgType_PaxosLearner_AskforCheckpoint = 12,
     MsgType_PaxosLearner_OnAskforCheckpoint = 13,
+    MsgType_PaxosLearner_SendLearnValueBatch = 14,
 };
 
 enum PaxosMsgFlagType
 {
     PaxosMsgFlagType_SendLearnValue_NeedAck = 1,
+    //set on ComfirmAskforLearn, learner can receive SendLearnValueBatch.
+    PaxosMsgFlagType_ComfirmAskforLearn_Batch = 2,
+    //value is compressed by ValueCompressor, only set on the wire,
+    //receiver clear it after decompress.
+    PaxosMsgFlagType_ValueCompressed = 0x10000,
+};
+
+enum AcceptorStateFlagType
+{
+    AcceptorStateFlagType_ValueCompressed = 1,
+};
+
+enum ValueChunkMsgType
+{
+    ValueChunkMsgType_SendChunk = 1,
+    ValueChunkMsgType_AskforChunk = 2,
+    ValueChunkMsgType_DropValue = 3,
+    ValueChunkMsgType_ChunkStored = 4,
+};
+
+enum ForwardMsgType
+{
+    ForwardMsgType_Propose = 1,
+    ForwardMsgType_ProposeReply = 2,
+};
+
+enum MasterLeaseMsgType
+{
+    MasterLeaseMsgType_Renew = 1,
+    MasterLeaseMsgType_RenewReply = 2,
+    MasterLeaseMsgType_Query = 3,
+    MasterLeaseMsgType_QueryReply = 4,
+    MasterLeaseMsgType_BatchRenew = 5,
+    MasterLeaseMsgType_BatchRenewReply = 6,
+    MasterLeaseMsgType_BatchQuery = 7,
+    MasterLeaseMsgType_BatchQueryReply = 8,
+};
+
+//Classes of messages waiting in a group's ioloop queue, in priority order.
+enum IOLoopMsgClass
+{
+    IOLoopMsgClass_Consensus = 0,   //prepare/accept and replies, chosen notify, value chunks, forward
+    IOLoopMsgClass_Learn = 1,       //learner catch up
+    IOLoopMsgClass_Checkpoint = 2,  //checkpoint file transfer
+    IOLoopMsgClass_Count = 3,
 };
 
 enum CheckpointMsgType
@@ -106,12 +159,14 @@ enum CheckpointSendFileFlag
     CheckpointSendFileFlag_BEGIN = 1,
     CheckpointSendFileFlag_ING = 2,
     CheckpointSendFileFlag_END = 3,
+    CheckpointSendFileFlag_REUSE = 4,
 };
 
 enum CheckpointSendFileAckFlag
 {
     CheckpointSendFileAckFlag_OK = 1,
     CheckpointSendFileAckFlag_Fail = 2,
+    CheckpointSendFileAckFlag_Resend = 3,
 };
 
 enum TimerType
@@ -0,0 +1,62 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#include "credit_notifier.h"
+#include <chrono>
+
+namespace phxpaxos
+{
+
+CreditNotifier :: CreditNotifier() : m_llVersion(0)
+{
+}
+
+CreditNotifier :: ~CreditNotifier()
+{
+}
+
+CreditNotifier * CreditNotifier :: Instance()
+{
+    static CreditNotifier oCreditNotifier;
+    return &oCreditNotifier;
+}
+
+const uint64_t CreditNotifier :: GetVersion()
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    return m_llVersion;
+}
+
+void CreditNotifier :: Wait(const uint64_t llVersion, const int iTimeoutMs)
+{
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+    m_oCond.wait_for(oLock, std::chrono::milliseconds(iTimeoutMs), [&]() { return m_llVersion != llVersion; });
+}
+
+void CreditNotifier :: Notify()
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    m_llVersion++;
+    m_oCond.notify_all();
+}
+    
+}
+
@@ -0,0 +1,55 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <inttypes.h>
+
+namespace phxpaxos
+{
+
+//Senders stalled by Paxos_NetWorkBackpressure wait here instead of polling,
+//network wake them up when any credit come back.
+class CreditNotifier
+{
+public:
+    CreditNotifier();
+    ~CreditNotifier();
+
+    static CreditNotifier * Instance();
+
+    //take the version before a send, so a credit come back before Wait is not missed.
+    const uint64_t GetVersion();
+
+    //wait until version change from llVersion or timeout.
+    void Wait(const uint64_t llVersion, const int iTimeoutMs);
+
+    void Notify();
+
+private:
+    std::mutex m_oMutex;
+    std::condition_variable m_oCond;
+    uint64_t m_llVersion;
+};
+    
+}
@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #include "inside_options.h"
 #include "commdef.h"
 #include "utils_include.h"
+#include <algorithm>
 
 namespace phxpaxos
 {
@@ -31,6 +32,9 @@ InsideOptions :: InsideOptions()
     m_bIsLargeBufferMode = false;
     m_bIsIMFollower = false;
     m_iGroupCount = 1;
+    m_iTcpCreditWindowBytes = 0;
+    m_bIsCheckpointBulkTransferMode = false;
+    m_iLogFileMaxSize = 0;
 }
 
 InsideOptions :: ~InsideOptions()
@@ -58,6 +62,21 @@ void InsideOptions :: SetGroupCount(const int iGroupCount)
     m_iGroupCount = iGroupCount;
 }
 
+void InsideOptions :: SetTcpCreditWindowBytes(const int iTcpCreditWindowBytes)
+{
+    m_iTcpCreditWindowBytes = iTcpCreditWindowBytes;
+}
+
+void InsideOptions :: SetAsCheckpointBulkTransferMode()
+{
+    m_bIsCheckpointBulkTransferMode = true;
+}
+
+void InsideOptions :: SetLogFileMaxSize(const int iLogFileMaxSize)
+{
+    m_iLogFileMaxSize = iLogFileMaxSize;
+}
+
 const int InsideOptions :: GetMaxBufferSize()
 {
     if (m_bIsLargeBufferMode)
@@ -228,8 +247,18 @@ const int InsideOptions :: GetTcpOutQueueDropTimeMs()
     }
 }
 
+const int InsideOptions :: GetTcpCreditWindowBytes()
+{
+    return m_iTcpCreditWindowBytes;
+}
+
 const int InsideOptions :: GetLogFileMaxSize()
 {
+    if (m_iLogFileMaxSize > 0)
+    {
+        return m_iLogFileMaxSize;
+    }
+
     if (m_bIsLargeBufferMode)
     {
         return 524288000;
@@ -264,18 +293,103 @@ const int InsideOptions :: GetLearnerSenderSendQps()
     }
 }
 
-const int InsideOptions :: GetCleanerDeleteQps()
+const int InsideOptions :: GetLearnerSenderBatchBytes()
 {
     if (m_bIsLargeBufferMode)
     {
-        return 30000 / m_iGroupCount;
+        return 4 * 1024 * 1024;
     }
     else
     {
-        return 300000 / m_iGroupCount;
+        return 256 * 1024;
     }
 }
 
+const int InsideOptions :: GetLearnerSenderBatchCount()
+{
+    if (m_bIsLargeBufferMode)
+    {
+        return 16;
+    }
+    else
+    {
+        return 256;
+    }
 }
 
+const int InsideOptions :: GetLearnerSenderMaxWindowBytes()
+{
+    //many groups still need a few batches in flight to pipeline.
+    int iMinWindowBytes = GetLearnerSenderBatchBytes() * 4;
+    if (m_bIsLargeBufferMode)
+    {
+        return std::max(256 * 1024 * 1024 / m_iGroupCount, iMinWindowBytes);
+    }
+    else
+    {
+        return std::max(64 * 1024 * 1024 / m_iGroupCount, iMinWindowBytes);
+    }
+}
 
+const int InsideOptions :: GetLogIndexWatermarkInterval()
+{
+    if (m_bIsLargeBufferMode)
+    {
+        return 1000;
+    }
+    else
+    {
+        return 10000;
+    }
+}
+
+const int InsideOptions :: GetCheckpointSendAckLead()
+{
+    if (m_bIsCheckpointBulkTransferMode)
+    {
+        return 64;
+    }
+    else
+    {
+        return 10;
+    }
+}
+
+const int InsideOptions :: GetCheckpointSendParallelFiles()
+{
+    if (m_bIsCheckpointBulkTransferMode)
+    {
+        return 4;
+    }
+    else
+    {
+        return 1;
+    }
+}
+
+const int InsideOptions :: GetCheckpointSendRetryTimeMs()
+{
+    if (m_bIsCheckpointBulkTransferMode)
+    {
+        return 100;
+    }
+    else
+    {
+        return 30000;
+    }
+}
+
+const int InsideOptions :: GetCheckpointResendTimeoutMs()
+{
+    if (m_bIsCheckpointBulkTransferMode)
+    {
+        return 5000;
+    }
+    else
+    {
+        //old receiver treat resend chunk as wrong sequence, never resend by timeout.
+        return 0;
+    }
+}
+
+}
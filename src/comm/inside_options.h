@@ -41,10 +41,18 @@ namespace phxpaxos
 #define TCP_QUEUE_MAXLEN (InsideOptions::Instance()->GetMaxQueueLen())
 #define UDP_QUEUE_MAXLEN (InsideOptions::Instance()->GetMaxQueueLen())
 #define TCP_OUTQUEUE_DROP_TIMEMS (InsideOptions::Instance()->GetTcpOutQueueDropTimeMs())
+#define TCP_CREDIT_WINDOW_BYTES (InsideOptions::Instance()->GetTcpCreditWindowBytes())
 #define LOG_FILE_MAX_SIZE (InsideOptions::Instance()->GetLogFileMaxSize())
 #define CONNECTTION_NONACTIVE_TIMEOUT (InsideOptions::Instance()->GetTcpConnectionNonActiveTimeout())
 #define LearnerSender_SEND_QPS (InsideOptions::Instance()->GetLearnerSenderSendQps())
-#define Cleaner_DELETE_QPS (InsideOptions::Instance()->GetCleanerDeleteQps())
+#define LearnerSender_BATCH_BYTES (InsideOptions::Instance()->GetLearnerSenderBatchBytes())
+#define LearnerSender_BATCH_COUNT (InsideOptions::Instance()->GetLearnerSenderBatchCount())
+#define LearnerSender_MAX_WINDOW_BYTES (InsideOptions::Instance()->GetLearnerSenderMaxWindowBytes())
+#define LOG_INDEX_WATERMARK_INTERVAL (InsideOptions::Instance()->GetLogIndexWatermarkInterval())
+#define Checkpoint_ACK_LEAD (InsideOptions::Instance()->GetCheckpointSendAckLead())
+#define Checkpoint_SEND_PARALLEL_FILES (InsideOptions::Instance()->GetCheckpointSendParallelFiles())
+#define Checkpoint_SEND_RETRY_TIMEMS (InsideOptions::Instance()->GetCheckpointSendRetryTimeMs())
+#define Checkpoint_RESEND_TIMEOUT (InsideOptions::Instance()->GetCheckpointResendTimeoutMs())
 
 class InsideOptions
 {
@@ -60,6 +68,12 @@ public:
 
     void SetGroupCount(const int iGroupCount);
 
+    void SetTcpCreditWindowBytes(const int iTcpCreditWindowBytes);
+
+    void SetAsCheckpointBulkTransferMode();
+
+    void SetLogFileMaxSize(const int iLogFileMaxSize);
+
 public:
     const int GetMaxBufferSize();
 
@@ -87,18 +101,37 @@ public:
 
     const int GetTcpOutQueueDropTimeMs();
 
+    const int GetTcpCreditWindowBytes();
+
     const int GetLogFileMaxSize();
 
     const int GetTcpConnectionNonActiveTimeout();
 
     const int GetLearnerSenderSendQps();
 
-    const int GetCleanerDeleteQps();
+    const int GetLearnerSenderBatchBytes();
+
+    const int GetLearnerSenderBatchCount();
+
+    const int GetLearnerSenderMaxWindowBytes();
+
+    const int GetLogIndexWatermarkInterval();
+
+    const int GetCheckpointSendAckLead();
+
+    const int GetCheckpointSendParallelFiles();
+
+    const int GetCheckpointSendRetryTimeMs();
+
+    const int GetCheckpointResendTimeoutMs();
 
 private:
     bool m_bIsLargeBufferMode;
     bool m_bIsIMFollower;
     int m_iGroupCount;
+    int m_iTcpCreditWindowBytes;
+    bool m_bIsCheckpointBulkTransferMode;
+    int m_iLogFileMaxSize;
 };
     
 }
@@ -0,0 +1,304 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "metrics.h"
+#include <stdio.h>
+#include <algorithm>
+
+namespace phxpaxos
+{
+
+MetricsRegistry :: MetricsRegistry()
+    : m_iNextShard(0)
+{
+    for (auto & oShard : m_arrShard)
+    {
+        for (int i = 0; i < METRICS_MAX_COUNTER; i++)
+        {
+            oShard.m_arrCounter[i].store(0, std::memory_order_relaxed);
+        }
+
+        for (int i = 0; i < METRICS_MAX_HISTOGRAM; i++)
+        {
+            oShard.m_arrHistogram[i] = nullptr;
+        }
+    }
+
+    for (int i = 0; i < METRICS_MAX_GAUGE; i++)
+    {
+        m_arrGauge[i].store(0, std::memory_order_relaxed);
+        m_arrGaugeMaxWindow[i].llWindowID = 0;
+        m_arrGaugeMaxWindow[i].llLastMax = 0;
+        m_arrGaugeMaxWindow[i].llNowMax = 0;
+    }
+}
+
+MetricsRegistry :: ~MetricsRegistry()
+{
+    for (auto & oShard : m_arrShard)
+    {
+        for (int i = 0; i < METRICS_MAX_HISTOGRAM; i++)
+        {
+            delete oShard.m_arrHistogram[i];
+        }
+    }
+}
+
+MetricsRegistry * MetricsRegistry :: Instance()
+{
+    static MetricsRegistry oMetricsRegistry;
+    return &oMetricsRegistry;
+}
+
+int MetricsRegistry :: Register(const std::string & sName, const std::string & sHelp, const int iType, 
+        const int iMaxCount, std::vector<MetricValue> & vecMetricDefine)
+{
+    for (size_t i = 0; i < vecMetricDefine.size(); i++)
+    {
+        if (vecMetricDefine[i].m_sName == sName)
+        {
+            return (int)i;
+        }
+    }
+
+    if ((int)vecMetricDefine.size() >= iMaxCount)
+    {
+        return -1;
+    }
+
+    MetricValue oMetric;
+    oMetric.m_sName = sName;
+    oMetric.m_sHelp = sHelp;
+    oMetric.m_iType = iType;
+    oMetric.m_llValue = 0;
+    oMetric.m_llSum = 0;
+    oMetric.m_llMax = 0;
+    oMetric.m_llP50 = 0;
+    oMetric.m_llP90 = 0;
+    oMetric.m_llP99 = 0;
+    oMetric.m_llP999 = 0;
+    vecMetricDefine.push_back(oMetric);
+
+    return (int)vecMetricDefine.size() - 1;
+}
+
+int MetricsRegistry :: RegisterCounter(const std::string & sName, const std::string & sHelp)
+{
+    std::lock_guard<std::mutex> oLock(m_oRegisterMutex);
+    return Register(sName, sHelp, MetricType_Counter, METRICS_MAX_COUNTER, m_vecCounterDefine);
+}
+
+int MetricsRegistry :: RegisterHistogram(const std::string & sName, const std::string & sHelp)
+{
+    std::lock_guard<std::mutex> oLock(m_oRegisterMutex);
+    int iID = Register(sName, sHelp, MetricType_Histogram, METRICS_MAX_HISTOGRAM, m_vecHistogramDefine);
+    if (iID != -1 && m_arrShard[0].m_arrHistogram[iID] == nullptr)
+    {
+        for (auto & oShard : m_arrShard)
+        {
+            oShard.m_arrHistogram[iID] = new Histogram();
+        }
+    }
+    return iID;
+}
+
+int MetricsRegistry :: RegisterGauge(const std::string & sName, const std::string & sHelp)
+{
+    std::lock_guard<std::mutex> oLock(m_oRegisterMutex);
+    return Register(sName, sHelp, MetricType_Gauge, METRICS_MAX_GAUGE, m_vecGaugeDefine);
+}
+
+MetricsShard & MetricsRegistry :: GetShard()
+{
+    static thread_local int iShard = -1;
+    if (iShard == -1)
+    {
+        iShard = m_iNextShard.fetch_add(1, std::memory_order_relaxed) % METRICS_SHARD_COUNT;
+    }
+
+    return m_arrShard[iShard];
+}
+
+void MetricsRegistry :: Count(const int iCounterID, const uint64_t llDelta)
+{
+    if (iCounterID < 0)
+    {
+        return;
+    }
+
+    GetShard().m_arrCounter[iCounterID].fetch_add(llDelta, std::memory_order_relaxed);
+}
+
+void MetricsRegistry :: Record(const int iHistogramID, const uint64_t llValue)
+{
+    if (iHistogramID < 0)
+    {
+        return;
+    }
+
+    GetShard().m_arrHistogram[iHistogramID]->Add(llValue);
+}
+
+void MetricsRegistry :: SetGauge(const int iGaugeID, const uint64_t llValue)
+{
+    if (iGaugeID < 0)
+    {
+        return;
+    }
+
+    m_arrGauge[iGaugeID].store(llValue, std::memory_order_relaxed);
+}
+
+void MetricsRegistry :: AddGauge(const int iGaugeID, const int64_t llDelta)
+{
+    if (iGaugeID < 0)
+    {
+        return;
+    }
+
+    m_arrGauge[iGaugeID].fetch_add((uint64_t)llDelta, std::memory_order_relaxed);
+}
+
+void MetricsRegistry :: MaxGauge(const int iGaugeID, const uint64_t llValue)
+{
+    if (iGaugeID < 0)
+    {
+        return;
+    }
+
+    uint64_t llWindowID = Time::GetSteadyClockMS() / METRICS_GAUGE_MAX_WINDOW_MS;
+
+    std::lock_guard<std::mutex> oLockGuard(m_oGaugeMaxMutex);
+
+    MetricsGaugeMaxWindow & oWindow = m_arrGaugeMaxWindow[iGaugeID];
+    if (oWindow.llWindowID != llWindowID)
+    {
+        oWindow.llLastMax = oWindow.llWindowID + 1 == llWindowID ? oWindow.llNowMax : 0;
+        oWindow.llNowMax = 0;
+        oWindow.llWindowID = llWindowID;
+    }
+
+    oWindow.llNowMax = std::max(oWindow.llNowMax, llValue);
+
+    m_arrGauge[iGaugeID].store(std::max(oWindow.llLastMax, oWindow.llNowMax), std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////
+
+void MetricsRegistry :: GetSnapshot(std::vector<MetricValue> & vecMetricList)
+{
+    vecMetricList.clear();
+
+    //only copy metric define under lock, values are read without lock.
+    int iCounterCount = 0;
+    int iGaugeCount = 0;
+    int iHistogramCount = 0;
+    {
+        std::lock_guard<std::mutex> oLock(m_oRegisterMutex);
+        vecMetricList.insert(vecMetricList.end(), m_vecCounterDefine.begin(), m_vecCounterDefine.end());
+        vecMetricList.insert(vecMetricList.end(), m_vecGaugeDefine.begin(), m_vecGaugeDefine.end());
+        vecMetricList.insert(vecMetricList.end(), m_vecHistogramDefine.begin(), m_vecHistogramDefine.end());
+        iCounterCount = (int)m_vecCounterDefine.size();
+        iGaugeCount = (int)m_vecGaugeDefine.size();
+        iHistogramCount = (int)m_vecHistogramDefine.size();
+    }
+
+    size_t iIndex = 0;
+    for (int i = 0; i < iCounterCount; i++, iIndex++)
+    {
+        uint64_t llValue = 0;
+        for (auto & oShard : m_arrShard)
+        {
+            llValue += oShard.m_arrCounter[i].load(std::memory_order_relaxed);
+        }
+        vecMetricList[iIndex].m_llValue = llValue;
+    }
+
+    for (int i = 0; i < iGaugeCount; i++, iIndex++)
+    {
+        vecMetricList[iIndex].m_llValue = m_arrGauge[i].load(std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < iHistogramCount; i++, iIndex++)
+    {
+        Histogram oHistogram;
+        for (auto & oShard : m_arrShard)
+        {
+            oHistogram.Merge(*oShard.m_arrHistogram[i]);
+        }
+
+        MetricValue & oMetric = vecMetricList[iIndex];
+        oMetric.m_llValue = oHistogram.GetCount();
+        oMetric.m_llSum = oHistogram.GetSum();
+        oMetric.m_llMax = oHistogram.GetMax();
+        oMetric.m_llP50 = oHistogram.GetPercentile(50);
+        oMetric.m_llP90 = oHistogram.GetPercentile(90);
+        oMetric.m_llP99 = oHistogram.GetPercentile(99);
+        oMetric.m_llP999 = oHistogram.GetPercentile(99.9);
+    }
+}
+
+void MetricsRegistry :: DumpText(std::string & sText)
+{
+    std::vector<MetricValue> vecMetricList;
+    GetSnapshot(vecMetricList);
+
+    sText.clear();
+    char sLine[512] = {0};
+    for (auto & oMetric : vecMetricList)
+    {
+        const char * pcName = oMetric.m_sName.c_str();
+
+        snprintf(sLine, sizeof(sLine), "# HELP %s %s\n", pcName, oMetric.m_sHelp.c_str());
+        sText += sLine;
+
+        if (oMetric.m_iType == MetricType_Counter)
+        {
+            snprintf(sLine, sizeof(sLine), "# TYPE %s counter\n%s %lu\n", pcName, pcName, oMetric.m_llValue);
+            sText += sLine;
+        }
+        else if (oMetric.m_iType == MetricType_Gauge)
+        {
+            snprintf(sLine, sizeof(sLine), "# TYPE %s gauge\n%s %lu\n", pcName, pcName, oMetric.m_llValue);
+            sText += sLine;
+        }
+        else
+        {
+            snprintf(sLine, sizeof(sLine), 
+                    "# TYPE %s summary\n"
+                    "%s{quantile=\"0.5\"} %lu\n"
+                    "%s{quantile=\"0.9\"} %lu\n"
+                    "%s{quantile=\"0.99\"} %lu\n"
+                    "%s{quantile=\"0.999\"} %lu\n"
+                    "%s{quantile=\"1\"} %lu\n"
+                    "%s_sum %lu\n"
+                    "%s_count %lu\n",
+                    pcName, pcName, oMetric.m_llP50, pcName, oMetric.m_llP90,
+                    pcName, oMetric.m_llP99, pcName, oMetric.m_llP999,
+                    pcName, oMetric.m_llMax, pcName, oMetric.m_llSum, pcName, oMetric.m_llValue);
+            sText += sLine;
+        }
+    }
+}
+
+}
+
@@ -0,0 +1,116 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "phxpaxos/breakpoint.h"
+#include "utils_include.h"
+
+namespace phxpaxos
+{
+
+#define METRICS_SHARD_COUNT 8
+#define METRICS_MAX_COUNTER 256
+#define METRICS_MAX_HISTOGRAM 64
+#define METRICS_MAX_GAUGE 64
+#define METRICS_GAUGE_MAX_WINDOW_MS 1000
+
+#define METRICS (MetricsRegistry::Instance())
+
+//Counters of one shard, each thread always use the same shard.
+class alignas(64) MetricsShard
+{
+public:
+    std::atomic<uint64_t> m_arrCounter[METRICS_MAX_COUNTER];
+    Histogram * m_arrHistogram[METRICS_MAX_HISTOGRAM];
+};
+
+//Max of a gauge in this and last window.
+class MetricsGaugeMaxWindow
+{
+public:
+    uint64_t llWindowID;
+    uint64_t llLastMax;
+    uint64_t llNowMax;
+};
+
+//Process wide metrics, register at startup then update from any thread without lock.
+//Counters and histograms are sharded by thread, aggregated only when read.
+class MetricsRegistry
+{
+public:
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    static MetricsRegistry * Instance();
+
+    //Return metric id, -1 if too many metrics. Same name return the same id.
+    int RegisterCounter(const std::string & sName, const std::string & sHelp);
+
+    int RegisterHistogram(const std::string & sName, const std::string & sHelp);
+
+    int RegisterGauge(const std::string & sName, const std::string & sHelp);
+
+public:
+    void Count(const int iCounterID, const uint64_t llDelta = 1);
+
+    void Record(const int iHistogramID, const uint64_t llValue);
+
+    void SetGauge(const int iGaugeID, const uint64_t llValue);
+
+    //for gauges summed over groups, each group add its own change.
+    void AddGauge(const int iGaugeID, const int64_t llDelta);
+
+    //for gauges each group report once a window, show the max of all groups 
+    //reported in this and last window, a group not report any more is forgot.
+    void MaxGauge(const int iGaugeID, const uint64_t llValue);
+
+public:
+    void GetSnapshot(std::vector<MetricValue> & vecMetricList);
+
+    //prometheus text exposition format.
+    void DumpText(std::string & sText);
+
+private:
+    int Register(const std::string & sName, const std::string & sHelp, const int iType, const int iMaxCount,
+            std::vector<MetricValue> & vecMetricDefine);
+
+    MetricsShard & GetShard();
+
+private:
+    std::mutex m_oRegisterMutex;
+    std::vector<MetricValue> m_vecCounterDefine;
+    std::vector<MetricValue> m_vecHistogramDefine;
+    std::vector<MetricValue> m_vecGaugeDefine;
+
+    MetricsShard m_arrShard[METRICS_SHARD_COUNT];
+    std::atomic<uint64_t> m_arrGauge[METRICS_MAX_GAUGE];
+    std::mutex m_oGaugeMaxMutex;
+    MetricsGaugeMaxWindow m_arrGaugeMaxWindow[METRICS_MAX_GAUGE];
+    std::atomic<int> m_iNextShard;
+};
+    
+}
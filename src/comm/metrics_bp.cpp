@@ -0,0 +1,1269 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "metrics_bp.h"
+#include "metrics.h"
+
+namespace phxpaxos
+{
+
+MetricsProposerBP :: MetricsProposerBP()
+{
+    m_iNewProposal = METRICS->RegisterCounter("phxpaxos_proposer_new_proposal_total", "ProposerBP::NewProposal count");
+    m_iNewProposalValueHistogram = METRICS->RegisterHistogram("phxpaxos_proposer_new_proposal_value_size", "ProposerBP::NewProposal sValue size");
+    m_iNewProposalSkipPrepare = METRICS->RegisterCounter("phxpaxos_proposer_new_proposal_skip_prepare_total", "ProposerBP::NewProposalSkipPrepare count");
+    m_iPrepare = METRICS->RegisterCounter("phxpaxos_proposer_prepare_total", "ProposerBP::Prepare count");
+    m_iOnPrepareReply = METRICS->RegisterCounter("phxpaxos_proposer_on_prepare_reply_total", "ProposerBP::OnPrepareReply count");
+    m_iOnPrepareReplyButNotPreparing = METRICS->RegisterCounter("phxpaxos_proposer_on_prepare_reply_but_not_preparing_total", "ProposerBP::OnPrepareReplyButNotPreparing count");
+    m_iOnPrepareReplyNotSameProposalIDMsg = METRICS->RegisterCounter("phxpaxos_proposer_on_prepare_reply_not_same_proposal_id_msg_total", "ProposerBP::OnPrepareReplyNotSameProposalIDMsg count");
+    m_iPreparePass = METRICS->RegisterCounter("phxpaxos_proposer_prepare_pass_total", "ProposerBP::PreparePass count");
+    m_iPreparePassUseTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_proposer_prepare_pass_use_time_ms", "ProposerBP::PreparePass iUseTimeMs");
+    m_iPrepareNotPass = METRICS->RegisterCounter("phxpaxos_proposer_prepare_not_pass_total", "ProposerBP::PrepareNotPass count");
+    m_iAccept = METRICS->RegisterCounter("phxpaxos_proposer_accept_total", "ProposerBP::Accept count");
+    m_iOnAcceptReply = METRICS->RegisterCounter("phxpaxos_proposer_on_accept_reply_total", "ProposerBP::OnAcceptReply count");
+    m_iOnAcceptReplyButNotAccepting = METRICS->RegisterCounter("phxpaxos_proposer_on_accept_reply_but_not_accepting_total", "ProposerBP::OnAcceptReplyButNotAccepting count");
+    m_iOnAcceptReplyNotSameProposalIDMsg = METRICS->RegisterCounter("phxpaxos_proposer_on_accept_reply_not_same_proposal_id_msg_total", "ProposerBP::OnAcceptReplyNotSameProposalIDMsg count");
+    m_iAcceptPass = METRICS->RegisterCounter("phxpaxos_proposer_accept_pass_total", "ProposerBP::AcceptPass count");
+    m_iAcceptPassUseTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_proposer_accept_pass_use_time_ms", "ProposerBP::AcceptPass iUseTimeMs");
+    m_iAcceptNotPass = METRICS->RegisterCounter("phxpaxos_proposer_accept_not_pass_total", "ProposerBP::AcceptNotPass count");
+    m_iPrepareTimeout = METRICS->RegisterCounter("phxpaxos_proposer_prepare_timeout_total", "ProposerBP::PrepareTimeout count");
+    m_iAcceptTimeout = METRICS->RegisterCounter("phxpaxos_proposer_accept_timeout_total", "ProposerBP::AcceptTimeout count");
+    m_iConflictBackoff = METRICS->RegisterCounter("phxpaxos_proposer_conflict_backoff_total", "ProposerBP::ConflictBackoff count");
+    m_iConflictBackoffMsHistogram = METRICS->RegisterHistogram("phxpaxos_proposer_conflict_backoff_ms", "ProposerBP::ConflictBackoff iBackoffMs");
+}
+
+void MetricsProposerBP :: NewProposal(const std::string & sValue)
+{
+    METRICS->Count(m_iNewProposal);
+    METRICS->Record(m_iNewProposalValueHistogram, sValue.size());
+}
+
+void MetricsProposerBP :: NewProposalSkipPrepare()
+{
+    METRICS->Count(m_iNewProposalSkipPrepare);
+}
+
+void MetricsProposerBP :: Prepare()
+{
+    METRICS->Count(m_iPrepare);
+}
+
+void MetricsProposerBP :: OnPrepareReply()
+{
+    METRICS->Count(m_iOnPrepareReply);
+}
+
+void MetricsProposerBP :: OnPrepareReplyButNotPreparing()
+{
+    METRICS->Count(m_iOnPrepareReplyButNotPreparing);
+}
+
+void MetricsProposerBP :: OnPrepareReplyNotSameProposalIDMsg()
+{
+    METRICS->Count(m_iOnPrepareReplyNotSameProposalIDMsg);
+}
+
+void MetricsProposerBP :: PreparePass(const int iUseTimeMs)
+{
+    METRICS->Count(m_iPreparePass);
+    METRICS->Record(m_iPreparePassUseTimeMsHistogram, iUseTimeMs > 0 ? (uint64_t)iUseTimeMs : 0);
+}
+
+void MetricsProposerBP :: PrepareNotPass()
+{
+    METRICS->Count(m_iPrepareNotPass);
+}
+
+void MetricsProposerBP :: Accept()
+{
+    METRICS->Count(m_iAccept);
+}
+
+void MetricsProposerBP :: OnAcceptReply()
+{
+    METRICS->Count(m_iOnAcceptReply);
+}
+
+void MetricsProposerBP :: OnAcceptReplyButNotAccepting()
+{
+    METRICS->Count(m_iOnAcceptReplyButNotAccepting);
+}
+
+void MetricsProposerBP :: OnAcceptReplyNotSameProposalIDMsg()
+{
+    METRICS->Count(m_iOnAcceptReplyNotSameProposalIDMsg);
+}
+
+void MetricsProposerBP :: AcceptPass(const int iUseTimeMs)
+{
+    METRICS->Count(m_iAcceptPass);
+    METRICS->Record(m_iAcceptPassUseTimeMsHistogram, iUseTimeMs > 0 ? (uint64_t)iUseTimeMs : 0);
+}
+
+void MetricsProposerBP :: AcceptNotPass()
+{
+    METRICS->Count(m_iAcceptNotPass);
+}
+
+void MetricsProposerBP :: PrepareTimeout()
+{
+    METRICS->Count(m_iPrepareTimeout);
+}
+
+void MetricsProposerBP :: AcceptTimeout()
+{
+    METRICS->Count(m_iAcceptTimeout);
+}
+
+void MetricsProposerBP :: ConflictBackoff(const int iBackoffMs)
+{
+    METRICS->Count(m_iConflictBackoff);
+    METRICS->Record(m_iConflictBackoffMsHistogram, iBackoffMs > 0 ? (uint64_t)iBackoffMs : 0);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsAcceptorBP :: MetricsAcceptorBP()
+{
+    m_iOnPrepare = METRICS->RegisterCounter("phxpaxos_acceptor_on_prepare_total", "AcceptorBP::OnPrepare count");
+    m_iOnPreparePass = METRICS->RegisterCounter("phxpaxos_acceptor_on_prepare_pass_total", "AcceptorBP::OnPreparePass count");
+    m_iOnPreparePersistFail = METRICS->RegisterCounter("phxpaxos_acceptor_on_prepare_persist_fail_total", "AcceptorBP::OnPreparePersistFail count");
+    m_iOnPrepareReject = METRICS->RegisterCounter("phxpaxos_acceptor_on_prepare_reject_total", "AcceptorBP::OnPrepareReject count");
+    m_iOnAccept = METRICS->RegisterCounter("phxpaxos_acceptor_on_accept_total", "AcceptorBP::OnAccept count");
+    m_iOnAcceptPass = METRICS->RegisterCounter("phxpaxos_acceptor_on_accept_pass_total", "AcceptorBP::OnAcceptPass count");
+    m_iOnAcceptPersistFail = METRICS->RegisterCounter("phxpaxos_acceptor_on_accept_persist_fail_total", "AcceptorBP::OnAcceptPersistFail count");
+    m_iOnAcceptReject = METRICS->RegisterCounter("phxpaxos_acceptor_on_accept_reject_total", "AcceptorBP::OnAcceptReject count");
+}
+
+void MetricsAcceptorBP :: OnPrepare()
+{
+    METRICS->Count(m_iOnPrepare);
+}
+
+void MetricsAcceptorBP :: OnPreparePass()
+{
+    METRICS->Count(m_iOnPreparePass);
+}
+
+void MetricsAcceptorBP :: OnPreparePersistFail()
+{
+    METRICS->Count(m_iOnPreparePersistFail);
+}
+
+void MetricsAcceptorBP :: OnPrepareReject()
+{
+    METRICS->Count(m_iOnPrepareReject);
+}
+
+void MetricsAcceptorBP :: OnAccept()
+{
+    METRICS->Count(m_iOnAccept);
+}
+
+void MetricsAcceptorBP :: OnAcceptPass()
+{
+    METRICS->Count(m_iOnAcceptPass);
+}
+
+void MetricsAcceptorBP :: OnAcceptPersistFail()
+{
+    METRICS->Count(m_iOnAcceptPersistFail);
+}
+
+void MetricsAcceptorBP :: OnAcceptReject()
+{
+    METRICS->Count(m_iOnAcceptReject);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsLearnerBP :: MetricsLearnerBP()
+{
+    m_iAskforLearn = METRICS->RegisterCounter("phxpaxos_learner_askfor_learn_total", "LearnerBP::AskforLearn count");
+    m_iOnAskforLearn = METRICS->RegisterCounter("phxpaxos_learner_on_askfor_learn_total", "LearnerBP::OnAskforLearn count");
+    m_iOnAskforLearnGetLockFail = METRICS->RegisterCounter("phxpaxos_learner_on_askfor_learn_get_lock_fail_total", "LearnerBP::OnAskforLearnGetLockFail count");
+    m_iSendNowInstanceID = METRICS->RegisterCounter("phxpaxos_learner_send_now_instance_id_total", "LearnerBP::SendNowInstanceID count");
+    m_iOnSendNowInstanceID = METRICS->RegisterCounter("phxpaxos_learner_on_send_now_instance_id_total", "LearnerBP::OnSendNowInstanceID count");
+    m_iComfirmAskForLearn = METRICS->RegisterCounter("phxpaxos_learner_comfirm_ask_for_learn_total", "LearnerBP::ComfirmAskForLearn count");
+    m_iOnComfirmAskForLearn = METRICS->RegisterCounter("phxpaxos_learner_on_comfirm_ask_for_learn_total", "LearnerBP::OnComfirmAskForLearn count");
+    m_iOnComfirmAskForLearnGetLockFail = METRICS->RegisterCounter("phxpaxos_learner_on_comfirm_ask_for_learn_get_lock_fail_total", "LearnerBP::OnComfirmAskForLearnGetLockFail count");
+    m_iSendLearnValue = METRICS->RegisterCounter("phxpaxos_learner_send_learn_value_total", "LearnerBP::SendLearnValue count");
+    m_iOnSendLearnValue = METRICS->RegisterCounter("phxpaxos_learner_on_send_learn_value_total", "LearnerBP::OnSendLearnValue count");
+    m_iSendLearnValue_Ack = METRICS->RegisterCounter("phxpaxos_learner_send_learn_value_ack_total", "LearnerBP::SendLearnValue_Ack count");
+    m_iOnSendLearnValue_Ack = METRICS->RegisterCounter("phxpaxos_learner_on_send_learn_value_ack_total", "LearnerBP::OnSendLearnValue_Ack count");
+    m_iProposerSendSuccess = METRICS->RegisterCounter("phxpaxos_learner_proposer_send_success_total", "LearnerBP::ProposerSendSuccess count");
+    m_iOnProposerSendSuccess = METRICS->RegisterCounter("phxpaxos_learner_on_proposer_send_success_total", "LearnerBP::OnProposerSendSuccess count");
+    m_iOnProposerSendSuccessNotAcceptYet = METRICS->RegisterCounter("phxpaxos_learner_on_proposer_send_success_not_accept_yet_total", "LearnerBP::OnProposerSendSuccessNotAcceptYet count");
+    m_iOnProposerSendSuccessBallotNotSame = METRICS->RegisterCounter("phxpaxos_learner_on_proposer_send_success_ballot_not_same_total", "LearnerBP::OnProposerSendSuccessBallotNotSame count");
+    m_iOnProposerSendSuccessSuccessLearn = METRICS->RegisterCounter("phxpaxos_learner_on_proposer_send_success_success_learn_total", "LearnerBP::OnProposerSendSuccessSuccessLearn count");
+    m_iSenderAckTimeout = METRICS->RegisterCounter("phxpaxos_learner_sender_ack_timeout_total", "LearnerBP::SenderAckTimeout count");
+    m_iSenderAckDelay = METRICS->RegisterCounter("phxpaxos_learner_sender_ack_delay_total", "LearnerBP::SenderAckDelay count");
+    m_iSenderSendOnePaxosLog = METRICS->RegisterCounter("phxpaxos_learner_sender_send_one_paxos_log_total", "LearnerBP::SenderSendOnePaxosLog count");
+    m_iSendLearnValueBatch = METRICS->RegisterCounter("phxpaxos_learner_send_learn_value_batch_total", "LearnerBP::SendLearnValueBatch count");
+    m_iSendLearnValueBatchCountHistogram = METRICS->RegisterHistogram("phxpaxos_learner_send_learn_value_batch_count", "LearnerBP::SendLearnValueBatch iCount");
+    m_iOnSendLearnValueBatch = METRICS->RegisterCounter("phxpaxos_learner_on_send_learn_value_batch_total", "LearnerBP::OnSendLearnValueBatch count");
+    m_iOnSendLearnValueBatchCountHistogram = METRICS->RegisterHistogram("phxpaxos_learner_on_send_learn_value_batch_count", "LearnerBP::OnSendLearnValueBatch iCount");
+    m_iSenderWindowShrink = METRICS->RegisterCounter("phxpaxos_learner_sender_window_shrink_total", "LearnerBP::SenderWindowShrink count");
+    m_iSenderWindowShrinkWindowBytesHistogram = METRICS->RegisterHistogram("phxpaxos_learner_sender_window_shrink_window_bytes", "LearnerBP::SenderWindowShrink iWindowBytes");
+    m_iSenderBackpressure = METRICS->RegisterCounter("phxpaxos_learner_sender_backpressure_total", "LearnerBP::SenderBackpressure count");
+}
+
+void MetricsLearnerBP :: AskforLearn()
+{
+    METRICS->Count(m_iAskforLearn);
+}
+
+void MetricsLearnerBP :: OnAskforLearn()
+{
+    METRICS->Count(m_iOnAskforLearn);
+}
+
+void MetricsLearnerBP :: OnAskforLearnGetLockFail()
+{
+    METRICS->Count(m_iOnAskforLearnGetLockFail);
+}
+
+void MetricsLearnerBP :: SendNowInstanceID()
+{
+    METRICS->Count(m_iSendNowInstanceID);
+}
+
+void MetricsLearnerBP :: OnSendNowInstanceID()
+{
+    METRICS->Count(m_iOnSendNowInstanceID);
+}
+
+void MetricsLearnerBP :: ComfirmAskForLearn()
+{
+    METRICS->Count(m_iComfirmAskForLearn);
+}
+
+void MetricsLearnerBP :: OnComfirmAskForLearn()
+{
+    METRICS->Count(m_iOnComfirmAskForLearn);
+}
+
+void MetricsLearnerBP :: OnComfirmAskForLearnGetLockFail()
+{
+    METRICS->Count(m_iOnComfirmAskForLearnGetLockFail);
+}
+
+void MetricsLearnerBP :: SendLearnValue()
+{
+    METRICS->Count(m_iSendLearnValue);
+}
+
+void MetricsLearnerBP :: OnSendLearnValue()
+{
+    METRICS->Count(m_iOnSendLearnValue);
+}
+
+void MetricsLearnerBP :: SendLearnValue_Ack()
+{
+    METRICS->Count(m_iSendLearnValue_Ack);
+}
+
+void MetricsLearnerBP :: OnSendLearnValue_Ack()
+{
+    METRICS->Count(m_iOnSendLearnValue_Ack);
+}
+
+void MetricsLearnerBP :: ProposerSendSuccess()
+{
+    METRICS->Count(m_iProposerSendSuccess);
+}
+
+void MetricsLearnerBP :: OnProposerSendSuccess()
+{
+    METRICS->Count(m_iOnProposerSendSuccess);
+}
+
+void MetricsLearnerBP :: OnProposerSendSuccessNotAcceptYet()
+{
+    METRICS->Count(m_iOnProposerSendSuccessNotAcceptYet);
+}
+
+void MetricsLearnerBP :: OnProposerSendSuccessBallotNotSame()
+{
+    METRICS->Count(m_iOnProposerSendSuccessBallotNotSame);
+}
+
+void MetricsLearnerBP :: OnProposerSendSuccessSuccessLearn()
+{
+    METRICS->Count(m_iOnProposerSendSuccessSuccessLearn);
+}
+
+void MetricsLearnerBP :: SenderAckTimeout()
+{
+    METRICS->Count(m_iSenderAckTimeout);
+}
+
+void MetricsLearnerBP :: SenderAckDelay()
+{
+    METRICS->Count(m_iSenderAckDelay);
+}
+
+void MetricsLearnerBP :: SenderSendOnePaxosLog()
+{
+    METRICS->Count(m_iSenderSendOnePaxosLog);
+}
+
+void MetricsLearnerBP :: SendLearnValueBatch(const int iCount)
+{
+    METRICS->Count(m_iSendLearnValueBatch);
+    METRICS->Record(m_iSendLearnValueBatchCountHistogram, iCount > 0 ? (uint64_t)iCount : 0);
+}
+
+void MetricsLearnerBP :: OnSendLearnValueBatch(const int iCount)
+{
+    METRICS->Count(m_iOnSendLearnValueBatch);
+    METRICS->Record(m_iOnSendLearnValueBatchCountHistogram, iCount > 0 ? (uint64_t)iCount : 0);
+}
+
+void MetricsLearnerBP :: SenderWindowShrink(const int iWindowBytes)
+{
+    METRICS->Count(m_iSenderWindowShrink);
+    METRICS->Record(m_iSenderWindowShrinkWindowBytesHistogram, iWindowBytes > 0 ? (uint64_t)iWindowBytes : 0);
+}
+
+void MetricsLearnerBP :: SenderBackpressure()
+{
+    METRICS->Count(m_iSenderBackpressure);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsInstanceBP :: MetricsInstanceBP()
+{
+    m_iNewInstance = METRICS->RegisterCounter("phxpaxos_instance_new_instance_total", "InstanceBP::NewInstance count");
+    m_iSendMessage = METRICS->RegisterCounter("phxpaxos_instance_send_message_total", "InstanceBP::SendMessage count");
+    m_iBroadcastMessage = METRICS->RegisterCounter("phxpaxos_instance_broadcast_message_total", "InstanceBP::BroadcastMessage count");
+    m_iOnNewValueCommitTimeout = METRICS->RegisterCounter("phxpaxos_instance_on_new_value_commit_timeout_total", "InstanceBP::OnNewValueCommitTimeout count");
+    m_iOnReceive = METRICS->RegisterCounter("phxpaxos_instance_on_receive_total", "InstanceBP::OnReceive count");
+    m_iOnReceiveParseError = METRICS->RegisterCounter("phxpaxos_instance_on_receive_parse_error_total", "InstanceBP::OnReceiveParseError count");
+    m_iOnReceivePaxosMsg = METRICS->RegisterCounter("phxpaxos_instance_on_receive_paxos_msg_total", "InstanceBP::OnReceivePaxosMsg count");
+    m_iOnReceivePaxosMsgNodeIDNotValid = METRICS->RegisterCounter("phxpaxos_instance_on_receive_paxos_msg_node_id_not_valid_total", "InstanceBP::OnReceivePaxosMsgNodeIDNotValid count");
+    m_iOnReceivePaxosMsgTypeNotValid = METRICS->RegisterCounter("phxpaxos_instance_on_receive_paxos_msg_type_not_valid_total", "InstanceBP::OnReceivePaxosMsgTypeNotValid count");
+    m_iOnReceivePaxosProposerMsgInotsame = METRICS->RegisterCounter("phxpaxos_instance_on_receive_paxos_proposer_msg_inotsame_total", "InstanceBP::OnReceivePaxosProposerMsgInotsame count");
+    m_iOnReceivePaxosAcceptorMsgInotsame = METRICS->RegisterCounter("phxpaxos_instance_on_receive_paxos_acceptor_msg_inotsame_total", "InstanceBP::OnReceivePaxosAcceptorMsgInotsame count");
+    m_iOnReceivePaxosAcceptorMsgAddRetry = METRICS->RegisterCounter("phxpaxos_instance_on_receive_paxos_acceptor_msg_add_retry_total", "InstanceBP::OnReceivePaxosAcceptorMsgAddRetry count");
+    m_iOnInstanceLearned = METRICS->RegisterCounter("phxpaxos_instance_on_instance_learned_total", "InstanceBP::OnInstanceLearned count");
+    m_iOnInstanceLearnedNotMyCommit = METRICS->RegisterCounter("phxpaxos_instance_on_instance_learned_not_my_commit_total", "InstanceBP::OnInstanceLearnedNotMyCommit count");
+    m_iOnInstanceLearnedIsMyCommit = METRICS->RegisterCounter("phxpaxos_instance_on_instance_learned_is_my_commit_total", "InstanceBP::OnInstanceLearnedIsMyCommit count");
+    m_iOnInstanceLearnedIsMyCommitUseTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_instance_on_instance_learned_is_my_commit_use_time_ms", "InstanceBP::OnInstanceLearnedIsMyCommit iUseTimeMs");
+    m_iOnInstanceLearnedSMExecuteFail = METRICS->RegisterCounter("phxpaxos_instance_on_instance_learned_sm_execute_fail_total", "InstanceBP::OnInstanceLearnedSMExecuteFail count");
+    m_iChecksumLogicFail = METRICS->RegisterCounter("phxpaxos_instance_checksum_logic_fail_total", "InstanceBP::ChecksumLogicFail count");
+}
+
+void MetricsInstanceBP :: NewInstance()
+{
+    METRICS->Count(m_iNewInstance);
+}
+
+void MetricsInstanceBP :: SendMessage()
+{
+    METRICS->Count(m_iSendMessage);
+}
+
+void MetricsInstanceBP :: BroadcastMessage()
+{
+    METRICS->Count(m_iBroadcastMessage);
+}
+
+void MetricsInstanceBP :: OnNewValueCommitTimeout()
+{
+    METRICS->Count(m_iOnNewValueCommitTimeout);
+}
+
+void MetricsInstanceBP :: OnReceive()
+{
+    METRICS->Count(m_iOnReceive);
+}
+
+void MetricsInstanceBP :: OnReceiveParseError()
+{
+    METRICS->Count(m_iOnReceiveParseError);
+}
+
+void MetricsInstanceBP :: OnReceivePaxosMsg()
+{
+    METRICS->Count(m_iOnReceivePaxosMsg);
+}
+
+void MetricsInstanceBP :: OnReceivePaxosMsgNodeIDNotValid()
+{
+    METRICS->Count(m_iOnReceivePaxosMsgNodeIDNotValid);
+}
+
+void MetricsInstanceBP :: OnReceivePaxosMsgTypeNotValid()
+{
+    METRICS->Count(m_iOnReceivePaxosMsgTypeNotValid);
+}
+
+void MetricsInstanceBP :: OnReceivePaxosProposerMsgInotsame()
+{
+    METRICS->Count(m_iOnReceivePaxosProposerMsgInotsame);
+}
+
+void MetricsInstanceBP :: OnReceivePaxosAcceptorMsgInotsame()
+{
+    METRICS->Count(m_iOnReceivePaxosAcceptorMsgInotsame);
+}
+
+void MetricsInstanceBP :: OnReceivePaxosAcceptorMsgAddRetry()
+{
+    METRICS->Count(m_iOnReceivePaxosAcceptorMsgAddRetry);
+}
+
+void MetricsInstanceBP :: OnInstanceLearned()
+{
+    METRICS->Count(m_iOnInstanceLearned);
+}
+
+void MetricsInstanceBP :: OnInstanceLearnedNotMyCommit()
+{
+    METRICS->Count(m_iOnInstanceLearnedNotMyCommit);
+}
+
+void MetricsInstanceBP :: OnInstanceLearnedIsMyCommit(const int iUseTimeMs)
+{
+    METRICS->Count(m_iOnInstanceLearnedIsMyCommit);
+    METRICS->Record(m_iOnInstanceLearnedIsMyCommitUseTimeMsHistogram, iUseTimeMs > 0 ? (uint64_t)iUseTimeMs : 0);
+}
+
+void MetricsInstanceBP :: OnInstanceLearnedSMExecuteFail()
+{
+    METRICS->Count(m_iOnInstanceLearnedSMExecuteFail);
+}
+
+void MetricsInstanceBP :: ChecksumLogicFail()
+{
+    METRICS->Count(m_iChecksumLogicFail);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsCommiterBP :: MetricsCommiterBP()
+{
+    m_iNewValue = METRICS->RegisterCounter("phxpaxos_committer_new_value_total", "CommiterBP::NewValue count");
+    m_iNewValueConflict = METRICS->RegisterCounter("phxpaxos_committer_new_value_conflict_total", "CommiterBP::NewValueConflict count");
+    m_iNewValueGetLockTimeout = METRICS->RegisterCounter("phxpaxos_committer_new_value_get_lock_timeout_total", "CommiterBP::NewValueGetLockTimeout count");
+    m_iNewValueGetLockReject = METRICS->RegisterCounter("phxpaxos_committer_new_value_get_lock_reject_total", "CommiterBP::NewValueGetLockReject count");
+    m_iNewValueGetLockOK = METRICS->RegisterCounter("phxpaxos_committer_new_value_get_lock_ok_total", "CommiterBP::NewValueGetLockOK count");
+    m_iNewValueGetLockOKUseTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_committer_new_value_get_lock_ok_use_time_ms", "CommiterBP::NewValueGetLockOK iUseTimeMs");
+    m_iNewValueCommitOK = METRICS->RegisterCounter("phxpaxos_committer_new_value_commit_ok_total", "CommiterBP::NewValueCommitOK count");
+    m_iNewValueCommitOKUseTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_committer_new_value_commit_ok_use_time_ms", "CommiterBP::NewValueCommitOK iUseTimeMs");
+    m_iNewValueCommitFail = METRICS->RegisterCounter("phxpaxos_committer_new_value_commit_fail_total", "CommiterBP::NewValueCommitFail count");
+    m_iNewValueWaitQueueDepth = METRICS->RegisterCounter("phxpaxos_committer_new_value_wait_queue_depth_total", "CommiterBP::NewValueWaitQueueDepth count");
+    m_iNewValueWaitQueueDepthHistogram = METRICS->RegisterHistogram("phxpaxos_committer_new_value_wait_queue_depth", "CommiterBP::NewValueWaitQueueDepth iQueueDepth");
+    m_iNewValueWaitSojournTimeMs = METRICS->RegisterCounter("phxpaxos_committer_new_value_wait_sojourn_time_ms_total", "CommiterBP::NewValueWaitSojournTimeMs count");
+    m_iNewValueWaitSojournTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_committer_new_value_wait_sojourn_time_ms", "CommiterBP::NewValueWaitSojournTimeMs iSojournTimeMs");
+    m_iBatchPropose = METRICS->RegisterCounter("phxpaxos_committer_batch_propose_total", "CommiterBP::BatchPropose count");
+    m_iBatchProposeOK = METRICS->RegisterCounter("phxpaxos_committer_batch_propose_ok_total", "CommiterBP::BatchProposeOK count");
+    m_iBatchProposeFail = METRICS->RegisterCounter("phxpaxos_committer_batch_propose_fail_total", "CommiterBP::BatchProposeFail count");
+    m_iBatchProposeWaitTimeMs = METRICS->RegisterCounter("phxpaxos_committer_batch_propose_wait_time_ms_total", "CommiterBP::BatchProposeWaitTimeMs count");
+    m_iBatchProposeWaitTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_committer_batch_propose_wait_time_ms", "CommiterBP::BatchProposeWaitTimeMs iWaitTimeMs");
+    m_iBatchProposeDoPropose = METRICS->RegisterCounter("phxpaxos_committer_batch_propose_do_propose_total", "CommiterBP::BatchProposeDoPropose count");
+    m_iBatchProposeDoProposeBatchCountHistogram = METRICS->RegisterHistogram("phxpaxos_committer_batch_propose_do_propose_batch_count", "CommiterBP::BatchProposeDoPropose iBatchCount");
+    m_iCoalescePropose = METRICS->RegisterCounter("phxpaxos_committer_coalesce_propose_total", "CommiterBP::CoalescePropose count");
+    m_iCoalesceProposeCoalesceCountHistogram = METRICS->RegisterHistogram("phxpaxos_committer_coalesce_propose_coalesce_count", "CommiterBP::CoalescePropose iCoalesceCount");
+    m_iForwardPropose = METRICS->RegisterCounter("phxpaxos_committer_forward_propose_total", "CommiterBP::ForwardPropose count");
+    m_iForwardProposeOK = METRICS->RegisterCounter("phxpaxos_committer_forward_propose_ok_total", "CommiterBP::ForwardProposeOK count");
+    m_iForwardProposeOKUseTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_committer_forward_propose_ok_use_time_ms", "CommiterBP::ForwardProposeOK iUseTimeMs");
+    m_iForwardProposeFail = METRICS->RegisterCounter("phxpaxos_committer_forward_propose_fail_total", "CommiterBP::ForwardProposeFail count");
+    m_iOnForwardPropose = METRICS->RegisterCounter("phxpaxos_committer_on_forward_propose_total", "CommiterBP::OnForwardPropose count");
+    m_iOnForwardProposeRejectByFullQueue = METRICS->RegisterCounter("phxpaxos_committer_on_forward_propose_reject_by_full_queue_total", "CommiterBP::OnForwardProposeRejectByFullQueue count");
+    m_iOnForwardProposeRejectByNotMaster = METRICS->RegisterCounter("phxpaxos_committer_on_forward_propose_reject_by_not_master_total", "CommiterBP::OnForwardProposeRejectByNotMaster count");
+    m_iCommitStageUseTimeUS = METRICS->RegisterCounter("phxpaxos_committer_commit_stage_use_time_us_total", "CommiterBP::CommitStageUseTimeUS count");
+    static const char * arrStageName[CommitStage_Count] = 
+            {"queue", "ioloop", "prepare", "accept", "persist", "learn", "execute", "total"};
+    for (int i = 0; i < CommitStage_Count; i++)
+    {
+        std::string sPrefix = std::string("phxpaxos_committer_commit_stage_") + arrStageName[i];
+        m_arrCommitStageP50Gauge[i] = METRICS->RegisterGauge(sPrefix + "_p50_us", "CommiterBP::CommitStageUseTimeUS p50 of last period, max of all groups");
+        m_arrCommitStageP99Gauge[i] = METRICS->RegisterGauge(sPrefix + "_p99_us", "CommiterBP::CommitStageUseTimeUS p99 of last period, max of all groups");
+        m_arrCommitStageMaxGauge[i] = METRICS->RegisterGauge(sPrefix + "_max_us", "CommiterBP::CommitStageUseTimeUS max of last period, max of all groups");
+    }
+}
+
+void MetricsCommiterBP :: NewValue()
+{
+    METRICS->Count(m_iNewValue);
+}
+
+void MetricsCommiterBP :: NewValueConflict()
+{
+    METRICS->Count(m_iNewValueConflict);
+}
+
+void MetricsCommiterBP :: NewValueGetLockTimeout()
+{
+    METRICS->Count(m_iNewValueGetLockTimeout);
+}
+
+void MetricsCommiterBP :: NewValueGetLockReject()
+{
+    METRICS->Count(m_iNewValueGetLockReject);
+}
+
+void MetricsCommiterBP :: NewValueGetLockOK(const int iUseTimeMs)
+{
+    METRICS->Count(m_iNewValueGetLockOK);
+    METRICS->Record(m_iNewValueGetLockOKUseTimeMsHistogram, iUseTimeMs > 0 ? (uint64_t)iUseTimeMs : 0);
+}
+
+void MetricsCommiterBP :: NewValueCommitOK(const int iUseTimeMs)
+{
+    METRICS->Count(m_iNewValueCommitOK);
+    METRICS->Record(m_iNewValueCommitOKUseTimeMsHistogram, iUseTimeMs > 0 ? (uint64_t)iUseTimeMs : 0);
+}
+
+void MetricsCommiterBP :: NewValueCommitFail()
+{
+    METRICS->Count(m_iNewValueCommitFail);
+}
+
+void MetricsCommiterBP :: NewValueWaitQueueDepth(const int iQueueDepth)
+{
+    METRICS->Count(m_iNewValueWaitQueueDepth);
+    METRICS->Record(m_iNewValueWaitQueueDepthHistogram, iQueueDepth > 0 ? (uint64_t)iQueueDepth : 0);
+}
+
+void MetricsCommiterBP :: NewValueWaitSojournTimeMs(const int iSojournTimeMs)
+{
+    METRICS->Count(m_iNewValueWaitSojournTimeMs);
+    METRICS->Record(m_iNewValueWaitSojournTimeMsHistogram, iSojournTimeMs > 0 ? (uint64_t)iSojournTimeMs : 0);
+}
+
+void MetricsCommiterBP :: BatchPropose()
+{
+    METRICS->Count(m_iBatchPropose);
+}
+
+void MetricsCommiterBP :: BatchProposeOK()
+{
+    METRICS->Count(m_iBatchProposeOK);
+}
+
+void MetricsCommiterBP :: BatchProposeFail()
+{
+    METRICS->Count(m_iBatchProposeFail);
+}
+
+void MetricsCommiterBP :: BatchProposeWaitTimeMs(const int iWaitTimeMs)
+{
+    METRICS->Count(m_iBatchProposeWaitTimeMs);
+    METRICS->Record(m_iBatchProposeWaitTimeMsHistogram, iWaitTimeMs > 0 ? (uint64_t)iWaitTimeMs : 0);
+}
+
+void MetricsCommiterBP :: BatchProposeDoPropose(const int iBatchCount)
+{
+    METRICS->Count(m_iBatchProposeDoPropose);
+    METRICS->Record(m_iBatchProposeDoProposeBatchCountHistogram, iBatchCount > 0 ? (uint64_t)iBatchCount : 0);
+}
+
+void MetricsCommiterBP :: CoalescePropose(const int iCoalesceCount)
+{
+    METRICS->Count(m_iCoalescePropose);
+    METRICS->Record(m_iCoalesceProposeCoalesceCountHistogram, iCoalesceCount > 0 ? (uint64_t)iCoalesceCount : 0);
+}
+
+void MetricsCommiterBP :: ForwardPropose()
+{
+    METRICS->Count(m_iForwardPropose);
+}
+
+void MetricsCommiterBP :: ForwardProposeOK(const int iUseTimeMs)
+{
+    METRICS->Count(m_iForwardProposeOK);
+    METRICS->Record(m_iForwardProposeOKUseTimeMsHistogram, iUseTimeMs > 0 ? (uint64_t)iUseTimeMs : 0);
+}
+
+void MetricsCommiterBP :: ForwardProposeFail()
+{
+    METRICS->Count(m_iForwardProposeFail);
+}
+
+void MetricsCommiterBP :: OnForwardPropose()
+{
+    METRICS->Count(m_iOnForwardPropose);
+}
+
+void MetricsCommiterBP :: OnForwardProposeRejectByFullQueue()
+{
+    METRICS->Count(m_iOnForwardProposeRejectByFullQueue);
+}
+
+void MetricsCommiterBP :: OnForwardProposeRejectByNotMaster()
+{
+    METRICS->Count(m_iOnForwardProposeRejectByNotMaster);
+}
+
+void MetricsCommiterBP :: CommitStageUseTimeUS(const int iGroupIdx, const int iStage, const uint64_t llP50UseTimeUS, const uint64_t llP99UseTimeUS, const uint64_t llMaxUseTimeUS)
+{
+    if (iStage < 0 || iStage >= CommitStage_Count)
+    {
+        return;
+    }
+
+    METRICS->Count(m_iCommitStageUseTimeUS);
+    METRICS->MaxGauge(m_arrCommitStageP50Gauge[iStage], llP50UseTimeUS);
+    METRICS->MaxGauge(m_arrCommitStageP99Gauge[iStage], llP99UseTimeUS);
+    METRICS->MaxGauge(m_arrCommitStageMaxGauge[iStage], llMaxUseTimeUS);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsIOLoopBP :: MetricsIOLoopBP()
+{
+    m_iOneLoop = METRICS->RegisterCounter("phxpaxos_ioloop_one_loop_total", "IOLoopBP::OneLoop count");
+    m_iEnqueueMsg = METRICS->RegisterCounter("phxpaxos_ioloop_enqueue_msg_total", "IOLoopBP::EnqueueMsg count");
+    m_iEnqueueMsgRejectByFullQueue = METRICS->RegisterCounter("phxpaxos_ioloop_enqueue_msg_reject_by_full_queue_total", "IOLoopBP::EnqueueMsgRejectByFullQueue count");
+    m_iEnqueueRetryMsg = METRICS->RegisterCounter("phxpaxos_ioloop_enqueue_retry_msg_total", "IOLoopBP::EnqueueRetryMsg count");
+    m_iEnqueueRetryMsgRejectByFullQueue = METRICS->RegisterCounter("phxpaxos_ioloop_enqueue_retry_msg_reject_by_full_queue_total", "IOLoopBP::EnqueueRetryMsgRejectByFullQueue count");
+    m_iOutQueueMsg = METRICS->RegisterCounter("phxpaxos_ioloop_out_queue_msg_total", "IOLoopBP::OutQueueMsg count");
+    m_iDealWithRetryMsg = METRICS->RegisterCounter("phxpaxos_ioloop_deal_with_retry_msg_total", "IOLoopBP::DealWithRetryMsg count");
+    m_iRunTask = METRICS->RegisterCounter("phxpaxos_ioloop_run_task_total", "IOLoopBP::RunTask count");
+    m_iRunTaskMsgCountHistogram = METRICS->RegisterHistogram("phxpaxos_ioloop_run_task_msg_count", "IOLoopBP::RunTask iMsgCount");
+    m_iStealTask = METRICS->RegisterCounter("phxpaxos_ioloop_steal_task_total", "IOLoopBP::StealTask count");
+    static const char * arrMsgClassName[IOLoopMsgClass_Count] = {"consensus", "learn", "checkpoint"};
+    for (int i = 0; i < IOLoopMsgClass_Count; i++)
+    {
+        m_arrMsgQueueDepthGauge[i] = METRICS->RegisterGauge(
+                std::string("phxpaxos_ioloop_msg_queue_depth_") + arrMsgClassName[i],
+                "IOLoopBP messages of the class queued in all groups");
+    }
+}
+
+void MetricsIOLoopBP :: OneLoop()
+{
+    METRICS->Count(m_iOneLoop);
+}
+
+void MetricsIOLoopBP :: EnqueueMsg()
+{
+    METRICS->Count(m_iEnqueueMsg);
+}
+
+void MetricsIOLoopBP :: EnqueueMsgRejectByFullQueue()
+{
+    METRICS->Count(m_iEnqueueMsgRejectByFullQueue);
+}
+
+void MetricsIOLoopBP :: EnqueueRetryMsg()
+{
+    METRICS->Count(m_iEnqueueRetryMsg);
+}
+
+void MetricsIOLoopBP :: EnqueueRetryMsgRejectByFullQueue()
+{
+    METRICS->Count(m_iEnqueueRetryMsgRejectByFullQueue);
+}
+
+void MetricsIOLoopBP :: OutQueueMsg()
+{
+    METRICS->Count(m_iOutQueueMsg);
+}
+
+void MetricsIOLoopBP :: DealWithRetryMsg()
+{
+    METRICS->Count(m_iDealWithRetryMsg);
+}
+
+void MetricsIOLoopBP :: RunTask(const int iMsgCount)
+{
+    METRICS->Count(m_iRunTask);
+    METRICS->Record(m_iRunTaskMsgCountHistogram, iMsgCount > 0 ? (uint64_t)iMsgCount : 0);
+}
+
+void MetricsIOLoopBP :: StealTask()
+{
+    METRICS->Count(m_iStealTask);
+}
+
+void MetricsIOLoopBP :: MsgQueueAdd(const int iMsgClass)
+{
+    if (iMsgClass < 0 || iMsgClass >= IOLoopMsgClass_Count)
+    {
+        return;
+    }
+
+    METRICS->AddGauge(m_arrMsgQueueDepthGauge[iMsgClass], 1);
+}
+
+void MetricsIOLoopBP :: MsgQueuePop(const int iMsgClass)
+{
+    if (iMsgClass < 0 || iMsgClass >= IOLoopMsgClass_Count)
+    {
+        return;
+    }
+
+    METRICS->AddGauge(m_arrMsgQueueDepthGauge[iMsgClass], -1);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsNetworkBP :: MetricsNetworkBP()
+{
+    m_iTcpEpollLoop = METRICS->RegisterCounter("phxpaxos_network_tcp_epoll_loop_total", "NetworkBP::TcpEpollLoop count");
+    m_iTcpOnError = METRICS->RegisterCounter("phxpaxos_network_tcp_on_error_total", "NetworkBP::TcpOnError count");
+    m_iTcpAcceptFd = METRICS->RegisterCounter("phxpaxos_network_tcp_accept_fd_total", "NetworkBP::TcpAcceptFd count");
+    m_iTcpQueueFull = METRICS->RegisterCounter("phxpaxos_network_tcp_queue_full_total", "NetworkBP::TcpQueueFull count");
+    m_iTcpReadOneMessageOk = METRICS->RegisterCounter("phxpaxos_network_tcp_read_one_message_ok_total", "NetworkBP::TcpReadOneMessageOk count");
+    m_iTcpReadOneMessageOkLenHistogram = METRICS->RegisterHistogram("phxpaxos_network_tcp_read_one_message_ok_len", "NetworkBP::TcpReadOneMessageOk iLen");
+    m_iTcpOnReadMessageLenError = METRICS->RegisterCounter("phxpaxos_network_tcp_on_read_message_len_error_total", "NetworkBP::TcpOnReadMessageLenError count");
+    m_iTcpReconnect = METRICS->RegisterCounter("phxpaxos_network_tcp_reconnect_total", "NetworkBP::TcpReconnect count");
+    m_iTcpOutQueue = METRICS->RegisterCounter("phxpaxos_network_tcp_out_queue_total", "NetworkBP::TcpOutQueue count");
+    m_iTcpOutQueueDelayMsHistogram = METRICS->RegisterHistogram("phxpaxos_network_tcp_out_queue_delay_ms", "NetworkBP::TcpOutQueue iDelayMs");
+    m_iTcpOutQueueDrop = METRICS->RegisterCounter("phxpaxos_network_tcp_out_queue_drop_total", "NetworkBP::TcpOutQueueDrop count");
+    m_iTcpCreditStall = METRICS->RegisterCounter("phxpaxos_network_tcp_credit_stall_total", "NetworkBP::TcpCreditStall count");
+    m_iTcpCreditGrant = METRICS->RegisterCounter("phxpaxos_network_tcp_credit_grant_total", "NetworkBP::TcpCreditGrant count");
+    m_iTcpCreditGrantGroupCountHistogram = METRICS->RegisterHistogram("phxpaxos_network_tcp_credit_grant_group_count", "NetworkBP::TcpCreditGrant iGroupCount");
+    m_iSendRejectByTooLargeSize = METRICS->RegisterCounter("phxpaxos_network_send_reject_by_too_large_size_total", "NetworkBP::SendRejectByTooLargeSize count");
+    m_iSend = METRICS->RegisterCounter("phxpaxos_network_send_total", "NetworkBP::Send count");
+    m_iSendMessageHistogram = METRICS->RegisterHistogram("phxpaxos_network_send_message_size", "NetworkBP::Send sMessage size");
+    m_iSendTcp = METRICS->RegisterCounter("phxpaxos_network_send_tcp_total", "NetworkBP::SendTcp count");
+    m_iSendTcpMessageHistogram = METRICS->RegisterHistogram("phxpaxos_network_send_tcp_message_size", "NetworkBP::SendTcp sMessage size");
+    m_iSendUdp = METRICS->RegisterCounter("phxpaxos_network_send_udp_total", "NetworkBP::SendUdp count");
+    m_iSendUdpMessageHistogram = METRICS->RegisterHistogram("phxpaxos_network_send_udp_message_size", "NetworkBP::SendUdp sMessage size");
+    m_iSendMessageNodeIDNotFound = METRICS->RegisterCounter("phxpaxos_network_send_message_node_id_not_found_total", "NetworkBP::SendMessageNodeIDNotFound count");
+    m_iUDPReceive = METRICS->RegisterCounter("phxpaxos_network_udp_receive_total", "NetworkBP::UDPReceive count");
+    m_iUDPReceiveRecvLenHistogram = METRICS->RegisterHistogram("phxpaxos_network_udp_receive_recv_len", "NetworkBP::UDPReceive iRecvLen");
+    m_iUDPRealSend = METRICS->RegisterCounter("phxpaxos_network_udp_real_send_total", "NetworkBP::UDPRealSend count");
+    m_iUDPRealSendMessageHistogram = METRICS->RegisterHistogram("phxpaxos_network_udp_real_send_message_size", "NetworkBP::UDPRealSend sMessage size");
+    m_iUDPQueueFull = METRICS->RegisterCounter("phxpaxos_network_udp_queue_full_total", "NetworkBP::UDPQueueFull count");
+    m_iSendCoalescedFrame = METRICS->RegisterCounter("phxpaxos_network_send_coalesced_frame_total", "NetworkBP::SendCoalescedFrame count");
+    m_iSendCoalescedFrameMsgCountHistogram = METRICS->RegisterHistogram("phxpaxos_network_send_coalesced_frame_msg_count", "NetworkBP::SendCoalescedFrame iMsgCount");
+    m_iSendCoalescedFrameLenHistogram = METRICS->RegisterHistogram("phxpaxos_network_send_coalesced_frame_len", "NetworkBP::SendCoalescedFrame iFrameLen");
+    m_iReceiveCoalescedFrame = METRICS->RegisterCounter("phxpaxos_network_receive_coalesced_frame_total", "NetworkBP::ReceiveCoalescedFrame count");
+    m_iReceiveCoalescedFrameMsgCountHistogram = METRICS->RegisterHistogram("phxpaxos_network_receive_coalesced_frame_msg_count", "NetworkBP::ReceiveCoalescedFrame iMsgCount");
+    m_iReceiveCoalescedFrameError = METRICS->RegisterCounter("phxpaxos_network_receive_coalesced_frame_error_total", "NetworkBP::ReceiveCoalescedFrameError count");
+}
+
+void MetricsNetworkBP :: TcpEpollLoop()
+{
+    METRICS->Count(m_iTcpEpollLoop);
+}
+
+void MetricsNetworkBP :: TcpOnError()
+{
+    METRICS->Count(m_iTcpOnError);
+}
+
+void MetricsNetworkBP :: TcpAcceptFd()
+{
+    METRICS->Count(m_iTcpAcceptFd);
+}
+
+void MetricsNetworkBP :: TcpQueueFull()
+{
+    METRICS->Count(m_iTcpQueueFull);
+}
+
+void MetricsNetworkBP :: TcpReadOneMessageOk(const int iLen)
+{
+    METRICS->Count(m_iTcpReadOneMessageOk);
+    METRICS->Record(m_iTcpReadOneMessageOkLenHistogram, iLen > 0 ? (uint64_t)iLen : 0);
+}
+
+void MetricsNetworkBP :: TcpOnReadMessageLenError()
+{
+    METRICS->Count(m_iTcpOnReadMessageLenError);
+}
+
+void MetricsNetworkBP :: TcpReconnect()
+{
+    METRICS->Count(m_iTcpReconnect);
+}
+
+void MetricsNetworkBP :: TcpOutQueue(const int iDelayMs)
+{
+    METRICS->Count(m_iTcpOutQueue);
+    METRICS->Record(m_iTcpOutQueueDelayMsHistogram, iDelayMs > 0 ? (uint64_t)iDelayMs : 0);
+}
+
+void MetricsNetworkBP :: TcpOutQueueDrop()
+{
+    METRICS->Count(m_iTcpOutQueueDrop);
+}
+
+void MetricsNetworkBP :: TcpCreditStall()
+{
+    METRICS->Count(m_iTcpCreditStall);
+}
+
+void MetricsNetworkBP :: TcpCreditGrant(const int iGroupCount)
+{
+    METRICS->Count(m_iTcpCreditGrant);
+    METRICS->Record(m_iTcpCreditGrantGroupCountHistogram, iGroupCount > 0 ? (uint64_t)iGroupCount : 0);
+}
+
+void MetricsNetworkBP :: SendRejectByTooLargeSize()
+{
+    METRICS->Count(m_iSendRejectByTooLargeSize);
+}
+
+void MetricsNetworkBP :: Send(const std::string & sMessage)
+{
+    METRICS->Count(m_iSend);
+    METRICS->Record(m_iSendMessageHistogram, sMessage.size());
+}
+
+void MetricsNetworkBP :: SendTcp(const std::string & sMessage)
+{
+    METRICS->Count(m_iSendTcp);
+    METRICS->Record(m_iSendTcpMessageHistogram, sMessage.size());
+}
+
+void MetricsNetworkBP :: SendUdp(const std::string & sMessage)
+{
+    METRICS->Count(m_iSendUdp);
+    METRICS->Record(m_iSendUdpMessageHistogram, sMessage.size());
+}
+
+void MetricsNetworkBP :: SendMessageNodeIDNotFound()
+{
+    METRICS->Count(m_iSendMessageNodeIDNotFound);
+}
+
+void MetricsNetworkBP :: UDPReceive(const int iRecvLen)
+{
+    METRICS->Count(m_iUDPReceive);
+    METRICS->Record(m_iUDPReceiveRecvLenHistogram, iRecvLen > 0 ? (uint64_t)iRecvLen : 0);
+}
+
+void MetricsNetworkBP :: UDPRealSend(const std::string & sMessage)
+{
+    METRICS->Count(m_iUDPRealSend);
+    METRICS->Record(m_iUDPRealSendMessageHistogram, sMessage.size());
+}
+
+void MetricsNetworkBP :: UDPQueueFull()
+{
+    METRICS->Count(m_iUDPQueueFull);
+}
+
+void MetricsNetworkBP :: SendCoalescedFrame(const int iMsgCount, const int iFrameLen)
+{
+    METRICS->Count(m_iSendCoalescedFrame);
+    METRICS->Record(m_iSendCoalescedFrameMsgCountHistogram, iMsgCount > 0 ? (uint64_t)iMsgCount : 0);
+    METRICS->Record(m_iSendCoalescedFrameLenHistogram, iFrameLen > 0 ? (uint64_t)iFrameLen : 0);
+}
+
+void MetricsNetworkBP :: ReceiveCoalescedFrame(const int iMsgCount)
+{
+    METRICS->Count(m_iReceiveCoalescedFrame);
+    METRICS->Record(m_iReceiveCoalescedFrameMsgCountHistogram, iMsgCount > 0 ? (uint64_t)iMsgCount : 0);
+}
+
+void MetricsNetworkBP :: ReceiveCoalescedFrameError()
+{
+    METRICS->Count(m_iReceiveCoalescedFrameError);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsLogStorageBP :: MetricsLogStorageBP()
+{
+    m_iLevelDBGetNotExist = METRICS->RegisterCounter("phxpaxos_logstorage_leveldb_get_not_exist_total", "LogStorageBP::LevelDBGetNotExist count");
+    m_iLevelDBGetFail = METRICS->RegisterCounter("phxpaxos_logstorage_leveldb_get_fail_total", "LogStorageBP::LevelDBGetFail count");
+    m_iFileIDToValueFail = METRICS->RegisterCounter("phxpaxos_logstorage_file_id_to_value_fail_total", "LogStorageBP::FileIDToValueFail count");
+    m_iValueToFileIDFail = METRICS->RegisterCounter("phxpaxos_logstorage_value_to_file_id_fail_total", "LogStorageBP::ValueToFileIDFail count");
+    m_iLevelDBPutFail = METRICS->RegisterCounter("phxpaxos_logstorage_leveldb_put_fail_total", "LogStorageBP::LevelDBPutFail count");
+    m_iLevelDBPutOK = METRICS->RegisterCounter("phxpaxos_logstorage_leveldb_put_ok_total", "LogStorageBP::LevelDBPutOK count");
+    m_iLevelDBPutOKUseTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_logstorage_leveldb_put_ok_use_time_ms", "LogStorageBP::LevelDBPutOK iUseTimeMs");
+    m_iAppendDataFail = METRICS->RegisterCounter("phxpaxos_logstorage_append_data_fail_total", "LogStorageBP::AppendDataFail count");
+    m_iAppendDataOK = METRICS->RegisterCounter("phxpaxos_logstorage_append_data_ok_total", "LogStorageBP::AppendDataOK count");
+    m_iAppendDataOKWriteLenHistogram = METRICS->RegisterHistogram("phxpaxos_logstorage_append_data_ok_write_len", "LogStorageBP::AppendDataOK iWriteLen");
+    m_iAppendDataOKUseTimeMsHistogram = METRICS->RegisterHistogram("phxpaxos_logstorage_append_data_ok_use_time_ms", "LogStorageBP::AppendDataOK iUseTimeMs");
+    m_iGetFileChecksumNotEquel = METRICS->RegisterCounter("phxpaxos_logstorage_get_file_checksum_not_equel_total", "LogStorageBP::GetFileChecksumNotEquel count");
+    m_iChosenValueCacheHit = METRICS->RegisterCounter("phxpaxos_logstorage_chosen_value_cache_hit_total", "LogStorageBP::ChosenValueCacheHit count");
+    m_iChosenValueCacheMiss = METRICS->RegisterCounter("phxpaxos_logstorage_chosen_value_cache_miss_total", "LogStorageBP::ChosenValueCacheMiss count");
+    m_iRebuildIndexStart = METRICS->RegisterCounter("phxpaxos_logstorage_rebuild_index_start_total", "LogStorageBP::RebuildIndexStart count");
+}
+
+void MetricsLogStorageBP :: LevelDBGetNotExist()
+{
+    METRICS->Count(m_iLevelDBGetNotExist);
+}
+
+void MetricsLogStorageBP :: LevelDBGetFail()
+{
+    METRICS->Count(m_iLevelDBGetFail);
+}
+
+void MetricsLogStorageBP :: FileIDToValueFail()
+{
+    METRICS->Count(m_iFileIDToValueFail);
+}
+
+void MetricsLogStorageBP :: ValueToFileIDFail()
+{
+    METRICS->Count(m_iValueToFileIDFail);
+}
+
+void MetricsLogStorageBP :: LevelDBPutFail()
+{
+    METRICS->Count(m_iLevelDBPutFail);
+}
+
+void MetricsLogStorageBP :: LevelDBPutOK(const int iUseTimeMs)
+{
+    METRICS->Count(m_iLevelDBPutOK);
+    METRICS->Record(m_iLevelDBPutOKUseTimeMsHistogram, iUseTimeMs > 0 ? (uint64_t)iUseTimeMs : 0);
+}
+
+void MetricsLogStorageBP :: AppendDataFail()
+{
+    METRICS->Count(m_iAppendDataFail);
+}
+
+void MetricsLogStorageBP :: AppendDataOK(const int iWriteLen, const int iUseTimeMs)
+{
+    METRICS->Count(m_iAppendDataOK);
+    METRICS->Record(m_iAppendDataOKWriteLenHistogram, iWriteLen > 0 ? (uint64_t)iWriteLen : 0);
+    METRICS->Record(m_iAppendDataOKUseTimeMsHistogram, iUseTimeMs > 0 ? (uint64_t)iUseTimeMs : 0);
+}
+
+void MetricsLogStorageBP :: GetFileChecksumNotEquel()
+{
+    METRICS->Count(m_iGetFileChecksumNotEquel);
+}
+
+void MetricsLogStorageBP :: ChosenValueCacheHit()
+{
+    METRICS->Count(m_iChosenValueCacheHit);
+}
+
+void MetricsLogStorageBP :: ChosenValueCacheMiss()
+{
+    METRICS->Count(m_iChosenValueCacheMiss);
+}
+
+void MetricsLogStorageBP :: RebuildIndexStart(const int iFileID, const int iOffset)
+{
+    METRICS->Count(m_iRebuildIndexStart);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsAlgorithmBaseBP :: MetricsAlgorithmBaseBP()
+{
+    m_iUnPackHeaderLenTooLong = METRICS->RegisterCounter("phxpaxos_algorithm_base_un_pack_header_len_too_long_total", "AlgorithmBaseBP::UnPackHeaderLenTooLong count");
+    m_iUnPackChecksumNotSame = METRICS->RegisterCounter("phxpaxos_algorithm_base_un_pack_checksum_not_same_total", "AlgorithmBaseBP::UnPackChecksumNotSame count");
+    m_iHeaderGidNotSame = METRICS->RegisterCounter("phxpaxos_algorithm_base_header_gid_not_same_total", "AlgorithmBaseBP::HeaderGidNotSame count");
+    m_iValueCompress = METRICS->RegisterCounter("phxpaxos_algorithm_base_value_compress_total", "AlgorithmBaseBP::ValueCompress count");
+    m_iValueCompressRawLenHistogram = METRICS->RegisterHistogram("phxpaxos_algorithm_base_value_compress_raw_len", "AlgorithmBaseBP::ValueCompress iRawLen");
+    m_iValueCompressLenHistogram = METRICS->RegisterHistogram("phxpaxos_algorithm_base_value_compress_len", "AlgorithmBaseBP::ValueCompress iCompressLen");
+    m_iValueCompressUseTimeUsHistogram = METRICS->RegisterHistogram("phxpaxos_algorithm_base_value_compress_use_time_us", "AlgorithmBaseBP::ValueCompress iUseTimeUs");
+    m_iValueCompressSkip = METRICS->RegisterCounter("phxpaxos_algorithm_base_value_compress_skip_total", "AlgorithmBaseBP::ValueCompressSkip count");
+    m_iValueCompressSkipRawLenHistogram = METRICS->RegisterHistogram("phxpaxos_algorithm_base_value_compress_skip_raw_len", "AlgorithmBaseBP::ValueCompressSkip iRawLen");
+    m_iValueDecompress = METRICS->RegisterCounter("phxpaxos_algorithm_base_value_decompress_total", "AlgorithmBaseBP::ValueDecompress count");
+    m_iValueDecompressCompressLenHistogram = METRICS->RegisterHistogram("phxpaxos_algorithm_base_value_decompress_compress_len", "AlgorithmBaseBP::ValueDecompress iCompressLen");
+    m_iValueDecompressRawLenHistogram = METRICS->RegisterHistogram("phxpaxos_algorithm_base_value_decompress_raw_len", "AlgorithmBaseBP::ValueDecompress iRawLen");
+    m_iValueDecompressUseTimeUsHistogram = METRICS->RegisterHistogram("phxpaxos_algorithm_base_value_decompress_use_time_us", "AlgorithmBaseBP::ValueDecompress iUseTimeUs");
+    m_iValueDecompressFail = METRICS->RegisterCounter("phxpaxos_algorithm_base_value_decompress_fail_total", "AlgorithmBaseBP::ValueDecompressFail count");
+}
+
+void MetricsAlgorithmBaseBP :: UnPackHeaderLenTooLong()
+{
+    METRICS->Count(m_iUnPackHeaderLenTooLong);
+}
+
+void MetricsAlgorithmBaseBP :: UnPackChecksumNotSame()
+{
+    METRICS->Count(m_iUnPackChecksumNotSame);
+}
+
+void MetricsAlgorithmBaseBP :: HeaderGidNotSame()
+{
+    METRICS->Count(m_iHeaderGidNotSame);
+}
+
+void MetricsAlgorithmBaseBP :: ValueCompress(const int iRawLen, const int iCompressLen, const int iUseTimeUs)
+{
+    METRICS->Count(m_iValueCompress);
+    METRICS->Record(m_iValueCompressRawLenHistogram, iRawLen > 0 ? (uint64_t)iRawLen : 0);
+    METRICS->Record(m_iValueCompressLenHistogram, iCompressLen > 0 ? (uint64_t)iCompressLen : 0);
+    METRICS->Record(m_iValueCompressUseTimeUsHistogram, iUseTimeUs > 0 ? (uint64_t)iUseTimeUs : 0);
+}
+
+void MetricsAlgorithmBaseBP :: ValueCompressSkip(const int iRawLen)
+{
+    METRICS->Count(m_iValueCompressSkip);
+    METRICS->Record(m_iValueCompressSkipRawLenHistogram, iRawLen > 0 ? (uint64_t)iRawLen : 0);
+}
+
+void MetricsAlgorithmBaseBP :: ValueDecompress(const int iCompressLen, const int iRawLen, const int iUseTimeUs)
+{
+    METRICS->Count(m_iValueDecompress);
+    METRICS->Record(m_iValueDecompressCompressLenHistogram, iCompressLen > 0 ? (uint64_t)iCompressLen : 0);
+    METRICS->Record(m_iValueDecompressRawLenHistogram, iRawLen > 0 ? (uint64_t)iRawLen : 0);
+    METRICS->Record(m_iValueDecompressUseTimeUsHistogram, iUseTimeUs > 0 ? (uint64_t)iUseTimeUs : 0);
+}
+
+void MetricsAlgorithmBaseBP :: ValueDecompressFail()
+{
+    METRICS->Count(m_iValueDecompressFail);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsCheckpointBP :: MetricsCheckpointBP()
+{
+    m_iNeedAskforCheckpoint = METRICS->RegisterCounter("phxpaxos_checkpoint_need_askfor_checkpoint_total", "CheckpointBP::NeedAskforCheckpoint count");
+    m_iSendCheckpointOneBlock = METRICS->RegisterCounter("phxpaxos_checkpoint_send_checkpoint_one_block_total", "CheckpointBP::SendCheckpointOneBlock count");
+    m_iOnSendCheckpointOneBlock = METRICS->RegisterCounter("phxpaxos_checkpoint_on_send_checkpoint_one_block_total", "CheckpointBP::OnSendCheckpointOneBlock count");
+    m_iSendCheckpointBegin = METRICS->RegisterCounter("phxpaxos_checkpoint_send_checkpoint_begin_total", "CheckpointBP::SendCheckpointBegin count");
+    m_iSendCheckpointEnd = METRICS->RegisterCounter("phxpaxos_checkpoint_send_checkpoint_end_total", "CheckpointBP::SendCheckpointEnd count");
+    m_iSendCheckpointResend = METRICS->RegisterCounter("phxpaxos_checkpoint_send_checkpoint_resend_total", "CheckpointBP::SendCheckpointResend count");
+    m_iSendCheckpointReuseFile = METRICS->RegisterCounter("phxpaxos_checkpoint_send_checkpoint_reuse_file_total", "CheckpointBP::SendCheckpointReuseFile count");
+    m_iSendCheckpointThroughput = METRICS->RegisterCounter("phxpaxos_checkpoint_send_checkpoint_throughput_total", "CheckpointBP::SendCheckpointThroughput count");
+    m_iSendCheckpointThroughputKBPerSecondHistogram = METRICS->RegisterHistogram("phxpaxos_checkpoint_send_checkpoint_throughput_kb_per_second", "CheckpointBP::SendCheckpointThroughput iKBPerSecond");
+    m_iReceiveCheckpointDone = METRICS->RegisterCounter("phxpaxos_checkpoint_receive_checkpoint_done_total", "CheckpointBP::ReceiveCheckpointDone count");
+    m_iReceiveCheckpointAndLoadFail = METRICS->RegisterCounter("phxpaxos_checkpoint_receive_checkpoint_and_load_fail_total", "CheckpointBP::ReceiveCheckpointAndLoadFail count");
+    m_iReceiveCheckpointAndLoadSucc = METRICS->RegisterCounter("phxpaxos_checkpoint_receive_checkpoint_and_load_succ_total", "CheckpointBP::ReceiveCheckpointAndLoadSucc count");
+    m_iReplayerPlayBatch = METRICS->RegisterCounter("phxpaxos_checkpoint_replayer_play_batch_total", "CheckpointBP::ReplayerPlayBatch count");
+    m_iReplayerPlayBatchInstanceCountHistogram = METRICS->RegisterHistogram("phxpaxos_checkpoint_replayer_play_batch_instance_count", "CheckpointBP::ReplayerPlayBatch iInstanceCount");
+    m_iReplayerLag = METRICS->RegisterCounter("phxpaxos_checkpoint_replayer_lag_total", "CheckpointBP::ReplayerLag count");
+    m_iReplayerLagInstanceCountHistogram = METRICS->RegisterHistogram("phxpaxos_checkpoint_replayer_lag_instance_count", "CheckpointBP::ReplayerLag llLagInstanceCount");
+}
+
+void MetricsCheckpointBP :: NeedAskforCheckpoint()
+{
+    METRICS->Count(m_iNeedAskforCheckpoint);
+}
+
+void MetricsCheckpointBP :: SendCheckpointOneBlock()
+{
+    METRICS->Count(m_iSendCheckpointOneBlock);
+}
+
+void MetricsCheckpointBP :: OnSendCheckpointOneBlock()
+{
+    METRICS->Count(m_iOnSendCheckpointOneBlock);
+}
+
+void MetricsCheckpointBP :: SendCheckpointBegin()
+{
+    METRICS->Count(m_iSendCheckpointBegin);
+}
+
+void MetricsCheckpointBP :: SendCheckpointEnd()
+{
+    METRICS->Count(m_iSendCheckpointEnd);
+}
+
+void MetricsCheckpointBP :: SendCheckpointResend()
+{
+    METRICS->Count(m_iSendCheckpointResend);
+}
+
+void MetricsCheckpointBP :: SendCheckpointReuseFile()
+{
+    METRICS->Count(m_iSendCheckpointReuseFile);
+}
+
+void MetricsCheckpointBP :: SendCheckpointThroughput(const int iKBPerSecond)
+{
+    METRICS->Count(m_iSendCheckpointThroughput);
+    METRICS->Record(m_iSendCheckpointThroughputKBPerSecondHistogram, iKBPerSecond > 0 ? (uint64_t)iKBPerSecond : 0);
+}
+
+void MetricsCheckpointBP :: ReceiveCheckpointDone()
+{
+    METRICS->Count(m_iReceiveCheckpointDone);
+}
+
+void MetricsCheckpointBP :: ReceiveCheckpointAndLoadFail()
+{
+    METRICS->Count(m_iReceiveCheckpointAndLoadFail);
+}
+
+void MetricsCheckpointBP :: ReceiveCheckpointAndLoadSucc()
+{
+    METRICS->Count(m_iReceiveCheckpointAndLoadSucc);
+}
+
+void MetricsCheckpointBP :: ReplayerPlayBatch(const int iInstanceCount)
+{
+    METRICS->Count(m_iReplayerPlayBatch);
+    METRICS->Record(m_iReplayerPlayBatchInstanceCountHistogram, iInstanceCount > 0 ? (uint64_t)iInstanceCount : 0);
+}
+
+void MetricsCheckpointBP :: ReplayerLag(const uint64_t llLagInstanceCount)
+{
+    METRICS->Count(m_iReplayerLag);
+    METRICS->Record(m_iReplayerLagInstanceCountHistogram, llLagInstanceCount);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsMasterBP :: MetricsMasterBP()
+{
+    m_iTryBeMaster = METRICS->RegisterCounter("phxpaxos_master_try_be_master_total", "MasterBP::TryBeMaster count");
+    m_iTryBeMasterProposeFail = METRICS->RegisterCounter("phxpaxos_master_try_be_master_propose_fail_total", "MasterBP::TryBeMasterProposeFail count");
+    m_iSuccessBeMaster = METRICS->RegisterCounter("phxpaxos_master_success_be_master_total", "MasterBP::SuccessBeMaster count");
+    m_iOtherBeMaster = METRICS->RegisterCounter("phxpaxos_master_other_be_master_total", "MasterBP::OtherBeMaster count");
+    m_iDropMaster = METRICS->RegisterCounter("phxpaxos_master_drop_master_total", "MasterBP::DropMaster count");
+    m_iMasterSMInconsistent = METRICS->RegisterCounter("phxpaxos_master_master_sm_inconsistent_total", "MasterBP::MasterSMInconsistent count");
+    m_iRenewLeaseOK = METRICS->RegisterCounter("phxpaxos_master_renew_lease_ok_total", "MasterBP::RenewLeaseOK count");
+    m_iRenewLeaseFail = METRICS->RegisterCounter("phxpaxos_master_renew_lease_fail_total", "MasterBP::RenewLeaseFail count");
+    m_iQueryLeaseFail = METRICS->RegisterCounter("phxpaxos_master_query_lease_fail_total", "MasterBP::QueryLeaseFail count");
+    m_iGrantLeaseReject = METRICS->RegisterCounter("phxpaxos_master_grant_lease_reject_total", "MasterBP::GrantLeaseReject count");
+    m_iCoordinatorRound = METRICS->RegisterCounter("phxpaxos_master_coordinator_round_total", "MasterBP::CoordinatorRound count");
+    m_iCoordinatorRoundRenewCountHistogram = METRICS->RegisterHistogram("phxpaxos_master_coordinator_round_renew_count", "MasterBP::CoordinatorRound iRenewCount");
+    m_iCoordinatorRoundQueryCountHistogram = METRICS->RegisterHistogram("phxpaxos_master_coordinator_round_query_count", "MasterBP::CoordinatorRound iQueryCount");
+    m_iRebalanceDropMaster = METRICS->RegisterCounter("phxpaxos_master_rebalance_drop_master_total", "MasterBP::RebalanceDropMaster count");
+}
+
+void MetricsMasterBP :: TryBeMaster()
+{
+    METRICS->Count(m_iTryBeMaster);
+}
+
+void MetricsMasterBP :: TryBeMasterProposeFail()
+{
+    METRICS->Count(m_iTryBeMasterProposeFail);
+}
+
+void MetricsMasterBP :: SuccessBeMaster()
+{
+    METRICS->Count(m_iSuccessBeMaster);
+}
+
+void MetricsMasterBP :: OtherBeMaster()
+{
+    METRICS->Count(m_iOtherBeMaster);
+}
+
+void MetricsMasterBP :: DropMaster()
+{
+    METRICS->Count(m_iDropMaster);
+}
+
+void MetricsMasterBP :: MasterSMInconsistent()
+{
+    METRICS->Count(m_iMasterSMInconsistent);
+}
+
+void MetricsMasterBP :: RenewLeaseOK()
+{
+    METRICS->Count(m_iRenewLeaseOK);
+}
+
+void MetricsMasterBP :: RenewLeaseFail()
+{
+    METRICS->Count(m_iRenewLeaseFail);
+}
+
+void MetricsMasterBP :: QueryLeaseFail()
+{
+    METRICS->Count(m_iQueryLeaseFail);
+}
+
+void MetricsMasterBP :: GrantLeaseReject()
+{
+    METRICS->Count(m_iGrantLeaseReject);
+}
+
+void MetricsMasterBP :: CoordinatorRound(const int iRenewCount, const int iQueryCount)
+{
+    METRICS->Count(m_iCoordinatorRound);
+    METRICS->Record(m_iCoordinatorRoundRenewCountHistogram, iRenewCount > 0 ? (uint64_t)iRenewCount : 0);
+    METRICS->Record(m_iCoordinatorRoundQueryCountHistogram, iQueryCount > 0 ? (uint64_t)iQueryCount : 0);
+}
+
+void MetricsMasterBP :: RebalanceDropMaster()
+{
+    METRICS->Count(m_iRebalanceDropMaster);
+}
+
+////////////////////////////////////////////////////////
+
+MetricsBreakpoint :: MetricsBreakpoint()
+{
+}
+
+MetricsBreakpoint * MetricsBreakpoint :: Instance()
+{
+    static MetricsBreakpoint oMetricsBreakpoint;
+    return &oMetricsBreakpoint;
+}
+
+ProposerBP * MetricsBreakpoint :: GetProposerBP()
+{
+    return &m_oMetricsProposerBP;
+}
+
+AcceptorBP * MetricsBreakpoint :: GetAcceptorBP()
+{
+    return &m_oMetricsAcceptorBP;
+}
+
+LearnerBP * MetricsBreakpoint :: GetLearnerBP()
+{
+    return &m_oMetricsLearnerBP;
+}
+
+InstanceBP * MetricsBreakpoint :: GetInstanceBP()
+{
+    return &m_oMetricsInstanceBP;
+}
+
+CommiterBP * MetricsBreakpoint :: GetCommiterBP()
+{
+    return &m_oMetricsCommiterBP;
+}
+
+IOLoopBP * MetricsBreakpoint :: GetIOLoopBP()
+{
+    return &m_oMetricsIOLoopBP;
+}
+
+NetworkBP * MetricsBreakpoint :: GetNetworkBP()
+{
+    return &m_oMetricsNetworkBP;
+}
+
+LogStorageBP * MetricsBreakpoint :: GetLogStorageBP()
+{
+    return &m_oMetricsLogStorageBP;
+}
+
+AlgorithmBaseBP * MetricsBreakpoint :: GetAlgorithmBaseBP()
+{
+    return &m_oMetricsAlgorithmBaseBP;
+}
+
+CheckpointBP * MetricsBreakpoint :: GetCheckpointBP()
+{
+    return &m_oMetricsCheckpointBP;
+}
+
+MasterBP * MetricsBreakpoint :: GetMasterBP()
+{
+    return &m_oMetricsMasterBP;
+}
+
+}
+
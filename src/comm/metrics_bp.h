@@ -0,0 +1,550 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include "phxpaxos/breakpoint.h"
+#include "phxpaxos/def.h"
+#include "commdef.h"
+
+namespace phxpaxos
+{
+
+class MetricsProposerBP : public ProposerBP
+{
+public:
+    MetricsProposerBP();
+
+    void NewProposal(const std::string & sValue);
+    void NewProposalSkipPrepare();
+    void Prepare();
+    void OnPrepareReply();
+    void OnPrepareReplyButNotPreparing();
+    void OnPrepareReplyNotSameProposalIDMsg();
+    void PreparePass(const int iUseTimeMs);
+    void PrepareNotPass();
+    void Accept();
+    void OnAcceptReply();
+    void OnAcceptReplyButNotAccepting();
+    void OnAcceptReplyNotSameProposalIDMsg();
+    void AcceptPass(const int iUseTimeMs);
+    void AcceptNotPass();
+    void PrepareTimeout();
+    void AcceptTimeout();
+    void ConflictBackoff(const int iBackoffMs);
+
+private:
+    int m_iNewProposal;
+    int m_iNewProposalValueHistogram;
+    int m_iNewProposalSkipPrepare;
+    int m_iPrepare;
+    int m_iOnPrepareReply;
+    int m_iOnPrepareReplyButNotPreparing;
+    int m_iOnPrepareReplyNotSameProposalIDMsg;
+    int m_iPreparePass;
+    int m_iPreparePassUseTimeMsHistogram;
+    int m_iPrepareNotPass;
+    int m_iAccept;
+    int m_iOnAcceptReply;
+    int m_iOnAcceptReplyButNotAccepting;
+    int m_iOnAcceptReplyNotSameProposalIDMsg;
+    int m_iAcceptPass;
+    int m_iAcceptPassUseTimeMsHistogram;
+    int m_iAcceptNotPass;
+    int m_iPrepareTimeout;
+    int m_iAcceptTimeout;
+    int m_iConflictBackoff;
+    int m_iConflictBackoffMsHistogram;
+};
+
+class MetricsAcceptorBP : public AcceptorBP
+{
+public:
+    MetricsAcceptorBP();
+
+    void OnPrepare();
+    void OnPreparePass();
+    void OnPreparePersistFail();
+    void OnPrepareReject();
+    void OnAccept();
+    void OnAcceptPass();
+    void OnAcceptPersistFail();
+    void OnAcceptReject();
+
+private:
+    int m_iOnPrepare;
+    int m_iOnPreparePass;
+    int m_iOnPreparePersistFail;
+    int m_iOnPrepareReject;
+    int m_iOnAccept;
+    int m_iOnAcceptPass;
+    int m_iOnAcceptPersistFail;
+    int m_iOnAcceptReject;
+};
+
+class MetricsLearnerBP : public LearnerBP
+{
+public:
+    MetricsLearnerBP();
+
+    void AskforLearn();
+    void OnAskforLearn();
+    void OnAskforLearnGetLockFail();
+    void SendNowInstanceID();
+    void OnSendNowInstanceID();
+    void ComfirmAskForLearn();
+    void OnComfirmAskForLearn();
+    void OnComfirmAskForLearnGetLockFail();
+    void SendLearnValue();
+    void OnSendLearnValue();
+    void SendLearnValue_Ack();
+    void OnSendLearnValue_Ack();
+    void ProposerSendSuccess();
+    void OnProposerSendSuccess();
+    void OnProposerSendSuccessNotAcceptYet();
+    void OnProposerSendSuccessBallotNotSame();
+    void OnProposerSendSuccessSuccessLearn();
+    void SenderAckTimeout();
+    void SenderAckDelay();
+    void SenderSendOnePaxosLog();
+    void SendLearnValueBatch(const int iCount);
+    void OnSendLearnValueBatch(const int iCount);
+    void SenderWindowShrink(const int iWindowBytes);
+    void SenderBackpressure();
+
+private:
+    int m_iAskforLearn;
+    int m_iOnAskforLearn;
+    int m_iOnAskforLearnGetLockFail;
+    int m_iSendNowInstanceID;
+    int m_iOnSendNowInstanceID;
+    int m_iComfirmAskForLearn;
+    int m_iOnComfirmAskForLearn;
+    int m_iOnComfirmAskForLearnGetLockFail;
+    int m_iSendLearnValue;
+    int m_iOnSendLearnValue;
+    int m_iSendLearnValue_Ack;
+    int m_iOnSendLearnValue_Ack;
+    int m_iProposerSendSuccess;
+    int m_iOnProposerSendSuccess;
+    int m_iOnProposerSendSuccessNotAcceptYet;
+    int m_iOnProposerSendSuccessBallotNotSame;
+    int m_iOnProposerSendSuccessSuccessLearn;
+    int m_iSenderAckTimeout;
+    int m_iSenderAckDelay;
+    int m_iSenderSendOnePaxosLog;
+    int m_iSendLearnValueBatch;
+    int m_iSendLearnValueBatchCountHistogram;
+    int m_iOnSendLearnValueBatch;
+    int m_iOnSendLearnValueBatchCountHistogram;
+    int m_iSenderWindowShrink;
+    int m_iSenderWindowShrinkWindowBytesHistogram;
+    int m_iSenderBackpressure;
+};
+
+class MetricsInstanceBP : public InstanceBP
+{
+public:
+    MetricsInstanceBP();
+
+    void NewInstance();
+    void SendMessage();
+    void BroadcastMessage();
+    void OnNewValueCommitTimeout();
+    void OnReceive();
+    void OnReceiveParseError();
+    void OnReceivePaxosMsg();
+    void OnReceivePaxosMsgNodeIDNotValid();
+    void OnReceivePaxosMsgTypeNotValid();
+    void OnReceivePaxosProposerMsgInotsame();
+    void OnReceivePaxosAcceptorMsgInotsame();
+    void OnReceivePaxosAcceptorMsgAddRetry();
+    void OnInstanceLearned();
+    void OnInstanceLearnedNotMyCommit();
+    void OnInstanceLearnedIsMyCommit(const int iUseTimeMs);
+    void OnInstanceLearnedSMExecuteFail();
+    void ChecksumLogicFail();
+
+private:
+    int m_iNewInstance;
+    int m_iSendMessage;
+    int m_iBroadcastMessage;
+    int m_iOnNewValueCommitTimeout;
+    int m_iOnReceive;
+    int m_iOnReceiveParseError;
+    int m_iOnReceivePaxosMsg;
+    int m_iOnReceivePaxosMsgNodeIDNotValid;
+    int m_iOnReceivePaxosMsgTypeNotValid;
+    int m_iOnReceivePaxosProposerMsgInotsame;
+    int m_iOnReceivePaxosAcceptorMsgInotsame;
+    int m_iOnReceivePaxosAcceptorMsgAddRetry;
+    int m_iOnInstanceLearned;
+    int m_iOnInstanceLearnedNotMyCommit;
+    int m_iOnInstanceLearnedIsMyCommit;
+    int m_iOnInstanceLearnedIsMyCommitUseTimeMsHistogram;
+    int m_iOnInstanceLearnedSMExecuteFail;
+    int m_iChecksumLogicFail;
+};
+
+class MetricsCommiterBP : public CommiterBP
+{
+public:
+    MetricsCommiterBP();
+
+    void NewValue();
+    void NewValueConflict();
+    void NewValueGetLockTimeout();
+    void NewValueGetLockReject();
+    void NewValueGetLockOK(const int iUseTimeMs);
+    void NewValueCommitOK(const int iUseTimeMs);
+    void NewValueCommitFail();
+    void NewValueWaitQueueDepth(const int iQueueDepth);
+    void NewValueWaitSojournTimeMs(const int iSojournTimeMs);
+    void BatchPropose();
+    void BatchProposeOK();
+    void BatchProposeFail();
+    void BatchProposeWaitTimeMs(const int iWaitTimeMs);
+    void BatchProposeDoPropose(const int iBatchCount);
+    void CoalescePropose(const int iCoalesceCount);
+    void ForwardPropose();
+    void ForwardProposeOK(const int iUseTimeMs);
+    void ForwardProposeFail();
+    void OnForwardPropose();
+    void OnForwardProposeRejectByFullQueue();
+    void OnForwardProposeRejectByNotMaster();
+    void CommitStageUseTimeUS(const int iGroupIdx, const int iStage, const uint64_t llP50UseTimeUS, const uint64_t llP99UseTimeUS, const uint64_t llMaxUseTimeUS);
+
+private:
+    int m_iNewValue;
+    int m_iNewValueConflict;
+    int m_iNewValueGetLockTimeout;
+    int m_iNewValueGetLockReject;
+    int m_iNewValueGetLockOK;
+    int m_iNewValueGetLockOKUseTimeMsHistogram;
+    int m_iNewValueCommitOK;
+    int m_iNewValueCommitOKUseTimeMsHistogram;
+    int m_iNewValueCommitFail;
+    int m_iNewValueWaitQueueDepth;
+    int m_iNewValueWaitQueueDepthHistogram;
+    int m_iNewValueWaitSojournTimeMs;
+    int m_iNewValueWaitSojournTimeMsHistogram;
+    int m_iBatchPropose;
+    int m_iBatchProposeOK;
+    int m_iBatchProposeFail;
+    int m_iBatchProposeWaitTimeMs;
+    int m_iBatchProposeWaitTimeMsHistogram;
+    int m_iBatchProposeDoPropose;
+    int m_iBatchProposeDoProposeBatchCountHistogram;
+    int m_iCoalescePropose;
+    int m_iCoalesceProposeCoalesceCountHistogram;
+    int m_iForwardPropose;
+    int m_iForwardProposeOK;
+    int m_iForwardProposeOKUseTimeMsHistogram;
+    int m_iForwardProposeFail;
+    int m_iOnForwardPropose;
+    int m_iOnForwardProposeRejectByFullQueue;
+    int m_iOnForwardProposeRejectByNotMaster;
+    int m_iCommitStageUseTimeUS;
+    int m_arrCommitStageP50Gauge[CommitStage_Count];
+    int m_arrCommitStageP99Gauge[CommitStage_Count];
+    int m_arrCommitStageMaxGauge[CommitStage_Count];
+};
+
+class MetricsIOLoopBP : public IOLoopBP
+{
+public:
+    MetricsIOLoopBP();
+
+    void OneLoop();
+    void EnqueueMsg();
+    void EnqueueMsgRejectByFullQueue();
+    void EnqueueRetryMsg();
+    void EnqueueRetryMsgRejectByFullQueue();
+    void OutQueueMsg();
+    void DealWithRetryMsg();
+    void RunTask(const int iMsgCount);
+    void StealTask();
+    void MsgQueueAdd(const int iMsgClass);
+    void MsgQueuePop(const int iMsgClass);
+
+private:
+    int m_iOneLoop;
+    int m_iEnqueueMsg;
+    int m_iEnqueueMsgRejectByFullQueue;
+    int m_iEnqueueRetryMsg;
+    int m_iEnqueueRetryMsgRejectByFullQueue;
+    int m_iOutQueueMsg;
+    int m_iDealWithRetryMsg;
+    int m_iRunTask;
+    int m_iRunTaskMsgCountHistogram;
+    int m_iStealTask;
+    int m_arrMsgQueueDepthGauge[IOLoopMsgClass_Count];
+};
+
+class MetricsNetworkBP : public NetworkBP
+{
+public:
+    MetricsNetworkBP();
+
+    void TcpEpollLoop();
+    void TcpOnError();
+    void TcpAcceptFd();
+    void TcpQueueFull();
+    void TcpReadOneMessageOk(const int iLen);
+    void TcpOnReadMessageLenError();
+    void TcpReconnect();
+    void TcpOutQueue(const int iDelayMs);
+    void TcpOutQueueDrop();
+    void TcpCreditStall();
+    void TcpCreditGrant(const int iGroupCount);
+    void SendRejectByTooLargeSize();
+    void Send(const std::string & sMessage);
+    void SendTcp(const std::string & sMessage);
+    void SendUdp(const std::string & sMessage);
+    void SendMessageNodeIDNotFound();
+    void UDPReceive(const int iRecvLen);
+    void UDPRealSend(const std::string & sMessage);
+    void UDPQueueFull();
+    void SendCoalescedFrame(const int iMsgCount, const int iFrameLen);
+    void ReceiveCoalescedFrame(const int iMsgCount);
+    void ReceiveCoalescedFrameError();
+
+private:
+    int m_iTcpEpollLoop;
+    int m_iTcpOnError;
+    int m_iTcpAcceptFd;
+    int m_iTcpQueueFull;
+    int m_iTcpReadOneMessageOk;
+    int m_iTcpReadOneMessageOkLenHistogram;
+    int m_iTcpOnReadMessageLenError;
+    int m_iTcpReconnect;
+    int m_iTcpOutQueue;
+    int m_iTcpOutQueueDelayMsHistogram;
+    int m_iTcpOutQueueDrop;
+    int m_iTcpCreditStall;
+    int m_iTcpCreditGrant;
+    int m_iTcpCreditGrantGroupCountHistogram;
+    int m_iSendRejectByTooLargeSize;
+    int m_iSend;
+    int m_iSendMessageHistogram;
+    int m_iSendTcp;
+    int m_iSendTcpMessageHistogram;
+    int m_iSendUdp;
+    int m_iSendUdpMessageHistogram;
+    int m_iSendMessageNodeIDNotFound;
+    int m_iUDPReceive;
+    int m_iUDPReceiveRecvLenHistogram;
+    int m_iUDPRealSend;
+    int m_iUDPRealSendMessageHistogram;
+    int m_iUDPQueueFull;
+    int m_iSendCoalescedFrame;
+    int m_iSendCoalescedFrameMsgCountHistogram;
+    int m_iSendCoalescedFrameLenHistogram;
+    int m_iReceiveCoalescedFrame;
+    int m_iReceiveCoalescedFrameMsgCountHistogram;
+    int m_iReceiveCoalescedFrameError;
+};
+
+class MetricsLogStorageBP : public LogStorageBP
+{
+public:
+    MetricsLogStorageBP();
+
+    void LevelDBGetNotExist();
+    void LevelDBGetFail();
+    void FileIDToValueFail();
+    void ValueToFileIDFail();
+    void LevelDBPutFail();
+    void LevelDBPutOK(const int iUseTimeMs);
+    void AppendDataFail();
+    void AppendDataOK(const int iWriteLen, const int iUseTimeMs);
+    void GetFileChecksumNotEquel();
+    void ChosenValueCacheHit();
+    void ChosenValueCacheMiss();
+    void RebuildIndexStart(const int iFileID, const int iOffset);
+
+private:
+    int m_iLevelDBGetNotExist;
+    int m_iLevelDBGetFail;
+    int m_iFileIDToValueFail;
+    int m_iValueToFileIDFail;
+    int m_iLevelDBPutFail;
+    int m_iLevelDBPutOK;
+    int m_iLevelDBPutOKUseTimeMsHistogram;
+    int m_iAppendDataFail;
+    int m_iAppendDataOK;
+    int m_iAppendDataOKWriteLenHistogram;
+    int m_iAppendDataOKUseTimeMsHistogram;
+    int m_iGetFileChecksumNotEquel;
+    int m_iChosenValueCacheHit;
+    int m_iChosenValueCacheMiss;
+    int m_iRebuildIndexStart;
+};
+
+class MetricsAlgorithmBaseBP : public AlgorithmBaseBP
+{
+public:
+    MetricsAlgorithmBaseBP();
+
+    void UnPackHeaderLenTooLong();
+    void UnPackChecksumNotSame();
+    void HeaderGidNotSame();
+    void ValueCompress(const int iRawLen, const int iCompressLen, const int iUseTimeUs);
+    void ValueCompressSkip(const int iRawLen);
+    void ValueDecompress(const int iCompressLen, const int iRawLen, const int iUseTimeUs);
+    void ValueDecompressFail();
+
+private:
+    int m_iUnPackHeaderLenTooLong;
+    int m_iUnPackChecksumNotSame;
+    int m_iHeaderGidNotSame;
+    int m_iValueCompress;
+    int m_iValueCompressRawLenHistogram;
+    int m_iValueCompressLenHistogram;
+    int m_iValueCompressUseTimeUsHistogram;
+    int m_iValueCompressSkip;
+    int m_iValueCompressSkipRawLenHistogram;
+    int m_iValueDecompress;
+    int m_iValueDecompressCompressLenHistogram;
+    int m_iValueDecompressRawLenHistogram;
+    int m_iValueDecompressUseTimeUsHistogram;
+    int m_iValueDecompressFail;
+};
+
+class MetricsCheckpointBP : public CheckpointBP
+{
+public:
+    MetricsCheckpointBP();
+
+    void NeedAskforCheckpoint();
+    void SendCheckpointOneBlock();
+    void OnSendCheckpointOneBlock();
+    void SendCheckpointBegin();
+    void SendCheckpointEnd();
+    void SendCheckpointResend();
+    void SendCheckpointReuseFile();
+    void SendCheckpointThroughput(const int iKBPerSecond);
+    void ReceiveCheckpointDone();
+    void ReceiveCheckpointAndLoadFail();
+    void ReceiveCheckpointAndLoadSucc();
+    void ReplayerPlayBatch(const int iInstanceCount);
+    void ReplayerLag(const uint64_t llLagInstanceCount);
+
+private:
+    int m_iNeedAskforCheckpoint;
+    int m_iSendCheckpointOneBlock;
+    int m_iOnSendCheckpointOneBlock;
+    int m_iSendCheckpointBegin;
+    int m_iSendCheckpointEnd;
+    int m_iSendCheckpointResend;
+    int m_iSendCheckpointReuseFile;
+    int m_iSendCheckpointThroughput;
+    int m_iSendCheckpointThroughputKBPerSecondHistogram;
+    int m_iReceiveCheckpointDone;
+    int m_iReceiveCheckpointAndLoadFail;
+    int m_iReceiveCheckpointAndLoadSucc;
+    int m_iReplayerPlayBatch;
+    int m_iReplayerPlayBatchInstanceCountHistogram;
+    int m_iReplayerLag;
+    int m_iReplayerLagInstanceCountHistogram;
+};
+
+class MetricsMasterBP : public MasterBP
+{
+public:
+    MetricsMasterBP();
+
+    void TryBeMaster();
+    void TryBeMasterProposeFail();
+    void SuccessBeMaster();
+    void OtherBeMaster();
+    void DropMaster();
+    void MasterSMInconsistent();
+    void RenewLeaseOK();
+    void RenewLeaseFail();
+    void QueryLeaseFail();
+    void GrantLeaseReject();
+    void CoordinatorRound(const int iRenewCount, const int iQueryCount);
+    void RebalanceDropMaster();
+
+private:
+    int m_iTryBeMaster;
+    int m_iTryBeMasterProposeFail;
+    int m_iSuccessBeMaster;
+    int m_iOtherBeMaster;
+    int m_iDropMaster;
+    int m_iMasterSMInconsistent;
+    int m_iRenewLeaseOK;
+    int m_iRenewLeaseFail;
+    int m_iQueryLeaseFail;
+    int m_iGrantLeaseReject;
+    int m_iCoordinatorRound;
+    int m_iCoordinatorRoundRenewCountHistogram;
+    int m_iCoordinatorRoundQueryCountHistogram;
+    int m_iRebalanceDropMaster;
+};
+
+//Built-in breakpoint, count every event to MetricsRegistry.
+class MetricsBreakpoint : public Breakpoint
+{
+public:
+    MetricsBreakpoint();
+
+    static MetricsBreakpoint * Instance();
+
+    ProposerBP * GetProposerBP();
+
+    AcceptorBP * GetAcceptorBP();
+
+    LearnerBP * GetLearnerBP();
+
+    InstanceBP * GetInstanceBP();
+
+    CommiterBP * GetCommiterBP();
+
+    IOLoopBP * GetIOLoopBP();
+
+    NetworkBP * GetNetworkBP();
+
+    LogStorageBP * GetLogStorageBP();
+
+    AlgorithmBaseBP * GetAlgorithmBaseBP();
+
+    CheckpointBP * GetCheckpointBP();
+
+    MasterBP * GetMasterBP();
+
+private:
+    MetricsProposerBP m_oMetricsProposerBP;
+    MetricsAcceptorBP m_oMetricsAcceptorBP;
+    MetricsLearnerBP m_oMetricsLearnerBP;
+    MetricsInstanceBP m_oMetricsInstanceBP;
+    MetricsCommiterBP m_oMetricsCommiterBP;
+    MetricsIOLoopBP m_oMetricsIOLoopBP;
+    MetricsNetworkBP m_oMetricsNetworkBP;
+    MetricsLogStorageBP m_oMetricsLogStorageBP;
+    MetricsAlgorithmBaseBP m_oMetricsAlgorithmBaseBP;
+    MetricsCheckpointBP m_oMetricsCheckpointBP;
+    MetricsMasterBP m_oMetricsMasterBP;
+};
+    
+}
@@ -0,0 +1,120 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "msg_class.h"
+#include <google/protobuf/io/coded_stream.h>
+
+namespace phxpaxos
+{
+
+int MsgClass :: ParseHeader(const char * pcMessage, const int iMessageLen, Header & oHeader)
+{
+    size_t iHeaderStartPos = GROUPIDXLEN + HEADLEN_LEN;
+    if ((size_t)iMessageLen <= iHeaderStartPos)
+    {
+        return -1;
+    }
+
+    uint16_t iHeaderLen = 0;
+    memcpy(&iHeaderLen, pcMessage + GROUPIDXLEN, HEADLEN_LEN);
+
+    size_t iBodyStartPos = iHeaderStartPos + iHeaderLen;
+    if (iBodyStartPos > (size_t)iMessageLen)
+    {
+        return -1;
+    }
+
+    if (!oHeader.ParseFromArray(pcMessage + iHeaderStartPos, iHeaderLen))
+    {
+        return -1;
+    }
+
+    return (int)iBodyStartPos;
+}
+
+bool MsgClass :: PeekBodyMsgType(const char * pcMessage, const int iMessageLen, 
+        const int iBodyStartPos, int & iMsgType)
+{
+    google::protobuf::io::CodedInputStream oInput(
+            (const uint8_t *)pcMessage + iBodyStartPos, iMessageLen - iBodyStartPos);
+    uint32_t iValue = 0;
+    if (oInput.ReadTag() != (1 << 3) || !oInput.ReadVarint32(&iValue))
+    {
+        return false;
+    }
+
+    iMsgType = (int)iValue;
+    return true;
+}
+
+bool MsgClass :: IsBulkMessage(const std::string & sMessage)
+{
+    const char * pcMessage = sMessage.data();
+    int iMessageLen = (int)sMessage.size();
+
+    Header oHeader;
+    int iBodyStartPos = ParseHeader(pcMessage, iMessageLen, oHeader);
+    if (iBodyStartPos < 0)
+    {
+        return false;
+    }
+
+    int iMsgType = 0;
+    if (!PeekBodyMsgType(pcMessage, iMessageLen, iBodyStartPos, iMsgType))
+    {
+        return false;
+    }
+
+    if (oHeader.cmdid() == MsgCmd_PaxosMsg)
+    {
+        return iMsgType == MsgType_PaxosLearner_SendLearnValue
+            || iMsgType == MsgType_PaxosLearner_SendLearnValueBatch;
+    }
+
+    if (oHeader.cmdid() != MsgCmd_CheckpointMsg || iMsgType != CheckpointMsgType_SendFile)
+    {
+        return false;
+    }
+
+    //begin/end of a checkpoint are not retried, only file chunks are.
+    //fields 1-3 are MsgType, NodeID, Flag, serialized in order.
+    google::protobuf::io::CodedInputStream oInput(
+            (const uint8_t *)pcMessage + iBodyStartPos, iMessageLen - iBodyStartPos);
+    uint32_t iTag = 0;
+    while ((iTag = oInput.ReadTag()) != 0 && (iTag >> 3) <= 3)
+    {
+        uint64_t llValue = 0;
+        if ((iTag & 0x7) != 0 || !oInput.ReadVarint64(&llValue))
+        {
+            return false;
+        }
+
+        if ((iTag >> 3) == 3)
+        {
+            return llValue == CheckpointSendFileFlag_ING || llValue == CheckpointSendFileFlag_REUSE;
+        }
+    }
+
+    return false;
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <string>
+#include "comm_include.h"
+
+namespace phxpaxos
+{
+
+//Peek at the header and the first fields of a packed message without parsing the body.
+class MsgClass
+{
+public:
+    //return body start pos, or -1 if the header is broken.
+    static int ParseHeader(const char * pcMessage, const int iMessageLen, Header & oHeader);
+
+    //PaxosMsg.MsgType and CheckpointMsg.MsgType are both field 1, serialized first.
+    static bool PeekBodyMsgType(const char * pcMessage, const int iMessageLen, 
+            const int iBodyStartPos, int & iMsgType);
+
+    //catch up data that the sender waits and retries on backpressure: 
+    //learn values and checkpoint file chunks.
+    static bool IsBulkMessage(const std::string & sMessage);
+};
+
+}
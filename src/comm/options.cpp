@@ -103,6 +103,7 @@ GroupSMInfo :: GroupSMInfo()
 {
     iGroupIdx = -1;
     bIsUseMaster = false;
+    iValueCompressThreshold = 0;
 }
 
 /////////////////////////////////////////////////////////////
@@ -115,17 +116,30 @@ Options :: Options()
     poNetWork = nullptr;
     iUDPMaxSize = 4096;
     iIOThreadCount = 1;
+    iTcpBusyPollUs = 0;
+    iCoalesceDelayUs = 0;
+    iTcpCreditWindowBytes = 0;
     iGroupCount = 1;
+    iIOLoopThreadCount = 0;
     bUseMembership = false;
     pMembershipChangeCallback = nullptr;
     pMasterChangeCallback = nullptr;
     poBreakpoint = nullptr;
     bIsLargeValueMode = false;
+    iValueChunkSize = 0;
     pLogFunc = nullptr;
     eLogLevel = LogLevel::LogLevel_None;
     bUseCheckpointReplayer = false;
+    bUseCheckpointBulkTransfer = false;
     bUseBatchPropose = false;
+    bUseProposeCoalesce = false;
+    bUseProposeForward = false;
+    iChosenValueCacheCount = 0;
     bOpenChangeValueBeforePropose = false;
+    bUseMetrics = false;
+    bUseMasterHeartbeatLease = false;
+    bUseMasterCoordinator = false;
+    eMasterDistributionPolicy = MasterDistributionPolicy_Even;
 }
     
 }
@@ -26,12 +26,20 @@ See the AUTHORS file for names of contributors.
 namespace phxpaxos
 {
 
+PeerEndpoint :: PeerEndpoint(const nodeid_t iNodeID)
+    : oNodeInfo(iNodeID), llSendCount(0), llSendBytes(0), llSendFailCount(0)
+{
+}
+
+//////////////////////////////////////////////////////////////
+
 Communicate :: Communicate(
         const Config * poConfig,
         const nodeid_t iMyNodeID, 
         const int iUDPMaxSize,
         NetWork * poNetwork)
-    : m_poConfig((Config *)poConfig), m_poNetwork(poNetwork), m_iMyNodeID(iMyNodeID), m_iUDPMaxSize(iUDPMaxSize)
+    : m_poConfig((Config *)poConfig), m_poNetwork(poNetwork), m_iMyNodeID(iMyNodeID), m_iUDPMaxSize(iUDPMaxSize),
+    m_poEndpointTable(std::make_shared<EndpointTable>())
 {
 }
 
@@ -39,8 +47,8 @@ Communicate :: ~Communicate()
 {
 }
 
-int Communicate :: Send(const int iGroupIdx, const nodeid_t iNodeID, 
-        const NodeInfo & oNodeInfo, const std::string & sMessage, const int iSendType)
+int Communicate :: Send(const int iGroupIdx, PeerEndpoint & oPeerEndpoint, 
+        const std::string & sMessage, const int iSendType)
 {
     if ((int)sMessage.size() > MAX_VALUE_SIZE)
     {
@@ -51,34 +59,113 @@ int Communicate :: Send(const int iGroupIdx, const nodeid_t iNodeID,
     }
 
     BP->GetNetworkBP()->Send(sMessage);
+
+    const NodeInfo & oNodeInfo = oPeerEndpoint.oNodeInfo;
+    int ret = 0;
     
     if (sMessage.size() > m_iUDPMaxSize || iSendType == Message_SendType_TCP)
     {
         BP->GetNetworkBP()->SendTcp(sMessage);
-        return m_poNetwork->SendMessageTCP(iGroupIdx, oNodeInfo.GetIP(), oNodeInfo.GetPort(), sMessage);
+        ret = m_poNetwork->SendMessageTCP(iGroupIdx, oNodeInfo.GetIP(), oNodeInfo.GetPort(), sMessage);
     }
     else
     {
         BP->GetNetworkBP()->SendUdp(sMessage);
-        return m_poNetwork->SendMessageUDP(iGroupIdx, oNodeInfo.GetIP(), oNodeInfo.GetPort(), sMessage);
+        ret = m_poNetwork->SendMessageUDP(iGroupIdx, oNodeInfo.GetIP(), oNodeInfo.GetPort(), sMessage);
+    }
+
+    oPeerEndpoint.llSendCount++;
+    oPeerEndpoint.llSendBytes += sMessage.size();
+    if (ret != 0)
+    {
+        oPeerEndpoint.llSendFailCount++;
+    }
+
+    return ret;
+}
+
+std::shared_ptr<PeerEndpoint> Communicate :: GetPeerEndpoint(const nodeid_t iNodeID)
+{
+    std::shared_ptr<const EndpointTable> poTable = std::atomic_load(&m_poEndpointTable);
+    auto it = poTable->mapEndpoint.find(iNodeID);
+    if (it != end(poTable->mapEndpoint))
+    {
+        return it->second;
+    }
+
+    //follower or temp node not in membership, add it once.
+    std::lock_guard<std::mutex> oLockGuard(m_oEndpointMutex);
+
+    poTable = std::atomic_load(&m_poEndpointTable);
+    it = poTable->mapEndpoint.find(iNodeID);
+    if (it != end(poTable->mapEndpoint))
+    {
+        return it->second;
+    }
+
+    std::shared_ptr<EndpointTable> poNewTable = std::make_shared<EndpointTable>(*poTable);
+    std::shared_ptr<PeerEndpoint> poPeerEndpoint = std::make_shared<PeerEndpoint>(iNodeID);
+    poNewTable->mapEndpoint[iNodeID] = poPeerEndpoint;
+    std::atomic_store(&m_poEndpointTable, std::shared_ptr<const EndpointTable>(poNewTable));
+
+    return poPeerEndpoint;
+}
+
+void Communicate :: OnMembershipChange(const std::set<nodeid_t> & setNodeID)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oEndpointMutex);
+
+    std::shared_ptr<const EndpointTable> poTable = std::atomic_load(&m_poEndpointTable);
+    std::shared_ptr<EndpointTable> poNewTable = std::make_shared<EndpointTable>();
+
+    //keep endpoints of nodes still in membership, their stats go on.
+    for (auto & iNodeID : setNodeID)
+    {
+        auto it = poTable->mapEndpoint.find(iNodeID);
+        std::shared_ptr<PeerEndpoint> poPeerEndpoint = it != end(poTable->mapEndpoint) ?
+            it->second : std::make_shared<PeerEndpoint>(iNodeID);
+
+        poNewTable->mapEndpoint[iNodeID] = poPeerEndpoint;
+        if (iNodeID != m_iMyNodeID)
+        {
+            poNewTable->vecMember.push_back(poPeerEndpoint);
+        }
     }
+
+    std::atomic_store(&m_poEndpointTable, std::shared_ptr<const EndpointTable>(poNewTable));
+
+    PLGHead("membership %zu nodes, endpoint table refleshed", setNodeID.size());
+}
+
+int Communicate :: GetPeerSendStat(const nodeid_t iNodeID, uint64_t & llSendCount, 
+        uint64_t & llSendBytes, uint64_t & llSendFailCount)
+{
+    std::shared_ptr<const EndpointTable> poTable = std::atomic_load(&m_poEndpointTable);
+    auto it = poTable->mapEndpoint.find(iNodeID);
+    if (it == end(poTable->mapEndpoint))
+    {
+        return 1;
+    }
+
+    llSendCount = it->second->llSendCount;
+    llSendBytes = it->second->llSendBytes;
+    llSendFailCount = it->second->llSendFailCount;
+
+    return 0;
 }
 
 int Communicate :: SendMessage(const int iGroupIdx, const nodeid_t iSendtoNodeID, const std::string & sMessage, const int iSendType)
 {
-    return Send(iGroupIdx, iSendtoNodeID, NodeInfo(iSendtoNodeID), sMessage, iSendType);
+    return Send(iGroupIdx, *GetPeerEndpoint(iSendtoNodeID), sMessage, iSendType);
 }
 
 int Communicate :: BroadcastMessage(const int iGroupIdx, const std::string & sMessage, const int iSendType)
 {
-    const std::set<nodeid_t> & setNodeInfo = m_poConfig->GetSystemVSM()->GetMembershipMap();
+    std::shared_ptr<const EndpointTable> poTable = std::atomic_load(&m_poEndpointTable);
     
-    for (auto & it : setNodeInfo)
+    for (auto & poPeerEndpoint : poTable->vecMember)
     {
-        if (it != m_iMyNodeID)
-        {
-            Send(iGroupIdx, it, NodeInfo(it), sMessage, iSendType);
-        }
+        Send(iGroupIdx, *poPeerEndpoint, sMessage, iSendType);
     }
 
     return 0;
@@ -92,7 +179,7 @@ int Communicate :: BroadcastMessageFollower(const int iGroupIdx, const std::stri
     {
         if (it.first != m_iMyNodeID)
         {
-            Send(iGroupIdx, it.first, NodeInfo(it.first), sMessage, iSendType);
+            Send(iGroupIdx, *GetPeerEndpoint(it.first), sMessage, iSendType);
         }
     }
     
@@ -109,7 +196,7 @@ int Communicate :: BroadcastMessageTempNode(const int iGroupIdx, const std::stri
     {
         if (it.first != m_iMyNodeID)
         {
-            Send(iGroupIdx, it.first, NodeInfo(it.first), sMessage, iSendType);
+            Send(iGroupIdx, *GetPeerEndpoint(it.first), sMessage, iSendType);
         }
     }
     
@@ -24,13 +24,30 @@ See the AUTHORS file for names of contributors.
 #include "phxpaxos/network.h"
 #include "phxpaxos/options.h"
 #include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include "msg_transport.h"
 #include "config_include.h"
 
 namespace phxpaxos
 {
 
-class Communicate : public MsgTransport
+//Resolved once per node, send path use it without parse nodeid again.
+class PeerEndpoint
+{
+public:
+    PeerEndpoint(const nodeid_t iNodeID);
+
+    const NodeInfo oNodeInfo;
+
+    std::atomic<uint64_t> llSendCount;
+    std::atomic<uint64_t> llSendBytes;
+    std::atomic<uint64_t> llSendFailCount;
+};
+
+class Communicate : public MsgTransport, public MembershipListener
 {
 public:
     Communicate(
@@ -55,9 +72,24 @@ public:
 public:
     void SetUDPMaxSize(const size_t iUDPMaxSize);
 
+    void OnMembershipChange(const std::set<nodeid_t> & setNodeID);
+
+    //return 1 if never send to this node.
+    int GetPeerSendStat(const nodeid_t iNodeID, uint64_t & llSendCount, 
+            uint64_t & llSendBytes, uint64_t & llSendFailCount);
+
 private:
-    int Send(const int iGroupIdx, const nodeid_t iNodeID, 
-            const NodeInfo & tNodeInfo, const std::string & sMessage, const int iSendType);
+    int Send(const int iGroupIdx, PeerEndpoint & oPeerEndpoint, 
+            const std::string & sMessage, const int iSendType);
+
+    std::shared_ptr<PeerEndpoint> GetPeerEndpoint(const nodeid_t iNodeID);
+
+    struct EndpointTable
+    {
+        std::map<nodeid_t, std::shared_ptr<PeerEndpoint> > mapEndpoint;
+        //members except me, for broadcast.
+        std::vector<std::shared_ptr<PeerEndpoint> > vecMember;
+    };
 
 private:
     Config * m_poConfig;
@@ -65,6 +97,10 @@ private:
 
     nodeid_t m_iMyNodeID;
     size_t m_iUDPMaxSize; 
+
+    //copy on write, readers load it without lock.
+    std::shared_ptr<const EndpointTable> m_poEndpointTable;
+    std::mutex m_oEndpointMutex;
 };
     
 }
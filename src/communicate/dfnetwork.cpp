@@ -21,11 +21,13 @@ See the AUTHORS file for names of contributors.
 
 #include "dfnetwork.h"
 #include "udp.h"
+#include "msg_transport.h"
+#include "msg_class.h"
 
 namespace phxpaxos 
 {
 
-DFNetWork :: DFNetWork() : m_oUDPRecv(this), m_oTcpIOThread(this)
+DFNetWork :: DFNetWork() : m_oMsgCoalescer(this), m_oUDPRecv(this), m_oTcpIOThread(this)
 {
 }
 
@@ -36,12 +38,15 @@ DFNetWork :: ~DFNetWork()
 
 void DFNetWork :: StopNetWork()
 {
+    //flush pending frames before senders stop.
+    m_oMsgCoalescer.Stop();
     m_oUDPRecv.Stop();
     m_oUDPSend.Stop();
     m_oTcpIOThread.Stop();
 }
 
-int DFNetWork :: Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount) 
+int DFNetWork :: Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount, const int iBusyPollUs,
+        const int iCoalesceDelayUs, const int iUDPMaxSize) 
 {
     int ret = m_oUDPSend.Init();
     if (ret != 0)
@@ -55,13 +60,20 @@ int DFNetWork :: Init(const std::string & sListenIp, const int iListenPort, cons
         return ret;
     }
 
-    ret = m_oTcpIOThread.Init(sListenIp, iListenPort, iIOThreadCount);
+    ret = m_oTcpIOThread.Init(sListenIp, iListenPort, iIOThreadCount, iBusyPollUs);
     if (ret != 0)
     {
         PLErr("m_oTcpIOThread Init fail, ret %d", ret);
         return ret;
     }
 
+    ret = m_oMsgCoalescer.Init(iCoalesceDelayUs, iUDPMaxSize, iIOThreadCount);
+    if (ret != 0)
+    {
+        PLErr("m_oMsgCoalescer Init fail, ret %d", ret);
+        return ret;
+    }
+
     return 0;
 }
 
@@ -70,15 +82,43 @@ void DFNetWork :: RunNetWork()
     m_oUDPSend.start();
     m_oUDPRecv.start();
     m_oTcpIOThread.Start();
+
+    if (m_oMsgCoalescer.IsOpen())
+    {
+        m_oMsgCoalescer.start();
+    }
 }
 
 int DFNetWork :: SendMessageTCP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage)
 {
-    return m_oTcpIOThread.AddMessage(iGroupIdx, sIp, iPort, sMessage);
+    if (m_oMsgCoalescer.IsOpen())
+    {
+        return m_oMsgCoalescer.AddMessage(iGroupIdx, sIp, iPort, sMessage, Message_SendType_TCP);
+    }
+
+    //only bulk catch up data wait for credit, consensus messages must not be rejected,
+    //their senders don't retry and the instance would stall until timeout.
+    return m_oTcpIOThread.AddMessage(iGroupIdx, sIp, iPort, sMessage, MsgClass::IsBulkMessage(sMessage));
 }
 
 int DFNetWork :: SendMessageUDP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage)
 {
+    if (m_oMsgCoalescer.IsOpen())
+    {
+        return m_oMsgCoalescer.AddMessage(iGroupIdx, sIp, iPort, sMessage, Message_SendType_UDP);
+    }
+
+    return m_oUDPSend.AddMessage(sIp, iPort, sMessage);
+}
+
+int DFNetWork :: SendFrame(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage, const int iSendType)
+{
+    if (iSendType == Message_SendType_TCP)
+    {
+        //coalesced messages already returned ok to the caller, can't reject them here.
+        return m_oTcpIOThread.AddMessage(iGroupIdx, sIp, iPort, sMessage, false);
+    }
+
     return m_oUDPSend.AddMessage(sIp, iPort, sMessage);
 }
 
@@ -24,6 +24,7 @@ See the AUTHORS file for names of contributors.
 #include <string>
 #include "udp.h"
 #include "tcp.h"
+#include "msg_coalescer.h"
 #include "phxpaxos/network.h"
 
 namespace phxpaxos 
@@ -35,7 +36,8 @@ public:
     DFNetWork();
     virtual ~DFNetWork();
 
-    int Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount);
+    int Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount, const int iBusyPollUs,
+            const int iCoalesceDelayUs, const int iUDPMaxSize);
 
     void RunNetWork();
 
@@ -45,7 +47,11 @@ public:
 
     int SendMessageUDP(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage);
 
+    //Send without coalesce, used by MsgCoalescer.
+    int SendFrame(const int iGroupIdx, const std::string & sIp, const int iPort, const std::string & sMessage, const int iSendType);
+
 private:
+    MsgCoalescer m_oMsgCoalescer;
     UDPRecv m_oUDPRecv;
     UDPSend m_oUDPSend;
     TcpIOThread m_oTcpIOThread;
@@ -0,0 +1,353 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "msg_coalescer.h"
+#include "dfnetwork.h"
+#include "comm_include.h"
+#include "msg_transport.h"
+
+namespace phxpaxos 
+{
+
+#define COALESCE_FRAME_HEAD_LEN ((int)(GROUPIDXLEN + sizeof(uint16_t)))
+#define COALESCE_FRAME_MAX_COUNT 65535
+
+MsgCoalescer :: MsgCoalescer(DFNetWork * poDFNetWork)
+    : m_poDFNetWork(poDFNetWork), m_iDelayUs(0), m_iUDPMaxSize(0), m_iTcpLaneCount(1),
+    m_iPendingCount(0), m_llNextSendTicket(0), m_llSendingTicket(0), 
+    m_bIsEnd(false), m_bIsStarted(false)
+{
+}
+
+MsgCoalescer :: ~MsgCoalescer()
+{
+}
+
+int MsgCoalescer :: Init(const int iDelayUs, const int iUDPMaxSize, const int iTcpLaneCount)
+{
+    if (iDelayUs < 0 || iTcpLaneCount <= 0)
+    {
+        PLErr("invalid args, delayus %d tcp lane count %d", iDelayUs, iTcpLaneCount);
+        return -1;
+    }
+
+    m_iDelayUs = iDelayUs;
+    m_iUDPMaxSize = iUDPMaxSize;
+    m_iTcpLaneCount = iTcpLaneCount;
+
+    return 0;
+}
+
+const bool MsgCoalescer :: IsOpen() const
+{
+    return m_iDelayUs > 0;
+}
+
+void MsgCoalescer :: Stop()
+{
+    if (m_bIsStarted)
+    {
+        {
+            std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+            m_bIsEnd = true;
+            m_oCond.notify_one();
+        }
+
+        join();
+    }
+}
+
+void MsgCoalescer :: run()
+{
+    m_bIsStarted = true;
+
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    while (!m_bIsEnd)
+    {
+        if (m_iPendingCount == 0)
+        {
+            m_oCond.wait_for(oLock, std::chrono::milliseconds(100));
+            continue;
+        }
+
+        uint64_t llNowTimeUs = Time::GetSteadyClockUS();
+        uint64_t llNextTimeUs = (uint64_t)-1;
+        std::vector<OutFrame> vecOutFrame;
+
+        for (auto & it : m_mapPeerFrame)
+        {
+            PeerFrame & oPeerFrame = it.second;
+            if (oPeerFrame.iMsgCount == 0)
+            {
+                continue;
+            }
+
+            uint64_t llDeadlineUs = oPeerFrame.llFirstEnqueueTimeUs + m_iDelayUs;
+            if (llDeadlineUs <= llNowTimeUs)
+            {
+                TakeFrame(oPeerFrame, vecOutFrame);
+            }
+            else if (llDeadlineUs < llNextTimeUs)
+            {
+                llNextTimeUs = llDeadlineUs;
+            }
+        }
+
+        if (vecOutFrame.size() > 0)
+        {
+            //adders only wait for the swap, not the send.
+            uint64_t llSendTicket = GetSendTicket();
+            oLock.unlock();
+            SendOutFrames(llSendTicket, vecOutFrame);
+            oLock.lock();
+            continue;
+        }
+
+        if (llNextTimeUs != (uint64_t)-1)
+        {
+            m_oCond.wait_for(oLock, std::chrono::microseconds(llNextTimeUs - llNowTimeUs));
+        }
+    }
+
+    std::vector<OutFrame> vecOutFrame;
+    for (auto & it : m_mapPeerFrame)
+    {
+        TakeFrame(it.second, vecOutFrame);
+    }
+
+    uint64_t llSendTicket = GetSendTicket();
+    oLock.unlock();
+    SendOutFrames(llSendTicket, vecOutFrame);
+
+    PLHead("MsgCoalescer [END]");
+}
+
+const int MsgCoalescer :: GetMaxFrameSize(const int iSendType) const
+{
+    return iSendType == Message_SendType_TCP ? COALESCE_TCP_FRAME_SIZE : m_iUDPMaxSize;
+}
+
+int MsgCoalescer :: AddMessage(const int iGroupIdx, const std::string & sIP, const int iPort, 
+        const std::string & sMessage, const int iSendType)
+{
+    //tcp messages of one group always go through the same write thread, keep it.
+    int iLane = iSendType == Message_SendType_TCP ? iGroupIdx % m_iTcpLaneCount : 0;
+
+    char sKey[128] = {0};
+    snprintf(sKey, sizeof(sKey), "%s:%d:%d:%d", sIP.c_str(), iPort, iSendType, iLane);
+
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+
+    PeerFrame & oPeerFrame = m_mapPeerFrame[sKey];
+    if (oPeerFrame.sIP.empty())
+    {
+        oPeerFrame.sIP = sIP;
+        oPeerFrame.iPort = iPort;
+        oPeerFrame.iSendType = iSendType;
+        oPeerFrame.iLane = iLane;
+        oPeerFrame.iMsgCount = 0;
+        oPeerFrame.llFirstEnqueueTimeUs = 0;
+    }
+
+    int iMaxFrameSize = GetMaxFrameSize(iSendType);
+    int iNeedSize = (int)(sizeof(uint32_t) + sMessage.size());
+
+    std::vector<OutFrame> vecOutFrame;
+
+    if (COALESCE_FRAME_HEAD_LEN + iNeedSize > iMaxFrameSize)
+    {
+        //too large to coalesce, flush pending first to keep order.
+        TakeFrame(oPeerFrame, vecOutFrame);
+        TakeMessage(oPeerFrame, sMessage, vecOutFrame);
+
+        uint64_t llSendTicket = GetSendTicket();
+        oLock.unlock();
+        return SendOutFrames(llSendTicket, vecOutFrame);
+    }
+
+    if (oPeerFrame.iMsgCount > 0 
+            && ((int)oPeerFrame.sFrame.size() + iNeedSize > iMaxFrameSize
+                || oPeerFrame.iMsgCount >= COALESCE_FRAME_MAX_COUNT))
+    {
+        TakeFrame(oPeerFrame, vecOutFrame);
+    }
+
+    if (oPeerFrame.iMsgCount == 0)
+    {
+        int iFrameGroupIdx = COALESCE_FRAME_GROUPIDX;
+        uint16_t iCount = 0;
+        oPeerFrame.sFrame.append((char *)&iFrameGroupIdx, GROUPIDXLEN);
+        oPeerFrame.sFrame.append((char *)&iCount, sizeof(uint16_t));
+        oPeerFrame.llFirstEnqueueTimeUs = Time::GetSteadyClockUS();
+
+        m_iPendingCount++;
+        m_oCond.notify_one();
+    }
+
+    uint32_t iMessageLen = (uint32_t)sMessage.size();
+    oPeerFrame.sFrame.append((char *)&iMessageLen, sizeof(uint32_t));
+    oPeerFrame.sFrame.append(sMessage);
+    oPeerFrame.iMsgCount++;
+
+    if (vecOutFrame.size() > 0)
+    {
+        uint64_t llSendTicket = GetSendTicket();
+        oLock.unlock();
+        SendOutFrames(llSendTicket, vecOutFrame);
+    }
+
+    return 0;
+}
+
+void MsgCoalescer :: TakeFrame(PeerFrame & oPeerFrame, std::vector<OutFrame> & vecOutFrame)
+{
+    if (oPeerFrame.iMsgCount == 0)
+    {
+        return;
+    }
+
+    if (oPeerFrame.iMsgCount == 1)
+    {
+        //only one message, no need frame.
+        TakeMessage(oPeerFrame, oPeerFrame.sFrame.substr(COALESCE_FRAME_HEAD_LEN + sizeof(uint32_t)), vecOutFrame);
+    }
+    else
+    {
+        uint16_t iCount = (uint16_t)oPeerFrame.iMsgCount;
+        memcpy(&oPeerFrame.sFrame[GROUPIDXLEN], &iCount, sizeof(uint16_t));
+
+        TakeMessage(oPeerFrame, std::string(), vecOutFrame);
+        vecOutFrame.back().sMessage.swap(oPeerFrame.sFrame);
+        vecOutFrame.back().iMsgCount = oPeerFrame.iMsgCount;
+    }
+
+    oPeerFrame.sFrame.clear();
+    oPeerFrame.iMsgCount = 0;
+    m_iPendingCount--;
+}
+
+void MsgCoalescer :: TakeMessage(const PeerFrame & oPeerFrame, const std::string & sMessage, 
+        std::vector<OutFrame> & vecOutFrame)
+{
+    OutFrame oOutFrame;
+    oOutFrame.sIP = oPeerFrame.sIP;
+    oOutFrame.iPort = oPeerFrame.iPort;
+    oOutFrame.iSendType = oPeerFrame.iSendType;
+    oOutFrame.iLane = oPeerFrame.iLane;
+    oOutFrame.sMessage = sMessage;
+    oOutFrame.iMsgCount = 1;
+    vecOutFrame.push_back(oOutFrame);
+}
+
+uint64_t MsgCoalescer :: GetSendTicket()
+{
+    return m_llNextSendTicket++;
+}
+
+int MsgCoalescer :: SendOutFrames(const uint64_t llSendTicket, const std::vector<OutFrame> & vecOutFrame)
+{
+    std::unique_lock<std::mutex> oSendLock(m_oSendMutex);
+    while (m_llSendingTicket != llSendTicket)
+    {
+        m_oSendCond.wait(oSendLock);
+    }
+    oSendLock.unlock();
+
+    int ret = 0;
+    for (auto & oOutFrame : vecOutFrame)
+    {
+        if (oOutFrame.iMsgCount > 1)
+        {
+            BP->GetNetworkBP()->SendCoalescedFrame(oOutFrame.iMsgCount, (int)oOutFrame.sMessage.size());
+        }
+
+        ret = SendFrame(oOutFrame.iLane, oOutFrame.sIP, oOutFrame.iPort, oOutFrame.sMessage, oOutFrame.iSendType);
+    }
+
+    oSendLock.lock();
+    m_llSendingTicket++;
+    m_oSendCond.notify_all();
+
+    return ret;
+}
+
+int MsgCoalescer :: SendFrame(const int iLane, const std::string & sIP, const int iPort, 
+        const std::string & sMessage, const int iSendType)
+{
+    return m_poDFNetWork->SendFrame(iLane, sIP, iPort, sMessage, iSendType);
+}
+
+const bool MsgCoalescer :: IsFrame(const char * pcMessage, const int iMessageLen)
+{
+    if (iMessageLen < (int)GROUPIDXLEN)
+    {
+        return false;
+    }
+
+    int iGroupIdx = 0;
+    memcpy(&iGroupIdx, pcMessage, GROUPIDXLEN);
+
+    return iGroupIdx == COALESCE_FRAME_GROUPIDX;
+}
+
+int MsgCoalescer :: UnpackFrame(const char * pcMessage, const int iMessageLen, 
+        std::vector<std::pair<const char *, int> > & vecMessage)
+{
+    if (iMessageLen < COALESCE_FRAME_HEAD_LEN)
+    {
+        return -1;
+    }
+
+    uint16_t iCount = 0;
+    memcpy(&iCount, pcMessage + GROUPIDXLEN, sizeof(uint16_t));
+
+    int iPos = COALESCE_FRAME_HEAD_LEN;
+    for (int i = 0; i < (int)iCount; i++)
+    {
+        if (iPos + (int)sizeof(uint32_t) > iMessageLen)
+        {
+            return -1;
+        }
+
+        uint32_t iLen = 0;
+        memcpy(&iLen, pcMessage + iPos, sizeof(uint32_t));
+        iPos += sizeof(uint32_t);
+
+        if (iLen == 0 || iLen > (uint32_t)(iMessageLen - iPos))
+        {
+            return -1;
+        }
+
+        vecMessage.push_back(std::make_pair(pcMessage + iPos, (int)iLen));
+        iPos += iLen;
+    }
+
+    if (iPos != iMessageLen)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+}
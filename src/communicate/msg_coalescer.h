@@ -0,0 +1,129 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <inttypes.h>
+#include "utils_include.h"
+
+namespace phxpaxos 
+{
+
+//Groupidx of a coalesced frame, never a valid group.
+//Frame: [groupidx(-1)][uint16 count]([uint32 len][message])...
+//Every message is a full message with it's own groupidx.
+#define COALESCE_FRAME_GROUPIDX -1
+#define COALESCE_TCP_FRAME_SIZE 65536
+
+class DFNetWork;
+
+class MsgCoalescer : public Thread
+{
+public:
+    MsgCoalescer(DFNetWork * poDFNetWork);
+    virtual ~MsgCoalescer();
+
+    int Init(const int iDelayUs, const int iUDPMaxSize, const int iTcpLaneCount);
+
+    void run();
+
+    void Stop();
+
+    const bool IsOpen() const;
+
+    //Messages to the same peer in iDelayUs are packed into one frame.
+    int AddMessage(const int iGroupIdx, const std::string & sIP, const int iPort, 
+            const std::string & sMessage, const int iSendType);
+
+public:
+    static const bool IsFrame(const char * pcMessage, const int iMessageLen);
+
+    static int UnpackFrame(const char * pcMessage, const int iMessageLen, 
+            std::vector<std::pair<const char *, int> > & vecMessage);
+
+protected:
+    virtual int SendFrame(const int iLane, const std::string & sIP, const int iPort, 
+            const std::string & sMessage, const int iSendType);
+
+private:
+    struct PeerFrame
+    {
+        std::string sIP;
+        int iPort;
+        int iSendType;
+        int iLane;
+        std::string sFrame;
+        int iMsgCount;
+        uint64_t llFirstEnqueueTimeUs;
+    };
+
+    //a frame or a single message taken out of PeerFrame, sent without m_oMutex.
+    struct OutFrame
+    {
+        std::string sIP;
+        int iPort;
+        int iSendType;
+        int iLane;
+        std::string sMessage;
+        int iMsgCount;
+    };
+
+    //must hold m_oMutex.
+    void TakeFrame(PeerFrame & oPeerFrame, std::vector<OutFrame> & vecOutFrame);
+
+    void TakeMessage(const PeerFrame & oPeerFrame, const std::string & sMessage, 
+            std::vector<OutFrame> & vecOutFrame);
+
+    //must hold m_oMutex, frames taken later must be sent later.
+    uint64_t GetSendTicket();
+
+    //wait for llSendTicket's turn, then send, return ret of the last frame.
+    int SendOutFrames(const uint64_t llSendTicket, const std::vector<OutFrame> & vecOutFrame);
+
+    const int GetMaxFrameSize(const int iSendType) const;
+
+private:
+    DFNetWork * m_poDFNetWork;
+    int m_iDelayUs;
+    int m_iUDPMaxSize;
+    int m_iTcpLaneCount;
+
+    std::mutex m_oMutex;
+    std::condition_variable m_oCond;
+    std::map<std::string, PeerFrame> m_mapPeerFrame;
+    int m_iPendingCount;
+    uint64_t m_llNextSendTicket;
+
+    std::mutex m_oSendMutex;
+    std::condition_variable m_oSendCond;
+    uint64_t m_llSendingTicket;
+
+    bool m_bIsEnd;
+    bool m_bIsStarted;
+};
+
+}
@@ -34,7 +34,7 @@ int NetWork :: OnReceiveMessage(const char * pcMessage, const int iMessageLen)
 {
     if (m_poNode != nullptr)
     {
-        m_poNode->OnReceiveMessage(pcMessage, iMessageLen);
+        return m_poNode->OnReceiveMessage(pcMessage, iMessageLen);
     }
     else
     {
@@ -39,6 +39,8 @@ EventLoop :: EventLoop(NetWork * poNetWork)
     m_poNetWork = poNetWork;
     m_poTcpClient = nullptr;
     m_poNotify = nullptr;
+    m_iBusyPollUs = 0;
+    m_llLastActiveTimeUs = 0;
     memset(m_EpollEvents, 0, sizeof(m_EpollEvents));
 }
 
@@ -57,6 +59,11 @@ void EventLoop :: SetTcpClient(TcpClient * poTcpClient)
     m_poTcpClient = poTcpClient;
 }
 
+void EventLoop :: SetBusyPollUs(const int iBusyPollUs)
+{
+    m_iBusyPollUs = iBusyPollUs;
+}
+
 int EventLoop :: Init(const int iEpollLength)
 {
     m_iEpollFd = epoll_create(iEpollLength);
@@ -93,7 +100,7 @@ void EventLoop :: ModEvent(const Event * poEvent, const int iEvents)
 
     epoll_event tEpollEvent;
     tEpollEvent.events = iEvents;
-    tEpollEvent.data.fd = poEvent->GetSocketFd();
+    tEpollEvent.data.ptr = (void *)poEvent;
 
     int ret = epoll_ctl(m_iEpollFd, iEpollOpertion, poEvent->GetSocketFd(), &tEpollEvent);
     if (ret == -1)
@@ -124,7 +131,7 @@ void EventLoop :: RemoveEvent(const Event * poEvent)
 
     epoll_event tEpollEvent;
     tEpollEvent.events = 0;
-    tEpollEvent.data.fd = poEvent->GetSocketFd();
+    tEpollEvent.data.ptr = (void *)poEvent;
 
     int ret = epoll_ctl(m_iEpollFd, iEpollOpertion, poEvent->GetSocketFd(), &tEpollEvent);
     if (ret == -1)
@@ -173,11 +180,20 @@ void EventLoop :: StartLoop()
 void EventLoop :: Stop()
 {
     m_bIsEnd = true;
+    JumpoutEpollWait();
 }
 
 void EventLoop :: OneLoop(const int iTimeoutMs)
 {
-    int n = epoll_wait(m_iEpollFd, m_EpollEvents, MAX_EVENTS, 1);
+    //sleep until next timer or notify, but keep polling a while after 
+    //last active if busy poll is set, this save the wakeup latency.
+    int iWaitTimeMs = iTimeoutMs;
+    if (m_iBusyPollUs > 0 && Time::GetSteadyClockUS() < m_llLastActiveTimeUs + m_iBusyPollUs)
+    {
+        iWaitTimeMs = 0;
+    }
+
+    int n = epoll_wait(m_iEpollFd, m_EpollEvents, MAX_EVENTS, iWaitTimeMs);
     if (n == -1)
     {
         if (errno != EINTR)
@@ -187,17 +203,15 @@ void EventLoop :: OneLoop(const int iTimeoutMs)
         }
     }
 
-    for (int i = 0; i < n; i++)
+    if (n > 0 && m_iBusyPollUs > 0)
     {
-        int iFd = m_EpollEvents[i].data.fd;
-        auto it = m_mapEvent.find(iFd);
-        if (it == end(m_mapEvent))
-        {
-            continue;
-        }
+        m_llLastActiveTimeUs = Time::GetSteadyClockUS();
+    }
 
+    for (int i = 0; i < n; i++)
+    {
         int iEvents = m_EpollEvents[i].events;
-        Event * poEvent = it->second.m_poEvent;
+        Event * poEvent = (Event *)m_EpollEvents[i].data.ptr;
 
         int ret = 0;
         if (iEvents & EPOLLERR)
@@ -316,20 +330,24 @@ void EventLoop :: DealwithTimeout(int & iNextTimeout)
         if (bHasTimeout)
         {
             DealwithTimeoutOne(iTimerID, iType);
-
-            iNextTimeout = m_oTimer.GetNextTimeout();
-            if (iNextTimeout != 0)
-            {
-                break;
-            }
         }
     }
+
+    int iTimerTimeout = m_oTimer.GetNextTimeout();
+    if (iTimerTimeout >= 0 && iTimerTimeout < iNextTimeout)
+    {
+        iNextTimeout = iTimerTimeout;
+    }
 }
 
 void EventLoop :: AddEvent(int iFD, SocketAddress oAddr)
 {
-    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
-    m_oFDQueue.push(make_pair(iFD, oAddr));
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+        m_oFDQueue.push(make_pair(iFD, oAddr));
+    }
+
+    JumpoutEpollWait();
 }
 
 void EventLoop :: CreateEvent()
@@ -353,6 +371,7 @@ void EventLoop :: CreateEvent()
         MessageEvent * poMessageEvent = new MessageEvent(MessageEventType_RECV, oData.first, 
                 oData.second, this, m_poNetWork);
         poMessageEvent->AddEvent(EPOLLIN);
+        poMessageEvent->AdvertiseCredit();
 
         m_vecCreatedEvent.push_back(poMessageEvent);
     }
@@ -60,6 +60,8 @@ public:
 public:
     void SetTcpClient(TcpClient * poTcpClient);
 
+    void SetBusyPollUs(const int iBusyPollUs);
+
     void JumpoutEpollWait();
 
 public:
@@ -97,6 +99,8 @@ protected:
     NetWork * m_poNetWork;
     TcpClient * m_poTcpClient;
     Notify * m_poNotify;
+    int m_iBusyPollUs;
+    uint64_t m_llLastActiveTimeUs;
 
 protected:
     Timer m_oTimer;
@@ -24,6 +24,7 @@ See the AUTHORS file for names of contributors.
 #include "phxpaxos/network.h"
 #include "event_loop.h"
 #include "comm_include.h"
+#include "credit_notifier.h"
 
 namespace phxpaxos
 {
@@ -56,6 +57,10 @@ MessageEvent :: MessageEvent(
     m_sHost = oAddr.getHost();
 
     m_iQueueMemSize = 0;
+
+    m_iCreditWindow = 0;
+    m_iCreditFlushTimeoutID = 0;
+    m_iQueuedCreditMsgCount = 0;
 }
 
 MessageEvent :: ~MessageEvent()
@@ -91,7 +96,7 @@ const bool MessageEvent :: IsActive()
     return true;
 }
 
-int MessageEvent :: AddMessage(const std::string & sMessage)
+int MessageEvent :: AddMessage(const std::string & sMessage, const bool bFlowControl)
 {
     m_llLastActiveTime = Time::GetSteadyClockMS();
     std::unique_lock<std::mutex> oLock(m_oMutex);
@@ -109,9 +114,34 @@ int MessageEvent :: AddMessage(const std::string & sMessage)
         return -2;
     }
 
+    //credit is taken only after the message surely enqueue.
+    int iCreditGroupIdx = -1;
+    int iGroupIdx = GetMessageGroupIdx(sMessage.data(), sMessage.size());
+    if (m_iCreditWindow > 0 && iGroupIdx >= 0)
+    {
+        auto it = m_mapGroupCredit.find(iGroupIdx);
+        if (it == end(m_mapGroupCredit))
+        {
+            it = m_mapGroupCredit.insert(std::make_pair(iGroupIdx, m_iCreditWindow)).first;
+        }
+
+        //a message larger than the window can still go when nothing is in flight.
+        if (bFlowControl && it->second < (int)sMessage.size() && it->second < m_iCreditWindow)
+        {
+            BP->GetNetworkBP()->TcpCreditStall();
+            return Paxos_NetWorkBackpressure;
+        }
+
+        it->second -= (int)sMessage.size();
+        iCreditGroupIdx = iGroupIdx;
+    }
+
     QueueData tData;
     tData.llEnqueueAbsTime = Time::GetSteadyClockMS();
     tData.psValue = new string(sMessage);
+    tData.bCanDrop = !bFlowControl;
+    tData.iCreditGroupIdx = iCreditGroupIdx;
+    tData.bIsCreditMsg = false;
     m_oInQueue.push(tData);
 
     m_iQueueMemSize += sMessage.size();
@@ -125,10 +155,22 @@ int MessageEvent :: AddMessage(const std::string & sMessage)
 
 void MessageEvent :: ReadDone(BytesBuffer & oBytesBuffer, const int iLen)
 {
+    if (m_iType == MessageEventType_SEND)
+    {
+        //only credit come back on a send connection.
+        OnCreditMessage(oBytesBuffer.GetPtr(), iLen);
+        return;
+    }
+
     //PLHead("ok, len %d", iLen);
-    m_poNetWork->OnReceiveMessage(oBytesBuffer.GetPtr(), iLen);
+    int ret = m_poNetWork->OnReceiveMessage(oBytesBuffer.GetPtr(), iLen);
 
     BP->GetNetworkBP()->TcpReadOneMessageOk(iLen);
+
+    if (m_iCreditWindow > 0)
+    {
+        ConsumeCredit(oBytesBuffer.GetPtr(), iLen, ret == 0);
+    }
 }
 
 int MessageEvent :: ReadLeft()
@@ -245,7 +287,7 @@ void MessageEvent :: OpenWrite()
         }
         else
         {
-            AddEvent(EPOLLOUT);
+            AddEvent(EPOLLOUT | EPOLLIN);
         }
     }
 }
@@ -324,16 +366,27 @@ int MessageEvent :: DoOnWrite()
     QueueData tData = m_oInQueue.front();
     m_oInQueue.pop();
     m_iQueueMemSize -= tData.psValue->size();
+    if (tData.bIsCreditMsg)
+    {
+        m_iQueuedCreditMsgCount--;
+    }
     m_oMutex.unlock();
 
     std::string * poMessage = tData.psValue;
     uint64_t llNowTime = Time::GetSteadyClockMS();
     int iDelayMs = llNowTime > tData.llEnqueueAbsTime ? (int)(llNowTime - tData.llEnqueueAbsTime) : 0;
     BP->GetNetworkBP()->TcpOutQueue(iDelayMs);
-    if (iDelayMs > TCP_OUTQUEUE_DROP_TIMEMS)
+    //flow controlled messages are bounded by the receiver's credit, the sender believe they are sent.
+    if (tData.bCanDrop && iDelayMs > TCP_OUTQUEUE_DROP_TIMEMS)
     {
+        BP->GetNetworkBP()->TcpOutQueueDrop();
         //PLErr("drop request because enqueue timeout, nowtime %lu unqueuetime %lu",
                 //llNowTime, tData.llEnqueueAbsTime);
+        //the receiver will never return credit of a dropped message.
+        if (tData.iCreditGroupIdx >= 0)
+        {
+            RefundCredit(tData.iCreditGroupIdx, (int)poMessage->size());
+        }
         delete poMessage;
         return 0;
     }
@@ -422,6 +475,7 @@ void MessageEvent :: OnError(bool & bNeedDelete)
             }
 
             m_iQueueMemSize = 0;
+            m_iQueuedCreditMsgCount = 0;
 
             m_oMutex.unlock();
 
@@ -433,6 +487,16 @@ void MessageEvent :: OnError(bool & bNeedDelete)
 
 void MessageEvent :: OnTimeout(const uint32_t iTimerID, const int iType)
 {
+    if (iType == MessageEventTimerType_CreditFlush)
+    {
+        if (iTimerID == m_iCreditFlushTimeoutID)
+        {
+            m_iCreditFlushTimeoutID = 0;
+            FlushCredit();
+        }
+        return;
+    }
+
     if (iTimerID != m_iReconnectTimeoutID)
     {
         return;
@@ -452,16 +516,208 @@ void MessageEvent :: ReConnect()
     m_iEvents = 0;
     m_iLeftWriteLen = 0;
     m_iLastWritePos = 0;
+    m_iLeftReadLen = 0;
+    m_iLastReadPos = 0;
+    m_iLastReadHeadPos = 0;
+
+    //new connection, wait the receiver advertise again.
+    m_oMutex.lock();
+    m_iCreditWindow = 0;
+    m_mapGroupCredit.clear();
+    m_oMutex.unlock();
+
+    //no flow control until advertise again, stalled senders can go.
+    CreditNotifier::Instance()->Notify();
 
     m_oSocket.reset();
     m_oSocket.setNonBlocking(true);
     m_oSocket.setNoDelay(true);
     m_oSocket.connect(m_oAddr);
-    AddEvent(EPOLLOUT);
+    AddEvent(EPOLLOUT | EPOLLIN);
     
     PLErr("start, ip %s", GetSocketHost().c_str());
 }
-    
+
+const int MessageEvent :: GetMessageGroupIdx(const char * pcMessage, const int iMessageLen)
+{
+    if (iMessageLen < (int)GROUPIDXLEN)
+    {
+        return -1;
+    }
+
+    int iGroupIdx = -1;
+    memcpy(&iGroupIdx, pcMessage, GROUPIDXLEN);
+    return iGroupIdx;
 }
 
+void MessageEvent :: AdvertiseCredit()
+{
+    int iWindow = TCP_CREDIT_WINDOW_BYTES;
+    if (iWindow <= 0)
+    {
+        return;
+    }
+
+    m_iCreditWindow = iWindow;
+    m_mapPendingCredit[TCP_CREDIT_GROUPIDX] = iWindow;
+    FlushCredit();
+}
 
+void MessageEvent :: ConsumeCredit(const char * pcMessage, const int iMessageLen, const bool bHandOff)
+{
+    //coalesced frames are not flow controlled.
+    int iGroupIdx = GetMessageGroupIdx(pcMessage, iMessageLen);
+    if (iGroupIdx < 0)
+    {
+        return;
+    }
+
+    int & iPendingCredit = m_mapPendingCredit[iGroupIdx];
+    iPendingCredit += iMessageLen;
+
+    //group queue is full, hold the credit until the flush timer to slow the sender down.
+    if (bHandOff && iPendingCredit >= m_iCreditWindow / 4)
+    {
+        FlushCredit();
+    }
+    else if (m_iCreditFlushTimeoutID == 0)
+    {
+        AddTimer(TCP_CREDIT_FLUSH_TIMEMS, MessageEventTimerType_CreditFlush, m_iCreditFlushTimeoutID);
+    }
+}
+
+void MessageEvent :: FlushCredit()
+{
+    if (m_mapPendingCredit.empty())
+    {
+        return;
+    }
+
+    //peer not reading it(like an old version without credit), don't pile up messages,
+    //later credit merge into pending and wait for the queued one written.
+    m_oMutex.lock();
+    bool bHasQueuedCreditMsg = m_iQueuedCreditMsgCount > 0;
+    m_oMutex.unlock();
+
+    if (bHasQueuedCreditMsg)
+    {
+        if (m_iCreditFlushTimeoutID == 0)
+        {
+            AddTimer(TCP_CREDIT_FLUSH_TIMEMS, MessageEventTimerType_CreditFlush, m_iCreditFlushTimeoutID);
+        }
+        return;
+    }
+
+    //[groupidx(TCP_CREDIT_GROUPIDX)][uint16 count]([int groupidx][int credit])...
+    std::string sMessage;
+    int iCreditGroupIdx = TCP_CREDIT_GROUPIDX;
+    uint16_t iCount = (uint16_t)m_mapPendingCredit.size();
+    sMessage.append((char *)&iCreditGroupIdx, GROUPIDXLEN);
+    sMessage.append((char *)&iCount, sizeof(uint16_t));
+
+    for (auto & it : m_mapPendingCredit)
+    {
+        sMessage.append((char *)&it.first, sizeof(int));
+        sMessage.append((char *)&it.second, sizeof(int));
+    }
+
+    m_mapPendingCredit.clear();
+
+    BP->GetNetworkBP()->TcpCreditGrant(iCount);
+    AddControlMessage(sMessage);
+}
+
+void MessageEvent :: AddControlMessage(const std::string & sMessage)
+{
+    m_oMutex.lock();
+    QueueData tData;
+    tData.llEnqueueAbsTime = Time::GetSteadyClockMS();
+    tData.psValue = new string(sMessage);
+    tData.bCanDrop = false;
+    tData.iCreditGroupIdx = -1;
+    tData.bIsCreditMsg = true;
+    m_oInQueue.push(tData);
+    m_iQueueMemSize += sMessage.size();
+    m_iQueuedCreditMsgCount++;
+    m_oMutex.unlock();
+
+    //we are in the event loop thread, no need to wake it up.
+    AddEvent(EPOLLOUT);
+}
+
+void MessageEvent :: OnCreditMessage(const char * pcMessage, const int iMessageLen)
+{
+    int iHeadLen = GROUPIDXLEN + sizeof(uint16_t);
+    if (iMessageLen < iHeadLen || GetMessageGroupIdx(pcMessage, iMessageLen) != TCP_CREDIT_GROUPIDX)
+    {
+        PLErr("not credit message, len %d ip %s", iMessageLen, GetSocketHost().c_str());
+        return;
+    }
+
+    uint16_t iCount = 0;
+    memcpy(&iCount, pcMessage + GROUPIDXLEN, sizeof(uint16_t));
+    if (iMessageLen != iHeadLen + (int)iCount * (int)(sizeof(int) * 2))
+    {
+        PLErr("credit message len %d count %d wrong", iMessageLen, (int)iCount);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+        AddCredit(pcMessage + iHeadLen, (int)iCount);
+    }
+
+    CreditNotifier::Instance()->Notify();
+}
+
+//must hold m_oMutex.
+void MessageEvent :: AddCredit(const char * pcPos, const int iCount)
+{
+    for (int i = 0; i < iCount; i++)
+    {
+        int iGroupIdx = 0;
+        int iCredit = 0;
+        memcpy(&iGroupIdx, pcPos, sizeof(int));
+        memcpy(&iCredit, pcPos + sizeof(int), sizeof(int));
+        pcPos += sizeof(int) * 2;
+
+        if (iGroupIdx == TCP_CREDIT_GROUPIDX)
+        {
+            PLImp("receiver advertise window %d, ip %s", iCredit, GetSocketHost().c_str());
+            m_iCreditWindow = iCredit;
+            m_mapGroupCredit.clear();
+            continue;
+        }
+
+        if (m_iCreditWindow == 0)
+        {
+            continue;
+        }
+
+        auto it = m_mapGroupCredit.find(iGroupIdx);
+        if (it != end(m_mapGroupCredit))
+        {
+            it->second = std::min(it->second + iCredit, m_iCreditWindow);
+        }
+    }
+}
+
+void MessageEvent :: RefundCredit(const int iGroupIdx, const int iCredit)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+
+    if (m_iCreditWindow == 0)
+    {
+        return;
+    }
+
+    auto it = m_mapGroupCredit.find(iGroupIdx);
+    if (it != end(m_mapGroupCredit))
+    {
+        it->second = std::min(it->second + iCredit, m_iCreditWindow);
+    }
+
+    CreditNotifier::Instance()->Notify();
+}
+    
+}
@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <mutex>
+#include <map>
 #include "event_base.h"
 #include "utils_include.h"
 #include "commdef.h"
@@ -42,6 +43,7 @@ enum MessageEventType
 enum MessageEventTimerType
 {
     MessageEventTimerType_Reconnect = 1,
+    MessageEventTimerType_CreditFlush = 2,
 };
 
 class MessageEvent : public Event
@@ -55,7 +57,9 @@ public:
             NetWork * poNetWork);
     ~MessageEvent();
 
-    int AddMessage(const std::string & sMessage);
+    //If bFlowControl, return Paxos_NetWorkBackpressure when the receiver
+    //has no credit left for this message's group. Other messages take credit but never wait.
+    int AddMessage(const std::string & sMessage, const bool bFlowControl = true);
 
     int GetSocketFd() const;
     
@@ -73,6 +77,8 @@ public:
 
     const bool IsActive();
 
+    void AdvertiseCredit();
+
 private:
     int ReadLeft();
 
@@ -86,6 +92,20 @@ private:
 
     void ReConnect();
 
+    static const int GetMessageGroupIdx(const char * pcMessage, const int iMessageLen);
+
+    void ConsumeCredit(const char * pcMessage, const int iMessageLen, const bool bHandOff);
+
+    void FlushCredit();
+
+    void AddControlMessage(const std::string & sMessage);
+
+    void OnCreditMessage(const char * pcMessage, const int iMessageLen);
+
+    void AddCredit(const char * pcPos, const int iCount);
+
+    void RefundCredit(const int iGroupIdx, const int iCredit);
+
 private:
     Socket m_oSocket;    
     SocketAddress m_oAddr;
@@ -108,6 +128,11 @@ private:
     {
         uint64_t llEnqueueAbsTime;
         std::string * psValue;
+        //flow controlled and control messages are never dropped by enqueue timeout.
+        bool bCanDrop;
+        //group the credit was taken from, -1 if none.
+        int iCreditGroupIdx;
+        bool bIsCreditMsg;
     };    
 
     std::queue<QueueData> m_oInQueue;
@@ -118,6 +143,17 @@ private:
 
 private:
     uint32_t m_iReconnectTimeoutID;
+
+private:
+    //credit flow control, only on when the receiver advertise a window.
+    //send side: window and credit left of each group, protected by m_oMutex.
+    //recv side: bytes consumed but not returned to the sender yet, only touched by the event loop.
+    int m_iCreditWindow;
+    std::map<int, int> m_mapGroupCredit;
+    std::map<int, int> m_mapPendingCredit;
+    uint32_t m_iCreditFlushTimeoutID;
+    //credit messages in m_oInQueue, at most one, protected by m_oMutex.
+    int m_iQueuedCreditMsgCount;
 };
 
 }
@@ -23,7 +23,7 @@ See the AUTHORS file for names of contributors.
 #include "commdef.h"
 #include <assert.h>
 #include <unistd.h>
-#include <fcntl.h>
+#include <sys/eventfd.h>
 #include <sys/epoll.h>
 
 namespace phxpaxos
@@ -32,41 +32,35 @@ namespace phxpaxos
 Notify :: Notify(EventLoop * poEventLoop)
     : Event(poEventLoop)
 {
-    m_iPipeFD[0] = -1;
-    m_iPipeFD[1] = -1;
+    m_iEventFD = -1;
     m_sHost = "Notify";
 }
 
 Notify :: ~Notify()
 {
-    for (int i = 0; i < 2; i++)
+    if (m_iEventFD != -1)
     {
-        if (m_iPipeFD[i] != -1)
-        {
-            close(m_iPipeFD[i]);
-        }
+        close(m_iEventFD);
     }
 }
 
 int Notify :: Init()
 {
-    int ret = pipe(m_iPipeFD);
-    if (ret != 0)
+    //eventfd is a counter, many notify before loop wake up only need one read.
+    m_iEventFD = eventfd(0, EFD_NONBLOCK);
+    if (m_iEventFD == -1)
     {
-        PLErr("create pipe fail, ret %d", ret);
-        return ret;
+        PLErr("create eventfd fail, errno %d", errno);
+        return -1;
     }
 
-    fcntl(m_iPipeFD[0], F_SETFL, O_NONBLOCK);
-    fcntl(m_iPipeFD[1], F_SETFL, O_NONBLOCK);
-
     AddEvent(EPOLLIN);
     return 0;
 }
 
 int Notify :: GetSocketFd() const
 {
-    return m_iPipeFD[0];
+    return m_iEventFD;
 }
 
 const std::string & Notify :: GetSocketHost()
@@ -76,8 +70,9 @@ const std::string & Notify :: GetSocketHost()
 
 void Notify :: SendNotify()
 {
-    ssize_t iWriteLen = write(m_iPipeFD[1], (void *)"a", 1);
-    if (iWriteLen != 1)
+    uint64_t llValue = 1;
+    ssize_t iWriteLen = write(m_iEventFD, &llValue, sizeof(llValue));
+    if (iWriteLen != sizeof(llValue))
     {
         //PLErr("notify error, writelen %d", iWriteLen);
     }
@@ -85,9 +80,9 @@ void Notify :: SendNotify()
 
 int Notify :: OnRead()
 {
-    char sTmp[2] = {0};
-    int iReadLen = read(m_iPipeFD[0], sTmp, 1);
-    if (iReadLen < 0)
+    uint64_t llValue = 0;
+    ssize_t iReadLen = read(m_iEventFD, &llValue, sizeof(llValue));
+    if (iReadLen < 0 && errno != EAGAIN)
     {
         return -1;
     }
@@ -102,4 +97,3 @@ void Notify :: OnError(bool & bNeedDelete)
     
 }
 
-
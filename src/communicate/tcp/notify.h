@@ -48,7 +48,7 @@ public:
     void OnError(bool & bNeedDelete);
 
 private:
-    int m_iPipeFD[2];    
+    int m_iEventFD;
     std::string m_sHost;
 };
     
@@ -34,8 +34,9 @@ TcpRead :: ~TcpRead()
 {
 }
 
-int TcpRead :: Init()
+int TcpRead :: Init(const int iBusyPollUs)
 {
+    m_oEventLoop.SetBusyPollUs(iBusyPollUs);
     return m_oEventLoop.Init(20480);
 }
 
@@ -69,8 +70,9 @@ TcpWrite :: ~TcpWrite()
 {
 }
 
-int TcpWrite :: Init()
+int TcpWrite :: Init(const int iBusyPollUs)
 {
+    m_oEventLoop.SetBusyPollUs(iBusyPollUs);
     return m_oEventLoop.Init(20480);
 }
 
@@ -87,9 +89,9 @@ void TcpWrite :: Stop()
     PLHead("TcpWriteThread [END]");
 }
 
-int TcpWrite :: AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage)
+int TcpWrite :: AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage, const bool bFlowControl)
 {
-    return m_oTcpClient.AddMessage(sIP, iPort, sMessage);
+    return m_oTcpClient.AddMessage(sIP, iPort, sMessage, bFlowControl);
 }
 
 ////////////////////////////////////////////////////////
@@ -136,7 +138,7 @@ void TcpIOThread :: Stop()
     PLHead("TcpIOThread [END]");
 }
 
-int TcpIOThread :: Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount)
+int TcpIOThread :: Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount, const int iBusyPollUs)
 {
     for (int i = 0; i < iIOThreadCount; i++)
     {
@@ -155,7 +157,7 @@ int TcpIOThread :: Init(const std::string & sListenIp, const int iListenPort, co
 
     for (auto & poTcpRead : m_vecTcpRead)
     {
-        ret = poTcpRead->Init();
+        ret = poTcpRead->Init(iBusyPollUs);
         if (ret != 0)
         {
             return ret;
@@ -164,7 +166,7 @@ int TcpIOThread :: Init(const std::string & sListenIp, const int iListenPort, co
 
     for (auto & poTcpWrite: m_vecTcpWrite)
     {
-        ret = poTcpWrite->Init();
+        ret = poTcpWrite->Init(iBusyPollUs);
         if (ret != 0)
         {
             return ret;
@@ -190,10 +192,11 @@ void TcpIOThread :: Start()
     m_bIsStarted = true;
 }
 
-int TcpIOThread :: AddMessage(const int iGroupIdx, const std::string & sIP, const int iPort, const std::string & sMessage)
+int TcpIOThread :: AddMessage(const int iGroupIdx, const std::string & sIP, const int iPort, const std::string & sMessage,
+        const bool bFlowControl)
 {
     int iIndex = iGroupIdx % (int)m_vecTcpWrite.size();
-    return m_vecTcpWrite[iIndex]->AddMessage(sIP, iPort, sMessage);
+    return m_vecTcpWrite[iIndex]->AddMessage(sIP, iPort, sMessage, bFlowControl);
 }
 
 }
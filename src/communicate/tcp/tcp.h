@@ -35,7 +35,7 @@ public:
     TcpRead(NetWork * poNetWork);
     ~TcpRead();
 
-    int Init();
+    int Init(const int iBusyPollUs);
 
     void run();
 
@@ -55,13 +55,13 @@ public:
     TcpWrite(NetWork * poNetWork);
     ~TcpWrite();
 
-    int Init();
+    int Init(const int iBusyPollUs);
 
     void run();
 
     void Stop();
 
-    int AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage);
+    int AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage, const bool bFlowControl);
 
 private:
     TcpClient m_oTcpClient;
@@ -74,13 +74,14 @@ public:
     TcpIOThread(NetWork * poNetWork);
     ~TcpIOThread();
 
-    int Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount);
+    int Init(const std::string & sListenIp, const int iListenPort, const int iIOThreadCount, const int iBusyPollUs);
 
     void Start();
 
     void Stop();
 
-    int AddMessage(const int iGroupIdx, const std::string & sIP, const int iPort, const std::string & sMessage);
+    int AddMessage(const int iGroupIdx, const std::string & sIP, const int iPort, const std::string & sMessage, 
+            const bool bFlowControl = true);
 
 private:
     NetWork * m_poNetWork;
@@ -41,7 +41,7 @@ TcpClient :: ~TcpClient()
     }
 }
 
-int TcpClient :: AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage)
+int TcpClient :: AddMessage(const std::string & sIP, const int iPort, const std::string & sMessage, const bool bFlowControl)
 {
     //PLImp("ok");
     MessageEvent * poEvent = GetEvent(sIP, iPort);
@@ -51,7 +51,7 @@ int TcpClient :: AddMessage(const std::string & sIP, const int iPort, const std:
         return -1;
     }
 
-    return poEvent->AddMessage(sMessage);
+    return poEvent->AddMessage(sMessage, bFlowControl);
 }
 
 MessageEvent * TcpClient :: GetEvent(const std::string & sIP, const int iPort)
@@ -23,6 +23,7 @@ See the AUTHORS file for names of contributors.
 #include <math.h>
 #include "inttypes.h"
 #include "comm_include.h"
+#include "crc32.h"
 
 namespace phxpaxos
 {
@@ -46,7 +47,12 @@ Config :: Config(
     m_iMyGroupIdx(iMyGroupIdx),
     m_iGroupCount(iGroupCount),
     m_oSystemVSM(iMyGroupIdx, oMyNode.GetNodeID(), poLogStorage, pMembershipChangeCallback),
-    m_poMasterSM(nullptr)
+    m_poMasterSM(nullptr),
+    m_poMasterLeaseGrantor(nullptr),
+    m_poMasterLeaseGrantorSet(nullptr),
+    m_poMasterInfo(nullptr),
+    m_iValueCompressThreshold(0),
+    m_iValueCompressDictID(0)
 {
     m_vecNodeInfoList = vecNodeInfoList;
 
@@ -185,6 +191,36 @@ InsideSM * Config :: GetMasterSM()
     return m_poMasterSM;
 }
 
+void Config :: SetMasterLeaseGrantor(MasterLeaseGrantor * poMasterLeaseGrantor)
+{
+    m_poMasterLeaseGrantor = poMasterLeaseGrantor;
+}
+
+MasterLeaseGrantor * Config :: GetMasterLeaseGrantor()
+{
+    return m_poMasterLeaseGrantor;
+}
+
+void Config :: SetMasterLeaseGrantorSet(MasterLeaseGrantorSet * poMasterLeaseGrantorSet)
+{
+    m_poMasterLeaseGrantorSet = poMasterLeaseGrantorSet;
+}
+
+MasterLeaseGrantorSet * Config :: GetMasterLeaseGrantorSet()
+{
+    return m_poMasterLeaseGrantorSet;
+}
+
+void Config :: SetMasterInfo(const MasterInfo * poMasterInfo)
+{
+    m_poMasterInfo = poMasterInfo;
+}
+
+const MasterInfo * Config :: GetMasterInfo() const
+{
+    return m_poMasterInfo;
+}
+
 ///////////////////////////////////////////////////////
 
 #define TmpNodeTimeout 60000
@@ -268,6 +304,75 @@ const int Config :: SyncInterval() const
     return m_iSyncInterval;
 }
 
+///////////////////////////////////////////////////////
+
+void Config :: SetValueCompress(const int iValueCompressThreshold, const uint32_t iValueCompressDictID)
+{
+    m_iValueCompressThreshold = iValueCompressThreshold;
+    m_iValueCompressDictID = iValueCompressDictID;
+}
+
+const int Config :: GetValueCompressThreshold() const
+{
+    return m_iValueCompressThreshold;
+}
+
+const uint32_t Config :: GetValueCompressDictID() const
+{
+    return m_iValueCompressDictID;
+}
+
+void Config :: SetNodeValueCompressSupport(const nodeid_t iNodeID, const bool bSupport)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oValueCompressNodeMutex);
+    if (bSupport)
+    {
+        m_setValueCompressNode.insert(iNodeID);
+    }
+    else
+    {
+        m_setValueCompressNode.erase(iNodeID);
+    }
+}
+
+const bool Config :: IsNodeValueCompressSupport(const nodeid_t iNodeID)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oValueCompressNodeMutex);
+    return m_setValueCompressNode.find(iNodeID) != end(m_setValueCompressNode);
 }
 
+const bool Config :: IsAllMemberValueCompressSupport()
+{
+    const std::set<nodeid_t> & setNodeID = m_oSystemVSM.GetMembershipMap();
+
+    std::lock_guard<std::mutex> oLockGuard(m_oValueCompressNodeMutex);
+    for (auto & iNodeID : setNodeID)
+    {
+        if (iNodeID != m_iMyNodeID
+                && m_setValueCompressNode.find(iNodeID) == end(m_setValueCompressNode))
+        {
+            return false;
+        }
+    }
 
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+const int Config :: GetChecksumType() const
+{
+    return m_oSystemVSM.GetChecksumType();
+}
+
+const uint32_t Config :: ChainChecksum(const uint32_t iLastChecksum, const std::string & sValue) const
+{
+    if (GetChecksumType() == ChecksumType_Crc32C)
+    {
+        return crc32c(iLastChecksum, (const uint8_t *)sValue.data(), sValue.size());
+    }
+
+    return crc32(iLastChecksum, (const uint8_t *)sValue.data(), sValue.size(), CRC32SKIP);
+}
+
+}
@@ -22,8 +22,12 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include <vector>
+#include <set>
+#include <mutex>
 #include "commdef.h"
 #include "system_v_sm.h"
+#include "master_lease.h"
+#include "master_info.h"
 
 namespace phxpaxos
 {
@@ -92,6 +96,18 @@ public:
 
     InsideSM * GetMasterSM();
 
+    void SetMasterLeaseGrantor(MasterLeaseGrantor * poMasterLeaseGrantor);
+
+    MasterLeaseGrantor * GetMasterLeaseGrantor();
+
+    void SetMasterLeaseGrantorSet(MasterLeaseGrantorSet * poMasterLeaseGrantorSet);
+
+    MasterLeaseGrantorSet * GetMasterLeaseGrantorSet();
+
+    void SetMasterInfo(const MasterInfo * poMasterInfo);
+
+    const MasterInfo * GetMasterInfo() const;
+
 public:
     void AddTmpNodeOnlyForLearn(const nodeid_t iTmpNodeID);
 
@@ -105,6 +121,27 @@ public:
 
     const size_t GetMyFollowerCount();
 
+public:
+    void SetValueCompress(const int iValueCompressThreshold, const uint32_t iValueCompressDictID);
+
+    const int GetValueCompressThreshold() const;
+
+    const uint32_t GetValueCompressDictID() const;
+
+    //node send header version >= HEADER_VERSION_VALUE_COMPRESS can decompress value.
+    void SetNodeValueCompressSupport(const nodeid_t iNodeID, const bool bSupport);
+
+    const bool IsNodeValueCompressSupport(const nodeid_t iNodeID);
+
+    const bool IsAllMemberValueCompressSupport();
+
+public:
+    //ChecksumType of this group, recorded in system variables.
+    const int GetChecksumType() const;
+
+    //checksum of paxos log chain, computed once when value persisted.
+    const uint32_t ChainChecksum(const uint32_t iLastChecksum, const std::string & sValue) const;
+
 private:
     bool m_bLogSync;
     int m_iSyncInterval;
@@ -122,9 +159,18 @@ private:
 
     SystemVSM m_oSystemVSM;
     InsideSM * m_poMasterSM;
+    MasterLeaseGrantor * m_poMasterLeaseGrantor;
+    MasterLeaseGrantorSet * m_poMasterLeaseGrantorSet;
+    const MasterInfo * m_poMasterInfo;
 
     std::map<nodeid_t, uint64_t> m_mapTmpNodeOnlyForLearn;
     std::map<nodeid_t, uint64_t> m_mapMyFollower;
+
+    int m_iValueCompressThreshold;
+    uint32_t m_iValueCompressDictID;
+
+    std::mutex m_oValueCompressNodeMutex;
+    std::set<nodeid_t> m_setValueCompressNode;
 };
 
 }
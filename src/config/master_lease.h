@@ -0,0 +1,96 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include "phxpaxos/options.h"
+#include <vector>
+
+namespace phxpaxos
+{
+
+//Master lease renewed by heartbeat to a majority, instead of a paxos value every renewal.
+//Only master change goes through paxos, a renewal keeps the master version and writes nothing.
+
+//Grantor side, the master state machine of every node.
+class MasterLeaseGrantor
+{
+public:
+    virtual ~MasterLeaseGrantor() {}
+
+    //extend the lease of iMasterNodeID on this node.
+    //refuse if it isn't the master of llMasterVersion here, or its lease already expired here,
+    //because this node may have told others the lease is free.
+    virtual bool GrantLease(const nodeid_t iMasterNodeID, const uint64_t llMasterVersion, const int iLeaseTimeMs) = 0;
+
+    //this node holds an unexpired lease of a master other than iNodeID.
+    virtual bool IsLeaseHeldByOther(const nodeid_t iNodeID) = 0;
+};
+
+//Node level, a multi-group lease message is received by one group,
+//then each group in it is answered by that group's grantor.
+class MasterLeaseGrantorSet
+{
+public:
+    virtual ~MasterLeaseGrantorSet() {}
+
+    //return nullptr if the group don't use heartbeat lease.
+    virtual MasterLeaseGrantor * GetMasterLeaseGrantor(const int iGroupIdx) = 0;
+};
+
+//One group in a multi-group renew or query.
+class MasterLeaseGroup
+{
+public:
+    MasterLeaseGroup() : iGroupIdx(0), llMasterVersion(0), iLeaseTimeMs(0), bIsSucc(false) { }
+
+    int iGroupIdx;
+    uint64_t llMasterVersion;
+    int iLeaseTimeMs;
+
+    //return parameter
+    bool bIsSucc;
+};
+
+//Master side, send to all members and wait the majority.
+class MasterLeaseRenewer
+{
+public:
+    virtual ~MasterLeaseRenewer() {}
+
+    //return 0 if majority granted the lease.
+    virtual int RenewLease(const nodeid_t iMasterNodeID, const uint64_t llMasterVersion, 
+            const int iLeaseTimeMs, const int iTimeoutMs) = 0;
+
+    //return 0 if majority hold no lease of other master, then iNodeID can try be master.
+    virtual int QueryLease(const nodeid_t iNodeID, const int iTimeoutMs) = 0;
+
+    //many groups in one message, each group's bIsSucc set by its own majority.
+    //all groups should have the same members.
+    virtual void RenewLeaseBatch(const nodeid_t iMasterNodeID, 
+            std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs) = 0;
+
+    virtual void QueryLeaseBatch(const nodeid_t iNodeID, 
+            std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs) = 0;
+};
+    
+}
@@ -33,7 +33,8 @@ SystemVSM :: SystemVSM(
         const LogStorage * poLogStorage,
         MembershipChangeCallback pMembershipChangeCallback) 
     : m_iMyGroupIdx(iGroupIdx), m_oSystemVStore(poLogStorage), 
-    m_iMyNodeID(iMyNodeID), m_pMembershipChangeCallback(pMembershipChangeCallback)
+    m_iMyNodeID(iMyNodeID), m_pMembershipChangeCallback(pMembershipChangeCallback),
+    m_poMembershipListener(nullptr)
 {
 }
 
@@ -121,7 +122,8 @@ bool SystemVSM :: Execute(const int iGroupIdx, const uint64_t llInstanceID, cons
         return false;
     }
 
-    PLG1Head("OK, new version %lu gid %lu", m_oSystemVariables.version(), m_oSystemVariables.gid());
+    PLG1Head("OK, new version %lu gid %lu checksumtype %d", 
+            m_oSystemVariables.version(), m_oSystemVariables.gid(), m_oSystemVariables.checksumtype());
 
     if (smret != nullptr) *smret = 0;
 
@@ -155,6 +157,7 @@ int SystemVSM :: Membership_OPValue(const NodeInfoList & vecNodeInfoList, const
     //must must set version first!
     oVariables.set_version(llVersion);
     oVariables.set_gid(m_oSystemVariables.gid());
+    oVariables.set_checksumtype(m_oSystemVariables.checksumtype());
     
     for (auto & tNodeInfo : vecNodeInfoList)
     {
@@ -174,6 +177,26 @@ int SystemVSM :: Membership_OPValue(const NodeInfoList & vecNodeInfoList, const
     return 0;
 }
 
+int SystemVSM :: ChecksumType_OPValue(const int iChecksumType, std::string & sOpValue)
+{
+    SystemVariables oVariables = m_oSystemVariables;
+    oVariables.set_checksumtype(iChecksumType);
+
+    bool sSucc = oVariables.SerializeToString(&sOpValue);
+    if (!sSucc)
+    {
+        PLG1Err("Variables.Serialize fail");
+        return -1;
+    }
+
+    return 0;
+}
+
+const int SystemVSM :: GetChecksumType() const
+{
+    return m_oSystemVariables.checksumtype();
+}
+
 int SystemVSM :: CreateGid_OPValue(const uint64_t llGid, std::string & sOpValue)
 {
     SystemVariables oVariables = m_oSystemVariables;
@@ -243,12 +266,22 @@ void SystemVSM :: RefleshNodeID()
         vecNodeInfoList.push_back(tTmpNode);
     }
 
+    if (m_poMembershipListener != nullptr)
+    {
+        m_poMembershipListener->OnMembershipChange(m_setNodeID);
+    }
+
     if (m_pMembershipChangeCallback != nullptr)
     {
         m_pMembershipChangeCallback(m_iMyGroupIdx, vecNodeInfoList);
     }
 }
 
+void SystemVSM :: SetMembershipListener(MembershipListener * poMembershipListener)
+{
+    m_poMembershipListener = poMembershipListener;
+}
+
 const int SystemVSM :: GetNodeCount() const
 {
     return (int)m_setNodeID.size();
@@ -32,6 +32,15 @@ namespace phxpaxos
 
 class MsgTransport;
 
+class MembershipListener
+{
+public:
+    virtual ~MembershipListener() {}
+
+    //called after membership reflesh, in the thread changing it.
+    virtual void OnMembershipChange(const std::set<nodeid_t> & setNodeID) = 0;
+};
+
 class SystemVSM : public InsideSM 
 {
 public:
@@ -57,6 +66,10 @@ public:
     
     int Membership_OPValue(const NodeInfoList & vecNodeInfoList, const uint64_t llVersion, std::string & sOpValue);
 
+    int ChecksumType_OPValue(const int iChecksumType, std::string & sOpValue);
+
+    const int GetChecksumType() const;
+
 public:
     //membership
     
@@ -72,6 +85,8 @@ public:
 
     const bool IsIMInMembership();
 
+    void SetMembershipListener(MembershipListener * poMembershipListener);
+
 public:
     const uint64_t GetCheckpointInstanceID(const int iGroupIdx) const { return m_oSystemVariables.version(); }
 
@@ -113,6 +128,7 @@ private:
     nodeid_t m_iMyNodeID;
 
     MembershipChangeCallback m_pMembershipChangeCallback;
+    MembershipListener * m_poMembershipListener;
 };
     
 }
@@ -0,0 +1,124 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "chosen_value_cache.h"
+#include "comm_include.h"
+
+namespace phxpaxos
+{
+
+ChosenValueCache :: ChosenValueCache(const LogStorage * poLogStorage, const int iMaxCount)
+    : m_oPaxosLog(poLogStorage), m_iMaxCount(iMaxCount), m_llHitCount(0), m_llMissCount(0)
+{
+}
+
+ChosenValueCache :: ~ChosenValueCache()
+{
+}
+
+int ChosenValueCache :: ReadState(const int iGroupIdx, const uint64_t llInstanceID, AcceptorStateData & oState)
+{
+    if (m_iMaxCount <= 0)
+    {
+        return m_oPaxosLog.ReadState(iGroupIdx, llInstanceID, oState);
+    }
+
+    std::shared_ptr<const AcceptorStateData> poState;
+
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+        auto it = m_mapCache.find(llInstanceID);
+        if (it != m_mapCache.end())
+        {
+            poState = it->second.first;
+            m_lstLRU.splice(m_lstLRU.begin(), m_lstLRU, it->second.second);
+        }
+    }
+
+    if (poState != nullptr)
+    {
+        m_llHitCount++;
+        BP->GetLogStorageBP()->ChosenValueCacheHit();
+
+        oState = *poState;
+        return 0;
+    }
+
+    m_llMissCount++;
+    BP->GetLogStorageBP()->ChosenValueCacheMiss();
+
+    //not fill on miss, a learner catching up from far behind would evict the hot tail.
+    return m_oPaxosLog.ReadState(iGroupIdx, llInstanceID, oState);
+}
+
+void ChosenValueCache :: Add(const AcceptorStateData & oState)
+{
+    if (m_iMaxCount <= 0)
+    {
+        return;
+    }
+
+    //copy outside lock, value maybe large.
+    std::shared_ptr<const AcceptorStateData> poState = std::make_shared<const AcceptorStateData>(oState);
+
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+    AddLocked(poState);
+}
+
+void ChosenValueCache :: AddLocked(const std::shared_ptr<const AcceptorStateData> & poState)
+{
+    auto it = m_mapCache.find(poState->instanceid());
+    if (it != m_mapCache.end())
+    {
+        it->second.first = poState;
+        m_lstLRU.splice(m_lstLRU.begin(), m_lstLRU, it->second.second);
+        return;
+    }
+
+    m_lstLRU.push_front(poState->instanceid());
+    m_mapCache[poState->instanceid()] = CacheEntry(poState, m_lstLRU.begin());
+
+    while ((int)m_mapCache.size() > m_iMaxCount)
+    {
+        m_mapCache.erase(m_lstLRU.back());
+        m_lstLRU.pop_back();
+    }
+}
+
+void ChosenValueCache :: Clear()
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+    m_mapCache.clear();
+    m_lstLRU.clear();
+}
+
+const uint64_t ChosenValueCache :: GetHitCount() const
+{
+    return m_llHitCount;
+}
+
+const uint64_t ChosenValueCache :: GetMissCount() const
+{
+    return m_llMissCount;
+}
+
+}
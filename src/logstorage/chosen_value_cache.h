@@ -0,0 +1,77 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <inttypes.h>
+#include "paxos_log.h"
+
+namespace phxpaxos
+{
+
+//Keep the most recent chosen states in memory, so the hot tail of paxos log
+//can be served to learners without db read and parse.
+//Only chosen state can be added, a chosen state never change.
+//Only the learn path add state, a miss read through db but not fill the cache.
+class ChosenValueCache
+{
+public:
+    ChosenValueCache(const LogStorage * poLogStorage, const int iMaxCount);
+    ~ChosenValueCache();
+
+    //read through on miss, return 0 means ok, 1 means not exist.
+    int ReadState(const int iGroupIdx, const uint64_t llInstanceID, AcceptorStateData & oState);
+
+    void Add(const AcceptorStateData & oState);
+
+    //call when the paxos log is cleared, e.g. before load a checkpoint.
+    void Clear();
+
+    const uint64_t GetHitCount() const;
+
+    const uint64_t GetMissCount() const;
+
+private:
+    void AddLocked(const std::shared_ptr<const AcceptorStateData> & poState);
+
+private:
+    typedef std::list<uint64_t> InstanceIDList;
+    typedef std::pair<std::shared_ptr<const AcceptorStateData>, InstanceIDList::iterator> CacheEntry;
+
+    PaxosLog m_oPaxosLog;
+    int m_iMaxCount;
+
+    std::mutex m_oMutex;
+    InstanceIDList m_lstLRU;
+    std::unordered_map<uint64_t, CacheEntry> m_mapCache;
+
+    std::atomic<uint64_t> m_llHitCount;
+    std::atomic<uint64_t> m_llMissCount;
+};
+
+}
@@ -0,0 +1,462 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "chunk_store.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <algorithm>
+#include "crc32.h"
+#include "comm_include.h"
+
+namespace phxpaxos
+{
+
+ChunkStore :: ChunkStore(const LogStorage * poLogStorage) 
+    : m_poLogStorage((LogStorage *)poLogStorage), m_bHasAnyChunk(false), m_iMyGroupIdx(-1)
+{
+}
+
+ChunkStore :: ~ChunkStore()
+{
+}
+
+int ChunkStore :: Init(const int iGroupIdx)
+{
+    m_iMyGroupIdx = iGroupIdx;
+
+    m_sPath = m_poLogStorage->GetLogStorageDirPath(iGroupIdx) + "/value_chunk";
+    if (access(m_sPath.c_str(), F_OK) == -1)
+    {
+        if (mkdir(m_sPath.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == -1)
+        {
+            PLG1Err("Create dir fail, path %s", m_sPath.c_str());
+            return -1;
+        }
+    }
+
+    std::vector<std::string> vecFilePathList;
+    int ret = FileUtils::IterDir(m_sPath, vecFilePathList);
+    if (ret != 0)
+    {
+        PLG1Err("IterDir fail, path %s", m_sPath.c_str());
+        return -1;
+    }
+
+    for (auto & sFilePath : vecFilePathList)
+    {
+        //tmp file left by crash.
+        if (sFilePath.find(".tmp") != std::string::npos)
+        {
+            remove(sFilePath.c_str());
+            continue;
+        }
+
+        ret = LoadFile(sFilePath);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+
+    m_bHasAnyChunk = m_mapValue.size() > 0;
+
+    PLG1Imp("OK, path %s value count %zu", m_sPath.c_str(), m_mapValue.size());
+
+    return 0;
+}
+
+int ChunkStore :: LoadFile(const std::string & sFilePath)
+{
+    size_t iPos = sFilePath.rfind('/');
+    std::string sFileName = iPos == std::string::npos ? sFilePath : sFilePath.substr(iPos + 1);
+
+    uint64_t llValueID = 0;
+    int iChunkIdx = -1;
+    char sSuffix[16] = {0};
+    bool bIsChosenFile = false;
+    if (sscanf(sFileName.c_str(), "%lu_%d", &llValueID, &iChunkIdx) == 2 && iChunkIdx >= 0)
+    {
+        bIsChosenFile = false;
+    }
+    else if (sscanf(sFileName.c_str(), "%lu.%15s", &llValueID, sSuffix) == 2 && strcmp(sSuffix, "chosen") == 0)
+    {
+        bIsChosenFile = true;
+    }
+    else
+    {
+        PLG1Err("unknown file, skip, filepath %s", sFilePath.c_str());
+        return 0;
+    }
+
+    struct stat oStat;
+    if (stat(sFilePath.c_str(), &oStat) != 0)
+    {
+        PLG1Err("stat fail, filepath %s", sFilePath.c_str());
+        return -1;
+    }
+
+    ChunkStoreValue & oValue = m_mapValue[llValueID];
+    if (bIsChosenFile)
+    {
+        oValue.bIsChosen = true;
+        return 0;
+    }
+
+    if ((int)oValue.vecHasChunk.size() <= iChunkIdx)
+    {
+        oValue.vecHasChunk.resize(iChunkIdx + 1, false);
+    }
+    oValue.vecHasChunk[iChunkIdx] = true;
+    oValue.llLastPutTimeMs = std::max(oValue.llLastPutTimeMs, (uint64_t)oStat.st_mtime * 1000);
+
+    return 0;
+}
+
+const std::string ChunkStore :: GetChunkPath(const uint64_t llValueID, const int iChunkIdx)
+{
+    char sFilePath[512] = {0};
+    snprintf(sFilePath, sizeof(sFilePath), "%s/%lu_%d", m_sPath.c_str(), llValueID, iChunkIdx);
+    return std::string(sFilePath);
+}
+
+const std::string ChunkStore :: GetChosenPath(const uint64_t llValueID)
+{
+    char sFilePath[512] = {0};
+    snprintf(sFilePath, sizeof(sFilePath), "%s/%lu.chosen", m_sPath.c_str(), llValueID);
+    return std::string(sFilePath);
+}
+
+int ChunkStore :: SyncDir()
+{
+    int iFd = open(m_sPath.c_str(), O_RDONLY);
+    if (iFd == -1)
+    {
+        PLG1Err("open dir fail, path %s errno %d", m_sPath.c_str(), errno);
+        return -1;
+    }
+
+    int ret = fsync(iFd);
+    close(iFd);
+
+    if (ret != 0)
+    {
+        PLG1Err("fsync dir fail, path %s errno %d", m_sPath.c_str(), errno);
+        return -1;
+    }
+
+    return 0;
+}
+
+int ChunkStore :: PutChunk(const uint64_t llValueID, const int iChunkIdx, const std::string & sChunk, const bool bSync)
+{
+    std::string sFilePath = GetChunkPath(llValueID, iChunkIdx);
+    std::string sTmpFilePath = sFilePath + ".tmp";
+
+    int iFd = open(sTmpFilePath.c_str(), O_CREAT | O_RDWR | O_TRUNC, S_IREAD | S_IWRITE);
+    if (iFd == -1)
+    {
+        PLG1Err("open fail, filepath %s", sTmpFilePath.c_str());
+        return -1;
+    }
+
+    size_t iWriteLen = 0;
+    while (iWriteLen < sChunk.size())
+    {
+        ssize_t iLen = write(iFd, sChunk.data() + iWriteLen, sChunk.size() - iWriteLen);
+        if (iLen <= 0)
+        {
+            PLG1Err("write fail, filepath %s writelen %zu chunksize %zu", 
+                    sTmpFilePath.c_str(), iWriteLen, sChunk.size());
+            close(iFd);
+            remove(sTmpFilePath.c_str());
+            return -1;
+        }
+
+        iWriteLen += iLen;
+    }
+
+    if (bSync && fdatasync(iFd) != 0)
+    {
+        PLG1Err("fdatasync fail, filepath %s errno %d", sTmpFilePath.c_str(), errno);
+        close(iFd);
+        remove(sTmpFilePath.c_str());
+        return -1;
+    }
+
+    close(iFd);
+
+    //rename make sure reader will never see half chunk.
+    if (rename(sTmpFilePath.c_str(), sFilePath.c_str()) != 0)
+    {
+        PLG1Err("rename fail, from %s to %s", sTmpFilePath.c_str(), sFilePath.c_str());
+        remove(sTmpFilePath.c_str());
+        return -1;
+    }
+
+    //the rename itself is durable only after the dir is synced,
+    //acceptor accept only after all chunks are durable.
+    if (bSync && SyncDir() != 0)
+    {
+        return -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+        ChunkStoreValue & oValue = m_mapValue[llValueID];
+        if ((int)oValue.vecHasChunk.size() <= iChunkIdx)
+        {
+            oValue.vecHasChunk.resize(iChunkIdx + 1, false);
+        }
+        oValue.vecHasChunk[iChunkIdx] = true;
+        oValue.llLastPutTimeMs = Time::GetTimestampMS();
+    }
+
+    m_bHasAnyChunk = true;
+
+    return 0;
+}
+
+int ChunkStore :: GetChunk(const uint64_t llValueID, const int iChunkIdx, std::string & sChunk)
+{
+    std::string sFilePath = GetChunkPath(llValueID, iChunkIdx);
+
+    int iFd = open(sFilePath.c_str(), O_RDONLY);
+    if (iFd == -1)
+    {
+        return 1;
+    }
+
+    struct stat oStat;
+    if (fstat(iFd, &oStat) != 0)
+    {
+        PLG1Err("fstat fail, filepath %s", sFilePath.c_str());
+        close(iFd);
+        return -1;
+    }
+
+    sChunk.resize(oStat.st_size);
+
+    size_t iReadLen = 0;
+    while (iReadLen < sChunk.size())
+    {
+        ssize_t iLen = read(iFd, &sChunk[iReadLen], sChunk.size() - iReadLen);
+        if (iLen <= 0)
+        {
+            PLG1Err("read fail, filepath %s readlen %zu filesize %zu", 
+                    sFilePath.c_str(), iReadLen, sChunk.size());
+            close(iFd);
+            return -1;
+        }
+
+        iReadLen += iLen;
+    }
+
+    close(iFd);
+
+    return 0;
+}
+
+const bool ChunkStore :: HasChunk(const uint64_t llValueID, const int iChunkIdx)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+    auto it = m_mapValue.find(llValueID);
+    if (it == end(m_mapValue) || iChunkIdx < 0 || iChunkIdx >= (int)it->second.vecHasChunk.size())
+    {
+        return false;
+    }
+
+    return it->second.vecHasChunk[iChunkIdx];
+}
+
+const bool ChunkStore :: HasAnyChunk() const
+{
+    return m_bHasAnyChunk;
+}
+
+int ChunkStore :: MarkChosen(const uint64_t llValueID, const bool bSync)
+{
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+        auto it = m_mapValue.find(llValueID);
+        if (it == end(m_mapValue) || it->second.bIsChosen)
+        {
+            return 0;
+        }
+    }
+
+    std::string sFilePath = GetChosenPath(llValueID);
+    int iFd = open(sFilePath.c_str(), O_CREAT | O_WRONLY, S_IREAD | S_IWRITE);
+    if (iFd == -1)
+    {
+        PLG1Err("open fail, filepath %s errno %d", sFilePath.c_str(), errno);
+        return -1;
+    }
+
+    close(iFd);
+
+    if (bSync && SyncDir() != 0)
+    {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+    auto it = m_mapValue.find(llValueID);
+    if (it != end(m_mapValue))
+    {
+        it->second.bIsChosen = true;
+    }
+
+    return 0;
+}
+
+int ChunkStore :: LoadValue(const ValueChunkManifest & oManifest, std::string & sValue)
+{
+    sValue.clear();
+    sValue.reserve(oManifest.valuesize());
+
+    uint32_t iValueChecksum = 0;
+    std::string sChunk;
+    for (int i = 0; i < oManifest.chunkchecksum_size(); i++)
+    {
+        int ret = GetChunk(oManifest.valueid(), i, sChunk);
+        if (ret != 0)
+        {
+            return ret;
+        }
+
+        uint32_t iChunkChecksum = crc32(0, (const uint8_t *)sChunk.data(), sChunk.size());
+        if (iChunkChecksum != oManifest.chunkchecksum(i))
+        {
+            PLG1Err("chunk checksum not same, valueid %lu chunkidx %d cal checksum %u manifest checksum %u",
+                    oManifest.valueid(), i, iChunkChecksum, oManifest.chunkchecksum(i));
+            return -1;
+        }
+
+        iValueChecksum = crc32(iValueChecksum, (const uint8_t *)sChunk.data(), sChunk.size());
+        sValue.append(sChunk);
+    }
+
+    if (sValue.size() != oManifest.valuesize() || iValueChecksum != oManifest.valuechecksum())
+    {
+        PLG1Err("value not same, valueid %lu size %zu manifest size %lu checksum %u manifest checksum %u",
+                oManifest.valueid(), sValue.size(), oManifest.valuesize(), iValueChecksum, oManifest.valuechecksum());
+        return -1;
+    }
+
+    return 0;
+}
+
+void ChunkStore :: GetMissingChunks(const ValueChunkManifest & oManifest, std::vector<int> & vecChunkIdx)
+{
+    vecChunkIdx.clear();
+
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+    auto it = m_mapValue.find(oManifest.valueid());
+    for (int i = 0; i < oManifest.chunkchecksum_size(); i++)
+    {
+        if (it == end(m_mapValue) || i >= (int)it->second.vecHasChunk.size() || !it->second.vecHasChunk[i])
+        {
+            vecChunkIdx.push_back(i);
+        }
+    }
+}
+
+int ChunkStore :: DelValue(const uint64_t llValueID, const int iChunkCount)
+{
+    int ret = DelFiles(llValueID, iChunkCount);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+    m_mapValue.erase(llValueID);
+
+    return 0;
+}
+
+int ChunkStore :: DelFiles(const uint64_t llValueID, const int iChunkCount)
+{
+    //mark first, chunks left by crash are collected by GCValues.
+    std::string sChosenPath = GetChosenPath(llValueID);
+    if (remove(sChosenPath.c_str()) != 0 && errno != ENOENT)
+    {
+        PLG1Err("remove fail, filepath %s", sChosenPath.c_str());
+        return -1;
+    }
+
+    for (int i = 0; i < iChunkCount; i++)
+    {
+        std::string sFilePath = GetChunkPath(llValueID, i);
+        if (remove(sFilePath.c_str()) != 0 && errno != ENOENT)
+        {
+            PLG1Err("remove fail, filepath %s", sFilePath.c_str());
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int ChunkStore :: GCValues(const uint64_t llMaxAgeMs, const std::set<uint64_t> & setKeepValueID, int & iDelCount)
+{
+    iDelCount = 0;
+    uint64_t llNowTimeMs = Time::GetTimestampMS();
+
+    std::vector<std::pair<uint64_t, int> > vecGarbage;
+    {
+        std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+        for (auto & it : m_mapValue)
+        {
+            const ChunkStoreValue & oValue = it.second;
+            if (oValue.bIsChosen
+                    || setKeepValueID.find(it.first) != end(setKeepValueID)
+                    || llNowTimeMs < oValue.llLastPutTimeMs + llMaxAgeMs)
+            {
+                continue;
+            }
+
+            vecGarbage.push_back(std::make_pair(it.first, (int)oValue.vecHasChunk.size()));
+        }
+    }
+
+    for (auto & oGarbage : vecGarbage)
+    {
+        int ret = DelValue(oGarbage.first, oGarbage.second);
+        if (ret != 0)
+        {
+            return ret;
+        }
+
+        PLG1Imp("delete value never chosen, valueid %lu chunkcount %d", oGarbage.first, oGarbage.second);
+        iDelCount++;
+    }
+
+    return 0;
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <inttypes.h>
+#include "phxpaxos/storage.h"
+#include "paxos_msg.pb.h"
+
+namespace phxpaxos
+{
+
+//chunks of a value never chosen are garbage after this long without new chunk.
+#define VALUE_CHUNK_GC_AGE_MS (3600 * 1000)
+
+//in memory state of a value's chunks, so ioloop check chunks without disk io.
+class ChunkStoreValue
+{
+public:
+    ChunkStoreValue() : llLastPutTimeMs(0), bIsChosen(false) { }
+
+    std::vector<bool> vecHasChunk;
+    uint64_t llLastPutTimeMs;
+    bool bIsChosen;
+};
+
+//Store chunks of large value which paxos only agree on it's manifest.
+//One file per chunk, path is [logstorage dir]/value_chunk/[valueid]_[chunkidx].
+//A chosen value has a mark file [valueid].chosen, chunks of it are deleted
+//with it's paxos log, chunks of others are deleted by GCValues.
+class ChunkStore
+{
+public:
+    ChunkStore(const LogStorage * poLogStorage);
+    ~ChunkStore();
+
+    int Init(const int iGroupIdx);
+
+    int PutChunk(const uint64_t llValueID, const int iChunkIdx, const std::string & sChunk, const bool bSync);
+
+    //return 1 means chunk not exist.
+    int GetChunk(const uint64_t llValueID, const int iChunkIdx, std::string & sChunk);
+
+    const bool HasChunk(const uint64_t llValueID, const int iChunkIdx);
+
+    const bool HasAnyChunk() const;
+
+    int MarkChosen(const uint64_t llValueID, const bool bSync);
+
+public:
+    //return 0 means ok, 1 means some chunks not exist, -1 means chunk broken.
+    int LoadValue(const ValueChunkManifest & oManifest, std::string & sValue);
+
+    void GetMissingChunks(const ValueChunkManifest & oManifest, std::vector<int> & vecChunkIdx);
+
+    int DelValue(const uint64_t llValueID, const int iChunkCount);
+
+    //delete values not chosen and without new chunk for llMaxAgeMs, except setKeepValueID.
+    int GCValues(const uint64_t llMaxAgeMs, const std::set<uint64_t> & setKeepValueID, int & iDelCount);
+
+private:
+    const std::string GetChunkPath(const uint64_t llValueID, const int iChunkIdx);
+
+    const std::string GetChosenPath(const uint64_t llValueID);
+
+    int SyncDir();
+
+    int LoadFile(const std::string & sFilePath);
+
+    int DelFiles(const uint64_t llValueID, const int iChunkCount);
+
+private:
+    LogStorage * m_poLogStorage;
+    std::string m_sPath;
+    std::atomic<bool> m_bHasAnyChunk;
+    int m_iMyGroupIdx;
+
+    std::mutex m_oMutex;
+    std::map<uint64_t, ChunkStoreValue> m_mapValue;
+};
+
+}
@@ -20,6 +20,7 @@ See the AUTHORS file for names of contributors.
 */
 
 #include "db.h"
+#include "leveldb/write_batch.h"
 #include "commdef.h"
 #include "utils_include.h"
 
@@ -65,6 +66,7 @@ Database :: Database() : m_poLevelDB(nullptr), m_poValueStore(nullptr)
 {
     m_bHasInit = false;
     m_iMyGroupIdx = -1;
+    m_llCompactBeginInstanceID = (uint64_t)-1;
 }
 
 Database :: ~Database()
@@ -365,9 +367,26 @@ int Database :: Put(const WriteOptions & oWriteOptions, const uint64_t llInstanc
         return ret;
     }
 
-    ret = PutToLevelDB(false, llInstanceID, sFileID);
+    //sync index periodically, so rebuild index only need to scan the tail after watermark.
+    bool bNeedSaveIndexWatermark = m_poValueStore->NeedSaveIndexWatermark();
+
+    ret = PutToLevelDB(bNeedSaveIndexWatermark, llInstanceID, sFileID);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    if (bNeedSaveIndexWatermark)
+    {
+        //watermark only speed up restart, value already persist.
+        int iWatermarkRet = m_poValueStore->SaveIndexWatermark(llInstanceID, sFileID);
+        if (iWatermarkRet != 0)
+        {
+            PLG1Err("SaveIndexWatermark fail, instanceid %lu ret %d", llInstanceID, iWatermarkRet);
+        }
+    }
     
-    return ret;
+    return 0;
 }
 
 int Database :: ForceDel(const WriteOptions & oWriteOptions, const uint64_t llInstanceID)
@@ -460,6 +479,77 @@ int Database :: Del(const WriteOptions & oWriteOptions, const uint64_t llInstanc
     return 0;
 }
 
+int Database :: DeleteRange(const WriteOptions & oWriteOptions, 
+        const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID)
+{
+    if (!m_bHasInit)
+    {
+        PLG1Err("no init yet");
+        return -1;
+    }
+
+    if (llBeginInstanceID >= llEndInstanceID)
+    {
+        return 0;
+    }
+
+    //vfiles before the last one's are all deleted.
+    string sLastKey = GenKey(llEndInstanceID - 1);
+    string sLastFileID;
+    leveldb::Status oStatus = m_poLevelDB->Get(leveldb::ReadOptions(), sLastKey, &sLastFileID);
+    if (!oStatus.ok() && !oStatus.IsNotFound())
+    {
+        PLG1Err("LevelDB.Get fail, instanceid %lu", llEndInstanceID - 1);
+        return -1;
+    }
+
+    //one atomic write for the whole range, never leave holes.
+    leveldb::WriteBatch oBatch;
+    for (uint64_t llInstanceID = llBeginInstanceID; llInstanceID < llEndInstanceID; llInstanceID++)
+    {
+        oBatch.Delete(GenKey(llInstanceID));
+    }
+
+    leveldb::WriteOptions oLevelDBWriteOptions;
+    oLevelDBWriteOptions.sync = oWriteOptions.bSync;
+
+    oStatus = m_poLevelDB->Write(oLevelDBWriteOptions, &oBatch);
+    if (!oStatus.ok())
+    {
+        PLG1Err("LevelDB.Write fail, begin instanceid %lu end instanceid %lu", llBeginInstanceID, llEndInstanceID);
+        return -1;
+    }
+
+    if (sLastFileID.size() > 0)
+    {
+        int ret = m_poValueStore->Del(sLastFileID, llEndInstanceID - 1);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+
+    if (m_llCompactBeginInstanceID == (uint64_t)-1)
+    {
+        m_llCompactBeginInstanceID = llBeginInstanceID;
+    }
+
+    if (llEndInstanceID >= m_llCompactBeginInstanceID + DELETE_COMPACT_INTERVAL)
+    {
+        string sBeginKey = GenKey(m_llCompactBeginInstanceID);
+        leveldb::Slice oBegin(sBeginKey);
+        leveldb::Slice oEnd(sLastKey);
+        m_poLevelDB->CompactRange(&oBegin, &oEnd);
+
+        PLG1Imp("compact deleted range, begin instanceid %lu end instanceid %lu", 
+                m_llCompactBeginInstanceID, llEndInstanceID);
+
+        m_llCompactBeginInstanceID = llEndInstanceID;
+    }
+
+    return 0;
+}
+
 int Database :: GetMaxInstanceID(uint64_t & llInstanceID)
 {
     llInstanceID = MINCHOSEN_KEY;
@@ -695,6 +785,17 @@ int MultiDatabase :: Del(const WriteOptions & oWriteOptions, const int iGroupIdx
     return m_vecDBList[iGroupIdx]->Del(oWriteOptions, llInstanceID);
 }
 
+int MultiDatabase :: DeleteRange(const WriteOptions & oWriteOptions, const int iGroupIdx, 
+        const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID)
+{
+    if (iGroupIdx >= (int)m_vecDBList.size())
+    {
+        return -2;
+    }
+    
+    return m_vecDBList[iGroupIdx]->DeleteRange(oWriteOptions, llBeginInstanceID, llEndInstanceID);
+}
+
 int MultiDatabase :: ForceDel(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID)
 {
     if (iGroupIdx >= (int)m_vecDBList.size())
@@ -53,6 +53,9 @@ public:
 #define SYSTEMVARIABLES_KEY ((uint64_t)-2)
 #define MASTERVARIABLES_KEY ((uint64_t)-3)
 
+//compact deleted range after so many instances deleted, let leveldb drop the tombstones.
+#define DELETE_COMPACT_INTERVAL 1000000
+
 class Database
 {
 public:
@@ -71,6 +74,8 @@ public:
 
     int Del(const WriteOptions & oWriteOptions, const uint64_t llInstanceID);
 
+    int DeleteRange(const WriteOptions & oWriteOptions, const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID);
+
     int ForceDel(const WriteOptions & oWriteOptions, const uint64_t llInstanceID);
 
     int GetMaxInstanceID(uint64_t & llInstanceID);
@@ -119,6 +124,7 @@ public:
 
 private:
     TimeStat m_oTimeStat;
+    uint64_t m_llCompactBeginInstanceID;
 };
 
 //////////////////////////////////////////
@@ -139,6 +145,9 @@ public:
 
     int Del(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID);
 
+    int DeleteRange(const WriteOptions & oWriteOptions, const int iGroupIdx, 
+            const uint64_t llBeginInstanceID, const uint64_t llEndInstanceID);
+
     int ForceDel(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID);
 
     int GetMaxInstanceID(const int iGroupIdx, uint64_t & llInstanceID);
@@ -42,6 +42,10 @@ LogStore :: LogStore()
     m_iMyGroupIdx = -1;
     m_iNowFileSize = -1;
     m_iNowFileOffset = 0;
+    m_iWatermarkFd = -1;
+    m_iAppendCountSinceWatermark = 0;
+    m_bNeedIndexWatermark = false;
+    m_llLastAppendInstanceID = 0;
 }
 
 LogStore :: ~LogStore()
@@ -55,6 +59,11 @@ LogStore :: ~LogStore()
     {
         close(m_iMetaFd);
     }
+
+    if (m_iWatermarkFd != -1)
+    {
+        close(m_iWatermarkFd);
+    }
 }
 
 int LogStore :: Init(const std::string & sPath, const int iMyGroupIdx, Database * poDatabase)
@@ -114,6 +123,15 @@ int LogStore :: Init(const std::string & sPath, const int iMyGroupIdx, Database
         }
     }
 
+    string sWatermarkFilePath = m_sPath + "/watermark";
+
+    m_iWatermarkFd = open(sWatermarkFilePath.c_str(), O_CREAT | O_RDWR, S_IREAD | S_IWRITE);
+    if (m_iWatermarkFd == -1)
+    {
+        PLG1Err("open watermark file fail, filepath %s", sWatermarkFilePath.c_str());
+        return -1;
+    }
+
     int ret = RebuildIndex(poDatabase, m_iNowFileOffset);
     if (ret != 0)
     {
@@ -293,8 +311,11 @@ int LogStore :: GetFileFD(const int iNeedWriteSize, int & iFd, int & iFileID, in
     iOffset = lseek(m_iFd, m_iNowFileOffset, SEEK_SET);
     assert(iOffset != -1);
 
-    if (iOffset + iNeedWriteSize > m_iNowFileSize)
+    if (iOffset + iNeedWriteSize > m_iNowFileSize - (int)SEGMENT_TRAILER_LEN)
     {
+        //seal this file, the trailer let rebuild index skip it without reading.
+        WriteSegmentTrailer(m_iFd, m_iNowFileSize, m_iNowFileOffset, m_llLastAppendInstanceID);
+
         close(m_iFd);
         m_iFd = -1;
 
@@ -338,6 +359,9 @@ int LogStore :: GetFileFD(const int iNeedWriteSize, int & iFd, int & iFileID, in
         }
 
         m_oFileLogger.Log("new file expand ok, fileid %d filesize %d", m_iFileID, m_iNowFileSize);
+
+        //make sure all index of the sealed file persist before write new file.
+        m_bNeedIndexWatermark = true;
     }
 
     iFd = m_iFd;
@@ -391,6 +415,8 @@ int LogStore :: Append(const WriteOptions & oWriteOptions, const uint64_t llInst
     }
 
     m_iNowFileOffset += iWriteLen;
+    m_llLastAppendInstanceID = llInstanceID;
+    m_iAppendCountSinceWatermark++;
 
     int iUseTimeMs = m_oTimeStat.Point();
     BP->GetLogStorageBP()->AppendDataOK(iWriteLen, iUseTimeMs);
@@ -504,6 +530,12 @@ int LogStore :: ForceDel(const std::string & sFileID, const uint64_t llInstanceI
 
     printf("fileid %d offset %d\n", iFileID, iOffset);
 
+    //watermark may point to the truncated data.
+    if (ClearIndexWatermark() != 0)
+    {
+        return -1;
+    }
+
     if (truncate(sFilePath, iOffset) != 0)
     {
         return -1;
@@ -544,6 +576,184 @@ const bool LogStore :: IsValidFileID(const std::string & sFileID)
 
 //////////////////////////////////////////////////////////////////
 
+const bool LogStore :: NeedSaveIndexWatermark()
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    return m_bNeedIndexWatermark || m_iAppendCountSinceWatermark >= LOG_INDEX_WATERMARK_INTERVAL;
+}
+
+int LogStore :: SaveIndexWatermark(const uint64_t llInstanceID, const std::string & sFileID)
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    int iFileID = -1;
+    int iOffset = -1;
+    uint32_t iCheckSum = 0;
+    ParseFileID(sFileID, iFileID, iOffset, iCheckSum);
+
+    char sBuffer[INDEX_WATERMARK_LEN] = {0};
+    memcpy(sBuffer, &iFileID, sizeof(int));
+    memcpy(sBuffer + sizeof(int), &iOffset, sizeof(int));
+    memcpy(sBuffer + sizeof(int) + sizeof(int), &llInstanceID, sizeof(uint64_t));
+    memcpy(sBuffer + sizeof(int) + sizeof(int) + sizeof(uint64_t), &iCheckSum, sizeof(uint32_t));
+
+    uint32_t iWatermarkCheckSum = crc32(0, (const uint8_t *)sBuffer, INDEX_WATERMARK_LEN - sizeof(uint32_t));
+    memcpy(sBuffer + INDEX_WATERMARK_LEN - sizeof(uint32_t), &iWatermarkCheckSum, sizeof(uint32_t));
+
+    ssize_t iWriteLen = pwrite(m_iWatermarkFd, sBuffer, INDEX_WATERMARK_LEN, 0);
+    if (iWriteLen != (ssize_t)INDEX_WATERMARK_LEN)
+    {
+        PLG1Err("write watermark fail, writelen %zd errno %d", iWriteLen, errno);
+        return -1;
+    }
+
+    int ret = fdatasync(m_iWatermarkFd);
+    if (ret != 0)
+    {
+        PLG1Err("fdatasync watermark fail, errno %d", errno);
+        return -1;
+    }
+
+    m_bNeedIndexWatermark = false;
+    m_iAppendCountSinceWatermark = 0;
+
+    PLG1Imp("ok, fileid %d offset %d instanceid %lu", iFileID, iOffset, llInstanceID);
+
+    return 0;
+}
+
+int LogStore :: LoadIndexWatermark(int & iFileID, int & iOffset, uint64_t & llInstanceID)
+{
+    char sBuffer[INDEX_WATERMARK_LEN] = {0};
+    ssize_t iReadLen = pread(m_iWatermarkFd, sBuffer, INDEX_WATERMARK_LEN, 0);
+    if (iReadLen != (ssize_t)INDEX_WATERMARK_LEN)
+    {
+        PLG1Imp("no watermark, readlen %zd", iReadLen);
+        return 1;
+    }
+
+    uint32_t iWatermarkCheckSum = 0;
+    memcpy(&iWatermarkCheckSum, sBuffer + INDEX_WATERMARK_LEN - sizeof(uint32_t), sizeof(uint32_t));
+
+    uint32_t iCalCheckSum = crc32(0, (const uint8_t *)sBuffer, INDEX_WATERMARK_LEN - sizeof(uint32_t));
+    if (iCalCheckSum != iWatermarkCheckSum)
+    {
+        PLG1Err("watermark checksum %u not same to cal checksum %u", iWatermarkCheckSum, iCalCheckSum);
+        return 1;
+    }
+
+    memcpy(&iFileID, sBuffer, sizeof(int));
+    memcpy(&iOffset, sBuffer + sizeof(int), sizeof(int));
+    memcpy(&llInstanceID, sBuffer + sizeof(int) + sizeof(int), sizeof(uint64_t));
+
+    return 0;
+}
+
+int LogStore :: ClearIndexWatermark()
+{
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    if (ftruncate(m_iWatermarkFd, 0) != 0)
+    {
+        PLG1Err("truncate watermark fail, errno %d", errno);
+        return -1;
+    }
+
+    m_bNeedIndexWatermark = true;
+
+    return 0;
+}
+
+int LogStore :: WriteSegmentTrailer(const int iFd, const int iFileSize, const int iDataEndOffset, const uint64_t llLastInstanceID)
+{
+    int iTrailerOffset = iFileSize - (int)SEGMENT_TRAILER_LEN;
+    if (iDataEndOffset > iTrailerOffset)
+    {
+        //file written by old version, data already use the trailer space.
+        PLG1Imp("no space for trailer, data end offset %d filesize %d", iDataEndOffset, iFileSize);
+        return 1;
+    }
+
+    uint32_t iMagic = SEGMENT_TRAILER_MAGIC;
+
+    char sBuffer[SEGMENT_TRAILER_LEN] = {0};
+    memcpy(sBuffer, &iMagic, sizeof(uint32_t));
+    memcpy(sBuffer + sizeof(uint32_t), &iDataEndOffset, sizeof(int));
+    memcpy(sBuffer + sizeof(uint32_t) + sizeof(int), &llLastInstanceID, sizeof(uint64_t));
+
+    uint32_t iTrailerCheckSum = crc32(0, (const uint8_t *)sBuffer, SEGMENT_TRAILER_LEN - sizeof(uint32_t));
+    memcpy(sBuffer + SEGMENT_TRAILER_LEN - sizeof(uint32_t), &iTrailerCheckSum, sizeof(uint32_t));
+
+    ssize_t iWriteLen = pwrite(iFd, sBuffer, SEGMENT_TRAILER_LEN, iTrailerOffset);
+    if (iWriteLen != (ssize_t)SEGMENT_TRAILER_LEN)
+    {
+        PLG1Err("write trailer fail, writelen %zd errno %d", iWriteLen, errno);
+        return -1;
+    }
+
+    if (fdatasync(iFd) != 0)
+    {
+        PLG1Err("fdatasync trailer fail, errno %d", errno);
+        return -1;
+    }
+
+    m_oFileLogger.Log("seal fileid %d data end offset %d last instanceid %lu", 
+            m_iFileID, iDataEndOffset, llLastInstanceID);
+
+    return 0;
+}
+
+int LogStore :: ReadSegmentTrailer(const int iFileID, int & iDataEndOffset, uint64_t & llLastInstanceID)
+{
+    int iFd = -1;
+    int ret = OpenFile(iFileID, iFd);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    int iFileLen = lseek(iFd, 0, SEEK_END);
+    if (iFileLen < (int)SEGMENT_TRAILER_LEN)
+    {
+        close(iFd);
+        return 1;
+    }
+
+    char sBuffer[SEGMENT_TRAILER_LEN] = {0};
+    ssize_t iReadLen = pread(iFd, sBuffer, SEGMENT_TRAILER_LEN, iFileLen - SEGMENT_TRAILER_LEN);
+    close(iFd);
+
+    if (iReadLen != (ssize_t)SEGMENT_TRAILER_LEN)
+    {
+        PLG1Err("read trailer fail, fileid %d readlen %zd", iFileID, iReadLen);
+        return 1;
+    }
+
+    uint32_t iMagic = 0;
+    memcpy(&iMagic, sBuffer, sizeof(uint32_t));
+    if (iMagic != SEGMENT_TRAILER_MAGIC)
+    {
+        return 1;
+    }
+
+    uint32_t iTrailerCheckSum = 0;
+    memcpy(&iTrailerCheckSum, sBuffer + SEGMENT_TRAILER_LEN - sizeof(uint32_t), sizeof(uint32_t));
+
+    uint32_t iCalCheckSum = crc32(0, (const uint8_t *)sBuffer, SEGMENT_TRAILER_LEN - sizeof(uint32_t));
+    if (iCalCheckSum != iTrailerCheckSum)
+    {
+        PLG1Err("trailer checksum %u not same to cal checksum %u, fileid %d", 
+                iTrailerCheckSum, iCalCheckSum, iFileID);
+        return 1;
+    }
+
+    memcpy(&iDataEndOffset, sBuffer + sizeof(uint32_t), sizeof(int));
+    memcpy(&llLastInstanceID, sBuffer + sizeof(uint32_t) + sizeof(int), sizeof(uint64_t));
+
+    return 0;
+}
+
 int LogStore :: RebuildIndex(Database * poDatabase, int & iNowFileWriteOffset)
 {
     string sLastFileID;
@@ -571,10 +781,57 @@ int LogStore :: RebuildIndex(Database * poDatabase, int & iNowFileWriteOffset)
         return -2;
     }
 
+    //The index before watermark was synced to leveldb, but the leveldb tail may 
+    //point to value data never synced, so verify and reindex from watermark.
+    int iWatermarkFileID = -1;
+    int iWatermarkOffset = -1;
+    uint64_t llWatermarkInstanceID = 0;
+    ret = LoadIndexWatermark(iWatermarkFileID, iWatermarkOffset, llWatermarkInstanceID);
+    if (ret == 0)
+    {
+        char sWatermarkFilePath[512] = {0};
+        snprintf(sWatermarkFilePath, sizeof(sWatermarkFilePath), "%s/%d.f", m_sPath.c_str(), iWatermarkFileID);
+
+        if (sLastFileID.size() == 0 || llNowInstanceID < llWatermarkInstanceID
+                || iWatermarkFileID < 0 || iWatermarkFileID > m_iFileID || iWatermarkOffset < 0
+                || access(sWatermarkFilePath, F_OK) == -1)
+        {
+            PLG1Err("watermark invalid, fileid %d offset %d instanceid %lu, leveldb max instanceid %lu, "
+                    "rebuild from leveldb max",
+                    iWatermarkFileID, iWatermarkOffset, llWatermarkInstanceID, llNowInstanceID);
+        }
+        else
+        {
+            PLG1Head("watermark fileid %d offset %d instanceid %lu, tail instances %lu",
+                    iWatermarkFileID, iWatermarkOffset, llWatermarkInstanceID, 
+                    llNowInstanceID - llWatermarkInstanceID);
+
+            iFileID = iWatermarkFileID;
+            iOffset = iWatermarkOffset;
+            llNowInstanceID = llWatermarkInstanceID;
+        }
+    }
+
     PLG1Head("START fileid %d offset %d checksum %u", iFileID, iOffset, iCheckSum);
+    BP->GetLogStorageBP()->RebuildIndexStart(iFileID, iOffset);
 
     for (int iNowFileID = iFileID; ;iNowFileID++)
     {
+        if (iNowFileID < m_iFileID && sLastFileID.size() > 0)
+        {
+            int iDataEndOffset = 0;
+            uint64_t llLastInstanceID = 0;
+            if (ReadSegmentTrailer(iNowFileID, iDataEndOffset, llLastInstanceID) == 0
+                    && llLastInstanceID <= llNowInstanceID)
+            {
+                //sealed file and all its index already in leveldb.
+                PLG1Imp("skip sealed fileid %d data end offset %d last instanceid %lu",
+                        iNowFileID, iDataEndOffset, llLastInstanceID);
+                iOffset = 0;
+                continue;
+            }
+        }
+
         ret = RebuildIndexForOneFile(iNowFileID, iOffset, poDatabase, iNowFileWriteOffset, llNowInstanceID);
         if (ret != 0 && ret != 1)
         {
@@ -595,6 +852,8 @@ int LogStore :: RebuildIndex(Database * poDatabase, int & iNowFileWriteOffset)
 
         iOffset = 0;
     }
+
+    m_llLastAppendInstanceID = llNowInstanceID;
     
     return ret;
 }
@@ -633,11 +892,26 @@ int LogStore :: RebuildIndexForOneFile(const int iFileID, const int iOffset,
         return -1;
     }
 
+    //sealed file, the trailer is not a record.
+    int iDataEndOffset = iFileLen;
+    uint64_t llLastInstanceID = 0;
+    if (ReadSegmentTrailer(iFileID, iDataEndOffset, llLastInstanceID) != 0)
+    {
+        iDataEndOffset = iFileLen;
+    }
+
     int iNowOffset = iOffset;
     bool bNeedTruncate = false;
 
     while (true)
     {
+        if (iNowOffset >= iDataEndOffset)
+        {
+            PLG1Head("File Sealed End, fileid %d offset %d", iFileID, iNowOffset);
+            iNowFileWriteOffset = iNowOffset;
+            break;
+        }
+
         int iLen = 0;
         ssize_t iReadLen = read(iFd, (char *)&iLen, sizeof(int));
         if (iReadLen == 0)
@@ -35,6 +35,14 @@ class Database;
 
 #define FILEID_LEN (sizeof(int) + sizeof(int) + sizeof(uint32_t))
 
+//index watermark: fileid + offset + instanceid + record checksum + crc.
+#define INDEX_WATERMARK_LEN (sizeof(int) + sizeof(int) + sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t))
+
+//segment trailer, stored in the last bytes of a sealed vfile: 
+//magic + data end offset + last instanceid + crc.
+#define SEGMENT_TRAILER_LEN (sizeof(uint32_t) + sizeof(int) + sizeof(uint64_t) + sizeof(uint32_t))
+#define SEGMENT_TRAILER_MAGIC 0x50584654
+
 class LogStoreLogger
 {
 public:
@@ -68,6 +76,14 @@ public:
 
     const bool IsValidFileID(const std::string & sFileID);
 
+    ////////////////////////////////////////////
+
+    //True means the index of the next appended value should be synced,
+    //and then recorded as the new index watermark.
+    const bool NeedSaveIndexWatermark();
+
+    int SaveIndexWatermark(const uint64_t llInstanceID, const std::string & sFileID);
+
     ////////////////////////////////////////////
     
     int RebuildIndex(Database * poDatabase, int & iNowFileWriteOffset);
@@ -89,6 +105,14 @@ private:
     int GetFileFD(const int iNeedWriteSize, int & iFd, int & iFileID, int & iOffset);
 
     int ExpandFile(int iFd, int & iFileSize);
+
+    int LoadIndexWatermark(int & iFileID, int & iOffset, uint64_t & llInstanceID);
+
+    int ClearIndexWatermark();
+
+    int WriteSegmentTrailer(const int iFd, const int iFileSize, const int iDataEndOffset, const uint64_t llLastInstanceID);
+
+    int ReadSegmentTrailer(const int iFileID, int & iDataEndOffset, uint64_t & llLastInstanceID);
     
 private:
     int m_iFd;
@@ -107,6 +131,11 @@ private:
     int m_iNowFileSize;
     int m_iNowFileOffset;
 
+    int m_iWatermarkFd;
+    int m_iAppendCountSinceWatermark;
+    bool m_bNeedIndexWatermark;
+    uint64_t m_llLastAppendInstanceID;
+
 private:
     TimeStat m_oTimeStat;
     LogStoreLogger m_oFileLogger;
@@ -21,6 +21,7 @@ See the AUTHORS file for names of contributors.
 
 #include "paxos_log.h"
 #include "db.h"
+#include "comm_include.h"
 
 namespace phxpaxos
 {
@@ -103,6 +104,41 @@ int PaxosLog :: WriteState(const WriteOptions & oWriteOptions, const int iGroupI
     return 0;
 }
 
+int PaxosLog :: WriteState(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID, const AcceptorStateData & oState,
+        const int iCompressThreshold, const uint32_t iCompressDictID)
+{
+    const int m_iMyGroupIdx = iGroupIdx;
+
+    if (iCompressThreshold <= 0 || (int)oState.acceptedvalue().size() < iCompressThreshold)
+    {
+        return WriteState(oWriteOptions, iGroupIdx, llInstanceID, oState);
+    }
+
+    uint64_t llBeginTimeUs = Time::GetSteadyClockUS();
+
+    string sCompressValue;
+    int ret = ValueCompressor::Compress(iCompressDictID, oState.acceptedvalue(), sCompressValue);
+    if (ret != 0)
+    {
+        if (ret < 0)
+        {
+            PLG1Err("Compress fail, dictid %u ret %d", iCompressDictID, ret);
+        }
+
+        BP->GetAlgorithmBaseBP()->ValueCompressSkip(oState.acceptedvalue().size());
+        return WriteState(oWriteOptions, iGroupIdx, llInstanceID, oState);
+    }
+
+    BP->GetAlgorithmBaseBP()->ValueCompress(oState.acceptedvalue().size(), sCompressValue.size(), 
+            (int)(Time::GetSteadyClockUS() - llBeginTimeUs));
+
+    AcceptorStateData oCompressState(oState);
+    oCompressState.set_acceptedvalue(sCompressValue);
+    oCompressState.set_flag(oState.flag() | AcceptorStateFlagType_ValueCompressed);
+
+    return WriteState(oWriteOptions, iGroupIdx, llInstanceID, oCompressState);
+}
+
 int PaxosLog :: ReadState(const int iGroupIdx, const uint64_t llInstanceID, AcceptorStateData & oState)
 {
     const int m_iMyGroupIdx = iGroupIdx;
@@ -127,6 +163,27 @@ int PaxosLog :: ReadState(const int iGroupIdx, const uint64_t llInstanceID, Acce
         return -1;
     }
 
+    if (oState.flag() & AcceptorStateFlagType_ValueCompressed)
+    {
+        uint64_t llBeginTimeUs = Time::GetSteadyClockUS();
+
+        string sValue;
+        ret = ValueCompressor::Decompress(oState.acceptedvalue(), MAX_VALUE_SIZE, sValue);
+        if (ret != 0)
+        {
+            BP->GetAlgorithmBaseBP()->ValueDecompressFail();
+            PLG1Err("Decompress fail, instanceid %lu bufferlen %zu, maybe dictionary not registered",
+                    llInstanceID, oState.acceptedvalue().size());
+            return -1;
+        }
+
+        BP->GetAlgorithmBaseBP()->ValueDecompress(oState.acceptedvalue().size(), sValue.size(),
+                (int)(Time::GetSteadyClockUS() - llBeginTimeUs));
+
+        oState.set_acceptedvalue(sValue);
+        oState.set_flag(oState.flag() & ~AcceptorStateFlagType_ValueCompressed);
+    }
+
     return 0;
 }
 
@@ -44,6 +44,11 @@ public:
 
     int WriteState(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID, const AcceptorStateData & oState);
 
+    //AcceptedValue which size >= iCompressThreshold will be compressed on disk,
+    //ReadState decompress it transparently.
+    int WriteState(const WriteOptions & oWriteOptions, const int iGroupIdx, const uint64_t llInstanceID, const AcceptorStateData & oState,
+            const int iCompressThreshold, const uint32_t iCompressDictID);
+
     int ReadState(const int iGroupIdx, const uint64_t llInstanceID, AcceptorStateData & oState);
 
 private:
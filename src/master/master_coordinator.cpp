@@ -0,0 +1,398 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "master_coordinator.h"
+#include "comm_include.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace phxpaxos 
+{
+
+MasterCoordinator :: MasterCoordinator(const Node * poPaxosNode, const MasterDistributionPolicy ePolicy)
+    : m_poPaxosNode((Node *)poPaxosNode), m_ePolicy(ePolicy), m_poLeaseRenewer(nullptr),
+    m_bIsEnd(false), m_bIsStarted(false)
+{
+}
+
+MasterCoordinator :: ~MasterCoordinator()
+{
+}
+
+void MasterCoordinator :: AddMaster(MasterMgr * poMaster)
+{
+    int iGroupIdx = poMaster->GetGroupIdx();
+    if (iGroupIdx >= (int)m_vecGroupMaster.size())
+    {
+        m_vecGroupMaster.resize(iGroupIdx + 1, nullptr);
+        m_vecFreeSinceTime.resize(iGroupIdx + 1, 0);
+        m_vecHoldOffUntilTime.resize(iGroupIdx + 1, 0);
+    }
+
+    m_vecGroupMaster[iGroupIdx] = poMaster;
+    m_vecMaster.push_back(poMaster);
+}
+
+void MasterCoordinator :: SetLeaseRenewer(MasterLeaseRenewer * poLeaseRenewer)
+{
+    m_poLeaseRenewer = poLeaseRenewer;
+}
+
+void MasterCoordinator :: RunMaster()
+{
+    if (m_vecMaster.empty())
+    {
+        return;
+    }
+
+    start();
+}
+
+void MasterCoordinator :: StopMaster()
+{
+    if (m_bIsStarted)
+    {
+        m_bIsEnd = true;
+        join();
+    }
+}
+
+void MasterCoordinator :: run()
+{
+    m_bIsStarted = true;
+
+    while (true)
+    {
+        if (m_bIsEnd)
+        {
+            return;
+        }
+
+        uint64_t llBeginTime = Time::GetSteadyClockMS();
+
+        int iLeaseTime = RunOnce();
+
+        int iContinueLeaseTimeout = (iLeaseTime - 100) / 4;
+        iContinueLeaseTimeout = iContinueLeaseTimeout / 2 + OtherUtils::FastRand() % iContinueLeaseTimeout;
+
+        uint64_t llEndTime = Time::GetSteadyClockMS();
+        int iRunTime = llEndTime > llBeginTime ? llEndTime - llBeginTime : 0;
+        int iNeedSleepTime = iContinueLeaseTimeout > iRunTime ? iContinueLeaseTimeout - iRunTime : 0;
+
+        PLImp("group count %zu, sleep time %dms", m_vecMaster.size(), iNeedSleepTime);
+        Time::MsSleep(iNeedSleepTime);
+    }
+}
+
+int MasterCoordinator :: RunOnce()
+{
+    nodeid_t iMyNodeID = m_poPaxosNode->GetMyNodeID();
+    int iMinLeaseTime = 0;
+
+    std::vector<MasterLeaseGroup> vecRenewGroup;
+    std::vector<MasterLeaseGroup> vecQueryGroup;
+    std::vector<MasterProposeTask> vecTask;
+
+    //batch message is sent to group 0's members and count group 0's majority.
+    std::set<nodeid_t> setBatchNodeID;
+    if (m_poLeaseRenewer != nullptr)
+    {
+        GetMemberNodeIDs(0, setBatchNodeID);
+    }
+
+    for (auto & poMaster : m_vecMaster)
+    {
+        int iGroupIdx = poMaster->GetGroupIdx();
+        int iLeaseTime = poMaster->GetLeaseTime();
+        if (iMinLeaseTime == 0 || iLeaseTime < iMinLeaseTime)
+        {
+            iMinLeaseTime = iLeaseTime;
+        }
+
+        uint64_t llNowTime = Time::GetSteadyClockMS();
+
+        //stop renew and wait double lease time, let other node take it.
+        if (poMaster->ConsumeDropMaster())
+        {
+            BP->GetMasterBP()->DropMaster();
+            m_vecHoldOffUntilTime[iGroupIdx] = llNowTime + iLeaseTime * 2;
+            PLImp("group %d need drop master, wait time %dms", iGroupIdx, iLeaseTime * 2);
+        }
+
+        if (llNowTime < m_vecHoldOffUntilTime[iGroupIdx])
+        {
+            continue;
+        }
+
+        nodeid_t iMasterNodeID = nullnode;
+        uint64_t llMasterVersion = 0;
+        poMaster->GetMasterSM()->SafeGetMaster(iMasterNodeID, llMasterVersion);
+
+        if (iMasterNodeID != nullnode)
+        {
+            m_vecFreeSinceTime[iGroupIdx] = 0;
+        }
+
+        if (iMasterNodeID != nullnode && iMasterNodeID != iMyNodeID)
+        {
+            continue;
+        }
+
+        if (iMasterNodeID == nullnode && !IsPreferredMaster(iGroupIdx))
+        {
+            //give the preferred node a lease time to take it first.
+            if (m_vecFreeSinceTime[iGroupIdx] == 0)
+            {
+                m_vecFreeSinceTime[iGroupIdx] = llNowTime;
+            }
+
+            if (llNowTime < m_vecFreeSinceTime[iGroupIdx] + iLeaseTime)
+            {
+                continue;
+            }
+        }
+
+        std::set<nodeid_t> setNodeID;
+        if (m_poLeaseRenewer != nullptr)
+        {
+            GetMemberNodeIDs(iGroupIdx, setNodeID);
+        }
+
+        if (m_poLeaseRenewer == nullptr || setNodeID != setBatchNodeID)
+        {
+            MasterProposeTask oTask;
+            oTask.poMaster = poMaster;
+            oTask.iLeaseTime = iLeaseTime;
+            oTask.bTryBeMaster = true;
+            vecTask.push_back(oTask);
+            continue;
+        }
+
+        MasterLeaseGroup oGroup;
+        oGroup.iGroupIdx = iGroupIdx;
+        oGroup.llMasterVersion = llMasterVersion;
+        oGroup.iLeaseTimeMs = iLeaseTime;
+
+        if (iMasterNodeID == iMyNodeID)
+        {
+            vecRenewGroup.push_back(oGroup);
+        }
+        else
+        {
+            vecQueryGroup.push_back(oGroup);
+        }
+    }
+
+    int iTimeoutMs = std::max(iMinLeaseTime / 10, 100);
+
+    if (!vecRenewGroup.empty())
+    {
+        RenewLease(vecRenewGroup, iTimeoutMs, vecTask);
+    }
+
+    if (!vecQueryGroup.empty())
+    {
+        QueryLease(vecQueryGroup, iTimeoutMs, vecTask);
+    }
+
+    RunProposeTasks(vecTask);
+
+    BP->GetMasterBP()->CoordinatorRound(vecRenewGroup.size(), vecQueryGroup.size());
+
+    return iMinLeaseTime;
+}
+
+void MasterCoordinator :: RenewLease(std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs, 
+        std::vector<MasterProposeTask> & vecTask)
+{
+    //grantors count lease from receive time, master from send time, a little earlier.
+    uint64_t llBeginTime = Time::GetSteadyClockMS();
+
+    m_poLeaseRenewer->RenewLeaseBatch(m_poPaxosNode->GetMyNodeID(), vecGroup, iTimeoutMs);
+
+    for (auto & oGroup : vecGroup)
+    {
+        MasterMgr * poMaster = m_vecGroupMaster[oGroup.iGroupIdx];
+        uint64_t llAbsMasterTimeout = llBeginTime + oGroup.iLeaseTimeMs - 100;
+
+        if (oGroup.bIsSucc && poMaster->GetMasterSM()->ExtendMyLease(oGroup.llMasterVersion, llAbsMasterTimeout))
+        {
+            BP->GetMasterBP()->RenewLeaseOK();
+            continue;
+        }
+
+        //grantors lost my lease or version, renew by paxos.
+        BP->GetMasterBP()->RenewLeaseFail();
+        PLImp("group %d renew lease by heartbeat fail, version %lu", oGroup.iGroupIdx, oGroup.llMasterVersion);
+
+        MasterProposeTask oTask;
+        oTask.poMaster = poMaster;
+        oTask.iLeaseTime = oGroup.iLeaseTimeMs;
+        oTask.llMasterVersion = oGroup.llMasterVersion;
+        vecTask.push_back(oTask);
+    }
+}
+
+void MasterCoordinator :: QueryLease(std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs,
+        std::vector<MasterProposeTask> & vecTask)
+{
+    m_poLeaseRenewer->QueryLeaseBatch(m_poPaxosNode->GetMyNodeID(), vecGroup, iTimeoutMs);
+
+    for (auto & oGroup : vecGroup)
+    {
+        if (!oGroup.bIsSucc)
+        {
+            //some member still hold a heartbeat lease of other master.
+            BP->GetMasterBP()->QueryLeaseFail();
+            continue;
+        }
+
+        MasterProposeTask oTask;
+        oTask.poMaster = m_vecGroupMaster[oGroup.iGroupIdx];
+        oTask.iLeaseTime = oGroup.iLeaseTimeMs;
+        oTask.llMasterVersion = oGroup.llMasterVersion;
+        vecTask.push_back(oTask);
+    }
+}
+
+void MasterCoordinator :: RunProposeTasks(std::vector<MasterProposeTask> & vecTask)
+{
+    if (vecTask.empty())
+    {
+        return;
+    }
+
+    //each proposal waits a paxos round of its own group, don't wait them one by one.
+    std::atomic<size_t> iNextTask(0);
+    auto RunTasks = [&]()
+    {
+        while (true)
+        {
+            size_t iTaskIdx = iNextTask++;
+            if (iTaskIdx >= vecTask.size())
+            {
+                break;
+            }
+
+            MasterProposeTask & oTask = vecTask[iTaskIdx];
+            if (oTask.bTryBeMaster)
+            {
+                oTask.poMaster->TryBeMaster(oTask.iLeaseTime);
+            }
+            else
+            {
+                oTask.poMaster->ProposeMaster(oTask.iLeaseTime, oTask.llMasterVersion);
+            }
+        }
+    };
+
+    int iThreadCount = std::min((int)vecTask.size(), MASTER_COORDINATOR_PROPOSE_THREADS);
+    std::vector<std::thread *> vecThread;
+    for (int i = 1; i < iThreadCount; i++)
+    {
+        vecThread.push_back(new std::thread(RunTasks));
+    }
+
+    RunTasks();
+
+    for (auto & poThread : vecThread)
+    {
+        poThread->join();
+        delete poThread;
+    }
+}
+
+void MasterCoordinator :: GetMemberNodeIDs(const int iGroupIdx, std::set<nodeid_t> & setNodeID)
+{
+    NodeInfoList vecNodeInfoList;
+    if (m_poPaxosNode->ShowMembership(iGroupIdx, vecNodeInfoList) != 0)
+    {
+        return;
+    }
+
+    for (auto & oNodeInfo : vecNodeInfoList)
+    {
+        setNodeID.insert(oNodeInfo.GetNodeID());
+    }
+}
+
+const bool MasterCoordinator :: IsPreferredMaster(const int iGroupIdx)
+{
+    if (m_ePolicy == MasterDistributionPolicy_None)
+    {
+        return true;
+    }
+
+    NodeInfoList vecNodeInfoList;
+    int ret = m_poPaxosNode->ShowMembership(iGroupIdx, vecNodeInfoList);
+    if (ret != 0 || vecNodeInfoList.empty())
+    {
+        return true;
+    }
+
+    return GetPreferredMaster(iGroupIdx, vecNodeInfoList) == m_poPaxosNode->GetMyNodeID();
+}
+
+nodeid_t MasterCoordinator :: GetPreferredMaster(const int iGroupIdx, const NodeInfoList & vecNodeInfoList)
+{
+    if (vecNodeInfoList.empty())
+    {
+        return nullnode;
+    }
+
+    std::vector<nodeid_t> vecNodeID;
+    for (auto & oNodeInfo : vecNodeInfoList)
+    {
+        vecNodeID.push_back(oNodeInfo.GetNodeID());
+    }
+
+    std::sort(vecNodeID.begin(), vecNodeID.end());
+
+    return vecNodeID[iGroupIdx % vecNodeID.size()];
+}
+
+int MasterCoordinator :: Rebalance()
+{
+    int iDropCount = 0;
+
+    if (m_ePolicy == MasterDistributionPolicy_None)
+    {
+        return iDropCount;
+    }
+
+    for (auto & poMaster : m_vecMaster)
+    {
+        if (poMaster->GetMasterSM()->IsIMMaster() && !IsPreferredMaster(poMaster->GetGroupIdx()))
+        {
+            BP->GetMasterBP()->RebalanceDropMaster();
+            poMaster->DropMaster();
+            iDropCount++;
+        }
+    }
+
+    PLHead("drop master count %d", iDropCount);
+
+    return iDropCount;
+}
+    
+}
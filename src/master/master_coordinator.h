@@ -0,0 +1,106 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <set>
+#include "utils_include.h"
+#include "phxpaxos/node.h"
+#include "master_mgr.h"
+#include "master_lease.h"
+
+namespace phxpaxos 
+{
+
+#define MASTER_COORDINATOR_PROPOSE_THREADS 8
+
+//Paxos work of one group in a round, groups run in parallel.
+class MasterProposeTask
+{
+public:
+    MasterProposeTask() : poMaster(nullptr), iLeaseTime(0), llMasterVersion(0), bTryBeMaster(false) { }
+
+    MasterMgr * poMaster;
+    int iLeaseTime;
+    uint64_t llMasterVersion;
+    //group not in the batch, TryBeMaster renew or query lease by itself.
+    bool bTryBeMaster;
+};
+
+//Run masters of all groups on this node in one thread instead of one thread per group,
+//with heartbeat lease, renew and query leases of all groups in one multi-group message.
+class MasterCoordinator : public Thread
+{
+public:
+    MasterCoordinator(const Node * poPaxosNode, const MasterDistributionPolicy ePolicy);
+    ~MasterCoordinator();
+
+    void AddMaster(MasterMgr * poMaster);
+
+    void SetLeaseRenewer(MasterLeaseRenewer * poLeaseRenewer);
+
+    void RunMaster();
+
+    void StopMaster();
+
+    void run();
+
+    //drop masters of groups which prefer other node, return the drop count.
+    int Rebalance();
+
+    //one round of all groups, run() repeat it, return the min lease time of all groups.
+    int RunOnce();
+
+public:
+    static nodeid_t GetPreferredMaster(const int iGroupIdx, const NodeInfoList & vecNodeInfoList);
+
+private:
+    const bool IsPreferredMaster(const int iGroupIdx);
+
+    void GetMemberNodeIDs(const int iGroupIdx, std::set<nodeid_t> & setNodeID);
+
+    void RenewLease(std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs, 
+            std::vector<MasterProposeTask> & vecTask);
+
+    void QueryLease(std::vector<MasterLeaseGroup> & vecGroup, const int iTimeoutMs,
+            std::vector<MasterProposeTask> & vecTask);
+
+    void RunProposeTasks(std::vector<MasterProposeTask> & vecTask);
+
+private:
+    Node * m_poPaxosNode;
+    MasterDistributionPolicy m_ePolicy;
+    //renew and query through group 0, only groups with group 0's members are batched.
+    MasterLeaseRenewer * m_poLeaseRenewer;
+
+    std::vector<MasterMgr *> m_vecMaster;
+    //index by groupidx.
+    std::vector<MasterMgr *> m_vecGroupMaster;
+    std::vector<uint64_t> m_vecFreeSinceTime;
+    std::vector<uint64_t> m_vecHoldOffUntilTime;
+
+    bool m_bIsEnd;
+    bool m_bIsStarted;
+};
+    
+}
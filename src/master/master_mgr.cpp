@@ -22,6 +22,7 @@ See the AUTHORS file for names of contributors.
 #include "master_mgr.h"
 #include "comm_include.h"
 #include "commdef.h"
+#include <algorithm>
 
 namespace phxpaxos 
 {
@@ -31,7 +32,8 @@ MasterMgr :: MasterMgr(
     const int iGroupIdx, 
     const LogStorage * poLogStorage,
     MasterChangeCallback pMasterChangeCallback) 
-    : m_oDefaultMasterSM(poLogStorage, poPaxosNode->GetMyNodeID(), iGroupIdx, pMasterChangeCallback) 
+    : m_oDefaultMasterSM(poLogStorage, poPaxosNode->GetMyNodeID(), iGroupIdx, pMasterChangeCallback),
+    m_poLeaseRenewer(nullptr)
 {
     m_iLeaseTime = 10000;
 
@@ -63,11 +65,37 @@ void MasterMgr :: SetLeaseTime(const int iLeaseTimeMs)
     m_iLeaseTime = iLeaseTimeMs;
 }
 
+const int MasterMgr :: GetLeaseTime() const
+{
+    return m_iLeaseTime;
+}
+
+const int MasterMgr :: GetGroupIdx() const
+{
+    return m_iMyGroupIdx;
+}
+
 void MasterMgr :: DropMaster()
 {
     m_bNeedDropMaster = true;
 }
 
+bool MasterMgr :: ConsumeDropMaster()
+{
+    if (!m_bNeedDropMaster)
+    {
+        return false;
+    }
+
+    m_bNeedDropMaster = false;
+    return true;
+}
+
+void MasterMgr :: SetLeaseRenewer(MasterLeaseRenewer * poLeaseRenewer)
+{
+    m_poLeaseRenewer = poLeaseRenewer;
+}
+
 void MasterMgr :: StopMaster()
 {
     if (m_bIsStarted)
@@ -134,9 +162,35 @@ void MasterMgr :: TryBeMaster(const int iLeaseTime)
         return;
     }
 
-    BP->GetMasterBP()->TryBeMaster();
+    if (m_poLeaseRenewer != nullptr)
+    {
+        if (iMasterNodeID == m_poPaxosNode->GetMyNodeID())
+        {
+            if (RenewLease(iLeaseTime, llMasterVersion))
+            {
+                return;
+            }
+
+            //grantors lost my lease or version, renew by paxos.
+        }
+        else if (m_poLeaseRenewer->QueryLease(m_poPaxosNode->GetMyNodeID(), 
+                    std::max(iLeaseTime / 10, 100)) != 0)
+        {
+            //some member still hold a heartbeat lease of other master.
+            BP->GetMasterBP()->QueryLeaseFail();
+            PLG1Imp("Lease may held by other, can't try be master");
+            return;
+        }
+    }
 
     //step 2 try be master
+    ProposeMaster(iLeaseTime, llMasterVersion);
+}
+
+void MasterMgr :: ProposeMaster(const int iLeaseTime, const uint64_t llMasterVersion)
+{
+    BP->GetMasterBP()->TryBeMaster();
+
     std::string sPaxosValue;
     if (!MasterStateMachine::MakeOpValue(
                 m_poPaxosNode->GetMyNodeID(),
@@ -165,6 +219,24 @@ void MasterMgr :: TryBeMaster(const int iLeaseTime)
     }
 }
 
+bool MasterMgr :: RenewLease(const int iLeaseTime, const uint64_t llMasterVersion)
+{
+    //grantors count lease from receive time, master from send time, a little earlier.
+    uint64_t llAbsMasterTimeout = Time::GetSteadyClockMS() + iLeaseTime - 100;
+
+    int ret = m_poLeaseRenewer->RenewLease(m_poPaxosNode->GetMyNodeID(), llMasterVersion, 
+            iLeaseTime, std::max(iLeaseTime / 10, 100));
+    if (ret != 0 || !m_oDefaultMasterSM.ExtendMyLease(llMasterVersion, llAbsMasterTimeout))
+    {
+        BP->GetMasterBP()->RenewLeaseFail();
+        PLG1Imp("Renew lease by heartbeat fail, ret %d version %lu", ret, llMasterVersion);
+        return false;
+    }
+
+    BP->GetMasterBP()->RenewLeaseOK();
+    return true;
+}
+
 MasterStateMachine * MasterMgr :: GetMasterSM()
 {
     return &m_oDefaultMasterSM;
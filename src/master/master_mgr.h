@@ -50,8 +50,21 @@ public:
 
     void TryBeMaster(const int iLeaseTime);
 
+    //propose myself as master of llMasterVersion by paxos.
+    void ProposeMaster(const int iLeaseTime, const uint64_t llMasterVersion);
+
     void DropMaster();
 
+    //MasterCoordinator run this group instead of own thread, take the drop request.
+    bool ConsumeDropMaster();
+
+    const int GetLeaseTime() const;
+
+    const int GetGroupIdx() const;
+
+    //renew lease by heartbeat, only master change write paxos log.
+    void SetLeaseRenewer(MasterLeaseRenewer * poLeaseRenewer);
+
 public:
     MasterStateMachine * GetMasterSM();
 
@@ -60,6 +73,11 @@ private:
 
     MasterStateMachine m_oDefaultMasterSM;
 
+    MasterLeaseRenewer * m_poLeaseRenewer;
+
+private:
+    bool RenewLease(const int iLeaseTime, const uint64_t llMasterVersion);
+
 private:
     int m_iLeaseTime;
 
@@ -43,6 +43,8 @@ MasterStateMachine :: MasterStateMachine(
     m_iLeaseTime = 0;
     m_llAbsExpireTime = 0;
 
+    m_bLeaseGrantable = false;
+    m_llRestoredVersion = 0;
 }
 
 MasterStateMachine :: ~MasterStateMachine()
@@ -68,6 +70,7 @@ int MasterStateMachine :: Init()
     else
     {
         m_llMasterVersion = oVariables.version();
+        m_llRestoredVersion = oVariables.version();
 
         if (oVariables.masternodeid() == m_iMyNodeID)
         {
@@ -166,6 +169,12 @@ int MasterStateMachine :: LearnMaster(
     m_iLeaseTime = oMasterOper.timeout();
     m_llMasterVersion = llInstanceID;
 
+    //a master op newer than what restored, no lease told free before can be extended by it.
+    if (llInstanceID > m_llRestoredVersion)
+    {
+        m_bLeaseGrantable = true;
+    }
+
     if (bMasterChange)
     {
         if (m_pMasterChangeCallback != nullptr)
@@ -221,6 +230,63 @@ const bool MasterStateMachine :: IsIMMaster() const
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+bool MasterStateMachine :: GrantLease(const nodeid_t iMasterNodeID, const uint64_t llMasterVersion, const int iLeaseTimeMs)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+
+    uint64_t llNowTime = Time::GetSteadyClockMS();
+
+    //after expired, this node may have told someone the lease is free, never extend again.
+    //master will renew by paxos, that change the version.
+    //after restore from disk or checkpoint, the expire time is a guess and we may have
+    //told someone free before restart, wait a master op learned by paxos.
+    if (!m_bLeaseGrantable
+            || iMasterNodeID != m_iMasterNodeID || llMasterVersion != m_llMasterVersion
+            || llNowTime >= m_llAbsExpireTime)
+    {
+        BP->GetMasterBP()->GrantLeaseReject();
+        PLG1Debug("reject, masternodeid %lu version %lu, my masternodeid %lu version %lu expiretime %lu now %lu",
+                iMasterNodeID, llMasterVersion, m_iMasterNodeID, m_llMasterVersion, m_llAbsExpireTime, llNowTime);
+        return false;
+    }
+
+    if (llNowTime + iLeaseTimeMs > m_llAbsExpireTime)
+    {
+        m_llAbsExpireTime = llNowTime + iLeaseTimeMs;
+    }
+
+    return true;
+}
+
+bool MasterStateMachine :: IsLeaseHeldByOther(const nodeid_t iNodeID)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+
+    return m_iMasterNodeID != nullnode && m_iMasterNodeID != iNodeID
+        && Time::GetSteadyClockMS() < m_llAbsExpireTime;
+}
+
+bool MasterStateMachine :: ExtendMyLease(const uint64_t llMasterVersion, const uint64_t llAbsExpireTime)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+
+    if (m_iMasterNodeID != m_iMyNodeID || llMasterVersion != m_llMasterVersion)
+    {
+        PLG1Imp("master changed, masternodeid %lu version %lu renew version %lu",
+                m_iMasterNodeID, m_llMasterVersion, llMasterVersion);
+        return false;
+    }
+
+    if (llAbsExpireTime > m_llAbsExpireTime)
+    {
+        m_llAbsExpireTime = llAbsExpireTime;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 bool MasterStateMachine :: Execute(const int iGroupIdx, const uint64_t llInstanceID, 
         const std::string & sValue, SMCtx * poSMCtx)
 {
@@ -343,6 +409,8 @@ int MasterStateMachine :: UpdateByCheckpoint(const std::string & sCPBuffer, bool
 
     bool bMasterChange = false;
     m_llMasterVersion = oVariables.version();
+    m_llRestoredVersion = oVariables.version();
+    m_bLeaseGrantable = false;
 
     if (oVariables.masternodeid() == m_iMyNodeID)
     {
@@ -29,6 +29,8 @@ See the AUTHORS file for names of contributors.
 #include "master_sm.pb.h"
 #include "master_sm.h"
 #include "master_variables_store.h"
+#include "master_lease.h"
+#include "master_info.h"
 #include "utils_include.h"
 
 namespace phxpaxos 
@@ -39,7 +41,7 @@ enum MasterOperatorType
     MasterOperatorType_Complete = 1,
 };
 
-class MasterStateMachine : public InsideSM 
+class MasterStateMachine : public InsideSM, public MasterLeaseGrantor, public MasterInfo
 {
 public:
     MasterStateMachine(
@@ -104,6 +106,17 @@ public:
 
     const bool IsIMMaster() const;
 
+public:
+    //heartbeat lease, in memory only, master version not change.
+    //refuse after restore until a newer master op is learned, query still answer held.
+    bool GrantLease(const nodeid_t iMasterNodeID, const uint64_t llMasterVersion, const int iLeaseTimeMs);
+
+    bool IsLeaseHeldByOther(const nodeid_t iNodeID);
+
+    //master side, after majority granted the lease.
+    //return false if i'm not the master of llMasterVersion any more.
+    bool ExtendMyLease(const uint64_t llMasterVersion, const uint64_t llAbsExpireTime);
+
 public:
     int UpdateMasterToStore(const nodeid_t llMasterNodeID, const uint64_t llVersion, const uint32_t iLeaseTime);
 
@@ -134,6 +147,10 @@ private:
     int m_iLeaseTime;
     uint64_t m_llAbsExpireTime;
 
+    //heartbeat lease grant only after learned a master op newer than m_llRestoredVersion.
+    bool m_bLeaseGrantable;
+    uint64_t m_llRestoredVersion;
+
     std::mutex m_oMutex;
 
     MasterChangeCallback m_pMasterChangeCallback;
@@ -38,6 +38,19 @@ Group :: Group(LogStorage * poLogStorage,
     m_iInitRet(-1), m_poThread(nullptr)
 {
     m_oConfig.SetMasterSM(poMasterSM);
+    m_oConfig.GetSystemVSM()->SetMembershipListener(&m_oCommunicate);
+
+    for (auto & oGroupSMInfo : oOptions.vecGroupSMInfoList)
+    {
+        if (oGroupSMInfo.iGroupIdx != iGroupIdx)
+        {
+            continue;
+        }
+
+        //register dictionary even if not compress, other nodes may compress with it.
+        uint32_t iDictID = ValueCompressor::RegisterDict(oGroupSMInfo.sValueCompressDict);
+        m_oConfig.SetValueCompress(oGroupSMInfo.iValueCompressThreshold, iDictID);
+    }
 }
 
 Group :: ~Group()
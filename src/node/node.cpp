@@ -21,6 +21,7 @@ See the AUTHORS file for names of contributors.
 
 #include "phxpaxos/node.h"
 #include "pnode.h"
+#include "metrics_bp.h"
 
 namespace phxpaxos
 {
@@ -33,12 +34,25 @@ int Node :: RunNode(const Options & oOptions, Node *& poNode)
     }
     
     InsideOptions::Instance()->SetGroupCount(oOptions.iGroupCount);
+    InsideOptions::Instance()->SetTcpCreditWindowBytes(oOptions.iTcpCreditWindowBytes);
+
+    if (oOptions.bUseCheckpointBulkTransfer)
+    {
+        InsideOptions::Instance()->SetAsCheckpointBulkTransferMode();
+    }
         
     poNode = nullptr;
     NetWork * poNetWork = nullptr;
 
     Breakpoint::m_poBreakpoint = nullptr;
-    BP->SetInstance(oOptions.poBreakpoint);
+    if (oOptions.poBreakpoint == nullptr && oOptions.bUseMetrics)
+    {
+        BP->SetInstance(MetricsBreakpoint::Instance());
+    }
+    else
+    {
+        BP->SetInstance(oOptions.poBreakpoint);
+    }
 
     PNode * poRealNode = new PNode();
     int ret = poRealNode->Init(oOptions, poNetWork);
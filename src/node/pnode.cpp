@@ -20,18 +20,25 @@ See the AUTHORS file for names of contributors.
 */
 
 #include "pnode.h"
+#include "metrics.h"
 
 namespace phxpaxos
 {
 
 PNode :: PNode()
-    : m_iMyNodeID(nullnode)
+    : m_iMyNodeID(nullnode), m_bUseProposeForward(false), m_poIOLoopScheduler(nullptr),
+    m_poMasterCoordinator(nullptr)
 {
 }
 
 PNode :: ~PNode()
 {
     //1.step: must stop master(app) first.
+    if (m_poMasterCoordinator != nullptr)
+    {
+        m_poMasterCoordinator->StopMaster();
+    }
+
     for (auto & poMaster : m_vecMasterList)
     {
         poMaster->StopMaster();
@@ -49,6 +56,12 @@ PNode :: ~PNode()
         poGroup->Stop();
     }
 
+    //all ioloops stopped, stop the shared ioloop workers.
+    if (m_poIOLoopScheduler != nullptr)
+    {
+        m_poIOLoopScheduler->Stop();
+    }
+
     //4. step: stop network.
     m_oDefaultNetWork.StopNetWork();
 
@@ -69,6 +82,16 @@ PNode :: ~PNode()
     {
         delete poProposeBatch;
     }
+
+    if (m_poIOLoopScheduler != nullptr)
+    {
+        delete m_poIOLoopScheduler;
+    }
+
+    if (m_poMasterCoordinator != nullptr)
+    {
+        delete m_poMasterCoordinator;
+    }
 }
 
 int PNode :: InitLogStorage(const Options & oOptions, LogStorage *& poLogStorage)
@@ -111,7 +134,8 @@ int PNode :: InitNetWork(const Options & oOptions, NetWork *& poNetWork)
     }
 
     int ret = m_oDefaultNetWork.Init(
-            oOptions.oMyNode.GetIP(), oOptions.oMyNode.GetPort(), oOptions.iIOThreadCount);
+            oOptions.oMyNode.GetIP(), oOptions.oMyNode.GetPort(), oOptions.iIOThreadCount, oOptions.iTcpBusyPollUs,
+            oOptions.iCoalesceDelayUs, (int)oOptions.iUDPMaxSize);
     if (ret != 0)
     {
         PLErr("init default network fail, listenip %s listenport %d ret %d",
@@ -172,6 +196,30 @@ int PNode :: CheckOptions(const Options & oOptions)
         }
     }
 
+    if (oOptions.iValueChunkSize < 0 || oOptions.iValueChunkSize > MAX_VALUE_SIZE / 2)
+    {
+        PLErr("value chunk size %d is invalid, max buffer size %d", oOptions.iValueChunkSize, MAX_VALUE_SIZE);
+        return -2;
+    }
+
+    if (oOptions.iTcpBusyPollUs < 0 || oOptions.iTcpBusyPollUs > 1000000)
+    {
+        PLErr("tcp busy poll us %d is invalid", oOptions.iTcpBusyPollUs);
+        return -2;
+    }
+
+    if (oOptions.iCoalesceDelayUs < 0 || oOptions.iCoalesceDelayUs > 100000)
+    {
+        PLErr("coalesce delay us %d is invalid", oOptions.iCoalesceDelayUs);
+        return -2;
+    }
+
+    if (oOptions.iTcpCreditWindowBytes != 0 && oOptions.iTcpCreditWindowBytes < 65536)
+    {
+        PLErr("tcp credit window bytes %d is invalid", oOptions.iTcpCreditWindowBytes);
+        return -2;
+    }
+
     for (auto & oGroupSMInfo : oOptions.vecGroupSMInfoList)
     {
         if (oGroupSMInfo.iGroupIdx >= oOptions.iGroupCount)
@@ -205,7 +253,14 @@ void PNode :: RunMaster(const Options & oOptions)
         {
             if (!m_vecGroupList[oGroupSMInfo.iGroupIdx]->GetConfig()->IsIMFollower())
             {
-                m_vecMasterList[oGroupSMInfo.iGroupIdx]->RunMaster();
+                if (m_poMasterCoordinator != nullptr)
+                {
+                    m_poMasterCoordinator->AddMaster(m_vecMasterList[oGroupSMInfo.iGroupIdx]);
+                }
+                else
+                {
+                    m_vecMasterList[oGroupSMInfo.iGroupIdx]->RunMaster();
+                }
             }
             else
             {
@@ -213,6 +268,11 @@ void PNode :: RunMaster(const Options & oOptions)
             }
         }
     }
+
+    if (m_poMasterCoordinator != nullptr)
+    {
+        m_poMasterCoordinator->RunMaster();
+    }
 }
 
 void PNode :: RunProposeBatch()
@@ -233,6 +293,7 @@ int PNode :: Init(const Options & oOptions, NetWork *& poNetWork)
     }
 
     m_iMyNodeID = oOptions.oMyNode.GetNodeID();
+    m_bUseProposeForward = oOptions.bUseProposeForward;
 
     //step1 init logstorage
     LogStorage * poLogStorage = nullptr;
@@ -268,9 +329,46 @@ int PNode :: Init(const Options & oOptions, NetWork *& poNetWork)
     {
         Group * poGroup = new Group(poLogStorage, poNetWork, m_vecMasterList[iGroupIdx]->GetMasterSM(), iGroupIdx, oOptions);
         assert(poGroup != nullptr);
+        poGroup->GetConfig()->SetMasterInfo(m_vecMasterList[iGroupIdx]->GetMasterSM());
         m_vecGroupList.push_back(poGroup);
     }
 
+    if (oOptions.bUseMasterHeartbeatLease)
+    {
+        for (int iGroupIdx = 0; iGroupIdx < oOptions.iGroupCount; iGroupIdx++)
+        {
+            m_vecGroupList[iGroupIdx]->GetConfig()->SetMasterLeaseGrantor(
+                    m_vecMasterList[iGroupIdx]->GetMasterSM());
+            m_vecGroupList[iGroupIdx]->GetConfig()->SetMasterLeaseGrantorSet(this);
+            m_vecMasterList[iGroupIdx]->SetLeaseRenewer(
+                    m_vecGroupList[iGroupIdx]->GetInstance()->GetMasterLeaser());
+        }
+    }
+
+    //one thread runs masters of all groups, renew leases in batch.
+    if (oOptions.bUseMasterCoordinator)
+    {
+        m_poMasterCoordinator = new MasterCoordinator(this, oOptions.eMasterDistributionPolicy);
+        assert(m_poMasterCoordinator != nullptr);
+
+        if (oOptions.bUseMasterHeartbeatLease)
+        {
+            m_poMasterCoordinator->SetLeaseRenewer(m_vecGroupList[0]->GetInstance()->GetMasterLeaser());
+        }
+    }
+
+    //groups share ioloop worker threads instead of one ioloop thread per group.
+    if (oOptions.iIOLoopThreadCount > 0)
+    {
+        m_poIOLoopScheduler = new IOLoopScheduler(oOptions.iIOLoopThreadCount);
+        assert(m_poIOLoopScheduler != nullptr);
+
+        for (auto & poGroup : m_vecGroupList)
+        {
+            poGroup->GetInstance()->SetIOLoopScheduler(m_poIOLoopScheduler);
+        }
+    }
+
     //step5 build batchpropose
     if (oOptions.bUseBatchPropose)
     {
@@ -308,6 +406,11 @@ int PNode :: Init(const Options & oOptions, NetWork *& poNetWork)
     //last step. must init ok, then should start threads.
     //because that stop threads is slower, if init fail, we need much time to stop many threads.
     //so we put start threads in the last step.
+    if (m_poIOLoopScheduler != nullptr)
+    {
+        m_poIOLoopScheduler->Start();
+    }
+
     for (auto & poGroup : m_vecGroupList)
     {
         //start group's thread first.
@@ -338,7 +441,7 @@ int PNode :: Propose(const int iGroupIdx, const std::string & sValue, uint64_t &
         return Paxos_GroupIdxWrong;
     }
 
-    return m_vecGroupList[iGroupIdx]->GetCommitter()->NewValueGetID(sValue, llInstanceID);
+    return Propose(iGroupIdx, sValue, llInstanceID, nullptr);
 }
 
 int PNode :: Propose(const int iGroupIdx, const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx)
@@ -348,9 +451,57 @@ int PNode :: Propose(const int iGroupIdx, const std::string & sValue, uint64_t &
         return Paxos_GroupIdxWrong;
     }
 
+    nodeid_t iMasterNodeID = GetForwardNodeID(iGroupIdx, poSMCtx);
+    if (iMasterNodeID != nullnode)
+    {
+        int ret = m_vecGroupList[iGroupIdx]->GetInstance()->GetProposeForwarder()->NewValueGetID(
+                iMasterNodeID, sValue, llInstanceID, poSMCtx);
+        if (ret != PaxosTryCommitRet_Not_Master)
+        {
+            return ret;
+        }
+
+        //master changed, forward once more if we already know the new one.
+        nodeid_t iNewMasterNodeID = GetForwardNodeID(iGroupIdx, poSMCtx);
+        if (iNewMasterNodeID != nullnode && iNewMasterNodeID != iMasterNodeID)
+        {
+            ret = m_vecGroupList[iGroupIdx]->GetInstance()->GetProposeForwarder()->NewValueGetID(
+                    iNewMasterNodeID, sValue, llInstanceID, poSMCtx);
+            if (ret != PaxosTryCommitRet_Not_Master)
+            {
+                return ret;
+            }
+        }
+
+        PLErr("forward fail, not master, propose by myself, groupidx %d", iGroupIdx);
+    }
+
     return m_vecGroupList[iGroupIdx]->GetCommitter()->NewValueGetID(sValue, llInstanceID, poSMCtx);
 }
 
+const nodeid_t PNode :: GetForwardNodeID(const int iGroupIdx, SMCtx * poSMCtx)
+{
+    if (!m_bUseProposeForward)
+    {
+        return nullnode;
+    }
+
+    //execute context only exist on this node, and inside sm must propose by myself.
+    if (poSMCtx != nullptr 
+            && (poSMCtx->m_pCtx != nullptr || poSMCtx->m_iSMID == SYSTEM_V_SMID || poSMCtx->m_iSMID == MASTER_V_SMID))
+    {
+        return nullnode;
+    }
+
+    nodeid_t iMasterNodeID = m_vecMasterList[iGroupIdx]->GetMasterSM()->GetMaster();
+    if (iMasterNodeID == m_iMyNodeID)
+    {
+        return nullnode;
+    }
+
+    return iMasterNodeID;
+}
+
 const uint64_t PNode :: GetNowInstanceID(const int iGroupIdx)
 {
     if (!CheckGroupID(iGroupIdx))
@@ -383,6 +534,11 @@ int PNode :: OnReceiveMessage(const char * pcMessage, const int iMessageLen)
 
     memcpy(&iGroupIdx, pcMessage, GROUPIDXLEN);
 
+    if (iGroupIdx == COALESCE_FRAME_GROUPIDX)
+    {
+        return OnReceiveFrame(pcMessage, iMessageLen);
+    }
+
     if (!CheckGroupID(iGroupIdx))
     {
         PLErr("Message groupid %d wrong, groupsize %zu", iGroupIdx, m_vecGroupList.size());
@@ -392,6 +548,35 @@ int PNode :: OnReceiveMessage(const char * pcMessage, const int iMessageLen)
     return m_vecGroupList[iGroupIdx]->GetInstance()->OnReceiveMessage(pcMessage, iMessageLen);
 }
 
+int PNode :: OnReceiveFrame(const char * pcMessage, const int iMessageLen)
+{
+    std::vector<std::pair<const char *, int> > vecMessage;
+    int ret = MsgCoalescer::UnpackFrame(pcMessage, iMessageLen, vecMessage);
+    if (ret != 0)
+    {
+        BP->GetNetworkBP()->ReceiveCoalescedFrameError();
+        PLErr("UnpackFrame fail, frame len %d", iMessageLen);
+        return -2;
+    }
+
+    BP->GetNetworkBP()->ReceiveCoalescedFrame((int)vecMessage.size());
+
+    for (auto & it : vecMessage)
+    {
+        //frame in frame is not allowed.
+        if (MsgCoalescer::IsFrame(it.first, it.second))
+        {
+            BP->GetNetworkBP()->ReceiveCoalescedFrameError();
+            PLErr("nested frame, skip, len %d", it.second);
+            continue;
+        }
+
+        OnReceiveMessage(it.first, it.second);
+    }
+
+    return 0;
+}
+
 void PNode :: AddStateMachine(StateMachine * poSM)
 {
     for (auto & poGroup : m_vecGroupList)
@@ -613,6 +798,47 @@ int PNode :: ChangeMember(const int iGroupIdx, const NodeInfo & oFromNode, const
     return ProposalMembership(poSystemVSM, iGroupIdx, vecAfterNodeInfoList, llVersion);
 }
 
+int PNode :: SetChecksumType(const int iGroupIdx, const int iChecksumType)
+{
+    if (!CheckGroupID(iGroupIdx))
+    {
+        return Paxos_GroupIdxWrong;
+    }
+
+    if (iChecksumType != ChecksumType_Crc32 && iChecksumType != ChecksumType_Crc32C)
+    {
+        return Paxos_ChecksumOp_TypeNotSupport;
+    }
+
+    SystemVSM * poSystemVSM = m_vecGroupList[iGroupIdx]->GetConfig()->GetSystemVSM();
+
+    if (poSystemVSM->GetGid() == 0)
+    {
+        return Paxos_MembershipOp_NoGid;
+    }
+
+    string sOpValue;
+    int ret = poSystemVSM->ChecksumType_OPValue(iChecksumType, sOpValue);
+    if (ret != 0)
+    {
+        return Paxos_SystemError;
+    }
+
+    SMCtx oCtx;
+    int smret = -1;
+    oCtx.m_iSMID = SYSTEM_V_SMID;
+    oCtx.m_pCtx = (void *)&smret;
+
+    uint64_t llInstanceID = 0;
+    ret = Propose(iGroupIdx, sOpValue, llInstanceID, &oCtx);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    return smret;
+}
+
 int PNode :: ShowMembership(const int iGroupIdx, NodeInfoList & vecNodeInfoList)
 {
     if (!CheckGroupID(iGroupIdx))
@@ -682,6 +908,28 @@ int PNode :: DropMaster(const int iGroupIdx)
     return 0;
 }
 
+int PNode :: RebalanceMaster()
+{
+    if (m_poMasterCoordinator == nullptr)
+    {
+        PLErr("not use master coordinator");
+        return Paxos_SystemError;
+    }
+
+    m_poMasterCoordinator->Rebalance();
+    return 0;
+}
+
+MasterLeaseGrantor * PNode :: GetMasterLeaseGrantor(const int iGroupIdx)
+{
+    if (!CheckGroupID(iGroupIdx))
+    {
+        return nullptr;
+    }
+
+    return m_vecMasterList[iGroupIdx]->GetMasterSM();
+}
+
 /////////////////////////////////////////////////////////////////////
 
 void PNode :: SetMaxHoldThreads(const int iGroupIdx, const int iMaxHoldThreads)
@@ -757,6 +1005,18 @@ int PNode :: GetInstanceValue(const int iGroupIdx, const uint64_t llInstanceID,
 
 //////////////////////////////////////////////////////////////////////////
 
+void PNode :: GetMetricsSnapshot(std::vector<MetricValue> & vecMetricList)
+{
+    METRICS->GetSnapshot(vecMetricList);
+}
+
+void PNode :: DumpMetrics(std::string & sText)
+{
+    METRICS->DumpText(sText);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 int PNode :: BatchPropose(const int iGroupIdx, const std::string & sValue, 
         uint64_t & llInstanceID, uint32_t & iBatchIndex)
 {
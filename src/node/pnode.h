@@ -28,13 +28,15 @@ See the AUTHORS file for names of contributors.
 #include "dfnetwork.h"
 #include "group.h"
 #include "master_mgr.h"
+#include "master_coordinator.h"
 #include "propose_batch.h"
+#include "ioloop_scheduler.h"
 #include "utils_include.h"
 
 namespace phxpaxos
 {
 
-class PNode : public Node
+class PNode : public Node, public MasterLeaseGrantorSet
 {
 public:
     PNode();
@@ -77,6 +79,7 @@ public:
     int AddMember(const int iGroupIdx, const NodeInfo & oNode);
     int RemoveMember(const int iGroupIdx, const NodeInfo & oNode);
     int ChangeMember(const int iGroupIdx, const NodeInfo & oFromNode, const NodeInfo & oToNode);
+    int SetChecksumType(const int iGroupIdx, const int iChecksumType);
     int ShowMembership(const int iGroupIdx, NodeInfoList & vecNodeInfoList);
 
 public:
@@ -86,6 +89,8 @@ public:
     const bool IsIMMaster(const int iGroupIdx);
     int SetMasterLease(const int iGroupIdx, const int iLeaseTimeMs);
     int DropMaster(const int iGroupIdx);
+    int RebalanceMaster();
+    MasterLeaseGrantor * GetMasterLeaseGrantor(const int iGroupIdx);
 
 public:
     void SetMaxHoldThreads(const int iGroupIdx, const int iMaxHoldThreads);
@@ -96,6 +101,10 @@ public:
     int GetInstanceValue(const int iGroupIdx, const uint64_t llInstanceID,
             std::vector<std::pair<std::string, int> > & vecValues);
 
+public:
+    void GetMetricsSnapshot(std::vector<MetricValue> & vecMetricList);
+    void DumpMetrics(std::string & sText);
+
 private:
     int CheckOptions(const Options & oOptions);
     int InitLogStorage(const Options & oOptions, LogStorage *& poLogStorage);
@@ -103,6 +112,8 @@ private:
     int InitMaster(const Options & oOptions);
     void InitStateMachine(const Options & oOptions);
     bool CheckGroupID(const int iGroupIdx);
+    const nodeid_t GetForwardNodeID(const int iGroupIdx, SMCtx * poSMCtx);
+    int OnReceiveFrame(const char * pcMessage, const int iMessageLen);
     int ProposalMembership(
             SystemVSM * poSystemVSM,
             const int iGroupIdx, 
@@ -123,6 +134,9 @@ private:
     NotifierPool m_oNotifierPool;
 
     nodeid_t m_iMyNodeID;
+    bool m_bUseProposeForward;
+    IOLoopScheduler * m_poIOLoopScheduler;
+    MasterCoordinator * m_poMasterCoordinator;
 };
     
 }
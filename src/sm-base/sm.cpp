@@ -39,6 +39,21 @@ bool StateMachine :: ExecuteForCheckpoint(const int iGroupIdx, const uint64_t ll
     return true; 
 }
 
+bool StateMachine :: ExecuteForCheckpointBatch(const int iGroupIdx, const CheckpointValueList & vecValueList,
+        size_t & iExecutedCount)
+{
+    for (iExecutedCount = 0; iExecutedCount < vecValueList.size(); iExecutedCount++)
+    {
+        const CheckpointValue & oValue = vecValueList[iExecutedCount];
+        if (!ExecuteForCheckpoint(iGroupIdx, oValue.m_llInstanceID, oValue.m_sPaxosValue))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 const uint64_t StateMachine :: GetCheckpointInstanceID(const int iGroupIdx) const 
 { 
     return phxpaxos::NoCheckpoint;
@@ -69,6 +84,12 @@ void StateMachine :: UnLockCheckpointState()
 { 
 }
 
+int StateMachine :: GetCheckpointImmutableFiles(const int iGroupIdx, std::string & sDirPath, 
+        CheckpointFileInfoList & vecFileInfoList)
+{
+    return 0;
+}
+
 void StateMachine :: BeforePropose(const int iGroupIdx, std::string & sValue)
 {
 }
@@ -19,6 +19,7 @@ permissions and limitations under the License.
 See the AUTHORS file for names of contributors. 
 */
 
+#include <algorithm>
 #include <set>
 #include "commdef.h"
 #include "sm_base.h"
@@ -30,7 +31,7 @@ using namespace std;
 namespace phxpaxos
 {
 
-SMFac :: SMFac(const int iMyGroupIdx) : m_iMyGroupIdx(iMyGroupIdx)
+SMFac :: SMFac(const int iMyGroupIdx) : m_iMyGroupIdx(iMyGroupIdx), m_poChunkStore(nullptr)
 {
 }
 
@@ -57,7 +58,16 @@ bool SMFac :: Execute(const int iGroupIdx, const uint64_t llInstanceID, const st
     }
 
     std::string sBodyValue = string(sPaxosValue.data() + sizeof(int), sPaxosValue.size() - sizeof(int));
-    if (iSMID == BATCH_PROPOSE_SMID)
+    if (iSMID == VALUE_CHUNK_SMID)
+    {
+        std::string sChunkValue;
+        if (!LoadChunkValue(llInstanceID, sBodyValue, sChunkValue))
+        {
+            return false;
+        }
+        return Execute(iGroupIdx, llInstanceID, sChunkValue, poSMCtx);
+    }
+    else if (iSMID == BATCH_PROPOSE_SMID)
     {
         BatchSMCtx * poBatchSMCtx = nullptr;
         if (poSMCtx != nullptr && poSMCtx->m_pCtx != nullptr)
@@ -136,7 +146,105 @@ bool SMFac :: DoExecute(const int iGroupIdx, const uint64_t llInstanceID,
 
 ////////////////////////////////////////////////////////////////
 
-bool SMFac :: ExecuteForCheckpoint(const int iGroupIdx, const uint64_t llInstanceID, const std::string & sPaxosValue)
+bool SMFac :: ExecuteForCheckpointBatch(const int iGroupIdx, const uint64_t llBeginInstanceID, 
+        const std::vector<std::string> & vecPaxosValue, size_t & iExecutedCount, int & iPartialValueCount)
+{
+    iExecutedCount = 0;
+
+    SMCheckpointValueList vecSMValueList;
+    size_t iUnpackCount = 0;
+    for (; iUnpackCount < vecPaxosValue.size(); iUnpackCount++)
+    {
+        if (!UnpackForCheckpoint(llBeginInstanceID + iUnpackCount, vecPaxosValue[iUnpackCount], vecSMValueList))
+        {
+            break;
+        }
+    }
+
+    //values of the first instance done by last call.
+    size_t iPos = 0;
+    while (iPos < vecSMValueList.size() && (int)iPos < iPartialValueCount
+            && vecSMValueList[iPos].second.m_llInstanceID == llBeginInstanceID)
+    {
+        iPos++;
+    }
+
+    //stop at the first fail value, values after it are not executed by any sm,
+    //so order of sms inside an instance keep the same as Execute.
+    bool bExecuteSucc = true;
+    while (iPos < vecSMValueList.size())
+    {
+        int iSMID = vecSMValueList[iPos].first;
+        size_t iRunEnd = iPos + 1;
+        while (iRunEnd < vecSMValueList.size() && vecSMValueList[iRunEnd].first == iSMID)
+        {
+            iRunEnd++;
+        }
+
+        StateMachine * poSM = GetSM(iSMID);
+        if (poSM == nullptr)
+        {
+            PLG1Err("Unknown smid %d instanceid %lu", iSMID, vecSMValueList[iPos].second.m_llInstanceID);
+            bExecuteSucc = false;
+            break;
+        }
+
+        CheckpointValueList vecValueList;
+        vecValueList.reserve(iRunEnd - iPos);
+        for (size_t i = iPos; i < iRunEnd; i++)
+        {
+            vecValueList.push_back(std::move(vecSMValueList[i].second));
+        }
+
+        size_t iSMExecutedCount = 0;
+        bool bSMExecuteSucc = poSM->ExecuteForCheckpointBatch(iGroupIdx, vecValueList, iSMExecutedCount);
+        if (!bSMExecuteSucc && iSMExecutedCount < vecValueList.size())
+        {
+            PLG1Err("Checkpoint sm excute fail, smid %d instanceid %lu", 
+                    iSMID, vecValueList[iSMExecutedCount].m_llInstanceID);
+            iPos += iSMExecutedCount;
+            bExecuteSucc = false;
+            break;
+        }
+
+        iPos = iRunEnd;
+    }
+
+    if (bExecuteSucc)
+    {
+        iExecutedCount = iUnpackCount;
+        iPartialValueCount = 0;
+        return iExecutedCount == vecPaxosValue.size();
+    }
+
+    //m_llInstanceID is kept after the value moved.
+    uint64_t llFailInstanceID = vecSMValueList[iPos].second.m_llInstanceID;
+    iExecutedCount = llFailInstanceID - llBeginInstanceID;
+
+    iPartialValueCount = 0;
+    for (size_t i = iPos; i > 0 && vecSMValueList[i - 1].second.m_llInstanceID == llFailInstanceID; i--)
+    {
+        iPartialValueCount++;
+    }
+
+    return false;
+}
+
+StateMachine * SMFac :: GetSM(const int iSMID)
+{
+    for (auto & poSM : m_vecSMList)
+    {
+        if (poSM->SMID() == iSMID)
+        {
+            return poSM;
+        }
+    }
+
+    return nullptr;
+}
+
+bool SMFac :: UnpackForCheckpoint(const uint64_t llInstanceID, const std::string & sPaxosValue, 
+        SMCheckpointValueList & vecSMValueList)
 {
     if (sPaxosValue.size() < sizeof(int))
     {
@@ -155,66 +263,117 @@ bool SMFac :: ExecuteForCheckpoint(const int iGroupIdx, const uint64_t llInstanc
     }
 
     std::string sBodyValue = string(sPaxosValue.data() + sizeof(int), sPaxosValue.size() - sizeof(int));
-    if (iSMID == BATCH_PROPOSE_SMID)
+    if (iSMID == VALUE_CHUNK_SMID)
+    {
+        std::string sChunkValue;
+        if (!LoadChunkValue(llInstanceID, sBodyValue, sChunkValue))
+        {
+            return false;
+        }
+        return UnpackForCheckpoint(llInstanceID, sChunkValue, vecSMValueList);
+    }
+    else if (iSMID == BATCH_PROPOSE_SMID)
     {
-        return BatchExecuteForCheckpoint(iGroupIdx, llInstanceID, sBodyValue);
+        BatchPaxosValues oBatchValues;
+        bool bSucc = oBatchValues.ParseFromArray(sBodyValue.data(), sBodyValue.size());
+        if (!bSucc)
+        {
+            PLG1Err("ParseFromArray fail, valuesize %zu", sBodyValue.size());
+            return false;
+        }
+
+        for (int i = 0; i < oBatchValues.values_size(); i++)
+        {
+            const PaxosValue & oValue = oBatchValues.values(i);
+            AddForCheckpoint(llInstanceID, oValue.value(), oValue.smid(), vecSMValueList);
+        }
     }
     else
     {
-        return DoExecuteForCheckpoint(iGroupIdx, llInstanceID, sBodyValue, iSMID);
+        AddForCheckpoint(llInstanceID, sBodyValue, iSMID, vecSMValueList);
     }
+
+    return true;
 }
 
-bool SMFac :: BatchExecuteForCheckpoint(const int iGroupIdx, const uint64_t llInstanceID, 
-        const std::string & sBodyValue)
+void SMFac :: AddForCheckpoint(const uint64_t llInstanceID, const std::string & sBodyValue, const int iSMID,
+        SMCheckpointValueList & vecSMValueList)
 {
-    BatchPaxosValues oBatchValues;
-    bool bSucc = oBatchValues.ParseFromArray(sBodyValue.data(), sBodyValue.size());
-    if (!bSucc)
+    if (iSMID == 0)
+    {
+        PLG1Imp("Value no need to do sm, just skip, instanceid %lu", llInstanceID);
+        return;
+    }
+
+    CheckpointValue oValue;
+    oValue.m_llInstanceID = llInstanceID;
+    oValue.m_sPaxosValue = sBodyValue;
+    vecSMValueList.push_back(std::make_pair(iSMID, oValue));
+}
+
+////////////////////////////////////////////////////////
+
+void SMFac :: SetChunkStore(ChunkStore * poChunkStore)
+{
+    m_poChunkStore = poChunkStore;
+}
+
+ChunkStore * SMFac :: GetChunkStore()
+{
+    return m_poChunkStore;
+}
+
+bool SMFac :: GetChunkManifest(const std::string & sPaxosValue, ValueChunkManifest & oManifest)
+{
+    if (sPaxosValue.size() < sizeof(int))
     {
-        PLG1Err("ParseFromArray fail, valuesize %zu", sBodyValue.size());
         return false;
     }
 
-    for (int i = 0; i < oBatchValues.values_size(); i++)
+    int iSMID = 0;
+    memcpy(&iSMID, sPaxosValue.data(), sizeof(int));
+    if (iSMID != VALUE_CHUNK_SMID)
     {
-        const PaxosValue & oValue = oBatchValues.values(i);
-        bool bExecuteSucc = DoExecuteForCheckpoint(iGroupIdx, llInstanceID, oValue.value(), oValue.smid());
-        if (!bExecuteSucc)
-        {
-            return false;
-        }
+        return false;
     }
 
-    return true;
+    return oManifest.ParseFromArray(sPaxosValue.data() + sizeof(int), sPaxosValue.size() - sizeof(int));
 }
 
-bool SMFac :: DoExecuteForCheckpoint(const int iGroupIdx, const uint64_t llInstanceID, 
-        const std::string & sBodyValue, const int iSMID)
+bool SMFac :: LoadChunkValue(const uint64_t llInstanceID, const std::string & sBodyValue, std::string & sPaxosValue)
 {
-    if (iSMID == 0)
+    ValueChunkManifest oManifest;
+    bool bSucc = oManifest.ParseFromArray(sBodyValue.data(), sBodyValue.size());
+    if (!bSucc)
     {
-        PLG1Imp("Value no need to do sm, just skip, instanceid %lu", llInstanceID);
-        return true;
+        PLG1Err("Manifest ParseFromArray fail, instanceid %lu valuesize %zu", llInstanceID, sBodyValue.size());
+        return false;
     }
 
-    if (m_vecSMList.size() == 0)
+    if (m_poChunkStore == nullptr)
     {
-        PLG1Imp("No any sm, need wait sm, instanceid %lu", llInstanceID);
+        PLG1Err("No chunk store, instanceid %lu", llInstanceID);
         return false;
     }
 
-    for (auto & poSM : m_vecSMList)
+    //chunks are assembled only when execute, then release.
+    int ret = m_poChunkStore->LoadValue(oManifest, sPaxosValue);
+    if (ret != 0)
     {
-        if (poSM->SMID() == iSMID)
-        {
-            return poSM->ExecuteForCheckpoint(iGroupIdx, llInstanceID, sBodyValue);
-        }
+        PLG1Err("LoadValue fail, chunks not ready, instanceid %lu valueid %lu ret %d", 
+                llInstanceID, oManifest.valueid(), ret);
+        return false;
     }
 
-    PLG1Err("Unknown smid %d instanceid %lu", iSMID, llInstanceID);
+    //chosen chunks are kept until the paxos log is deleted, not collected as garbage.
+    ret = m_poChunkStore->MarkChosen(oManifest.valueid(), true);
+    if (ret != 0)
+    {
+        PLG1Err("MarkChosen fail, instanceid %lu valueid %lu ret %d", 
+                llInstanceID, oManifest.valueid(), ret);
+    }
 
-    return false;
+    return true;
 }
 
 ////////////////////////////////////////////////////////
@@ -23,7 +23,9 @@ See the AUTHORS file for names of contributors.
 
 #include "commdef.h"
 #include <vector>
+#include <map>
 #include "phxpaxos/sm.h"
+#include "chunk_store.h"
 
 namespace phxpaxos
 {
@@ -33,6 +35,9 @@ class BatchSMCtx
 public:
     std::vector<SMCtx *> m_vecSMCtxList;
 };
+
+//values of all sms in instanceid order, key is smid.
+typedef std::vector<std::pair<int, CheckpointValue> > SMCheckpointValueList;
     
 class SMFac
 {
@@ -43,7 +48,12 @@ public:
     bool Execute(const int iGroupIdx, const uint64_t llInstanceID, 
             const std::string & sPaxosValue, SMCtx * poSMCtx);
 
-    bool ExecuteForCheckpoint(const int iGroupIdx, const uint64_t llInstanceID, const std::string & sPaxosValue);
+    //Execute consecutive instances from llBeginInstanceID in the same order as Execute,
+    //consecutive values of one sm are passed to it at once.
+    //iPartialValueCount is in and out, how many values of the first not done instance are done,
+    //iExecutedCount is how many instances done, retry from there never execute a value twice.
+    bool ExecuteForCheckpointBatch(const int iGroupIdx, const uint64_t llBeginInstanceID, 
+            const std::vector<std::string> & vecPaxosValue, size_t & iExecutedCount, int & iPartialValueCount);
 
     void PackPaxosValue(std::string & sPaxosValue, const int iSMID = 0);
 
@@ -61,6 +71,17 @@ public:
 
     std::vector<StateMachine *> GetSMList();
 
+public:
+    void SetChunkStore(ChunkStore * poChunkStore);
+
+    ChunkStore * GetChunkStore();
+
+    //return true if sPaxosValue is a manifest of chunked large value.
+    static bool GetChunkManifest(const std::string & sPaxosValue, ValueChunkManifest & oManifest);
+
+private:
+    bool LoadChunkValue(const uint64_t llInstanceID, const std::string & sBodyValue, std::string & sPaxosValue);
+
 private:
     bool BatchExecute(const int iGroupIdx, const uint64_t llInstanceID, 
             const std::string & sBodyValue, BatchSMCtx * poBatchSMCtx);
@@ -68,15 +89,18 @@ private:
     bool DoExecute(const int iGroupIdx, const uint64_t llInstanceID, 
             const std::string & sBodyValue, const int iSMID, SMCtx * poSMCtx);
 
-    bool BatchExecuteForCheckpoint(const int iGroupIdx, const uint64_t llInstanceID, 
-            const std::string & sBodyValue);
+    bool UnpackForCheckpoint(const uint64_t llInstanceID, const std::string & sPaxosValue, 
+            SMCheckpointValueList & vecSMValueList);
+
+    void AddForCheckpoint(const uint64_t llInstanceID, const std::string & sBodyValue, const int iSMID,
+            SMCheckpointValueList & vecSMValueList);
 
-    bool DoExecuteForCheckpoint(const int iGroupIdx, const uint64_t llInstanceID, 
-            const std::string & sBodyValue, const int iSMID);
+    StateMachine * GetSM(const int iSMID);
 
 private:
     std::vector<StateMachine *> m_vecSMList;
     int m_iMyGroupIdx;
+    ChunkStore * m_poChunkStore;
 };
     
 }
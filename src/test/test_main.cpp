@@ -43,6 +43,7 @@ using namespace std;
 
 int giRunNodeCount = 3;
 bool gbTestBatch = false;
+bool gbUseLocalNetWork = false;
 
 void RandValue(const int iSize, string & sValue)
 {
@@ -264,7 +265,7 @@ int RunServer(vector<TestServer *> & vecTestServerList)
     for (int i = 0; i < iServerCount; i++)
     {
         NodeInfo oMyNode(sIP, iPort + i);
-        TestServer * poTestServer = new TestServer(oMyNode, vecNodeList);
+        TestServer * poTestServer = new TestServer(oMyNode, vecNodeList, gbUseLocalNetWork);
         assert(poTestServer != nullptr);
         vecTestServerList.push_back(poTestServer);
 
@@ -413,7 +414,7 @@ int main(int argc, char ** argv)
 {
     if (argc < 2)
     {
-        printf("%s <run node count> <test batch y/n ?>\n", argv[0]);
+        printf("%s <run node count> <test batch y/n ?> <use local network y/n ?>\n", argv[0]);
         return -1;
     }
 
@@ -423,6 +424,11 @@ int main(int argc, char ** argv)
         gbTestBatch = string(argv[2]) == "y" ? true : false;
     }
 
+    if (argc >= 4)
+    {
+        gbUseLocalNetWork = string(argv[3]) == "y" ? true : false;
+    }
+
     vector<TestServer *> vecTestServerList;
 
     int ret = RunServer(vecTestServerList);
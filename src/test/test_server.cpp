@@ -34,14 +34,23 @@ using namespace std;
 namespace phxpaxos_test
 {
 
-TestServer :: TestServer(const phxpaxos::NodeInfo & oMyNode, const phxpaxos::NodeInfoList & vecNodeList)
-    : m_oMyNode(oMyNode), m_vecNodeList(vecNodeList), m_poPaxosNode(nullptr)
+TestServer :: TestServer(const phxpaxos::NodeInfo & oMyNode, const phxpaxos::NodeInfoList & vecNodeList,
+        const bool bUseLocalNetWork)
+    : m_oMyNode(oMyNode), m_vecNodeList(vecNodeList), m_poPaxosNode(nullptr), 
+    m_bUseLocalNetWork(bUseLocalNetWork)
+#ifdef PHXPAXOS_TEST_LOCAL_NETWORK
+    , m_oLocalNetWork(oMyNode.GetIP(), oMyNode.GetPort())
+#endif
 {
 }
 
 TestServer :: ~TestServer()
 {
     printf("start end server ip %s port %d\n", m_oMyNode.GetIP().c_str(), m_oMyNode.GetPort());
+#ifdef PHXPAXOS_TEST_LOCAL_NETWORK
+    //user network is not stopped by node.
+    m_oLocalNetWork.StopNetWork();
+#endif
     delete m_poPaxosNode;
     printf("server ip %s port %d ended\n", m_oMyNode.GetIP().c_str(), m_oMyNode.GetPort());
 }
@@ -99,6 +108,16 @@ int TestServer :: RunPaxos()
 
     oOptions.iIOThreadCount = 3;
 
+    if (m_bUseLocalNetWork)
+    {
+#ifdef PHXPAXOS_TEST_LOCAL_NETWORK
+        oOptions.poNetWork = &m_oLocalNetWork;
+#else
+        printf("local network not built in, make with local_network=y\n");
+        return -1;
+#endif
+    }
+
     ret = Node::RunNode(oOptions, m_poPaxosNode);
     if (ret != 0)
     {
@@ -22,6 +22,9 @@ See the AUTHORS file for names of contributors.
 #pragma once
 
 #include "phxpaxos/node.h"
+#ifdef PHXPAXOS_TEST_LOCAL_NETWORK
+#include "phxpaxos_plugin/local_network.h"
+#endif
 #include "test_sm.h"
 #include <string>
 #include <vector>
@@ -32,7 +35,8 @@ namespace phxpaxos_test
 class TestServer
 {
 public:
-    TestServer(const phxpaxos::NodeInfo & oMyNode, const phxpaxos::NodeInfoList & vecNodeList);
+    TestServer(const phxpaxos::NodeInfo & oMyNode, const phxpaxos::NodeInfoList & vecNodeList,
+            const bool bUseLocalNetWork = false);
     ~TestServer();
 
     int RunPaxos();
@@ -55,6 +59,11 @@ private:
     TestSM m_oTestSM;
 
     phxpaxos::Node * m_poPaxosNode;
+
+    bool m_bUseLocalNetWork;
+#ifdef PHXPAXOS_TEST_LOCAL_NETWORK
+    phxpaxos::LocalNetWork m_oLocalNetWork;
+#endif
 };
     
 }
@@ -0,0 +1,218 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "comm_include.h"
+#include "checkpoint_writer.h"
+#include "checkpoint_receiver.h"
+#include "sm_base.h"
+#include "gmock/gmock.h"
+#include "mock_class.h"
+#include "make_class.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+static uint32_t Checksum(const string & sBuffer)
+{
+	return crc32(0, (const uint8_t *)sBuffer.data(), sBuffer.size(), CRC32SKIP);
+}
+
+static string ReadAll(const string & sPath)
+{
+	string sContent;
+	FILE * fp = fopen(sPath.c_str(), "rb");
+	if (fp == nullptr)
+	{
+		return sContent;
+	}
+
+	char sBuf[4096];
+	size_t iLen = 0;
+	while ((iLen = fread(sBuf, 1, sizeof(sBuf), fp)) > 0)
+	{
+		sContent.append(sBuf, iLen);
+	}
+
+	fclose(fp);
+	return sContent;
+}
+
+TEST(CheckpointWriter, WriteAndFinish)
+{
+	char sDirPath[] = "/tmp/checkpoint_writer_ut_XXXXXX";
+	ASSERT_TRUE(mkdtemp(sDirPath) != nullptr);
+	string sFile1 = string(sDirPath) + "/file1";
+	string sFile2 = string(sDirPath) + "/file2";
+
+	string sChunk1(CheckpointWriter_BUFFER_SIZE - 10, 'a');
+	string sChunk2(100, 'b');
+	string sChunk3 = "file2 without size";
+
+	CheckpointWriter oWriter;
+	EXPECT_TRUE(oWriter.AddChunk(sFile1, 0, sChunk1.size() + sChunk2.size(), Checksum(sChunk1), sChunk1) == 0);
+	EXPECT_TRUE(oWriter.AddChunk(sFile2, 0, 0, Checksum(sChunk3), sChunk3) == 0);
+	EXPECT_TRUE(oWriter.AddChunk(sFile1, sChunk1.size(), sChunk1.size() + sChunk2.size(), Checksum(sChunk2), sChunk2) == 0);
+	EXPECT_TRUE(oWriter.Finish(sDirPath) == 0);
+
+	EXPECT_TRUE(ReadAll(sFile1) == sChunk1 + sChunk2);
+	EXPECT_TRUE(ReadAll(sFile2) == sChunk3);
+
+	//bad checksum fail this chunk, and all after until reset.
+	string sFile3 = string(sDirPath) + "/file3";
+	EXPECT_TRUE(oWriter.AddChunk(sFile3, 0, 0, Checksum(sChunk3) + 1, sChunk3) == 0);
+	EXPECT_TRUE(oWriter.Finish(sDirPath) != 0);
+	EXPECT_TRUE(oWriter.AddChunk(sFile3, 0, 0, Checksum(sChunk3), sChunk3) != 0);
+
+	oWriter.Reset();
+	EXPECT_TRUE(oWriter.AddChunk(sFile3, 0, 0, Checksum(sChunk3), sChunk3) == 0);
+	EXPECT_TRUE(oWriter.Finish(sDirPath) == 0);
+	EXPECT_TRUE(ReadAll(sFile3) == sChunk3);
+
+	unlink(sFile1.c_str());
+	unlink(sFile2.c_str());
+	unlink(sFile3.c_str());
+	rmdir(sDirPath);
+}
+
+TEST(CheckpointWriter, LinkReuseFile)
+{
+	char sDirPath[] = "/tmp/checkpoint_writer_ut_XXXXXX";
+	ASSERT_TRUE(mkdtemp(sDirPath) != nullptr);
+	string sSrcFile = string(sDirPath) + "/src";
+	string sDstFile = string(sDirPath) + "/dst";
+
+	string sContent = "immutable file content";
+	FILE * fp = fopen(sSrcFile.c_str(), "wb");
+	ASSERT_TRUE(fp != nullptr);
+	fwrite(sContent.data(), 1, sContent.size(), fp);
+	fclose(fp);
+
+	CheckpointWriter oWriter;
+	EXPECT_TRUE(oWriter.AddLink(sSrcFile, sDstFile, sContent.size()) == 0);
+	EXPECT_TRUE(oWriter.Finish(sDirPath) == 0);
+	EXPECT_TRUE(ReadAll(sDstFile) == sContent);
+
+	//local file changed after advertised.
+	unlink(sDstFile.c_str());
+	EXPECT_TRUE(oWriter.AddLink(sSrcFile, sDstFile, sContent.size() + 1) == 0);
+	EXPECT_TRUE(oWriter.Finish(sDirPath) != 0);
+
+	unlink(sSrcFile.c_str());
+	unlink(sDstFile.c_str());
+	rmdir(sDirPath);
+}
+
+//count how many times the files are listed.
+class TestImmutableFilesSM : public StateMachine
+{
+public:
+	TestImmutableFilesSM() : m_llCheckpointInstanceID(10), m_iListCount(0) { }
+
+	const int SMID() const { return 1; }
+
+	bool Execute(const int iGroupIdx, const uint64_t llInstanceID, 
+			const std::string & sPaxosValue, SMCtx * poSMCtx) { return true; }
+
+	const uint64_t GetCheckpointInstanceID(const int iGroupIdx) const { return m_llCheckpointInstanceID; }
+
+	int GetCheckpointImmutableFiles(const int iGroupIdx, std::string & sDirPath, 
+			CheckpointFileInfoList & vecFileInfoList)
+	{
+		m_iListCount++;
+		sDirPath = "/tmp/ut_ckpt_sm";
+		CheckpointFileInfo oFileInfo;
+		oFileInfo.m_sFilePath = "000001.sst";
+		oFileInfo.m_llFileSize = 100;
+		oFileInfo.m_llChecksum = 1234;
+		vecFileInfoList.push_back(oFileInfo);
+		return 0;
+	}
+
+	uint64_t m_llCheckpointInstanceID;
+	int m_iListCount;
+};
+
+//listing run in background, ask again until it done.
+static int WaitReuseFiles(CheckpointReceiver & oReceiver, SMFac * poSMFac, string & sFiles)
+{
+	int ret = oReceiver.PrepareReuseFiles(poSMFac, sFiles);
+	for (int i = 0; ret == 1 && i < 1000; i++)
+	{
+		Time::MsSleep(1);
+		ret = oReceiver.PrepareReuseFiles(poSMFac, sFiles);
+	}
+
+	return ret;
+}
+
+TEST(CheckpointReceiver, ReuseFilesListOncePerCheckpoint)
+{
+	MockLogStorage oMockLogStorage;
+	Config * poConfig = nullptr;
+	MakeConfig(&oMockLogStorage, poConfig);
+
+	TestImmutableFilesSM oSM;
+	SMFac oSMFac(0);
+	oSMFac.AddSM(&oSM);
+
+	CheckpointReceiver oReceiver(poConfig, &oMockLogStorage);
+
+	//not listed yet, not block the caller.
+	string sFirstFiles;
+	EXPECT_TRUE(oReceiver.PrepareReuseFiles(&oSMFac, sFirstFiles) == 1);
+	EXPECT_TRUE(sFirstFiles.size() == 0);
+
+	EXPECT_TRUE(WaitReuseFiles(oReceiver, &oSMFac, sFirstFiles) == 0);
+	EXPECT_TRUE(sFirstFiles.size() > 0);
+
+	string sFiles;
+	EXPECT_TRUE(oReceiver.PrepareReuseFiles(&oSMFac, sFiles) == 0);
+	EXPECT_TRUE(sFiles == sFirstFiles);
+	EXPECT_TRUE(oSM.m_iListCount == 1);
+
+	//new checkpoint, list again.
+	oSM.m_llCheckpointInstanceID = 20;
+	EXPECT_TRUE(WaitReuseFiles(oReceiver, &oSMFac, sFiles) == 0);
+	EXPECT_TRUE(oSM.m_iListCount == 2);
+
+	//sender think we have a file we don't, list again.
+	CheckpointMsg oCheckpointMsg;
+	oCheckpointMsg.set_smid(1);
+	oCheckpointMsg.set_filepath("000002.sst");
+	oCheckpointMsg.set_filesize(100);
+	oCheckpointMsg.set_filechecksum(1234);
+	oCheckpointMsg.set_nodeid(nullnode);
+	oCheckpointMsg.set_uuid(0);
+	oCheckpointMsg.set_sequence(1);
+	EXPECT_TRUE(oReceiver.ReceiveReuseFile(oCheckpointMsg) != 0);
+
+	EXPECT_TRUE(WaitReuseFiles(oReceiver, &oSMFac, sFiles) == 0);
+	EXPECT_TRUE(oSM.m_iListCount == 3);
+
+	delete poConfig;
+}
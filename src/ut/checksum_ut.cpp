@@ -0,0 +1,70 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "gmock/gmock.h"
+#include "make_class.h"
+#include "mock_class.h"
+#include "crc32.h"
+
+using namespace phxpaxos;
+using namespace std;
+using ::testing::_;
+using ::testing::Return;
+
+TEST(Checksum, Crc32C)
+{
+	string sValue = "123456789";
+	EXPECT_TRUE(crc32c(0, (const uint8_t *)sValue.data(), sValue.size()) == 0xE3069283);
+
+	string sBuffer(1000, 'a');
+	for (size_t i = 0; i < sBuffer.size(); i++)
+	{
+		sBuffer[i] = (char)(i * 7);
+	}
+
+	uint32_t iChecksum = crc32c(0, (const uint8_t *)sBuffer.data(), 333);
+	iChecksum = crc32c(iChecksum, (const uint8_t *)sBuffer.data() + 333, sBuffer.size() - 333);
+	EXPECT_TRUE(iChecksum == crc32c(0, (const uint8_t *)sBuffer.data(), sBuffer.size()));
+}
+
+TEST(Checksum, ChainChecksumType)
+{
+	MockLogStorage oMockLogStorage;
+	Config * poConfig = nullptr;
+	MakeConfig(&oMockLogStorage, poConfig);
+
+	string sValue = "checksum chain value";
+	EXPECT_TRUE(poConfig->GetChecksumType() == ChecksumType_Crc32);
+	EXPECT_TRUE(poConfig->ChainChecksum(1, sValue) == 
+			crc32(1, (const uint8_t *)sValue.data(), sValue.size(), CRC32SKIP));
+
+	string sOpValue;
+	EXPECT_TRUE(poConfig->GetSystemVSM()->ChecksumType_OPValue(ChecksumType_Crc32C, sOpValue) == 0);
+
+	EXPECT_CALL(oMockLogStorage, SetSystemVariables(_,_,_)).WillOnce(Return(0));
+	EXPECT_TRUE(poConfig->GetSystemVSM()->Execute(0, 10, sOpValue, nullptr));
+
+	EXPECT_TRUE(poConfig->GetChecksumType() == ChecksumType_Crc32C);
+	EXPECT_TRUE(poConfig->ChainChecksum(1, sValue) == crc32c(1, (const uint8_t *)sValue.data(), sValue.size()));
+
+	delete poConfig;
+}
@@ -0,0 +1,219 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+
+#include "gmock/gmock.h"
+#include "mock_class.h"
+#include "make_class.h"
+#include "committer.h"
+#include "value_chunk_mgr.h"
+#include <vector>
+
+using namespace phxpaxos;
+using namespace std;
+
+//write the value as int to SMCtx.
+class TestCoalesceSM : public StateMachine
+{
+public:
+	const int SMID() const { return 1; }
+
+	bool Execute(const int iGroupIdx, const uint64_t llInstanceID, 
+			const std::string & sPaxosValue, SMCtx * poSMCtx)
+	{
+		if (poSMCtx != nullptr && poSMCtx->m_pCtx != nullptr)
+		{
+			*(int *)poSMCtx->m_pCtx = atoi(sPaxosValue.c_str());
+		}
+		return true;
+	}
+};
+
+class TestProposal
+{
+public:
+	TestProposal() : iRet(-1), llInstanceID(0), iSMRet(-1) { }
+
+	int iRet;
+	uint64_t llInstanceID;
+	int iSMRet;
+};
+
+static void TestPropose(Committer * poCommitter, const int iValue, TestProposal * poProposal)
+{
+	SMCtx oSMCtx(1, &poProposal->iSMRet);
+	poProposal->iRet = poCommitter->NewValueGetID(to_string(iValue), poProposal->llInstanceID, &oSMCtx);
+}
+
+static void TestProposeWithTimeout(Committer * poCommitter, const int iValue, const int iTimeoutMs, 
+		TestProposal * poProposal)
+{
+	SMCtx oSMCtx(1, &poProposal->iSMRet);
+	poProposal->iRet = poCommitter->NewValueGetID(to_string(iValue), poProposal->llInstanceID, &oSMCtx, iTimeoutMs);
+}
+
+TEST(Committer, CoalesceConcurrentProposals)
+{
+	MockLogStorage oLogStorage;
+	Config * poConfig = nullptr;
+	MakeConfig(&oLogStorage, poConfig);
+
+	TestCoalesceSM oSM;
+	SMFac oSMFac(0);
+	oSMFac.AddSM(&oSM);
+
+	CommitCtx oCommitCtx(poConfig);
+	MockIOLoop oIOLoop;
+	ValueChunkMgr oValueChunkMgr(poConfig, nullptr, nullptr, nullptr, 0);
+	Committer oCommitter(poConfig, &oCommitCtx, &oIOLoop, &oSMFac, &oValueChunkMgr, true);
+	//coalesced proposals wait without taking a place of hold threads.
+	oCommitter.SetMaxHoldThreads(1);
+
+	const int iCount = 8;
+	std::vector<TestProposal> vecProposal(iCount);
+	std::vector<std::thread *> vecThread;
+	{
+		TestCommitLoop oCommitLoop(&oCommitCtx, &oSMFac);
+		oCommitLoop.m_bPause = true;
+
+		//first one hold the lock, the others queue behind it.
+		vecThread.push_back(new std::thread(TestPropose, &oCommitter, 0, &vecProposal[0]));
+		Time::MsSleep(50);
+		for (int i = 1; i < iCount; i++)
+		{
+			vecThread.push_back(new std::thread(TestPropose, &oCommitter, i, &vecProposal[i]));
+		}
+		Time::MsSleep(100);
+
+		oCommitLoop.m_bPause = false;
+		for (auto & poThread : vecThread)
+		{
+			poThread->join();
+			delete poThread;
+		}
+
+		EXPECT_TRUE(oCommitLoop.m_iCommitCount == 2);
+	}
+
+	EXPECT_TRUE(vecProposal[0].iRet == 0);
+	for (int i = 1; i < iCount; i++)
+	{
+		EXPECT_TRUE(vecProposal[i].iRet == 0);
+		EXPECT_TRUE(vecProposal[i].llInstanceID == vecProposal[0].llInstanceID + 1);
+	}
+
+	for (int i = 0; i < iCount; i++)
+	{
+		EXPECT_TRUE(vecProposal[i].iSMRet == i);
+	}
+
+	delete poConfig;
+}
+
+TEST(Committer, CoalesceSkipAlmostExpiredProposal)
+{
+	MockLogStorage oLogStorage;
+	Config * poConfig = nullptr;
+	MakeConfig(&oLogStorage, poConfig);
+
+	TestCoalesceSM oSM;
+	SMFac oSMFac(0);
+	oSMFac.AddSM(&oSM);
+
+	CommitCtx oCommitCtx(poConfig);
+	MockIOLoop oIOLoop;
+	ValueChunkMgr oValueChunkMgr(poConfig, nullptr, nullptr, nullptr, 0);
+	Committer oCommitter(poConfig, &oCommitCtx, &oIOLoop, &oSMFac, &oValueChunkMgr, true);
+
+	const int iCount = 5;
+	std::vector<TestProposal> vecProposal(iCount);
+	std::vector<std::thread *> vecThread;
+	{
+		TestCommitLoop oCommitLoop(&oCommitCtx, &oSMFac);
+		oCommitLoop.m_bPause = true;
+
+		//0 hold the lock, 1 is the next leader.
+		vecThread.push_back(new std::thread(TestProposeWithTimeout, &oCommitter, 0, 5000, &vecProposal[0]));
+		Time::MsSleep(50);
+		vecThread.push_back(new std::thread(TestProposeWithTimeout, &oCommitter, 1, 5000, &vecProposal[1]));
+		Time::MsSleep(50);
+		for (int i = 2; i < iCount - 1; i++)
+		{
+			vecThread.push_back(new std::thread(TestProposeWithTimeout, &oCommitter, i, 5000, &vecProposal[i]));
+		}
+		//about to expire when 1 pluck.
+		vecThread.push_back(new std::thread(TestProposeWithTimeout, &oCommitter, iCount - 1, 300, 
+					&vecProposal[iCount - 1]));
+		Time::MsSleep(150);
+
+		oCommitLoop.m_bPause = false;
+		for (auto & poThread : vecThread)
+		{
+			poThread->join();
+			delete poThread;
+		}
+
+		EXPECT_TRUE(oCommitLoop.m_iCommitCount == 2);
+		//not shrink by the almost expired one.
+		EXPECT_TRUE(oCommitLoop.m_iLastTimeoutMs > 1000);
+	}
+
+	for (int i = 0; i < iCount - 1; i++)
+	{
+		EXPECT_TRUE(vecProposal[i].iRet == 0);
+		EXPECT_TRUE(vecProposal[i].iSMRet == i);
+	}
+	EXPECT_TRUE(vecProposal[2].llInstanceID == vecProposal[1].llInstanceID);
+	EXPECT_TRUE(vecProposal[iCount - 1].iRet == PaxosTryCommitRet_Timeout);
+
+	delete poConfig;
+}
+
+TEST(CommitCtx, TraceSumRetryRounds)
+{
+	MockLogStorage oLogStorage;
+	Config * poConfig = nullptr;
+	MakeConfig(&oLogStorage, poConfig);
+
+	CommitCtx oCommitCtx(poConfig);
+	string sValue = "trace";
+	oCommitCtx.NewCommit(&sValue, nullptr, 1000);
+	oCommitCtx.StartCommit(5);
+
+	//prepare retry begin again without end, the first round must count.
+	oCommitCtx.TraceBegin(CommitStage_Prepare, 5);
+	Time::MsSleep(20);
+	oCommitCtx.TraceBegin(CommitStage_Prepare, 5);
+	Time::MsSleep(20);
+	oCommitCtx.TraceEnd(CommitStage_Prepare, 5);
+
+	EXPECT_TRUE(oCommitCtx.GetTraceUseTimeUS(CommitStage_Prepare) >= 40000);
+
+	//other instance is not my commit.
+	oCommitCtx.TraceBegin(CommitStage_Accept, 6);
+	Time::MsSleep(5);
+	oCommitCtx.TraceEnd(CommitStage_Accept, 6);
+	EXPECT_TRUE(oCommitCtx.GetTraceUseTimeUS(CommitStage_Accept) == 0);
+
+	delete poConfig;
+}
@@ -0,0 +1,104 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+#include <string>
+#include <thread>
+#include "communicate.h"
+#include "credit_notifier.h"
+#include "mock_class.h"
+#include "make_class.h"
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+using ::testing::_;
+using ::testing::Return;
+
+TEST(Communicate, EndpointReflesh)
+{
+	MockLogStorage oMockLogStorage;
+	MockNetWork oMockNetWork;
+
+	Config * poConfig = nullptr;
+	MakeConfig(&oMockLogStorage, poConfig);
+
+	Communicate * poCommunicate = nullptr;
+	MakeCommunicate(&oMockNetWork, poConfig, poCommunicate);
+
+	//3 nodes membership, broadcast to the other 2.
+	EXPECT_CALL(oMockNetWork, SendMessageUDP(0, "127.0.0.1", _, _)).Times(2).WillRepeatedly(Return(0));
+	poCommunicate->BroadcastMessage(0, "test");
+
+	NodeInfo oNewNode("127.0.0.1", 11115);
+	NodeInfoList vecNodeInfoList;
+	vecNodeInfoList.push_back(NodeInfo("127.0.0.1", 11111));
+	vecNodeInfoList.push_back(oNewNode);
+	SystemVariables oVariables;
+	poConfig->GetSystemVSM()->GetSystemVariables(oVariables);
+	oVariables.clear_membership();
+	for (auto & oNodeInfo : vecNodeInfoList)
+	{
+		PaxosNodeInfo * poNodeInfo = oVariables.add_membership();
+		poNodeInfo->set_rid(0);
+		poNodeInfo->set_nodeid(oNodeInfo.GetNodeID());
+	}
+
+	EXPECT_CALL(oMockLogStorage, SetSystemVariables(_,_,_)).WillOnce(Return(0));
+	EXPECT_TRUE(poConfig->GetSystemVSM()->UpdateSystemVariables(oVariables) == 0);
+
+	EXPECT_CALL(oMockNetWork, SendMessageUDP(0, "127.0.0.1", 11115, _)).Times(1).WillOnce(Return(-1));
+	poCommunicate->BroadcastMessage(0, "test");
+
+	uint64_t llSendCount = 0, llSendBytes = 0, llSendFailCount = 0;
+	EXPECT_TRUE(poCommunicate->GetPeerSendStat(oNewNode.GetNodeID(), llSendCount, llSendBytes, llSendFailCount) == 0);
+	EXPECT_TRUE(llSendCount == 1 && llSendBytes == 4 && llSendFailCount == 1);
+
+	delete poCommunicate;
+	delete poConfig;
+}
+
+TEST(CreditNotifier, WaitForCredit)
+{
+	CreditNotifier * poNotifier = CreditNotifier::Instance();
+
+	//credit come back before wait is not missed.
+	uint64_t llVersion = poNotifier->GetVersion();
+	poNotifier->Notify();
+	uint64_t llBeginTime = Time::GetSteadyClockMS();
+	poNotifier->Wait(llVersion, 1000);
+	EXPECT_TRUE(Time::GetSteadyClockMS() - llBeginTime < 500);
+
+	//wake up by notify, not by timeout.
+	llVersion = poNotifier->GetVersion();
+	std::thread oThread([poNotifier]() { Time::MsSleep(20); poNotifier->Notify(); });
+	llBeginTime = Time::GetSteadyClockMS();
+	poNotifier->Wait(llVersion, 5000);
+	EXPECT_TRUE(Time::GetSteadyClockMS() - llBeginTime < 2500);
+	oThread.join();
+
+	//no credit, timeout.
+	llVersion = poNotifier->GetVersion();
+	llBeginTime = Time::GetSteadyClockMS();
+	poNotifier->Wait(llVersion, 20);
+	EXPECT_TRUE(Time::GetSteadyClockMS() - llBeginTime >= 19);
+}
@@ -21,6 +21,11 @@ See the AUTHORS file for names of contributors.
 
 #include <string>
 #include "db.h"
+#include "chunk_store.h"
+#include "chosen_value_cache.h"
+#include "crc32.h"
+#include "inside_options.h"
+#include "mock_class.h"
 #include "gmock/gmock.h"
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -262,3 +267,223 @@ TEST(MultiDatabase, Set_Get_MasterVariables)
 }
 
 
+
+TEST(MultiDatabase, ReopenAfterIndexWatermark)
+{
+	int iGroupCount = 1;
+	InsideOptions::Instance()->SetLogFileMaxSize(1024 * 1024);
+
+	//pass the watermark interval and roll over to next file several times.
+	const uint64_t llPutCount = LOG_INDEX_WATERMARK_INTERVAL + 10;
+	const size_t iValueSize = LOG_FILE_MAX_SIZE / LOG_INDEX_WATERMARK_INTERVAL + 1024;
+	WriteOptions oWriteOptions;
+	oWriteOptions.bSync = false;
+
+	{
+		MultiDatabase oDB;
+		ASSERT_TRUE(InitDB(iGroupCount, oDB) == 0);
+
+		for (uint64_t llInstanceID = 0; llInstanceID < llPutCount; llInstanceID++)
+		{
+			std::string sValue(iValueSize, 'a' + llInstanceID % 26);
+			ASSERT_TRUE(oDB.Put(oWriteOptions, 0, llInstanceID, sValue) == 0);
+		}
+	}
+
+	ASSERT_TRUE(access("./ut_test_db_path/g0/vfile/1.f", F_OK) == 0);
+
+	int iWatermarkFileID = -1;
+	int iWatermarkOffset = -1;
+	int iWatermarkFd = open("./ut_test_db_path/g0/vfile/watermark", O_RDONLY);
+	ASSERT_TRUE(iWatermarkFd != -1);
+	EXPECT_TRUE(pread(iWatermarkFd, &iWatermarkFileID, sizeof(int), 0) == sizeof(int));
+	EXPECT_TRUE(pread(iWatermarkFd, &iWatermarkOffset, sizeof(int), sizeof(int)) == sizeof(int));
+	close(iWatermarkFd);
+	EXPECT_TRUE(iWatermarkFileID > 0);
+
+	//rebuild must start from the watermark, not from the first file.
+	MockBreakpoint oMockBreakpoint;
+	EXPECT_CALL(oMockBreakpoint.m_oMockLogStorageBP, RebuildIndexStart(iWatermarkFileID, iWatermarkOffset)).Times(1);
+
+	BP->SetInstance(&oMockBreakpoint);
+	MultiDatabase oDB;
+	int ret = oDB.Init("./ut_test_db_path/", iGroupCount);
+	BP->SetInstance(nullptr);
+	ASSERT_TRUE(ret == 0);
+
+	uint64_t llMaxInstanceID = 0;
+	ASSERT_TRUE(oDB.GetMaxInstanceID(0, llMaxInstanceID) == 0);
+	EXPECT_TRUE(llMaxInstanceID == llPutCount - 1);
+
+	for (uint64_t llInstanceID = 0; llInstanceID < llPutCount; llInstanceID++)
+	{
+		std::string sGetValue;
+		ASSERT_TRUE(oDB.Get(0, llInstanceID, sGetValue) == 0);
+		EXPECT_TRUE(sGetValue == std::string(iValueSize, 'a' + llInstanceID % 26));
+	}
+
+	InsideOptions::Instance()->SetLogFileMaxSize(0);
+}
+
+TEST(ChunkStore, PutAndLoadValue)
+{
+	MultiDatabase oDB;
+	ASSERT_TRUE(InitDB(1, oDB) == 0);
+
+	ChunkStore oChunkStore(&oDB);
+	ASSERT_TRUE(oChunkStore.Init(0) == 0);
+	EXPECT_TRUE(oChunkStore.HasAnyChunk() == false);
+
+	std::string sValue(1000, 'x');
+	sValue += std::string(500, 'y');
+	const int iChunkSize = 400;
+
+	ValueChunkManifest oManifest;
+	oManifest.set_valueid(12345);
+	oManifest.set_valuesize(sValue.size());
+	oManifest.set_chunksize(iChunkSize);
+
+	uint32_t iValueChecksum = 0;
+	for (size_t iOffset = 0; iOffset < sValue.size(); iOffset += iChunkSize)
+	{
+		std::string sChunk = sValue.substr(iOffset, iChunkSize);
+		oManifest.add_chunkchecksum(crc32(0, (const uint8_t *)sChunk.data(), sChunk.size()));
+		iValueChecksum = crc32(iValueChecksum, (const uint8_t *)sChunk.data(), sChunk.size());
+	}
+	oManifest.set_valuechecksum(iValueChecksum);
+
+	//chunk 3 missing.
+	for (int i = 0; i < 3; i++)
+	{
+		ASSERT_TRUE(oChunkStore.PutChunk(oManifest.valueid(), i, sValue.substr(i * iChunkSize, iChunkSize), false) == 0);
+	}
+
+	std::vector<int> vecChunkIdx;
+	oChunkStore.GetMissingChunks(oManifest, vecChunkIdx);
+	ASSERT_TRUE(vecChunkIdx.size() == 1);
+	EXPECT_TRUE(vecChunkIdx[0] == 3);
+
+	std::string sLoadValue;
+	EXPECT_TRUE(oChunkStore.LoadValue(oManifest, sLoadValue) == 1);
+
+	ASSERT_TRUE(oChunkStore.PutChunk(oManifest.valueid(), 3, sValue.substr(3 * iChunkSize), false) == 0);
+	EXPECT_TRUE(oChunkStore.LoadValue(oManifest, sLoadValue) == 0);
+	EXPECT_TRUE(sLoadValue == sValue);
+
+	//broken chunk.
+	ASSERT_TRUE(oChunkStore.PutChunk(oManifest.valueid(), 1, std::string(iChunkSize, 'z'), false) == 0);
+	EXPECT_TRUE(oChunkStore.LoadValue(oManifest, sLoadValue) == -1);
+
+	ASSERT_TRUE(oChunkStore.DelValue(oManifest.valueid(), oManifest.chunkchecksum_size()) == 0);
+	EXPECT_TRUE(oChunkStore.HasChunk(oManifest.valueid(), 0) == false);
+}
+
+TEST(ChunkStore, ReopenAndGCValues)
+{
+	MultiDatabase oDB;
+	ASSERT_TRUE(InitDB(1, oDB) == 0);
+
+	{
+		ChunkStore oChunkStore(&oDB);
+		ASSERT_TRUE(oChunkStore.Init(0) == 0);
+
+		//1 chosen, 2 abandoned, 3 accepted on the instance not chosen yet.
+		for (uint64_t llValueID = 1; llValueID <= 3; llValueID++)
+		{
+			for (int i = 0; i < 2; i++)
+			{
+				ASSERT_TRUE(oChunkStore.PutChunk(llValueID, i, "chunk", true) == 0);
+			}
+		}
+		ASSERT_TRUE(oChunkStore.MarkChosen(1, true) == 0);
+	}
+
+	//chunk bitmap is rebuilt from files.
+	ChunkStore oChunkStore(&oDB);
+	ASSERT_TRUE(oChunkStore.Init(0) == 0);
+	EXPECT_TRUE(oChunkStore.HasAnyChunk());
+	EXPECT_TRUE(oChunkStore.HasChunk(2, 1));
+	EXPECT_TRUE(oChunkStore.HasChunk(2, 2) == false);
+
+	std::set<uint64_t> setKeepValueID;
+	setKeepValueID.insert(3);
+
+	int iDelCount = 0;
+	ASSERT_TRUE(oChunkStore.GCValues(VALUE_CHUNK_GC_AGE_MS, setKeepValueID, iDelCount) == 0);
+	EXPECT_TRUE(iDelCount == 0);
+
+	ASSERT_TRUE(oChunkStore.GCValues(0, setKeepValueID, iDelCount) == 0);
+	EXPECT_TRUE(iDelCount == 1);
+	EXPECT_TRUE(oChunkStore.HasChunk(1, 0));
+	EXPECT_TRUE(oChunkStore.HasChunk(2, 0) == false);
+	EXPECT_TRUE(oChunkStore.HasChunk(3, 0));
+
+	//deleted with it's paxos log.
+	ASSERT_TRUE(oChunkStore.DelValue(1, 2) == 0);
+
+	ChunkStore oReopenChunkStore(&oDB);
+	ASSERT_TRUE(oReopenChunkStore.Init(0) == 0);
+	EXPECT_TRUE(oReopenChunkStore.HasChunk(1, 0) == false);
+	EXPECT_TRUE(oReopenChunkStore.HasChunk(2, 0) == false);
+	EXPECT_TRUE(oReopenChunkStore.HasChunk(3, 1));
+}
+
+TEST(ChosenValueCache, ReadThroughAndEvict)
+{
+	MultiDatabase oDB;
+	ASSERT_TRUE(InitDB(1, oDB) == 0);
+
+	PaxosLog oPaxosLog(&oDB);
+	WriteOptions oWriteOptions;
+	oWriteOptions.bSync = false;
+
+	AcceptorStateData oState;
+	oState.set_promiseid(0);
+	oState.set_promisenodeid(nullnode);
+	oState.set_acceptedid(0);
+	oState.set_acceptednodeid(nullnode);
+	oState.set_checksum(0);
+
+	for (uint64_t llInstanceID = 0; llInstanceID < 5; llInstanceID++)
+	{
+		oState.set_instanceid(llInstanceID);
+		oState.set_acceptedvalue("value" + std::to_string(llInstanceID));
+		ASSERT_TRUE(oPaxosLog.WriteState(oWriteOptions, 0, llInstanceID, oState) == 0);
+	}
+
+	ChosenValueCache oCache(&oDB, 2);
+	for (uint64_t llInstanceID = 2; llInstanceID < 5; llInstanceID++)
+	{
+		oState.set_instanceid(llInstanceID);
+		oState.set_acceptedvalue("value" + std::to_string(llInstanceID));
+		oCache.Add(oState);
+	}
+
+	//2 is evicted by 4.
+	AcceptorStateData oGetState;
+	ASSERT_TRUE(oCache.ReadState(0, 4, oGetState) == 0);
+	EXPECT_TRUE(oGetState.acceptedvalue() == "value4");
+	ASSERT_TRUE(oCache.ReadState(0, 3, oGetState) == 0);
+	EXPECT_TRUE(oCache.GetHitCount() == 2);
+
+	ASSERT_TRUE(oCache.ReadState(0, 2, oGetState) == 0);
+	EXPECT_TRUE(oGetState.acceptedvalue() == "value2");
+	EXPECT_TRUE(oCache.GetMissCount() == 1);
+
+	//miss read through without fill, scan old instances not evict the tail.
+	ASSERT_TRUE(oCache.ReadState(0, 1, oGetState) == 0);
+	EXPECT_TRUE(oGetState.acceptedvalue() == "value1");
+	ASSERT_TRUE(oCache.ReadState(0, 1, oGetState) == 0);
+	EXPECT_TRUE(oCache.GetMissCount() == 3);
+
+	ASSERT_TRUE(oCache.ReadState(0, 3, oGetState) == 0);
+	ASSERT_TRUE(oCache.ReadState(0, 4, oGetState) == 0);
+	EXPECT_TRUE(oCache.GetHitCount() == 4);
+
+	EXPECT_TRUE(oCache.ReadState(0, 7, oGetState) == 1);
+
+	oCache.Clear();
+	ASSERT_TRUE(oCache.ReadState(0, 4, oGetState) == 0);
+	EXPECT_TRUE(oGetState.acceptedvalue() == "value4");
+	EXPECT_TRUE(oCache.GetMissCount() == 5);
+}
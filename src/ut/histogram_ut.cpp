@@ -0,0 +1,52 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+#include "utils_include.h"
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+TEST(Histogram, Percentile)
+{
+	Histogram oHistogram;
+	EXPECT_TRUE(oHistogram.GetPercentile(50) == 0);
+
+	for (uint64_t i = 1; i <= 1000; i++)
+	{
+		oHistogram.Add(i);
+	}
+
+	EXPECT_TRUE(oHistogram.GetCount() == 1000);
+	EXPECT_TRUE(oHistogram.GetMax() == 1000);
+
+	uint64_t llP50 = oHistogram.GetPercentile(50);
+	EXPECT_TRUE(llP50 >= 500 && llP50 < 1024);
+
+	uint64_t llP99 = oHistogram.GetPercentile(99);
+	EXPECT_TRUE(llP99 == 1000);
+
+	oHistogram.Reset();
+	EXPECT_TRUE(oHistogram.GetCount() == 0);
+	EXPECT_TRUE(oHistogram.GetMax() == 0);
+}
@@ -0,0 +1,177 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+#include "gmock/gmock.h"
+#include "ioloop.h"
+#include "msg_class.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+static string PackTestMsg(const int iCmd, const int iMsgType)
+{
+	Header oHeader;
+	oHeader.set_gid(0);
+	oHeader.set_rid(0);
+	oHeader.set_cmdid(iCmd);
+	string sHeaderBuffer;
+	oHeader.SerializeToString(&sHeaderBuffer);
+
+	PaxosMsg oPaxosMsg;
+	oPaxosMsg.set_msgtype(iMsgType);
+	oPaxosMsg.set_instanceid(100);
+	oPaxosMsg.set_value("abc");
+	string sBodyBuffer;
+	oPaxosMsg.SerializeToString(&sBodyBuffer);
+
+	int iGroupIdx = 0;
+	uint16_t iHeaderLen = (uint16_t)sHeaderBuffer.size();
+	return string((char *)&iGroupIdx, GROUPIDXLEN) + string((char *)&iHeaderLen, HEADLEN_LEN)
+		+ sHeaderBuffer + sBodyBuffer + string(CHECKSUM_LEN, '\0');
+}
+
+TEST(IOLoopMsgQueue, GetMsgClass)
+{
+	string sBuffer = PackTestMsg(MsgCmd_PaxosMsg, MsgType_PaxosAccept);
+	EXPECT_TRUE(IOLoop::GetMsgClass(sBuffer.data(), sBuffer.size()) == IOLoopMsgClass_Consensus);
+
+	sBuffer = PackTestMsg(MsgCmd_PaxosMsg, MsgType_PaxosLearner_SendLearnValue);
+	EXPECT_TRUE(IOLoop::GetMsgClass(sBuffer.data(), sBuffer.size()) == IOLoopMsgClass_Learn);
+
+	sBuffer = PackTestMsg(MsgCmd_CheckpointMsg, 0);
+	EXPECT_TRUE(IOLoop::GetMsgClass(sBuffer.data(), sBuffer.size()) == IOLoopMsgClass_Checkpoint);
+
+	EXPECT_TRUE(IOLoop::GetMsgClass("abc", 3) == IOLoopMsgClass_Consensus);
+}
+
+static string PackTestCheckpointMsg(const int iFlag)
+{
+	Header oHeader;
+	oHeader.set_gid(0);
+	oHeader.set_rid(0);
+	oHeader.set_cmdid(MsgCmd_CheckpointMsg);
+	string sHeaderBuffer;
+	oHeader.SerializeToString(&sHeaderBuffer);
+
+	CheckpointMsg oCheckpointMsg;
+	oCheckpointMsg.set_msgtype(CheckpointMsgType_SendFile);
+	oCheckpointMsg.set_nodeid(1);
+	oCheckpointMsg.set_flag(iFlag);
+	oCheckpointMsg.set_uuid(1);
+	oCheckpointMsg.set_sequence(1);
+	oCheckpointMsg.set_buffer("abc");
+	string sBodyBuffer;
+	oCheckpointMsg.SerializeToString(&sBodyBuffer);
+
+	int iGroupIdx = 0;
+	uint16_t iHeaderLen = (uint16_t)sHeaderBuffer.size();
+	return string((char *)&iGroupIdx, GROUPIDXLEN) + string((char *)&iHeaderLen, HEADLEN_LEN)
+		+ sHeaderBuffer + sBodyBuffer + string(CHECKSUM_LEN, '\0');
+}
+
+TEST(IOLoopMsgQueue, IsBulkMessage)
+{
+	EXPECT_FALSE(MsgClass::IsBulkMessage(PackTestMsg(MsgCmd_PaxosMsg, MsgType_PaxosAccept)));
+	EXPECT_FALSE(MsgClass::IsBulkMessage(PackTestMsg(MsgCmd_PaxosMsg, MsgType_PaxosAcceptReply)));
+	EXPECT_FALSE(MsgClass::IsBulkMessage(PackTestMsg(MsgCmd_PaxosMsg, MsgType_PaxosLearner_SendLearnValue_Ack)));
+	EXPECT_TRUE(MsgClass::IsBulkMessage(PackTestMsg(MsgCmd_PaxosMsg, MsgType_PaxosLearner_SendLearnValue)));
+	EXPECT_TRUE(MsgClass::IsBulkMessage(PackTestMsg(MsgCmd_PaxosMsg, MsgType_PaxosLearner_SendLearnValueBatch)));
+
+	EXPECT_FALSE(MsgClass::IsBulkMessage(PackTestCheckpointMsg(CheckpointSendFileFlag_BEGIN)));
+	EXPECT_FALSE(MsgClass::IsBulkMessage(PackTestCheckpointMsg(CheckpointSendFileFlag_END)));
+	EXPECT_TRUE(MsgClass::IsBulkMessage(PackTestCheckpointMsg(CheckpointSendFileFlag_ING)));
+	EXPECT_TRUE(MsgClass::IsBulkMessage(PackTestCheckpointMsg(CheckpointSendFileFlag_REUSE)));
+
+	EXPECT_FALSE(MsgClass::IsBulkMessage("abc"));
+}
+
+TEST(IOLoopMsgQueue, WeightedPop)
+{
+	IOLoopMsgQueue oQueue(1000, 1000000);
+	int iDepth = 0;
+	for (int i = 0; i < 100; i++)
+	{
+		for (int iMsgClass = 0; iMsgClass < IOLoopMsgClass_Count; iMsgClass++)
+		{
+			EXPECT_TRUE(oQueue.Add(iMsgClass, new string("a"), iDepth) == 0);
+		}
+	}
+
+	int arrPopCount[IOLoopMsgClass_Count] = {0};
+	for (int i = 0; i < 11 * 5; i++)
+	{
+		string * psMessage = nullptr;
+		int iMsgClass = 0;
+		EXPECT_TRUE(oQueue.Pop(psMessage, iMsgClass, iDepth, 0));
+		delete psMessage;
+		arrPopCount[iMsgClass]++;
+	}
+
+	EXPECT_TRUE(arrPopCount[IOLoopMsgClass_Consensus] == 40);
+	EXPECT_TRUE(arrPopCount[IOLoopMsgClass_Learn] == 10);
+	EXPECT_TRUE(arrPopCount[IOLoopMsgClass_Checkpoint] == 5);
+}
+
+TEST(IOLoopMsgQueue, ConsensusNotBlockedByCatchup)
+{
+	IOLoopMsgQueue oQueue(10, 1000000);
+	int iDepth = 0;
+	for (int i = 0; i <= 10; i++)
+	{
+		EXPECT_TRUE(oQueue.Add(IOLoopMsgClass_Learn, new string("a"), iDepth) == 0);
+	}
+
+	string sFullMessage("a");
+	EXPECT_TRUE(oQueue.Add(IOLoopMsgClass_Learn, &sFullMessage, iDepth) == -2);
+
+	EXPECT_TRUE(oQueue.Add(IOLoopMsgClass_Consensus, new string("b"), iDepth) == 0);
+
+	string * psMessage = nullptr;
+	int iMsgClass = 0;
+	EXPECT_TRUE(oQueue.Pop(psMessage, iMsgClass, iDepth, 0));
+	EXPECT_TRUE(iMsgClass == IOLoopMsgClass_Consensus);
+	EXPECT_TRUE(*psMessage == "b");
+	delete psMessage;
+}
+
+TEST(IOLoopMsgQueue, ConsensusMemoryBudget)
+{
+	IOLoopMsgQueue oQueue(1000, 100);
+	int iDepth = 0;
+	EXPECT_TRUE(oQueue.Add(IOLoopMsgClass_Learn, new string(101, 'a'), iDepth) == 0);
+	EXPECT_TRUE(oQueue.Add(IOLoopMsgClass_Consensus, new string(101, 'b'), iDepth) == 0);
+
+	//both budgets used up.
+	string sFullMessage("c");
+	EXPECT_TRUE(oQueue.Add(IOLoopMsgClass_Consensus, &sFullMessage, iDepth) == -2);
+	EXPECT_TRUE(oQueue.Add(IOLoopMsgClass_Checkpoint, &sFullMessage, iDepth) == -2);
+
+	string * psMessage = nullptr;
+	int iMsgClass = 0;
+	EXPECT_TRUE(oQueue.Pop(psMessage, iMsgClass, iDepth, 0));
+	EXPECT_TRUE(iMsgClass == IOLoopMsgClass_Consensus);
+	delete psMessage;
+
+	EXPECT_TRUE(oQueue.Add(IOLoopMsgClass_Consensus, new string("d"), iDepth) == 0);
+	EXPECT_TRUE(oQueue.GetMemSize() == 102);
+}
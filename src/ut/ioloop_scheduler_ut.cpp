@@ -0,0 +1,251 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+
+#include "gmock/gmock.h"
+#include "ioloop_scheduler.h"
+#include "utils_include.h"
+#include <atomic>
+#include <thread>
+#include <functional>
+
+using namespace phxpaxos;
+using namespace std;
+
+//count runs and concurrent runs, optionally block or wake itself by timer.
+class TestIOLoopTask : public IOLoopTask
+{
+public:
+	TestIOLoopTask() : m_iPending(0), m_iDone(0), m_iRunCount(0), m_iRunning(0), m_iMaxRunning(0),
+		m_bBlock(false), m_iWakeupMs(0), m_iWakeupRunCount(0) { }
+
+	void Start(IOLoopScheduler * poScheduler)
+	{
+		StartTask(poScheduler);
+	}
+
+	void Stop()
+	{
+		StopTask();
+	}
+
+	void AddWork()
+	{
+		m_iPending++;
+		Schedule();
+	}
+
+	std::atomic<int> m_iPending;
+	std::atomic<int> m_iDone;
+	std::atomic<int> m_iRunCount;
+	std::atomic<int> m_iRunning;
+	std::atomic<int> m_iMaxRunning;
+	std::atomic<bool> m_bBlock;
+	int m_iWakeupMs;
+	int m_iWakeupRunCount;
+
+protected:
+	void DoRunTask()
+	{
+		int iRunning = ++m_iRunning;
+		if (iRunning > m_iMaxRunning)
+		{
+			m_iMaxRunning = iRunning;
+		}
+
+		m_iRunCount++;
+		while (m_bBlock)
+		{
+			Time::MsSleep(1);
+		}
+
+		//stay a while, let other workers try to run it too.
+		Time::MsSleep(1);
+		m_iDone += m_iPending.exchange(0);
+
+		if (m_iWakeupMs > 0 && m_iRunCount < m_iWakeupRunCount)
+		{
+			AddWakeup(m_iWakeupMs);
+		}
+
+		m_iRunning--;
+	}
+
+	bool HasReadyWork()
+	{
+		return m_iPending > 0;
+	}
+};
+
+static bool WaitUntil(std::function<bool()> Check, const int iTimeoutMs)
+{
+	uint64_t llEndTime = Time::GetSteadyClockMS() + iTimeoutMs;
+	while (!Check())
+	{
+		if (Time::GetSteadyClockMS() > llEndTime)
+		{
+			return false;
+		}
+		Time::MsSleep(1);
+	}
+	return true;
+}
+
+TEST(IOLoopScheduler, NeverRunOneTaskOnTwoWorkers)
+{
+	IOLoopScheduler oScheduler(4);
+	oScheduler.Start();
+
+	TestIOLoopTask oTask;
+	oTask.Start(&oScheduler);
+
+	std::vector<std::thread *> vecThread;
+	for (int i = 0; i < 4; i++)
+	{
+		vecThread.push_back(new std::thread([&oTask]()
+		{
+			for (int j = 0; j < 200; j++)
+			{
+				oTask.AddWork();
+			}
+		}));
+	}
+
+	for (auto & poThread : vecThread)
+	{
+		poThread->join();
+		delete poThread;
+	}
+
+	EXPECT_TRUE(WaitUntil([&oTask]() { return oTask.m_iDone == 800; }, 5000));
+	EXPECT_TRUE(oTask.m_iMaxRunning == 1);
+
+	oTask.Stop();
+}
+
+TEST(IOLoopScheduler, WakeupOnEnqueue)
+{
+	IOLoopScheduler oScheduler(2);
+	oScheduler.Start();
+
+	TestIOLoopTask oTask;
+	oTask.Start(&oScheduler);
+	EXPECT_TRUE(WaitUntil([&oTask]() { return oTask.m_iRunCount == 1 && oTask.m_iRunning == 0; }, 1000));
+
+	//no timer, only the new work run it again.
+	Time::MsSleep(50);
+	EXPECT_TRUE(oTask.m_iRunCount == 1);
+
+	oTask.AddWork();
+	EXPECT_TRUE(WaitUntil([&oTask]() { return oTask.m_iDone == 1; }, 1000));
+	EXPECT_TRUE(oTask.m_iRunCount == 2);
+
+	oTask.Stop();
+}
+
+TEST(IOLoopScheduler, WakeupOnTimer)
+{
+	IOLoopScheduler oScheduler(2);
+	oScheduler.Start();
+
+	TestIOLoopTask oTask;
+	oTask.m_iWakeupMs = 20;
+	oTask.m_iWakeupRunCount = 3;
+	oTask.Start(&oScheduler);
+
+	EXPECT_TRUE(WaitUntil([&oTask]() { return oTask.m_iRunCount == 3; }, 1000));
+
+	//no more wakeup after the third run.
+	Time::MsSleep(100);
+	EXPECT_TRUE(oTask.m_iRunCount == 3);
+
+	oTask.Stop();
+}
+
+TEST(IOLoopScheduler, StopWhileRunning)
+{
+	IOLoopScheduler oScheduler(1);
+	oScheduler.Start();
+
+	TestIOLoopTask oTask;
+	oTask.m_bBlock = true;
+	oTask.Start(&oScheduler);
+	EXPECT_TRUE(WaitUntil([&oTask]() { return oTask.m_iRunning == 1; }, 1000));
+
+	std::atomic<bool> bStopped(false);
+	std::thread oStopThread([&]()
+	{
+		oTask.Stop();
+		bStopped = true;
+	});
+
+	//stop wait the running task.
+	Time::MsSleep(50);
+	EXPECT_FALSE(bStopped);
+
+	oTask.m_bBlock = false;
+	oStopThread.join();
+	EXPECT_TRUE(bStopped);
+	EXPECT_TRUE(oTask.m_iRunning == 0);
+
+	//stopped task never run again.
+	oTask.AddWork();
+	Time::MsSleep(50);
+	EXPECT_TRUE(oTask.m_iRunCount == 1);
+	EXPECT_TRUE(oTask.m_iDone == 0);
+}
+
+TEST(IOLoopScheduler, StopWhileScheduled)
+{
+	IOLoopScheduler oScheduler(1);
+	oScheduler.Start();
+
+	//the only worker is busy with task A, task B wait in queue.
+	TestIOLoopTask oTaskA;
+	oTaskA.m_bBlock = true;
+	oTaskA.Start(&oScheduler);
+	EXPECT_TRUE(WaitUntil([&oTaskA]() { return oTaskA.m_iRunning == 1; }, 1000));
+
+	TestIOLoopTask oTaskB;
+	oTaskB.Start(&oScheduler);
+
+	std::atomic<bool> bStopped(false);
+	std::thread oStopThread([&]()
+	{
+		oTaskB.Stop();
+		bStopped = true;
+	});
+
+	//stop wait the worker take B out of queue.
+	Time::MsSleep(50);
+	EXPECT_FALSE(bStopped);
+
+	oTaskA.m_bBlock = false;
+	oStopThread.join();
+	EXPECT_TRUE(bStopped);
+
+	//B is taken out of queue without run.
+	EXPECT_TRUE(oTaskB.m_iRunCount == 0);
+
+	oTaskA.Stop();
+}
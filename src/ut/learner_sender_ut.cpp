@@ -0,0 +1,110 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+#include "gmock/gmock.h"
+#include "learner_sender.h"
+#include "comm_include.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+TEST(LearnerSendWindow, AckSlide)
+{
+	LearnerSendWindow oWindow;
+	oWindow.Reset(100, 10000);
+	EXPECT_TRUE(oWindow.GetWindowBytes() == 400);
+
+	oWindow.AddInflight(10, 100, 1000);
+	oWindow.AddInflight(20, 100, 1000);
+	oWindow.AddInflight(30, 100, 1000);
+	EXPECT_TRUE(oWindow.GetInflightBytes() == 300);
+	EXPECT_TRUE(oWindow.CanSend());
+
+	oWindow.AddInflight(40, 100, 1000);
+	EXPECT_FALSE(oWindow.CanSend());
+
+	//ack inside a batch slide nothing.
+	EXPECT_TRUE(oWindow.OnAck(9, 1500) == 0);
+	EXPECT_TRUE(oWindow.GetInflightBytes() == 400);
+
+	EXPECT_TRUE(oWindow.OnAck(25, 1500) == 200);
+	EXPECT_TRUE(oWindow.GetInflightBytes() == 200);
+	EXPECT_TRUE(oWindow.GetMinRttUs() == 500);
+	EXPECT_TRUE(oWindow.GetWindowBytes() == 600);
+	EXPECT_TRUE(oWindow.CanSend());
+}
+
+TEST(LearnerSendWindow, ShrinkOnRttInflate)
+{
+	LearnerSendWindow oWindow;
+	oWindow.Reset(100, 10000);
+
+	oWindow.AddInflight(10, 100, 0);
+	EXPECT_TRUE(oWindow.OnAck(10, 1000) == 100);
+	EXPECT_TRUE(oWindow.GetWindowBytes() == 500);
+
+	//acks delayed far over the base rtt, cut by half.
+	oWindow.AddInflight(20, 100, 10000);
+	oWindow.AddInflight(30, 100, 10000);
+	EXPECT_TRUE(oWindow.OnAck(20, 20000) == 100);
+	EXPECT_TRUE(oWindow.GetWindowBytes() == 250);
+
+	//at most once per rtt.
+	EXPECT_TRUE(oWindow.OnAck(30, 21000) == 100);
+	EXPECT_TRUE(oWindow.GetWindowBytes() == 250);
+
+	//never below one batch.
+	uint64_t llSendTimeUs = 100000;
+	for (int i = 0; i < 10; i++)
+	{
+		oWindow.AddInflight(40 + i, 100, llSendTimeUs);
+		llSendTimeUs += 100000;
+		oWindow.OnAck(40 + i, llSendTimeUs);
+	}
+	EXPECT_TRUE(oWindow.GetWindowBytes() == 100);
+}
+
+TEST(LearnerSendWindow, WindowCap)
+{
+	LearnerSendWindow oWindow;
+	oWindow.Reset(100, 1000);
+
+	for (int i = 0; i < 20; i++)
+	{
+		oWindow.AddInflight(i, 100, 1000);
+		oWindow.OnAck(i, 1500);
+	}
+	EXPECT_TRUE(oWindow.GetWindowBytes() == 1000);
+
+	//max below one batch, still send one batch.
+	oWindow.Reset(100, 50);
+	EXPECT_TRUE(oWindow.GetWindowBytes() == 100);
+	EXPECT_TRUE(oWindow.CanSend());
+}
+
+TEST(LearnerSendWindow, MaxWindowFloor)
+{
+	InsideOptions::Instance()->SetGroupCount(100000);
+	EXPECT_TRUE(LearnerSender_MAX_WINDOW_BYTES >= LearnerSender_BATCH_BYTES * 4);
+	InsideOptions::Instance()->SetGroupCount(1);
+}
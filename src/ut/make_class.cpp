@@ -71,6 +71,9 @@ void MakeCommunicate(MockNetWork * poMockNetWork, Config * poConfig, Communicate
     poCommunicate = nullptr;
     poCommunicate = new Communicate(poConfig, poConfig->GetMyNodeID(), 2048, poMockNetWork);
     assert(poCommunicate != nullptr);
+
+    poConfig->GetSystemVSM()->SetMembershipListener(poCommunicate);
+    poCommunicate->OnMembershipChange(poConfig->GetSystemVSM()->GetMembershipMap());
 }
 
 void MakeInstance(MockLogStorage * poMockLogStorage, Config * poConfig, Communicate * poCommunicate, Instance *& poInstance)
@@ -95,8 +98,56 @@ void MakeProposer(Config * poConfig, Communicate * poCommunicate, Instance * poI
     assert(poProposer != nullptr);
 }
 
+TestCommitLoop :: TestCommitLoop(CommitCtx * poCommitCtx, SMFac * poSMFac)
+    : m_poCommitCtx(poCommitCtx), m_poSMFac(poSMFac), m_bChosen(true), m_bPause(false), 
+    m_iCommitCount(0), m_iLastTimeoutMs(0), m_llInstanceID(100), m_bIsEnd(false)
+{
+    m_poThread = new std::thread(&TestCommitLoop::Run, this);
 }
 
+TestCommitLoop :: ~TestCommitLoop()
+{
+    m_bIsEnd = true;
+    m_poThread->join();
+    delete m_poThread;
+}
+
+void TestCommitLoop :: Run()
+{
+    while (!m_bIsEnd)
+    {
+        if (m_bPause || !m_poCommitCtx->IsNewCommit())
+        {
+            Time::MsSleep(1);
+            continue;
+        }
+
+        m_iLastTimeoutMs = m_poCommitCtx->GetTimeoutMs();
+        m_iCommitCount++;
+
+        if (!m_bChosen)
+        {
+            m_poCommitCtx->SetResultOnlyRet(PaxosTryCommitRet_Timeout);
+            continue;
+        }
+
+        uint64_t llInstanceID = ++m_llInstanceID;
+        m_poCommitCtx->StartCommit(llInstanceID);
+
+        std::string sValue = m_poCommitCtx->GetCommitValue();
+        SMCtx * poSMCtx = nullptr;
+        if (m_poSMFac != nullptr && m_poCommitCtx->IsMyCommit(llInstanceID, sValue, poSMCtx))
+        {
+            m_poSMFac->Execute(0, llInstanceID, sValue, poSMCtx);
+        }
+
+        m_poCommitCtx->SetResult(0, llInstanceID, sValue);
+    }
+}
+
+}
+
+
 
 
 
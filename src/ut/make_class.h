@@ -27,6 +27,9 @@ See the AUTHORS file for names of contributors.
 #include "acceptor.h"
 #include "proposer.h"
 #include "mock_class.h"
+#include "commitctx.h"
+#include <atomic>
+#include <thread>
 
 namespace phxpaxos
 {
@@ -43,4 +46,25 @@ void MakeAcceptor(MockLogStorage * poMockLogStorage, Config * poConfig, Communic
 
 void MakeProposer(Config * poConfig, Communicate * poCommunicate, Instance * poInstance, Learner * poLearner, IOLoop * poIOLoop, Proposer *& poProposer);
 
+//play ioloop for a committer, every commit is chosen at once and executed by poSMFac if not null,
+//or timeout if m_bChosen is false. No commit finish while m_bPause.
+class TestCommitLoop
+{
+public:
+    TestCommitLoop(CommitCtx * poCommitCtx, SMFac * poSMFac);
+    ~TestCommitLoop();
+
+    void Run();
+
+    CommitCtx * m_poCommitCtx;
+    SMFac * m_poSMFac;
+    std::atomic<bool> m_bChosen;
+    std::atomic<bool> m_bPause;
+    std::atomic<int> m_iCommitCount;
+    std::atomic<int> m_iLastTimeoutMs;
+    std::atomic<uint64_t> m_llInstanceID;
+    std::atomic<bool> m_bIsEnd;
+    std::thread * m_poThread;
+};
+
 }
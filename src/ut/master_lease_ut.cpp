@@ -0,0 +1,671 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+#include "gmock/gmock.h"
+#include "mock_class.h"
+#include "master_sm.h"
+#include "master_sm.pb.h"
+#include "master_coordinator.h"
+#include "master_leaser.h"
+#include "config_include.h"
+#include <map>
+#include <mutex>
+
+using namespace phxpaxos;
+using namespace std;
+using ::testing::_;
+using ::testing::Return;
+using ::testing::DoAll;
+using ::testing::SetArgReferee;
+
+static void LearnTestMaster(MasterStateMachine & oMasterSM, const nodeid_t iMasterNodeID, 
+		const uint64_t llInstanceID, const int iLeaseTimeMs)
+{
+	MasterOperator oMasterOper;
+	oMasterOper.set_nodeid(iMasterNodeID);
+	oMasterOper.set_version((uint64_t)-1);
+	oMasterOper.set_timeout(iLeaseTimeMs);
+	oMasterOper.set_operator_(MasterOperatorType_Complete);
+	oMasterOper.set_sid(0);
+
+	EXPECT_TRUE(oMasterSM.LearnMaster(llInstanceID, oMasterOper) == 0);
+}
+
+TEST(MasterLease, GrantLease)
+{
+	MockLogStorage oLogStorage;
+	EXPECT_CALL(oLogStorage, SetMasterVariables(_, _, _)).WillRepeatedly(Return(0));
+
+	MasterStateMachine oMasterSM(&oLogStorage, 1, 0, nullptr);
+	LearnTestMaster(oMasterSM, 2, 10, 5000);
+
+	EXPECT_TRUE(oMasterSM.GetMaster() == 2);
+	EXPECT_TRUE(oMasterSM.GrantLease(2, 10, 5000));
+	EXPECT_FALSE(oMasterSM.GrantLease(3, 10, 5000));
+	EXPECT_FALSE(oMasterSM.GrantLease(2, 9, 5000));
+
+	EXPECT_TRUE(oMasterSM.IsLeaseHeldByOther(3));
+	EXPECT_FALSE(oMasterSM.IsLeaseHeldByOther(2));
+}
+
+TEST(MasterLease, NoGrantAfterExpire)
+{
+	MockLogStorage oLogStorage;
+	EXPECT_CALL(oLogStorage, SetMasterVariables(_, _, _)).WillRepeatedly(Return(0));
+
+	MasterStateMachine oMasterSM(&oLogStorage, 1, 0, nullptr);
+	LearnTestMaster(oMasterSM, 2, 10, 10);
+	Time::MsSleep(20);
+
+	EXPECT_FALSE(oMasterSM.IsLeaseHeldByOther(3));
+	EXPECT_FALSE(oMasterSM.GrantLease(2, 10, 5000));
+	EXPECT_TRUE(oMasterSM.GetMaster() == nullnode);
+}
+
+TEST(MasterLease, ExtendMyLease)
+{
+	MockLogStorage oLogStorage;
+	EXPECT_CALL(oLogStorage, SetMasterVariables(_, _, _)).WillRepeatedly(Return(0));
+
+	MasterStateMachine oMasterSM(&oLogStorage, 1, 0, nullptr);
+	LearnTestMaster(oMasterSM, 1, 10, 5000);
+
+	EXPECT_TRUE(oMasterSM.ExtendMyLease(10, Time::GetSteadyClockMS() + 5000));
+	EXPECT_TRUE(oMasterSM.IsIMMaster());
+	EXPECT_FALSE(oMasterSM.ExtendMyLease(9, Time::GetSteadyClockMS() + 5000));
+}
+
+static string MakeMasterVariablesBuffer(const nodeid_t iMasterNodeID, const uint64_t llVersion, const int iLeaseTimeMs)
+{
+	MasterVariables oVariables;
+	oVariables.set_masternodeid(iMasterNodeID);
+	oVariables.set_version(llVersion);
+	oVariables.set_leasetime(iLeaseTimeMs);
+	string sBuffer;
+	oVariables.SerializeToString(&sBuffer);
+	return sBuffer;
+}
+
+TEST(MasterLease, NoGrantAfterRestoreUntilLearn)
+{
+	MockLogStorage oLogStorage;
+	EXPECT_CALL(oLogStorage, SetMasterVariables(_, _, _)).WillRepeatedly(Return(0));
+	EXPECT_CALL(oLogStorage, GetMasterVariables(_, _)).WillOnce(
+			DoAll(SetArgReferee<1>(MakeMasterVariablesBuffer(2, 10, 5000)), Return(0)));
+
+	//restart, the lease on disk may have been told free to a challenger before.
+	MasterStateMachine oMasterSM(&oLogStorage, 1, 0, nullptr);
+	EXPECT_TRUE(oMasterSM.Init() == 0);
+
+	EXPECT_TRUE(oMasterSM.IsLeaseHeldByOther(3));
+	EXPECT_FALSE(oMasterSM.GrantLease(2, 10, 5000));
+
+	//a master op learned by paxos after restart, grant again.
+	MasterOperator oMasterOper;
+	oMasterOper.set_nodeid(2);
+	oMasterOper.set_version(10);
+	oMasterOper.set_timeout(5000);
+	oMasterOper.set_operator_(MasterOperatorType_Complete);
+	oMasterOper.set_sid(0);
+	EXPECT_TRUE(oMasterSM.LearnMaster(11, oMasterOper) == 0);
+
+	EXPECT_TRUE(oMasterSM.GrantLease(2, 11, 5000));
+}
+
+//////////////////////////////////////////////////////////////////
+
+//deliver messages between leasers of one process synchronously.
+class LoopbackTransport : public MsgTransport
+{
+public:
+	LoopbackTransport() : m_iBroadcastCount(0) { }
+
+	int SendMessage(const int iGroupIdx, const nodeid_t iSendtoNodeID, 
+			const std::string & sBuffer, const int iSendType)
+	{
+		auto it = m_mapLeaser.find(iSendtoNodeID);
+		if (it == end(m_mapLeaser))
+		{
+			return -1;
+		}
+
+		Deliver(it->second, sBuffer);
+		return 0;
+	}
+
+	int BroadcastMessage(const int iGroupIdx, const std::string & sBuffer, const int iSendType)
+	{
+		MasterLeaseMsg oMasterLeaseMsg;
+		Parse(sBuffer, oMasterLeaseMsg);
+
+		m_iBroadcastCount++;
+		for (auto & oGroupItem : oMasterLeaseMsg.groupitems())
+		{
+			m_mapGroupItemCount[oGroupItem.groupidx()]++;
+		}
+
+		for (auto & it : m_mapLeaser)
+		{
+			if (it.first != oMasterLeaseMsg.nodeid())
+			{
+				Deliver(it.second, sBuffer);
+			}
+		}
+		return 0;
+	}
+
+	int BroadcastMessageFollower(const int iGroupIdx, const std::string & sBuffer, const int iSendType) { return 0; }
+
+	int BroadcastMessageTempNode(const int iGroupIdx, const std::string & sBuffer, const int iSendType) { return 0; }
+
+	static void Parse(const std::string & sBuffer, MasterLeaseMsg & oMasterLeaseMsg)
+	{
+		Header oHeader;
+		size_t iBodyStartPos = 0;
+		size_t iBodyLen = 0;
+		EXPECT_TRUE(Base::UnPackBaseMsg(sBuffer, oHeader, iBodyStartPos, iBodyLen) == 0);
+		EXPECT_TRUE(oHeader.cmdid() == MsgCmd_MasterLeaseMsg);
+		EXPECT_TRUE(oMasterLeaseMsg.ParseFromArray(sBuffer.data() + iBodyStartPos, iBodyLen));
+	}
+
+	static void Deliver(MasterLeaser * poLeaser, const std::string & sBuffer)
+	{
+		MasterLeaseMsg oMasterLeaseMsg;
+		Parse(sBuffer, oMasterLeaseMsg);
+		poLeaser->OnMasterLeaseMsg(oMasterLeaseMsg);
+	}
+
+	std::map<nodeid_t, MasterLeaser *> m_mapLeaser;
+	int m_iBroadcastCount;
+	std::map<int, int> m_mapGroupItemCount;
+};
+
+class TestGrantorSet : public MasterLeaseGrantorSet
+{
+public:
+	MasterLeaseGrantor * GetMasterLeaseGrantor(const int iGroupIdx)
+	{
+		return iGroupIdx < (int)m_vecGrantor.size() ? m_vecGrantor[iGroupIdx] : nullptr;
+	}
+
+	std::vector<MasterLeaseGrantor *> m_vecGrantor;
+};
+
+//three members, one group of master sm per node, group 1 of each node as a second group for batch.
+class LeaserBuilder
+{
+public:
+	LeaserBuilder()
+	{
+		EXPECT_CALL(oLogStorage, GetSystemVariables(_, _)).WillRepeatedly(Return(1));
+		EXPECT_CALL(oLogStorage, SetMasterVariables(_, _, _)).WillRepeatedly(Return(0));
+
+		NodeInfoList vecNodeInfoList;
+		for (int i = 0; i < 3; i++)
+		{
+			vecNodeInfoList.push_back(NodeInfo("127.0.0.1", 11111 + i));
+		}
+
+		for (int i = 0; i < 3; i++)
+		{
+			nodeid_t iNodeID = vecNodeInfoList[i].GetNodeID();
+			arrNodeID[i] = iNodeID;
+
+			arrConfig[i] = new Config(&oLogStorage, true, 0, false, vecNodeInfoList[i], vecNodeInfoList, 
+					FollowerNodeInfoList(), 0, 1, nullptr);
+			arrConfig[i]->Init();
+
+			for (int iGroupIdx = 0; iGroupIdx < 2; iGroupIdx++)
+			{
+				arrMasterSM[i][iGroupIdx] = new MasterStateMachine(&oLogStorage, iNodeID, iGroupIdx, nullptr);
+				arrGrantorSet[i].m_vecGrantor.push_back(arrMasterSM[i][iGroupIdx]);
+			}
+
+			arrConfig[i]->SetMasterLeaseGrantor(arrMasterSM[i][0]);
+			arrConfig[i]->SetMasterLeaseGrantorSet(&arrGrantorSet[i]);
+
+			arrLeaser[i] = new MasterLeaser(arrConfig[i], &oTransport, nullptr);
+			oTransport.m_mapLeaser[iNodeID] = arrLeaser[i];
+		}
+	}
+
+	~LeaserBuilder()
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			delete arrLeaser[i];
+			delete arrMasterSM[i][0];
+			delete arrMasterSM[i][1];
+			delete arrConfig[i];
+		}
+	}
+
+	void LearnMasterAll(const int iGroupIdx, const int iMasterIdx, const uint64_t llInstanceID)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			LearnTestMaster(*arrMasterSM[i][iGroupIdx], arrNodeID[iMasterIdx], llInstanceID, 5000);
+		}
+	}
+
+	MockLogStorage oLogStorage;
+	LoopbackTransport oTransport;
+
+	nodeid_t arrNodeID[3];
+	Config * arrConfig[3];
+	MasterStateMachine * arrMasterSM[3][2];
+	TestGrantorSet arrGrantorSet[3];
+	MasterLeaser * arrLeaser[3];
+};
+
+TEST(MasterLease, LeaserRenewAndQuery)
+{
+	LeaserBuilder ob;
+	ob.LearnMasterAll(0, 0, 10);
+
+	EXPECT_TRUE(ob.arrLeaser[0]->RenewLease(ob.arrNodeID[0], 10, 5000, 100) == 0);
+	//wrong version, all refuse.
+	EXPECT_TRUE(ob.arrLeaser[0]->RenewLease(ob.arrNodeID[0], 9, 5000, 100) != 0);
+
+	//node 1 challenge, node 2 still hold node 0's lease.
+	EXPECT_TRUE(ob.arrLeaser[1]->QueryLease(ob.arrNodeID[1], 100) != 0);
+	//master itself ask, nobody else hold.
+	EXPECT_TRUE(ob.arrLeaser[0]->QueryLease(ob.arrNodeID[0], 100) == 0);
+}
+
+TEST(MasterLease, LeaserRenewFailAfterGrantorsRestart)
+{
+	LeaserBuilder ob;
+	ob.LearnMasterAll(0, 0, 10);
+
+	//node 1 and node 2 restart, restore node 0 as master from disk.
+	for (int i = 1; i < 3; i++)
+	{
+		delete ob.arrMasterSM[i][0];
+		ob.arrMasterSM[i][0] = new MasterStateMachine(&ob.oLogStorage, ob.arrNodeID[i], 0, nullptr);
+		EXPECT_CALL(ob.oLogStorage, GetMasterVariables(_, _)).WillOnce(
+				DoAll(SetArgReferee<1>(MakeMasterVariablesBuffer(ob.arrNodeID[0], 10, 5000)), Return(0)));
+		EXPECT_TRUE(ob.arrMasterSM[i][0]->Init() == 0);
+		ob.arrConfig[i]->SetMasterLeaseGrantor(ob.arrMasterSM[i][0]);
+	}
+
+	//no majority grant, master must renew by paxos.
+	EXPECT_TRUE(ob.arrLeaser[0]->RenewLease(ob.arrNodeID[0], 10, 5000, 100) != 0);
+	//but a challenger still see the lease held.
+	EXPECT_TRUE(ob.arrLeaser[1]->QueryLease(ob.arrNodeID[1], 100) != 0);
+}
+
+TEST(MasterLease, LeaserBatch)
+{
+	LeaserBuilder ob;
+	ob.LearnMasterAll(0, 0, 10);
+	ob.LearnMasterAll(1, 2, 20);
+
+	std::vector<MasterLeaseGroup> vecGroup(2);
+	vecGroup[0].iGroupIdx = 0;
+	vecGroup[0].llMasterVersion = 10;
+	vecGroup[0].iLeaseTimeMs = 5000;
+	vecGroup[1].iGroupIdx = 1;
+	vecGroup[1].llMasterVersion = 20;
+	vecGroup[1].iLeaseTimeMs = 5000;
+
+	//node 0 is master of group 0 only.
+	ob.arrLeaser[0]->RenewLeaseBatch(ob.arrNodeID[0], vecGroup, 100);
+	EXPECT_TRUE(vecGroup[0].bIsSucc);
+	EXPECT_FALSE(vecGroup[1].bIsSucc);
+
+	//node 1 ask both, both held by others.
+	ob.arrLeaser[1]->QueryLeaseBatch(ob.arrNodeID[1], vecGroup, 100);
+	EXPECT_FALSE(vecGroup[0].bIsSucc);
+	EXPECT_FALSE(vecGroup[1].bIsSucc);
+
+	//node 2 ask both, group 0 held by node 0, group 1 is its own.
+	ob.arrLeaser[2]->QueryLeaseBatch(ob.arrNodeID[2], vecGroup, 100);
+	EXPECT_FALSE(vecGroup[0].bIsSucc);
+	EXPECT_TRUE(vecGroup[1].bIsSucc);
+}
+
+TEST(MasterLease, PreferredMasterEven)
+{
+	NodeInfoList vecNodeInfoList;
+	vecNodeInfoList.push_back(NodeInfo(30));
+	vecNodeInfoList.push_back(NodeInfo(10));
+	vecNodeInfoList.push_back(NodeInfo(20));
+
+	EXPECT_TRUE(MasterCoordinator::GetPreferredMaster(0, vecNodeInfoList) == 10);
+	EXPECT_TRUE(MasterCoordinator::GetPreferredMaster(1, vecNodeInfoList) == 20);
+	EXPECT_TRUE(MasterCoordinator::GetPreferredMaster(2, vecNodeInfoList) == 30);
+	EXPECT_TRUE(MasterCoordinator::GetPreferredMaster(3, vecNodeInfoList) == 10);
+
+	vecNodeInfoList.clear();
+	EXPECT_TRUE(MasterCoordinator::GetPreferredMaster(0, vecNodeInfoList) == nullnode);
+}
+
+//////////////////////////////////////////////////////////////////
+
+//every master proposal is chosen at once and learned by master sm of all nodes.
+class TestMasterPaxosLog
+{
+public:
+	TestMasterPaxosLog() : m_llInstanceID(0)
+	{
+		m_arrProposeCount[0] = 0;
+		m_arrProposeCount[1] = 0;
+	}
+
+	uint64_t Choose(const int iGroupIdx, const nodeid_t iProposerNodeID, const std::string & sValue, SMCtx * poSMCtx)
+	{
+		std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+
+		m_llInstanceID++;
+		m_arrProposeCount[iGroupIdx]++;
+
+		for (auto & it : m_vecMasterSM[iGroupIdx])
+		{
+			it.second->Execute(iGroupIdx, m_llInstanceID, sValue, it.first == iProposerNodeID ? poSMCtx : nullptr);
+		}
+
+		return m_llInstanceID;
+	}
+
+	int GetProposeCount(const int iGroupIdx)
+	{
+		std::lock_guard<std::mutex> oLockGuard(m_oMutex);
+		return m_arrProposeCount[iGroupIdx];
+	}
+
+	std::vector<std::pair<nodeid_t, MasterStateMachine *> > m_vecMasterSM[2];
+
+private:
+	std::mutex m_oMutex;
+	uint64_t m_llInstanceID;
+	int m_arrProposeCount[2];
+};
+
+//only propose, membership and node id are used by master.
+class TestMasterNode : public Node
+{
+public:
+	TestMasterNode(const nodeid_t iMyNodeID, TestMasterPaxosLog * poPaxosLog, const NodeInfoList & vecNodeInfoList)
+		: m_iMyNodeID(iMyNodeID), m_poPaxosLog(poPaxosLog)
+	{
+		m_arrMembership[0] = vecNodeInfoList;
+		m_arrMembership[1] = vecNodeInfoList;
+	}
+
+	int Propose(const int iGroupIdx, const std::string & sValue, uint64_t & llInstanceID)
+	{
+		return Propose(iGroupIdx, sValue, llInstanceID, nullptr);
+	}
+
+	int Propose(const int iGroupIdx, const std::string & sValue, uint64_t & llInstanceID, SMCtx * poSMCtx)
+	{
+		llInstanceID = m_poPaxosLog->Choose(iGroupIdx, m_iMyNodeID, sValue, poSMCtx);
+		return 0;
+	}
+
+	const uint64_t GetNowInstanceID(const int iGroupIdx) { return 0; }
+	const uint64_t GetMinChosenInstanceID(const int iGroupIdx) { return 0; }
+	const nodeid_t GetMyNodeID() const { return m_iMyNodeID; }
+
+	int BatchPropose(const int iGroupIdx, const std::string & sValue, 
+			uint64_t & llInstanceID, uint32_t & iBatchIndex) { return -1; }
+	int BatchPropose(const int iGroupIdx, const std::string & sValue, uint64_t & llInstanceID, 
+			uint32_t & iBatchIndex, SMCtx * poSMCtx) { return -1; }
+	void SetBatchCount(const int iGroupIdx, const int iBatchCount) { }
+	void SetBatchDelayTimeMs(const int iGroupIdx, const int iBatchDelayTimeMs) { }
+
+	void AddStateMachine(StateMachine * poSM) { }
+	void AddStateMachine(const int iGroupIdx, StateMachine * poSM) { }
+	void SetTimeoutMs(const int iTimeoutMs) { }
+	void SetHoldPaxosLogCount(const uint64_t llHoldCount) { }
+	void PauseCheckpointReplayer() { }
+	void ContinueCheckpointReplayer() { }
+	void PausePaxosLogCleaner() { }
+	void ContinuePaxosLogCleaner() { }
+
+	int ShowMembership(const int iGroupIdx, NodeInfoList & vecNodeInfoList)
+	{
+		vecNodeInfoList = m_arrMembership[iGroupIdx];
+		return 0;
+	}
+
+	int AddMember(const int iGroupIdx, const NodeInfo & oNode) { return -1; }
+	int RemoveMember(const int iGroupIdx, const NodeInfo & oNode) { return -1; }
+	int ChangeMember(const int iGroupIdx, const NodeInfo & oFromNode, const NodeInfo & oToNode) { return -1; }
+	int SetChecksumType(const int iGroupIdx, const int iChecksumType) { return -1; }
+
+	const NodeInfo GetMaster(const int iGroupIdx) { return NodeInfo(nullnode); }
+	const NodeInfo GetMasterWithVersion(const int iGroupIdx, uint64_t & llVersion) { return NodeInfo(nullnode); }
+	const bool IsIMMaster(const int iGroupIdx) { return false; }
+	int SetMasterLease(const int iGroupIdx, const int iLeaseTimeMs) { return -1; }
+	int DropMaster(const int iGroupIdx) { return -1; }
+	int RebalanceMaster() { return 0; }
+
+	void SetMaxHoldThreads(const int iGroupIdx, const int iMaxHoldThreads) { }
+	void SetProposeWaitTimeThresholdMS(const int iGroupIdx, const int iWaitTimeThresholdMS) { }
+	void SetLogSync(const int iGroupIdx, const bool bLogSync) { }
+
+	int GetInstanceValue(const int iGroupIdx, const uint64_t llInstanceID, 
+			std::vector<std::pair<std::string, int> > & vecValues) { return -1; }
+	void GetMetricsSnapshot(std::vector<MetricValue> & vecMetricList) { }
+	void DumpMetrics(std::string & sText) { }
+
+	NodeInfoList m_arrMembership[2];
+
+protected:
+	int OnReceiveMessage(const char * pcMessage, const int iMessageLen) { return 0; }
+
+private:
+	nodeid_t m_iMyNodeID;
+	TestMasterPaxosLog * m_poPaxosLog;
+};
+
+//three members with two groups, one coordinator per node, group 0's leaser carry the batch.
+class CoordinatorBuilder
+{
+public:
+	CoordinatorBuilder()
+	{
+		EXPECT_CALL(oLogStorage, GetSystemVariables(_, _)).WillRepeatedly(Return(1));
+		EXPECT_CALL(oLogStorage, GetMasterVariables(_, _)).WillRepeatedly(Return(1));
+		EXPECT_CALL(oLogStorage, SetMasterVariables(_, _, _)).WillRepeatedly(Return(0));
+
+		for (int i = 0; i < 3; i++)
+		{
+			vecNodeInfoList.push_back(NodeInfo("127.0.0.1", 11111 + i));
+		}
+
+		for (int i = 0; i < 3; i++)
+		{
+			nodeid_t iNodeID = vecNodeInfoList[i].GetNodeID();
+			arrNodeID[i] = iNodeID;
+			arrNode[i] = new TestMasterNode(iNodeID, &oPaxosLog, vecNodeInfoList);
+			arrCoordinator[i] = new MasterCoordinator(arrNode[i], MasterDistributionPolicy_Even);
+
+			for (int iGroupIdx = 0; iGroupIdx < 2; iGroupIdx++)
+			{
+				MasterMgr * poMaster = new MasterMgr(arrNode[i], iGroupIdx, &oLogStorage, nullptr);
+				EXPECT_TRUE(poMaster->Init() == 0);
+				poMaster->SetLeaseTime(1000);
+				arrMaster[i][iGroupIdx] = poMaster;
+
+				MasterStateMachine * poMasterSM = poMaster->GetMasterSM();
+				oPaxosLog.m_vecMasterSM[iGroupIdx].push_back(std::make_pair(iNodeID, poMasterSM));
+				arrGrantorSet[i].m_vecGrantor.push_back(poMasterSM);
+
+				arrConfig[i][iGroupIdx] = new Config(&oLogStorage, true, 0, false, vecNodeInfoList[i], vecNodeInfoList, 
+						FollowerNodeInfoList(), iGroupIdx, 2, nullptr);
+				arrConfig[i][iGroupIdx]->Init();
+				arrConfig[i][iGroupIdx]->SetMasterLeaseGrantor(poMasterSM);
+				arrConfig[i][iGroupIdx]->SetMasterLeaseGrantorSet(&arrGrantorSet[i]);
+
+				arrLeaser[i][iGroupIdx] = new MasterLeaser(arrConfig[i][iGroupIdx], &arrTransport[iGroupIdx], nullptr);
+				arrTransport[iGroupIdx].m_mapLeaser[iNodeID] = arrLeaser[i][iGroupIdx];
+
+				poMaster->SetLeaseRenewer(arrLeaser[i][iGroupIdx]);
+				arrCoordinator[i]->AddMaster(poMaster);
+			}
+
+			arrCoordinator[i]->SetLeaseRenewer(arrLeaser[i][0]);
+		}
+	}
+
+	~CoordinatorBuilder()
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			delete arrCoordinator[i];
+			for (int iGroupIdx = 0; iGroupIdx < 2; iGroupIdx++)
+			{
+				delete arrLeaser[i][iGroupIdx];
+				delete arrConfig[i][iGroupIdx];
+				delete arrMaster[i][iGroupIdx];
+			}
+			delete arrNode[i];
+		}
+	}
+
+	void RunOnceAll()
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			arrCoordinator[i]->RunOnce();
+		}
+	}
+
+	nodeid_t GetMaster(const int iNodeIdx, const int iGroupIdx)
+	{
+		return arrMaster[iNodeIdx][iGroupIdx]->GetMasterSM()->GetMaster();
+	}
+
+	MockLogStorage oLogStorage;
+	TestMasterPaxosLog oPaxosLog;
+	LoopbackTransport arrTransport[2];
+	NodeInfoList vecNodeInfoList;
+
+	nodeid_t arrNodeID[3];
+	TestMasterNode * arrNode[3];
+	MasterMgr * arrMaster[3][2];
+	Config * arrConfig[3][2];
+	TestGrantorSet arrGrantorSet[3];
+	MasterLeaser * arrLeaser[3][2];
+	MasterCoordinator * arrCoordinator[3];
+};
+
+TEST(MasterLease, CoordinatorBatchRenewAndQuery)
+{
+	CoordinatorBuilder ob;
+
+	//each preferred node query both groups in one message, then propose itself.
+	ob.RunOnceAll();
+
+	for (int i = 0; i < 3; i++)
+	{
+		EXPECT_TRUE(ob.GetMaster(i, 0) == ob.arrNodeID[0]);
+		EXPECT_TRUE(ob.GetMaster(i, 1) == ob.arrNodeID[1]);
+	}
+	EXPECT_TRUE(ob.oPaxosLog.GetProposeCount(0) == 1);
+	EXPECT_TRUE(ob.oPaxosLog.GetProposeCount(1) == 1);
+	EXPECT_TRUE(ob.arrTransport[0].m_mapGroupItemCount[1] > 0);
+	EXPECT_TRUE(ob.arrTransport[1].m_iBroadcastCount == 0);
+
+	//next round renew by heartbeat, no paxos.
+	ob.RunOnceAll();
+
+	EXPECT_TRUE(ob.arrMaster[0][0]->GetMasterSM()->IsIMMaster());
+	EXPECT_TRUE(ob.arrMaster[1][1]->GetMasterSM()->IsIMMaster());
+	EXPECT_TRUE(ob.oPaxosLog.GetProposeCount(0) == 1);
+	EXPECT_TRUE(ob.oPaxosLog.GetProposeCount(1) == 1);
+}
+
+TEST(MasterLease, CoordinatorNotBatchDifferentMembers)
+{
+	CoordinatorBuilder ob;
+
+	//group 1 has a fourth member, group 0's majority can't grant it.
+	for (int i = 0; i < 3; i++)
+	{
+		ob.arrNode[i]->m_arrMembership[1].push_back(NodeInfo("127.0.0.1", 11114));
+	}
+
+	ob.RunOnceAll();
+
+	EXPECT_TRUE(ob.GetMaster(0, 0) == ob.arrNodeID[0]);
+	EXPECT_TRUE(ob.GetMaster(0, 1) == ob.arrNodeID[1]);
+	EXPECT_TRUE(ob.arrTransport[0].m_mapGroupItemCount[1] == 0);
+	EXPECT_TRUE(ob.arrTransport[1].m_iBroadcastCount > 0);
+}
+
+TEST(MasterLease, CoordinatorHoldOffAfterDrop)
+{
+	CoordinatorBuilder ob;
+	ob.RunOnceAll();
+	EXPECT_TRUE(ob.GetMaster(0, 0) == ob.arrNodeID[0]);
+
+	//stop renew for double lease time.
+	uint64_t llDropTime = Time::GetSteadyClockMS();
+	ob.arrMaster[0][0]->DropMaster();
+	ob.arrCoordinator[0]->RunOnce();
+
+	//node 1 keep its group 1, and wait a lease time before take the free group 0.
+	while (Time::GetSteadyClockMS() < llDropTime + 1300)
+	{
+		ob.arrCoordinator[1]->RunOnce();
+		Time::MsSleep(100);
+	}
+
+	EXPECT_TRUE(ob.GetMaster(0, 0) == nullnode);
+	ob.arrCoordinator[0]->RunOnce();
+	EXPECT_TRUE(ob.GetMaster(0, 0) == nullnode);
+	EXPECT_TRUE(ob.oPaxosLog.GetProposeCount(0) == 1);
+
+	//hold off end, the preferred node take it back.
+	while (Time::GetSteadyClockMS() < llDropTime + 2100)
+	{
+		Time::MsSleep(50);
+	}
+	ob.arrCoordinator[0]->RunOnce();
+
+	EXPECT_TRUE(ob.GetMaster(0, 0) == ob.arrNodeID[0]);
+	EXPECT_TRUE(ob.oPaxosLog.GetProposeCount(0) == 2);
+	EXPECT_TRUE(ob.GetMaster(0, 1) == ob.arrNodeID[1]);
+}
+
+TEST(MasterLease, CoordinatorRebalance)
+{
+	CoordinatorBuilder ob;
+	ob.RunOnceAll();
+
+	//node 2 take group 1, which prefer node 1.
+	nodeid_t iMasterNodeID = nullnode;
+	uint64_t llMasterVersion = 0;
+	ob.arrMaster[2][1]->GetMasterSM()->SafeGetMaster(iMasterNodeID, llMasterVersion);
+	ob.arrMaster[2][1]->ProposeMaster(1000, llMasterVersion);
+	EXPECT_TRUE(ob.GetMaster(0, 1) == ob.arrNodeID[2]);
+
+	EXPECT_TRUE(ob.arrCoordinator[0]->Rebalance() == 0);
+	EXPECT_TRUE(ob.arrCoordinator[1]->Rebalance() == 0);
+	EXPECT_TRUE(ob.arrCoordinator[2]->Rebalance() == 1);
+	EXPECT_TRUE(ob.arrMaster[2][1]->ConsumeDropMaster());
+}
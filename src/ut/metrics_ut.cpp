@@ -0,0 +1,101 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+#include "metrics.h"
+#include "gmock/gmock.h"
+#include <thread>
+
+using namespace phxpaxos;
+using namespace std;
+
+TEST(Metrics, CountAndSnapshot)
+{
+	MetricsRegistry oMetrics;
+	int iCounterID = oMetrics.RegisterCounter("ut_event_total", "ut event");
+	EXPECT_TRUE(iCounterID == oMetrics.RegisterCounter("ut_event_total", "ut event"));
+
+	int iHistogramID = oMetrics.RegisterHistogram("ut_event_use_time_ms", "ut event use time");
+	int iGaugeID = oMetrics.RegisterGauge("ut_event_depth", "ut event depth");
+
+	vector<thread> vecThread;
+	for (int i = 0; i < 16; i++)
+	{
+		vecThread.push_back(thread([&]()
+		{
+			for (int j = 1; j <= 1000; j++)
+			{
+				oMetrics.Count(iCounterID);
+				oMetrics.Record(iHistogramID, j);
+			}
+		}));
+	}
+
+	for (auto & oThread : vecThread)
+	{
+		oThread.join();
+	}
+
+	oMetrics.SetGauge(iGaugeID, 7);
+
+	vector<MetricValue> vecMetricList;
+	oMetrics.GetSnapshot(vecMetricList);
+	ASSERT_TRUE(vecMetricList.size() == 3);
+
+	EXPECT_TRUE(vecMetricList[0].m_iType == MetricType_Counter);
+	EXPECT_TRUE(vecMetricList[0].m_llValue == 16000);
+	EXPECT_TRUE(vecMetricList[1].m_iType == MetricType_Gauge);
+	EXPECT_TRUE(vecMetricList[1].m_llValue == 7);
+	EXPECT_TRUE(vecMetricList[2].m_iType == MetricType_Histogram);
+	EXPECT_TRUE(vecMetricList[2].m_llValue == 16000);
+	EXPECT_TRUE(vecMetricList[2].m_llMax == 1000);
+	EXPECT_TRUE(vecMetricList[2].m_llSum == 16 * 500500);
+
+	string sText;
+	oMetrics.DumpText(sText);
+	EXPECT_TRUE(sText.find("ut_event_total 16000\n") != string::npos);
+	EXPECT_TRUE(sText.find("ut_event_use_time_ms_count 16000\n") != string::npos);
+}
+
+TEST(Metrics, MaxGaugeOfGroups)
+{
+	MetricsRegistry oMetrics;
+	int iGaugeID = oMetrics.RegisterGauge("ut_stage_p99_us", "ut stage p99");
+
+	//three groups report in one window, a low one won't hide the high one.
+	oMetrics.MaxGauge(iGaugeID, 500);
+	oMetrics.MaxGauge(iGaugeID, 900);
+	oMetrics.MaxGauge(iGaugeID, 100);
+
+	vector<MetricValue> vecMetricList;
+	oMetrics.GetSnapshot(vecMetricList);
+	ASSERT_TRUE(vecMetricList.size() == 1);
+	EXPECT_TRUE(vecMetricList[0].m_llValue == 900);
+
+	//the high group stop report, forgot after two windows.
+	Time::MsSleep(METRICS_GAUGE_MAX_WINDOW_MS * 2 + 10);
+	oMetrics.MaxGauge(iGaugeID, 100);
+
+	vecMetricList.clear();
+	oMetrics.GetSnapshot(vecMetricList);
+	EXPECT_TRUE(vecMetricList[0].m_llValue == 100);
+}
@@ -67,7 +67,7 @@ public:
 class MockLearner : public phxpaxos::Learner
 {
 public:
-    MockLearner() : Learner(nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr) { }
+    MockLearner() : Learner(nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr) { }
     MOCK_METHOD2(ProposerSendSuccess, void(const uint64_t llLearnInstanceID, const uint64_t llProposalID));
 };
 
@@ -98,13 +98,21 @@ public:
     MOCK_METHOD0(AcceptNotPass, void()); 
 };
 
+class MockLogStorageBP : public phxpaxos::LogStorageBP
+{
+public:
+    MOCK_METHOD2(RebuildIndexStart, void(const int iFileID, const int iOffset));
+};
+
 class MockBreakpoint : public phxpaxos::Breakpoint
 {
 public:
     phxpaxos::AcceptorBP * GetAcceptorBP() { return &m_oMockAcceptorBP; }
     phxpaxos::ProposerBP * GetProposerBP() { return &m_oMockProposerBP; }
+    phxpaxos::LogStorageBP * GetLogStorageBP() { return &m_oMockLogStorageBP; }
 
     MockAcceptorBP m_oMockAcceptorBP;
     MockProposerBP m_oMockProposerBP;
+    MockLogStorageBP m_oMockLogStorageBP;
 };
 
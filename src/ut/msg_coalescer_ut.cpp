@@ -0,0 +1,217 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+#include <string>
+#include <vector>
+#include "comm_include.h"
+#include "msg_coalescer.h"
+#include "msg_transport.h"
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+static void AppendFrameMessage(string & sFrame, const string & sMessage)
+{
+	uint32_t iLen = (uint32_t)sMessage.size();
+	sFrame.append((char *)&iLen, sizeof(uint32_t));
+	sFrame.append(sMessage);
+}
+
+static string MakeMessage(const int iGroupIdx, const string & sBody)
+{
+	string sMessage((char *)&iGroupIdx, GROUPIDXLEN);
+	sMessage += sBody;
+	return sMessage;
+}
+
+TEST(MsgCoalescer, UnpackFrame)
+{
+	string sFrame;
+	int iFrameGroupIdx = COALESCE_FRAME_GROUPIDX;
+	uint16_t iCount = 2;
+	sFrame.append((char *)&iFrameGroupIdx, GROUPIDXLEN);
+	sFrame.append((char *)&iCount, sizeof(uint16_t));
+
+	string sMessage1 = MakeMessage(0, "group0 message");
+	string sMessage2 = MakeMessage(3, "group3");
+	AppendFrameMessage(sFrame, sMessage1);
+	AppendFrameMessage(sFrame, sMessage2);
+
+	EXPECT_TRUE(MsgCoalescer::IsFrame(sFrame.data(), sFrame.size()));
+	EXPECT_FALSE(MsgCoalescer::IsFrame(sMessage1.data(), sMessage1.size()));
+
+	vector<pair<const char *, int> > vecMessage;
+	int ret = MsgCoalescer::UnpackFrame(sFrame.data(), sFrame.size(), vecMessage);
+	EXPECT_TRUE(ret == 0);
+	ASSERT_TRUE(vecMessage.size() == 2);
+	EXPECT_TRUE(string(vecMessage[0].first, vecMessage[0].second) == sMessage1);
+	EXPECT_TRUE(string(vecMessage[1].first, vecMessage[1].second) == sMessage2);
+
+	//truncated frame.
+	vecMessage.clear();
+	ret = MsgCoalescer::UnpackFrame(sFrame.data(), sFrame.size() - 1, vecMessage);
+	EXPECT_TRUE(ret != 0);
+
+	//trailing garbage.
+	vecMessage.clear();
+	sFrame.push_back('x');
+	ret = MsgCoalescer::UnpackFrame(sFrame.data(), sFrame.size(), vecMessage);
+	EXPECT_TRUE(ret != 0);
+}
+
+//record frames instead of send them.
+class TestMsgCoalescer : public MsgCoalescer
+{
+public:
+	TestMsgCoalescer() : MsgCoalescer(nullptr) { }
+
+	vector<string> GetSent()
+	{
+		std::lock_guard<std::mutex> oLock(m_oSentMutex);
+		return m_vecSent;
+	}
+
+	bool WaitSent(const size_t iCount, const int iTimeoutMs)
+	{
+		for (int i = 0; i < iTimeoutMs; i++)
+		{
+			if (GetSent().size() >= iCount)
+			{
+				return true;
+			}
+			Time::MsSleep(1);
+		}
+		return GetSent().size() >= iCount;
+	}
+
+protected:
+	int SendFrame(const int iLane, const std::string & sIP, const int iPort, 
+			const std::string & sMessage, const int iSendType)
+	{
+		std::lock_guard<std::mutex> oLock(m_oSentMutex);
+		m_vecSent.push_back(sMessage);
+		return 0;
+	}
+
+private:
+	std::mutex m_oSentMutex;
+	vector<string> m_vecSent;
+};
+
+static vector<string> UnpackTestFrame(const string & sFrame)
+{
+	vector<string> vecMessage;
+	vector<pair<const char *, int> > vecMessagePos;
+	if (MsgCoalescer::UnpackFrame(sFrame.data(), sFrame.size(), vecMessagePos) == 0)
+	{
+		for (auto & oPos : vecMessagePos)
+		{
+			vecMessage.push_back(string(oPos.first, oPos.second));
+		}
+	}
+	return vecMessage;
+}
+
+TEST(MsgCoalescer, SingleMessageNotFramed)
+{
+	TestMsgCoalescer oCoalescer;
+	EXPECT_TRUE(oCoalescer.Init(1000, 1400, 1) == 0);
+	oCoalescer.start();
+
+	string sMessage = MakeMessage(0, "single");
+	EXPECT_TRUE(oCoalescer.AddMessage(0, "127.0.0.1", 11111, sMessage, Message_SendType_UDP) == 0);
+
+	EXPECT_TRUE(oCoalescer.WaitSent(1, 1000));
+	vector<string> vecSent = oCoalescer.GetSent();
+	ASSERT_TRUE(vecSent.size() == 1);
+	EXPECT_TRUE(vecSent[0] == sMessage);
+	EXPECT_FALSE(MsgCoalescer::IsFrame(vecSent[0].data(), vecSent[0].size()));
+
+	oCoalescer.Stop();
+}
+
+TEST(MsgCoalescer, DelayFlush)
+{
+	TestMsgCoalescer oCoalescer;
+	EXPECT_TRUE(oCoalescer.Init(50000, 1400, 1) == 0);
+	oCoalescer.start();
+
+	vector<string> vecMessage;
+	for (int i = 0; i < 3; i++)
+	{
+		vecMessage.push_back(MakeMessage(i, "message" + to_string(i)));
+		EXPECT_TRUE(oCoalescer.AddMessage(i, "127.0.0.1", 11111, vecMessage[i], Message_SendType_UDP) == 0);
+	}
+
+	//wait the delay.
+	EXPECT_TRUE(oCoalescer.GetSent().size() == 0);
+
+	EXPECT_TRUE(oCoalescer.WaitSent(1, 1000));
+	vector<string> vecSent = oCoalescer.GetSent();
+	ASSERT_TRUE(vecSent.size() == 1);
+	EXPECT_TRUE(UnpackTestFrame(vecSent[0]) == vecMessage);
+
+	oCoalescer.Stop();
+}
+
+TEST(MsgCoalescer, SizeFlush)
+{
+	//not started, only a full frame is sent by the adder.
+	TestMsgCoalescer oCoalescer;
+	EXPECT_TRUE(oCoalescer.Init(1000000, 200, 1) == 0);
+
+	vector<string> vecMessage;
+	for (int i = 0; i < 4; i++)
+	{
+		vecMessage.push_back(MakeMessage(0, string(56, 'a' + i)));
+		EXPECT_TRUE(oCoalescer.AddMessage(0, "127.0.0.1", 11111, vecMessage[i], Message_SendType_UDP) == 0);
+	}
+
+	vector<string> vecSent = oCoalescer.GetSent();
+	ASSERT_TRUE(vecSent.size() == 1);
+	EXPECT_TRUE(UnpackTestFrame(vecSent[0]) == vector<string>(vecMessage.begin(), vecMessage.begin() + 3));
+}
+
+TEST(MsgCoalescer, LargeMessageKeepOrder)
+{
+	TestMsgCoalescer oCoalescer;
+	EXPECT_TRUE(oCoalescer.Init(1000000, 200, 1) == 0);
+
+	string sMessage1 = MakeMessage(0, "small1");
+	string sMessage2 = MakeMessage(0, "small2");
+	string sLargeMessage = MakeMessage(0, string(300, 'l'));
+	EXPECT_TRUE(oCoalescer.AddMessage(0, "127.0.0.1", 11111, sMessage1, Message_SendType_UDP) == 0);
+	EXPECT_TRUE(oCoalescer.AddMessage(0, "127.0.0.1", 11111, sMessage2, Message_SendType_UDP) == 0);
+
+	//other peer not flushed.
+	string sOtherMessage = MakeMessage(0, "other");
+	EXPECT_TRUE(oCoalescer.AddMessage(0, "127.0.0.1", 22222, sOtherMessage, Message_SendType_UDP) == 0);
+
+	EXPECT_TRUE(oCoalescer.AddMessage(0, "127.0.0.1", 11111, sLargeMessage, Message_SendType_UDP) == 0);
+
+	vector<string> vecSent = oCoalescer.GetSent();
+	ASSERT_TRUE(vecSent.size() == 2);
+	EXPECT_TRUE(UnpackTestFrame(vecSent[0]) == vector<string>({sMessage1, sMessage2}));
+	EXPECT_TRUE(vecSent[1] == sLargeMessage);
+}
@@ -0,0 +1,227 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+
+#include "gmock/gmock.h"
+#include "mock_class.h"
+#include "make_class.h"
+#include "propose_forwarder.h"
+#include "committer.h"
+#include "value_chunk_mgr.h"
+#include "config_include.h"
+#include <map>
+
+using namespace phxpaxos;
+using namespace std;
+using ::testing::_;
+using ::testing::Return;
+
+class ForwardTransport : public MsgTransport
+{
+public:
+	ForwardTransport() : m_bDrop(false) { }
+
+	int SendMessage(const int iGroupIdx, const nodeid_t iSendtoNodeID, 
+			const std::string & sBuffer, const int iSendType)
+	{
+		auto it = m_mapForwarder.find(iSendtoNodeID);
+		if (it == end(m_mapForwarder))
+		{
+			return -1;
+		}
+
+		if (m_bDrop)
+		{
+			return 0;
+		}
+
+		Header oHeader;
+		size_t iBodyStartPos = 0;
+		size_t iBodyLen = 0;
+		EXPECT_TRUE(Base::UnPackBaseMsg(sBuffer, oHeader, iBodyStartPos, iBodyLen) == 0);
+		EXPECT_TRUE(oHeader.cmdid() == MsgCmd_ForwardMsg);
+
+		ForwardMsg oForwardMsg;
+		EXPECT_TRUE(oForwardMsg.ParseFromArray(sBuffer.data() + iBodyStartPos, iBodyLen));
+		it->second->OnForwardMsg(oForwardMsg);
+		return 0;
+	}
+
+	int BroadcastMessage(const int iGroupIdx, const std::string & sBuffer, const int iSendType) { return 0; }
+
+	int BroadcastMessageFollower(const int iGroupIdx, const std::string & sBuffer, const int iSendType) { return 0; }
+
+	int BroadcastMessageTempNode(const int iGroupIdx, const std::string & sBuffer, const int iSendType) { return 0; }
+
+	std::map<nodeid_t, ProposeForwarder *> m_mapForwarder;
+	std::atomic<bool> m_bDrop;
+};
+
+class TestMasterInfo : public MasterInfo
+{
+public:
+	TestMasterInfo() : m_bIsIMMaster(false) { }
+
+	const bool IsIMMaster() const { return m_bIsIMMaster; }
+
+	std::atomic<bool> m_bIsIMMaster;
+};
+
+class ForwardNode
+{
+public:
+	ForwardNode(MockLogStorage * poLogStorage, const NodeInfo & oMyNode, const NodeInfoList & vecNodeInfoList, 
+			ForwardTransport * poTransport)
+		: oConfig(poLogStorage, true, 0, false, oMyNode, vecNodeInfoList, FollowerNodeInfoList(), 0, 1, nullptr),
+		oCommitCtx(&oConfig), oSMFac(0), oValueChunkMgr(&oConfig, poTransport, nullptr, nullptr, 0),
+		oCommitter(&oConfig, &oCommitCtx, &oIOLoop, &oSMFac, &oValueChunkMgr, false),
+		oForwarder(&oConfig, poTransport, nullptr, &oCommitter), oCommitLoop(&oCommitCtx, nullptr)
+	{
+		oConfig.Init();
+		oConfig.SetMasterInfo(&oMasterInfo);
+		oCommitter.SetTimeoutMs(300);
+	}
+
+	Config oConfig;
+	TestMasterInfo oMasterInfo;
+	CommitCtx oCommitCtx;
+	MockIOLoop oIOLoop;
+	SMFac oSMFac;
+	ValueChunkMgr oValueChunkMgr;
+	Committer oCommitter;
+	ProposeForwarder oForwarder;
+	TestCommitLoop oCommitLoop;
+};
+
+//node 0 forward to node 1.
+class ForwardBuilder
+{
+public:
+	ForwardBuilder()
+	{
+		EXPECT_CALL(oLogStorage, GetSystemVariables(_, _)).WillRepeatedly(Return(1));
+
+		NodeInfoList vecNodeInfoList;
+		for (int i = 0; i < 2; i++)
+		{
+			vecNodeInfoList.push_back(NodeInfo("127.0.0.1", 11111 + i));
+		}
+
+		for (int i = 0; i < 2; i++)
+		{
+			arrNodeID[i] = vecNodeInfoList[i].GetNodeID();
+			arrNode[i] = new ForwardNode(&oLogStorage, vecNodeInfoList[i], vecNodeInfoList, &oTransport);
+			oTransport.m_mapForwarder[arrNodeID[i]] = &arrNode[i]->oForwarder;
+		}
+
+		arrNode[1]->oMasterInfo.m_bIsIMMaster = true;
+	}
+
+	~ForwardBuilder()
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			arrNode[i]->oForwarder.Stop();
+		}
+
+		for (int i = 0; i < 2; i++)
+		{
+			delete arrNode[i];
+		}
+	}
+
+	MockLogStorage oLogStorage;
+	ForwardTransport oTransport;
+
+	nodeid_t arrNodeID[2];
+	ForwardNode * arrNode[2];
+};
+
+TEST(ProposeForwarder, ForwardAndReply)
+{
+	ForwardBuilder ob;
+
+	uint64_t llInstanceID = 0;
+	EXPECT_TRUE(ob.arrNode[0]->oForwarder.NewValueGetID(ob.arrNodeID[1], "hello paxos", llInstanceID, nullptr) == 0);
+	EXPECT_TRUE(llInstanceID == ob.arrNode[1]->oCommitLoop.m_llInstanceID);
+
+	//committed on master only.
+	EXPECT_TRUE(ob.arrNode[1]->oCommitLoop.m_iCommitCount == 1);
+	EXPECT_TRUE(ob.arrNode[0]->oCommitLoop.m_iCommitCount == 0);
+	//worker never commit without timeout, so Stop can join it.
+	EXPECT_TRUE(ob.arrNode[1]->oCommitLoop.m_iLastTimeoutMs > 0);
+}
+
+TEST(ProposeForwarder, ReplyNotMaster)
+{
+	ForwardBuilder ob;
+	ob.arrNode[1]->oMasterInfo.m_bIsIMMaster = false;
+
+	uint64_t llInstanceID = 0;
+	EXPECT_TRUE(ob.arrNode[0]->oForwarder.NewValueGetID(ob.arrNodeID[1], "hello paxos", llInstanceID, nullptr) 
+			== PaxosTryCommitRet_Not_Master);
+	EXPECT_TRUE(ob.arrNode[1]->oCommitLoop.m_iCommitCount == 0);
+
+	//stopped master tell sender to find another one.
+	ob.arrNode[1]->oMasterInfo.m_bIsIMMaster = true;
+	ob.arrNode[1]->oForwarder.Stop();
+	EXPECT_TRUE(ob.arrNode[0]->oForwarder.NewValueGetID(ob.arrNodeID[1], "hello paxos", llInstanceID, nullptr) 
+			== PaxosTryCommitRet_Not_Master);
+	EXPECT_TRUE(ob.arrNode[1]->oCommitLoop.m_iCommitCount == 0);
+}
+
+TEST(ProposeForwarder, Timeout)
+{
+	ForwardBuilder ob;
+	ob.oTransport.m_bDrop = true;
+
+	uint64_t llBeginTimeMs = Time::GetSteadyClockMS();
+	uint64_t llInstanceID = 0;
+	EXPECT_TRUE(ob.arrNode[0]->oForwarder.NewValueGetID(ob.arrNodeID[1], "hello paxos", llInstanceID, nullptr) 
+			== PaxosTryCommitRet_Timeout);
+	EXPECT_TRUE(Time::GetSteadyClockMS() - llBeginTimeMs >= 300);
+}
+
+TEST(ProposeForwarder, WorkerCommitTimeout)
+{
+	ForwardBuilder ob;
+	ob.arrNode[1]->oCommitLoop.m_bChosen = false;
+
+	uint64_t llInstanceID = 0;
+	EXPECT_TRUE(ob.arrNode[0]->oForwarder.NewValueGetID(ob.arrNodeID[1], "hello paxos", llInstanceID, nullptr) 
+			== PaxosTryCommitRet_Timeout);
+	EXPECT_TRUE(ob.arrNode[1]->oCommitLoop.m_iCommitCount == 1);
+	EXPECT_TRUE(ob.arrNode[1]->oCommitLoop.m_iLastTimeoutMs > 0);
+}
+
+TEST(ProposeForwarder, FallbackWhenSendFail)
+{
+	ForwardBuilder ob;
+
+	//unknown master, propose by myself.
+	uint64_t llInstanceID = 0;
+	EXPECT_TRUE(ob.arrNode[0]->oForwarder.NewValueGetID(12345, "hello paxos", llInstanceID, nullptr) == 0);
+	EXPECT_TRUE(llInstanceID == ob.arrNode[0]->oCommitLoop.m_llInstanceID);
+	EXPECT_TRUE(ob.arrNode[0]->oCommitLoop.m_iCommitCount == 1);
+	EXPECT_TRUE(ob.arrNode[1]->oCommitLoop.m_iCommitCount == 0);
+}
@@ -299,3 +299,29 @@ TEST(Proposer, OnAcceptReply_Pass)
 }
 
 
+
+TEST(Proposer, ConflictBackoff)
+{
+    ProposerBuilder ob;
+
+    EXPECT_TRUE(ob.poProposer->GetBackoffTimeMs() < PROPOSER_BACKOFF_MIN_MS + PROPOSER_BACKOFF_RANGE_MS);
+
+    //same proposal reject many times only count once.
+    ob.poProposer->OnReject(101);
+    ob.poProposer->OnReject(101);
+    EXPECT_TRUE(ob.poProposer->m_iConflictCount == 1);
+
+    for (uint64_t llProposalID = 102; llProposalID < 120; llProposalID++)
+    {
+        ob.poProposer->OnReject(llProposalID);
+    }
+
+    EXPECT_TRUE(ob.poProposer->m_iConflictCount == PROPOSER_BACKOFF_MAX_SHIFT + 1);
+    EXPECT_TRUE(ob.poProposer->GetBackoffTimeMs() < 
+            PROPOSER_BACKOFF_MIN_MS + (PROPOSER_BACKOFF_RANGE_MS << PROPOSER_BACKOFF_MAX_SHIFT));
+    EXPECT_TRUE(ob.poProposer->m_oProposerState.m_llHighestOtherProposalID == 119);
+
+    ob.poProposer->InitForNewPaxosInstance();
+    EXPECT_TRUE(ob.poProposer->m_iConflictCount == 0);
+    EXPECT_TRUE(ob.poProposer->GetBackoffTimeMs() < PROPOSER_BACKOFF_MIN_MS + PROPOSER_BACKOFF_RANGE_MS);
+}
@@ -0,0 +1,155 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+#include "gmock/gmock.h"
+#include "shm_ring.h"
+#include <unistd.h>
+
+using namespace phxpaxos;
+using namespace std;
+
+static string GetTestRingName()
+{
+	return "/phxpaxos_ut_ring_" + to_string(getpid());
+}
+
+static string PopOne(ShmRing & oRing)
+{
+	const char * pcData = nullptr;
+	int iLen = 0;
+	if (!oRing.Wait(10) || !oRing.Front(pcData, iLen))
+	{
+		return "";
+	}
+
+	string sData(pcData, iLen);
+	oRing.Pop();
+	return sData;
+}
+
+TEST(ShmRing, PushAndPop)
+{
+	ShmRing oConsumer;
+	EXPECT_TRUE(oConsumer.Create(GetTestRingName(), 256) == 0);
+
+	ShmRing oProducer;
+	EXPECT_TRUE(oProducer.Attach(GetTestRingName()) == 0);
+
+	EXPECT_TRUE(oProducer.Push("hello", 5) == 0);
+	EXPECT_TRUE(oProducer.Push("paxos", 5) == 0);
+
+	EXPECT_TRUE(PopOne(oConsumer) == "hello");
+	EXPECT_TRUE(PopOne(oConsumer) == "paxos");
+	oConsumer.Commit();
+
+	EXPECT_FALSE(oConsumer.Wait(10));
+
+	oConsumer.Close();
+}
+
+TEST(ShmRing, WrapWithPadRecord)
+{
+	ShmRing oConsumer;
+	EXPECT_TRUE(oConsumer.Create(GetTestRingName(), 256) == 0);
+
+	ShmRing oProducer;
+	EXPECT_TRUE(oProducer.Attach(GetTestRingName()) == 0);
+
+	string sA(100, 'a');
+	string sB(100, 'b');
+	string sC(100, 'c');
+
+	EXPECT_TRUE(oProducer.Push(sA.data(), (int)sA.size()) == 0);
+	EXPECT_TRUE(oProducer.Push(sB.data(), (int)sB.size()) == 0);
+	EXPECT_TRUE(PopOne(oConsumer) == sA);
+	EXPECT_TRUE(PopOne(oConsumer) == sB);
+	oConsumer.Commit();
+
+	//not enough tail space, skipped by a pad record.
+	EXPECT_TRUE(oProducer.Push(sC.data(), (int)sC.size()) == 0);
+	EXPECT_TRUE(PopOne(oConsumer) == sC);
+	oConsumer.Commit();
+
+	oConsumer.Close();
+}
+
+TEST(ShmRing, FullAndTooLarge)
+{
+	ShmRing oConsumer;
+	EXPECT_TRUE(oConsumer.Create(GetTestRingName(), 256) == 0);
+
+	ShmRing oProducer;
+	EXPECT_TRUE(oProducer.Attach(GetTestRingName()) == 0);
+
+	string sData(100, 'a');
+	EXPECT_TRUE(oProducer.Push(sData.data(), (int)sData.size()) == 0);
+	EXPECT_TRUE(oProducer.Push(sData.data(), (int)sData.size()) == 0);
+	EXPECT_TRUE(oProducer.Push(sData.data(), (int)sData.size()) == -2);
+
+	//space is given back only after commit.
+	EXPECT_TRUE(PopOne(oConsumer) == sData);
+	EXPECT_TRUE(oProducer.Push(sData.data(), (int)sData.size()) == -2);
+	oConsumer.Commit();
+	EXPECT_TRUE(oProducer.Push(sData.data(), (int)sData.size()) == 0);
+
+	string sLarge(200, 'l');
+	EXPECT_TRUE(oProducer.Push(sLarge.data(), (int)sLarge.size()) == -1);
+	EXPECT_FALSE(oProducer.IsClosed());
+
+	oConsumer.Close();
+}
+
+TEST(ShmRing, RecreateRetireOldRing)
+{
+	ShmRing oOldConsumer;
+	EXPECT_TRUE(oOldConsumer.Create(GetTestRingName(), 256) == 0);
+
+	ShmRing oProducer;
+	EXPECT_TRUE(oProducer.Attach(GetTestRingName()) == 0);
+	EXPECT_TRUE(oProducer.Push("old", 3) == 0);
+
+	//consumer restart without close, like a crash.
+	ShmRing oNewConsumer;
+	EXPECT_TRUE(oNewConsumer.Create(GetTestRingName(), 256) == 0);
+
+	EXPECT_TRUE(oProducer.IsClosed());
+	EXPECT_TRUE(oProducer.Push("lost", 4) == -1);
+
+	//old consumer close must not unlink the new ring.
+	oOldConsumer.Close();
+
+	ShmRing oNewProducer;
+	EXPECT_TRUE(oNewProducer.Attach(GetTestRingName()) == 0);
+	EXPECT_FALSE(oNewProducer.IsClosed());
+	EXPECT_TRUE(oNewProducer.Push("new", 3) == 0);
+	EXPECT_TRUE(PopOne(oNewConsumer) == "new");
+	oNewConsumer.Commit();
+
+	oNewConsumer.Close();
+	EXPECT_TRUE(oNewProducer.IsClosed());
+	EXPECT_TRUE(oNewProducer.Push("closed", 6) == -1);
+
+	ShmRing oLateProducer;
+	EXPECT_TRUE(oLateProducer.Attach(GetTestRingName()) != 0);
+}
+
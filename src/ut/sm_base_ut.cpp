@@ -0,0 +1,178 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+
+#include <string>
+#include <vector>
+#include "sm_base.h"
+#include "paxos_msg.pb.h"
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+class TestCheckpointSM : public StateMachine
+{
+public:
+	TestCheckpointSM(const int iSMID, const uint64_t llFailInstanceID)
+		: m_iSMID(iSMID), m_llFailInstanceID(llFailInstanceID), m_pvecExecuteLog(nullptr) { }
+
+	const int SMID() const { return m_iSMID; }
+
+	bool Execute(const int iGroupIdx, const uint64_t llInstanceID, 
+			const std::string & sPaxosValue, SMCtx * poSMCtx)
+	{
+		return true;
+	}
+
+	bool ExecuteForCheckpoint(const int iGroupIdx, const uint64_t llInstanceID, 
+			const std::string & sPaxosValue)
+	{
+		if (llInstanceID == m_llFailInstanceID)
+		{
+			return false;
+		}
+
+		m_vecValue.push_back(sPaxosValue);
+		if (m_pvecExecuteLog != nullptr)
+		{
+			m_pvecExecuteLog->push_back(sPaxosValue);
+		}
+		return true;
+	}
+
+	int m_iSMID;
+	uint64_t m_llFailInstanceID;
+	vector<string> m_vecValue;
+	//values of all sms in execute order.
+	vector<string> * m_pvecExecuteLog;
+};
+
+TEST(SMFac, ExecuteForCheckpointBatch)
+{
+	SMFac oSMFac(0);
+	TestCheckpointSM oSM1(1, (uint64_t)-1);
+	TestCheckpointSM oSM2(2, (uint64_t)-1);
+	oSMFac.AddSM(&oSM1);
+	oSMFac.AddSM(&oSM2);
+
+	vector<string> vecPaxosValue;
+	for (int i = 0; i < 10; i++)
+	{
+		string sValue = "value" + to_string(i);
+		oSMFac.PackPaxosValue(sValue, i % 2 + 1);
+		vecPaxosValue.push_back(sValue);
+	}
+
+	size_t iExecutedCount = 0;
+	int iPartialValueCount = 0;
+	bool bSucc = oSMFac.ExecuteForCheckpointBatch(0, 100, vecPaxosValue, iExecutedCount, iPartialValueCount);
+	EXPECT_TRUE(bSucc);
+	EXPECT_TRUE(iExecutedCount == 10);
+	EXPECT_TRUE(oSM1.m_vecValue.size() == 5);
+	EXPECT_TRUE(oSM2.m_vecValue.size() == 5);
+	EXPECT_TRUE(oSM1.m_vecValue[1] == "value2");
+}
+
+TEST(SMFac, ExecuteForCheckpointBatchFail)
+{
+	SMFac oSMFac(0);
+	TestCheckpointSM oSM1(1, (uint64_t)-1);
+	TestCheckpointSM oSM2(2, 105);
+	oSMFac.AddSM(&oSM1);
+	oSMFac.AddSM(&oSM2);
+
+	vector<string> vecPaxosValue;
+	for (int i = 0; i < 10; i++)
+	{
+		string sValue = "value" + to_string(i);
+		oSMFac.PackPaxosValue(sValue, i % 2 + 1);
+		vecPaxosValue.push_back(sValue);
+	}
+
+	size_t iExecutedCount = 0;
+	int iPartialValueCount = 0;
+	bool bSucc = oSMFac.ExecuteForCheckpointBatch(0, 100, vecPaxosValue, iExecutedCount, iPartialValueCount);
+	EXPECT_FALSE(bSucc);
+	EXPECT_TRUE(iExecutedCount == 5);
+	EXPECT_TRUE(iPartialValueCount == 0);
+	EXPECT_TRUE(oSM2.m_vecValue.size() == 2);
+	//sm1 not run ahead of the fail instance.
+	EXPECT_TRUE(oSM1.m_vecValue.size() == 3);
+}
+
+TEST(SMFac, ExecuteForCheckpointBatchRetryOnce)
+{
+	SMFac oSMFac(0);
+	TestCheckpointSM oSM1(1, (uint64_t)-1);
+	TestCheckpointSM oSM2(2, 102);
+	vector<string> vecExecuteLog;
+	oSM1.m_pvecExecuteLog = &vecExecuteLog;
+	oSM2.m_pvecExecuteLog = &vecExecuteLog;
+	oSMFac.AddSM(&oSM1);
+	oSMFac.AddSM(&oSM2);
+
+	//instance 102 is batch proposed, sm1 value is before the fail sm2 value.
+	vector<string> vecPaxosValue;
+	for (int i = 0; i < 5; i++)
+	{
+		string sValue;
+		if (i == 2)
+		{
+			BatchPaxosValues oBatchValues;
+			PaxosValue * poValue = oBatchValues.add_values();
+			poValue->set_smid(1);
+			poValue->set_value("value2a");
+			poValue = oBatchValues.add_values();
+			poValue->set_smid(2);
+			poValue->set_value("value2b");
+			oBatchValues.SerializeToString(&sValue);
+			oSMFac.PackPaxosValue(sValue, BATCH_PROPOSE_SMID);
+		}
+		else
+		{
+			sValue = "value" + to_string(i);
+			oSMFac.PackPaxosValue(sValue, i % 2 + 1);
+		}
+		vecPaxosValue.push_back(sValue);
+	}
+
+	size_t iExecutedCount = 0;
+	int iPartialValueCount = 0;
+	bool bSucc = oSMFac.ExecuteForCheckpointBatch(0, 100, vecPaxosValue, iExecutedCount, iPartialValueCount);
+	EXPECT_FALSE(bSucc);
+	EXPECT_TRUE(iExecutedCount == 2);
+	EXPECT_TRUE(iPartialValueCount == 1);
+
+	//retry like replayer, from the fail instance.
+	oSM2.m_llFailInstanceID = (uint64_t)-1;
+	vecPaxosValue.erase(vecPaxosValue.begin(), vecPaxosValue.begin() + iExecutedCount);
+	bSucc = oSMFac.ExecuteForCheckpointBatch(0, 100 + iExecutedCount, vecPaxosValue, iExecutedCount, iPartialValueCount);
+	EXPECT_TRUE(bSucc);
+	EXPECT_TRUE(iExecutedCount == 3);
+	EXPECT_TRUE(iPartialValueCount == 0);
+
+	vector<string> vecExpectLog = {"value0", "value1", "value2a", "value2b", "value3", "value4"};
+	EXPECT_TRUE(vecExecuteLog == vecExpectLog);
+	EXPECT_TRUE(oSM1.m_vecValue.size() == 3);
+	EXPECT_TRUE(oSM2.m_vecValue.size() == 3);
+}
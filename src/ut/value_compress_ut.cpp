@@ -0,0 +1,112 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include <string>
+#include "comm_include.h"
+#include "gmock/gmock.h"
+
+using namespace phxpaxos;
+using namespace std;
+
+TEST(ValueCompressor, CompressAndDecompress)
+{
+	string sValue;
+	for (int i = 0; i < 1000; i++)
+	{
+		sValue += "phxpaxos value " + to_string(i % 10);
+	}
+
+	string sCompressValue;
+	int ret = ValueCompressor::Compress(0, sValue, sCompressValue);
+	EXPECT_TRUE(ret == 0);
+	EXPECT_TRUE(sCompressValue.size() < sValue.size());
+
+	string sDecompressValue;
+	ret = ValueCompressor::Decompress(sCompressValue, 1024 * 1024, sDecompressValue);
+	EXPECT_TRUE(ret == 0);
+	EXPECT_TRUE(sDecompressValue == sValue);
+}
+
+TEST(ValueCompressor, NotCompressible)
+{
+	string sValue;
+	for (int i = 0; i < 100; i++)
+	{
+		sValue.push_back((char)OtherUtils::FastRand());
+	}
+
+	string sCompressValue;
+	int ret = ValueCompressor::Compress(0, sValue, sCompressValue);
+	EXPECT_TRUE(ret == 1);
+}
+
+TEST(ValueCompressor, Dictionary)
+{
+	string sDict = "{\"user\":\"\",\"email\":\"\",\"address\":\"\",\"phone\":\"\"}";
+	uint32_t iDictID = ValueCompressor::RegisterDict(sDict);
+	EXPECT_TRUE(iDictID != 0);
+
+	string sValue = "{\"user\":\"ann\",\"email\":\"a@b.c\",\"address\":\"x\",\"phone\":\"1\"}";
+
+	string sCompressValue;
+	int ret = ValueCompressor::Compress(iDictID, sValue, sCompressValue);
+	EXPECT_TRUE(ret == 0);
+	EXPECT_TRUE(sCompressValue.size() < sValue.size());
+
+	string sDecompressValue;
+	ret = ValueCompressor::Decompress(sCompressValue, 1024 * 1024, sDecompressValue);
+	EXPECT_TRUE(ret == 0);
+	EXPECT_TRUE(sDecompressValue == sValue);
+
+	ret = ValueCompressor::Compress(iDictID + 1, sValue, sCompressValue);
+	EXPECT_TRUE(ret == -1);
+}
+
+TEST(ValueCompressor, BrokenData)
+{
+	string sValue(4096, 'a');
+
+	string sCompressValue;
+	int ret = ValueCompressor::Compress(0, sValue, sCompressValue);
+	EXPECT_TRUE(ret == 0);
+
+	//raw length in header not match.
+	string sBrokenValue = sCompressValue;
+	sBrokenValue[sizeof(uint32_t)] ^= 1;
+
+	string sDecompressValue;
+	ret = ValueCompressor::Decompress(sBrokenValue, 1024 * 1024, sDecompressValue);
+	EXPECT_TRUE(ret == -1);
+
+	ret = ValueCompressor::Decompress(sCompressValue.substr(0, 3), 1024 * 1024, sDecompressValue);
+	EXPECT_TRUE(ret == -1);
+
+	//raw length in header over limit, reject before allocate.
+	ret = ValueCompressor::Decompress(sCompressValue, sValue.size() - 1, sDecompressValue);
+	EXPECT_TRUE(ret == -1);
+
+	sBrokenValue = sCompressValue;
+	uint32_t iHugeRawLen = 0xFFFFFFFF;
+	memcpy(&sBrokenValue[sizeof(uint32_t)], &iHugeRawLen, sizeof(uint32_t));
+	ret = ValueCompressor::Decompress(sBrokenValue, 1024 * 1024, sDecompressValue);
+	EXPECT_TRUE(ret == -1);
+}
@@ -195,3 +195,102 @@ TEST(WaitLock, TooMuchLockWating)
     EXPECT_TRUE(iRejectCount == 4);
 }
 
+
+class FifoLockTester : public Thread
+{
+public:
+	FifoLockTester(WaitLock * poLock, const int iID, std::vector<int> & vecOrder)
+		: m_poLock(poLock), m_iID(iID), m_vecOrder(vecOrder)
+	{
+	}
+
+	~FifoLockTester() { }
+
+	void run()
+	{
+		int iLockUseTimeMs = 0;
+		bool bHasLock = m_poLock->Lock(-1, iLockUseTimeMs);
+		ASSERT_TRUE(bHasLock == true);
+		m_vecOrder.push_back(m_iID);
+		m_poLock->UnLock();
+	}
+
+private:
+	WaitLock * m_poLock;
+	int m_iID;
+	std::vector<int> & m_vecOrder;
+};
+
+TEST(WaitLock, Fifo)
+{
+	WaitLock oLock;
+	int iLockUseTimeMs = 0;
+	EXPECT_TRUE(oLock.Lock(-1, iLockUseTimeMs));
+
+	std::vector<int> vecOrder;
+	std::vector<FifoLockTester *> vecTester;
+	for (int i = 0; i < 5; i++)
+	{
+		auto poTester = new FifoLockTester(&oLock, i, vecOrder);
+		vecTester.push_back(poTester);
+		poTester->start();
+		Time::MsSleep(5);
+	}
+
+	oLock.UnLock();
+
+	for (auto & poTester : vecTester)
+	{
+		poTester->join();
+		delete poTester;
+	}
+
+	EXPECT_TRUE(vecOrder.size() == 5);
+	for (int i = 0; i < (int)vecOrder.size(); i++)
+	{
+		EXPECT_TRUE(vecOrder[i] == i);
+	}
+}
+
+TEST(WaitLock, DeadlineReject)
+{
+	WaitLock oLock;
+	oLock.SetLockWaitTimeThreshold(1000);
+	int iLockUseTimeMs = 0;
+	for (int i = 0; i < 20; i++)
+	{
+		EXPECT_TRUE(oLock.Lock(-1, iLockUseTimeMs));
+		Time::MsSleep(10);
+		oLock.UnLock();
+	}
+
+	EXPECT_TRUE(oLock.Lock(-1, iLockUseTimeMs));
+
+	//lock hold about 10ms each time, can't get it in 5ms.
+	bool bHasLock = oLock.Lock(5, iLockUseTimeMs);
+	EXPECT_FALSE(bHasLock);
+	EXPECT_TRUE(iLockUseTimeMs == 0);
+
+	oLock.UnLock();
+}
+
+TEST(WaitLock, NoDeadlineRejectWithoutThreshold)
+{
+	WaitLock oLock;
+	int iLockUseTimeMs = 0;
+	for (int i = 0; i < 20; i++)
+	{
+		EXPECT_TRUE(oLock.Lock(-1, iLockUseTimeMs));
+		Time::MsSleep(10);
+		oLock.UnLock();
+	}
+
+	EXPECT_TRUE(oLock.Lock(-1, iLockUseTimeMs));
+
+	//not configured, wait until timeout as before.
+	bool bHasLock = oLock.Lock(5, iLockUseTimeMs);
+	EXPECT_FALSE(bHasLock);
+	EXPECT_TRUE(iLockUseTimeMs >= 5);
+
+	oLock.UnLock();
+}
@@ -21,8 +21,14 @@ See the AUTHORS file for names of contributors.
 
 #include <crc32.h>
 #include <stdio.h>
+#include <string.h>
 #include "inttypes.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define CRC32C_HW_SUPPORT
+#endif
+
 static uint32_t crc32_tab[] = {
     0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
     0xe963a535, 0x9e6495a3,    0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
@@ -88,4 +94,82 @@ crc32(uint32_t crc, const uint8_t *buf, int size, int skiplen)
     return crc ^ ~0U;
 }
 
+////////////////////////////////////////////////////////////
+
+static uint32_t crc32c_tab[256];
+
+static bool crc32c_init_tab()
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+        }
+        crc32c_tab[i] = crc;
+    }
+
+    return true;
+}
+
+static uint32_t
+crc32c_sw(uint32_t crc, const uint8_t *buf, size_t size)
+{
+    static bool is_init = crc32c_init_tab();
+    (void)is_init;
 
+    while (size > 0)
+    {
+        crc = crc32c_tab[(crc ^ *buf) & 0xFF] ^ (crc >> 8);
+
+        size--;
+        buf++;
+    }
+
+    return crc;
+}
+
+#ifdef CRC32C_HW_SUPPORT
+__attribute__((target("sse4.2"))) static uint32_t
+crc32c_hw(uint32_t crc, const uint8_t *buf, size_t size)
+{
+    uint64_t crc64 = crc;
+    while (size >= sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        memcpy(&word, buf, sizeof(uint64_t));
+        crc64 = _mm_crc32_u64(crc64, word);
+
+        size -= sizeof(uint64_t);
+        buf += sizeof(uint64_t);
+    }
+
+    crc = (uint32_t)crc64;
+    while (size > 0)
+    {
+        crc = _mm_crc32_u8(crc, *buf);
+
+        size--;
+        buf++;
+    }
+
+    return crc;
+}
+#endif
+
+uint32_t
+crc32c(uint32_t crc, const uint8_t *buf, size_t size)
+{
+    crc = crc ^ ~0U;
+
+#ifdef CRC32C_HW_SUPPORT
+    static bool is_hw = __builtin_cpu_supports("sse4.2");
+    if (is_hw)
+    {
+        return crc32c_hw(crc, buf, size) ^ ~0U;
+    }
+#endif
+
+    return crc32c_sw(crc, buf, size) ^ ~0U;
+}
@@ -23,7 +23,11 @@ See the AUTHORS file for names of contributors.
 #define __CRC32_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 uint32_t crc32(uint32_t crc, const uint8_t *buf, int len, int skiplen = 1);
 
+//crc32c(castagnoli), use sse4.2 crc32 instruction if cpu support.
+uint32_t crc32c(uint32_t crc, const uint8_t *buf, size_t len);
+
 #endif
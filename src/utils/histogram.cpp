@@ -0,0 +1,152 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "histogram.h"
+
+namespace phxpaxos
+{
+
+Histogram :: Histogram()
+{
+    Reset();
+}
+
+Histogram :: ~Histogram()
+{
+}
+
+int Histogram :: GetBucket(const uint64_t llValue)
+{
+    if (llValue < HISTOGRAM_SUB_BUCKET_COUNT)
+    {
+        return (int)llValue;
+    }
+
+    int iShift = 63 - __builtin_clzll(llValue) - HISTOGRAM_SUB_BUCKET_BITS;
+    int iSubBucket = (int)(llValue >> iShift) & (HISTOGRAM_SUB_BUCKET_COUNT - 1);
+    return (iShift + 1) * HISTOGRAM_SUB_BUCKET_COUNT + iSubBucket;
+}
+
+uint64_t Histogram :: GetBucketUpper(const int iBucket)
+{
+    if (iBucket < HISTOGRAM_SUB_BUCKET_COUNT)
+    {
+        return (uint64_t)iBucket;
+    }
+
+    int iShift = iBucket / HISTOGRAM_SUB_BUCKET_COUNT - 1;
+    uint64_t llLower = (uint64_t)(HISTOGRAM_SUB_BUCKET_COUNT + iBucket % HISTOGRAM_SUB_BUCKET_COUNT) << iShift;
+    return llLower + (((uint64_t)1 << iShift) - 1);
+}
+
+void Histogram :: Add(const uint64_t llValue)
+{
+    m_arrBucket[GetBucket(llValue)].fetch_add(1, std::memory_order_relaxed);
+    m_llCount.fetch_add(1, std::memory_order_relaxed);
+    m_llSum.fetch_add(llValue, std::memory_order_relaxed);
+
+    uint64_t llMax = m_llMax.load(std::memory_order_relaxed);
+    while (llValue > llMax 
+            && !m_llMax.compare_exchange_weak(llMax, llValue, std::memory_order_relaxed))
+    {
+    }
+}
+
+void Histogram :: Merge(const Histogram & oHistogram)
+{
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        uint64_t llBucketCount = oHistogram.m_arrBucket[i].load(std::memory_order_relaxed);
+        if (llBucketCount > 0)
+        {
+            m_arrBucket[i].fetch_add(llBucketCount, std::memory_order_relaxed);
+        }
+    }
+
+    m_llCount.fetch_add(oHistogram.GetCount(), std::memory_order_relaxed);
+    m_llSum.fetch_add(oHistogram.GetSum(), std::memory_order_relaxed);
+
+    uint64_t llOtherMax = oHistogram.GetMax();
+    uint64_t llMax = m_llMax.load(std::memory_order_relaxed);
+    while (llOtherMax > llMax 
+            && !m_llMax.compare_exchange_weak(llMax, llOtherMax, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t Histogram :: GetCount() const
+{
+    return m_llCount.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram :: GetSum() const
+{
+    return m_llSum.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram :: GetMax() const
+{
+    return m_llMax.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram :: GetPercentile(const double dPercentile) const
+{
+    uint64_t llCount = GetCount();
+    if (llCount == 0)
+    {
+        return 0;
+    }
+
+    uint64_t llRank = (uint64_t)(dPercentile / 100 * llCount);
+    if (llRank >= llCount)
+    {
+        llRank = llCount - 1;
+    }
+
+    uint64_t llSum = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        llSum += m_arrBucket[i].load(std::memory_order_relaxed);
+        if (llSum > llRank)
+        {
+            uint64_t llUpper = GetBucketUpper(i);
+            uint64_t llMax = GetMax();
+            return llUpper < llMax ? llUpper : llMax;
+        }
+    }
+
+    return GetMax();
+}
+
+void Histogram :: Reset()
+{
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        m_arrBucket[i].store(0, std::memory_order_relaxed);
+    }
+    m_llCount.store(0, std::memory_order_relaxed);
+    m_llSum.store(0, std::memory_order_relaxed);
+    m_llMax.store(0, std::memory_order_relaxed);
+}
+
+}
+
@@ -0,0 +1,73 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+namespace phxpaxos
+{
+
+//Values under 2^HISTOGRAM_SUB_BUCKET_BITS are exact, larger values keep 
+//HISTOGRAM_SUB_BUCKET_BITS significant bits(about 12% precision).
+#define HISTOGRAM_SUB_BUCKET_BITS 3
+#define HISTOGRAM_SUB_BUCKET_COUNT (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKET_COUNT ((64 - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKET_COUNT)
+
+//Lock free HDR(log linear) histogram for latency.
+//Add can be called by any thread at the same time.
+class Histogram
+{
+public:
+    Histogram();
+    ~Histogram();
+
+    void Add(const uint64_t llValue);
+
+    //Add all values of another histogram.
+    void Merge(const Histogram & oHistogram);
+
+    uint64_t GetCount() const;
+
+    uint64_t GetSum() const;
+
+    uint64_t GetMax() const;
+
+    //Return the upper bound of the bucket which dPercentile(0~100) of values fall under.
+    uint64_t GetPercentile(const double dPercentile) const;
+
+    void Reset();
+
+private:
+    static int GetBucket(const uint64_t llValue);
+
+    static uint64_t GetBucketUpper(const int iBucket);
+
+private:
+    std::atomic<uint64_t> m_arrBucket[HISTOGRAM_BUCKET_COUNT];
+    std::atomic<uint64_t> m_llCount;
+    std::atomic<uint64_t> m_llSum;
+    std::atomic<uint64_t> m_llMax;
+};
+    
+}
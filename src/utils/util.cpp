@@ -47,6 +47,13 @@ const uint64_t Time :: GetSteadyClockMS()
     return now;
 }
 
+const uint64_t Time :: GetSteadyClockUS() 
+{
+    auto now_time = chrono::steady_clock::now();
+    uint64_t now = (chrono::duration_cast<chrono::microseconds>(now_time.time_since_epoch())).count();
+    return now;
+}
+
 void Time :: MsSleep(const int iTimeMs)
 {
     std::this_thread::sleep_for(std::chrono::milliseconds(iTimeMs));
@@ -91,6 +91,8 @@ public:
 
     static const uint64_t GetSteadyClockMS();
 
+    static const uint64_t GetSteadyClockUS();
+
     static void MsSleep(const int iTimeMs);
 };
 
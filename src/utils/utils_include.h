@@ -30,3 +30,5 @@ See the AUTHORS file for names of contributors.
 #include "./wait_lock.h"
 #include "./bytes_buffer.h"
 #include "./notifier_pool.h"
+#include "./value_compress.h"
+#include "./histogram.h"
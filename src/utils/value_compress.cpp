@@ -0,0 +1,329 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#include "value_compress.h"
+#include <string.h>
+#include <vector>
+#include "crc32.h"
+
+namespace phxpaxos
+{
+
+#define VALUE_COMPRESS_MIN_MATCH 4
+#define VALUE_COMPRESS_MAX_OFFSET 65535
+#define VALUE_COMPRESS_HASH_BITS 12
+
+std::mutex ValueCompressor :: m_oDictMutex;
+std::map<uint32_t, std::string> ValueCompressor :: m_mapDict;
+
+uint32_t ValueCompressor :: RegisterDict(const std::string & sDict)
+{
+    if (sDict.size() == 0)
+    {
+        return 0;
+    }
+
+    uint32_t iDictID = crc32(0, (const uint8_t *)sDict.data(), sDict.size());
+    if (iDictID == 0)
+    {
+        //0 is reserved for no dictionary.
+        iDictID = 1;
+    }
+
+    std::lock_guard<std::mutex> oLockGuard(m_oDictMutex);
+    //dictionary never be removed, so pointer return by GetDict is always valid.
+    m_mapDict.insert(std::make_pair(iDictID, sDict));
+
+    return iDictID;
+}
+
+const std::string * ValueCompressor :: GetDict(const uint32_t iDictID)
+{
+    std::lock_guard<std::mutex> oLockGuard(m_oDictMutex);
+    auto it = m_mapDict.find(iDictID);
+    if (it == m_mapDict.end())
+    {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+size_t ValueCompressor :: Hash(const uint32_t iSeq)
+{
+    return (size_t)((iSeq * 2654435761U) >> (32 - VALUE_COMPRESS_HASH_BITS));
+}
+
+void ValueCompressor :: WriteLength(const size_t iLen, std::string & sBuffer)
+{
+    size_t iLeft = iLen;
+    while (iLeft >= 255)
+    {
+        sBuffer.push_back((char)255);
+        iLeft -= 255;
+    }
+
+    sBuffer.push_back((char)iLeft);
+}
+
+bool ValueCompressor :: ReadLength(const char *& pPos, const char * pEnd, size_t & iLen)
+{
+    while (pPos < pEnd)
+    {
+        uint8_t iByte = (uint8_t)*pPos++;
+        iLen += iByte;
+        if (iByte != 255)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int ValueCompressor :: Compress(const uint32_t iDictID, const std::string & sValue, std::string & sCompressValue)
+{
+    const std::string * psDict = nullptr;
+    if (iDictID != 0)
+    {
+        psDict = GetDict(iDictID);
+        if (psDict == nullptr)
+        {
+            return -1;
+        }
+    }
+
+    //matches can refer to the dictionary, so compress on [dict][value].
+    std::string sWindow;
+    const char * pBase = sValue.data();
+    size_t iDictLen = 0;
+    if (psDict != nullptr)
+    {
+        sWindow.reserve(psDict->size() + sValue.size());
+        sWindow.append(*psDict);
+        sWindow.append(sValue);
+        pBase = sWindow.data();
+        iDictLen = psDict->size();
+    }
+    size_t iTotalLen = iDictLen + sValue.size();
+
+    std::vector<uint32_t> vecHashTable(1 << VALUE_COMPRESS_HASH_BITS, 0);
+    for (size_t i = 0; i + VALUE_COMPRESS_MIN_MATCH <= iDictLen; i++)
+    {
+        uint32_t iSeq = 0;
+        memcpy(&iSeq, pBase + i, sizeof(iSeq));
+        vecHashTable[Hash(iSeq)] = (uint32_t)i + 1;
+    }
+
+    uint32_t iRawLen = (uint32_t)sValue.size();
+    size_t iLimitLen = VALUE_COMPRESS_HEADER_LEN + sValue.size();
+
+    sCompressValue.clear();
+    sCompressValue.reserve(iLimitLen);
+    sCompressValue.append((const char *)&iDictID, sizeof(uint32_t));
+    sCompressValue.append((const char *)&iRawLen, sizeof(uint32_t));
+
+    size_t iAnchor = iDictLen;
+    size_t iPos = iDictLen;
+    while (iPos + VALUE_COMPRESS_MIN_MATCH <= iTotalLen)
+    {
+        uint32_t iSeq = 0;
+        memcpy(&iSeq, pBase + iPos, sizeof(iSeq));
+        size_t iHash = Hash(iSeq);
+        size_t iCandidate = vecHashTable[iHash];
+        vecHashTable[iHash] = (uint32_t)iPos + 1;
+
+        if (iCandidate == 0
+                || iPos - (iCandidate - 1) > VALUE_COMPRESS_MAX_OFFSET
+                || memcmp(pBase + iCandidate - 1, pBase + iPos, VALUE_COMPRESS_MIN_MATCH) != 0)
+        {
+            iPos++;
+            continue;
+        }
+
+        size_t iMatchPos = iCandidate - 1;
+        size_t iMatchLen = VALUE_COMPRESS_MIN_MATCH;
+        while (iPos + iMatchLen < iTotalLen && pBase[iMatchPos + iMatchLen] == pBase[iPos + iMatchLen])
+        {
+            iMatchLen++;
+        }
+
+        size_t iLiteralLen = iPos - iAnchor;
+        size_t iExtraMatchLen = iMatchLen - VALUE_COMPRESS_MIN_MATCH;
+        uint8_t iToken = (uint8_t)((iLiteralLen >= 15 ? 15 : iLiteralLen) << 4)
+            | (uint8_t)(iExtraMatchLen >= 15 ? 15 : iExtraMatchLen);
+
+        sCompressValue.push_back((char)iToken);
+        if (iLiteralLen >= 15)
+        {
+            WriteLength(iLiteralLen - 15, sCompressValue);
+        }
+        sCompressValue.append(pBase + iAnchor, iLiteralLen);
+
+        uint16_t iOffset = (uint16_t)(iPos - iMatchPos);
+        sCompressValue.push_back((char)(iOffset & 0xff));
+        sCompressValue.push_back((char)(iOffset >> 8));
+        if (iExtraMatchLen >= 15)
+        {
+            WriteLength(iExtraMatchLen - 15, sCompressValue);
+        }
+
+        iPos += iMatchLen;
+        iAnchor = iPos;
+
+        if (sCompressValue.size() >= iLimitLen)
+        {
+            return 1;
+        }
+    }
+
+    //last sequence only have literals.
+    size_t iLiteralLen = iTotalLen - iAnchor;
+    sCompressValue.push_back((char)((iLiteralLen >= 15 ? 15 : iLiteralLen) << 4));
+    if (iLiteralLen >= 15)
+    {
+        WriteLength(iLiteralLen - 15, sCompressValue);
+    }
+    sCompressValue.append(pBase + iAnchor, iLiteralLen);
+
+    if (sCompressValue.size() >= iLimitLen)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+int ValueCompressor :: Decompress(const std::string & sCompressValue, const size_t iMaxRawLen, std::string & sValue)
+{
+    if (sCompressValue.size() < VALUE_COMPRESS_HEADER_LEN)
+    {
+        return -1;
+    }
+
+    uint32_t iDictID = 0;
+    uint32_t iRawLen = 0;
+    memcpy(&iDictID, sCompressValue.data(), sizeof(uint32_t));
+    memcpy(&iRawLen, sCompressValue.data() + sizeof(uint32_t), sizeof(uint32_t));
+
+    //header come from disk or network, don't trust it before reserve.
+    if (iRawLen > iMaxRawLen)
+    {
+        return -1;
+    }
+
+    const std::string * psDict = nullptr;
+    if (iDictID != 0)
+    {
+        psDict = GetDict(iDictID);
+        if (psDict == nullptr)
+        {
+            return -1;
+        }
+    }
+
+    size_t iDictLen = psDict != nullptr ? psDict->size() : 0;
+    size_t iTotalLen = iDictLen + iRawLen;
+
+    std::string sOutput;
+    sOutput.reserve(iTotalLen);
+    if (psDict != nullptr)
+    {
+        sOutput.append(*psDict);
+    }
+
+    const char * pPos = sCompressValue.data() + VALUE_COMPRESS_HEADER_LEN;
+    const char * pEnd = sCompressValue.data() + sCompressValue.size();
+    while (pPos < pEnd)
+    {
+        uint8_t iToken = (uint8_t)*pPos++;
+
+        size_t iLiteralLen = iToken >> 4;
+        if (iLiteralLen == 15 && !ReadLength(pPos, pEnd, iLiteralLen))
+        {
+            return -1;
+        }
+
+        if ((size_t)(pEnd - pPos) < iLiteralLen || sOutput.size() + iLiteralLen > iTotalLen)
+        {
+            return -1;
+        }
+        sOutput.append(pPos, iLiteralLen);
+        pPos += iLiteralLen;
+
+        if (pPos == pEnd)
+        {
+            break;
+        }
+
+        if (pEnd - pPos < 2)
+        {
+            return -1;
+        }
+        size_t iOffset = (uint8_t)pPos[0] | ((size_t)(uint8_t)pPos[1] << 8);
+        pPos += 2;
+
+        size_t iMatchLen = iToken & 0x0f;
+        if (iMatchLen == 15 && !ReadLength(pPos, pEnd, iMatchLen))
+        {
+            return -1;
+        }
+        iMatchLen += VALUE_COMPRESS_MIN_MATCH;
+
+        if (iOffset == 0 || iOffset > sOutput.size() || sOutput.size() + iMatchLen > iTotalLen)
+        {
+            return -1;
+        }
+
+        size_t iFrom = sOutput.size() - iOffset;
+        if (iOffset >= iMatchLen)
+        {
+            sOutput.append(sOutput.data() + iFrom, iMatchLen);
+        }
+        else
+        {
+            //overlap copy, repeat the last iOffset bytes.
+            for (size_t i = 0; i < iMatchLen; i++)
+            {
+                sOutput.push_back(sOutput[iFrom + i]);
+            }
+        }
+    }
+
+    if (sOutput.size() != iTotalLen)
+    {
+        return -1;
+    }
+
+    if (iDictLen > 0)
+    {
+        sValue = sOutput.substr(iDictLen);
+    }
+    else
+    {
+        sValue.swap(sOutput);
+    }
+
+    return 0;
+}
+    
+}
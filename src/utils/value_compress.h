@@ -0,0 +1,70 @@
+/*
+Tencent is pleased to support the open source community by making 
+PhxPaxos available.
+Copyright (C) 2016 THL A29 Limited, a Tencent company. 
+All rights reserved.
+
+Licensed under the BSD 3-Clause License (the "License"); you may 
+not use this file except in compliance with the License. You may 
+obtain a copy of the License at
+
+https://opensource.org/licenses/BSD-3-Clause
+
+Unless required by applicable law or agreed to in writing, software 
+distributed under the License is distributed on an "AS IS" basis, 
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or 
+implied. See the License for the specific language governing 
+permissions and limitations under the License.
+
+See the AUTHORS file for names of contributors. 
+*/
+
+
+#pragma once
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+
+namespace phxpaxos
+{
+
+//compressed value layout: [dictid(uint32)][rawlen(uint32)][lz sequences]
+#define VALUE_COMPRESS_HEADER_LEN (sizeof(uint32_t) + sizeof(uint32_t))
+
+//A small LZ77 codec (lz4 alike sequence format) for paxos values,
+//support preset dictionary to help compress small values which share 
+//the same schema.
+class ValueCompressor
+{
+public:
+    //Register a dictionary, return dictid (crc32 of the dictionary), 
+    //0 means no dictionary. Both sides must register the same dictionary
+    //before they can decompress values compressed with it.
+    static uint32_t RegisterDict(const std::string & sDict);
+
+    //return 0 means compress ok,
+    //return 1 means value is not compressible, caller should keep the raw value,
+    //return -1 means unknown dictid.
+    static int Compress(const uint32_t iDictID, const std::string & sValue, std::string & sCompressValue);
+
+    //return 0 means decompress ok, 
+    //return -1 means broken data, raw length over iMaxRawLen or dictionary not registered.
+    static int Decompress(const std::string & sCompressValue, const size_t iMaxRawLen, std::string & sValue);
+
+private:
+    static const std::string * GetDict(const uint32_t iDictID);
+
+    static size_t Hash(const uint32_t iSeq);
+
+    static void WriteLength(const size_t iLen, std::string & sBuffer);
+
+    static bool ReadLength(const char *& pPos, const char * pEnd, size_t & iLen);
+
+private:
+    static std::mutex m_oDictMutex;
+    static std::map<uint32_t, std::string> m_mapDict;
+};
+    
+}
@@ -19,7 +19,7 @@ permissions and limitations under the License.
 See the AUTHORS file for names of contributors. 
 */
 
-#include <random>
+#include <chrono>
 #include "wait_lock.h"
 #include <stdio.h>
 #include "utils_include.h"
@@ -28,9 +28,11 @@ namespace phxpaxos
 {
 
 WaitLock :: WaitLock() 
-    :m_bIsLockUsing(false), m_iWaitLockCount(0), m_iMaxWaitLockCount(-1),
+    :m_bIsLockUsing(false), m_iMaxWaitLockCount(-1),
+    m_llLockTimeUS(0), m_llAvgHoldTimeUS(0),
     m_iLockUseTimeSum(0), m_iAvgLockUseTime(0), m_iLockUseTimeCount(0),
-    m_iRejectRate(0), m_iLockWaitTimeThresholdMS(-1)
+    m_iRejectCount(0), m_iRejectRate(0), 
+    m_iLockWaitTimeThresholdMS(-1), m_llFirstAboveTime(0), m_bIsDropping(false)
 {
 }
 
@@ -38,53 +40,68 @@ WaitLock :: ~WaitLock()
 {
 }
 
-bool WaitLock :: CanLock()
+bool WaitLock :: CanLock(const int iTimeoutMs)
 {
+    int iWaitLockCount = (int)m_dequeWaiter.size();
     if (m_iMaxWaitLockCount != -1
-            && m_iWaitLockCount >= m_iMaxWaitLockCount) 
+            && iWaitLockCount >= m_iMaxWaitLockCount) 
     {
         //to much lock waiting
         return false;
     }
 
-    if (m_iLockWaitTimeThresholdMS == -1)
+    if (!m_bIsLockUsing)
     {
         return true;
     }
 
-    static std::default_random_engine e_rand;
-    return ((int)(e_rand() % 100)) >= m_iRejectRate;
-}
+    if (m_iLockWaitTimeThresholdMS != -1 && iTimeoutMs != -1
+            && (uint64_t)(iWaitLockCount + 1) * m_llAvgHoldTimeUS > (uint64_t)iTimeoutMs * 1000)
+    {
+        //will timeout before get lock, reject now.
+        //only when load shedding is configured, the estimate may be wrong.
+        return false;
+    }
 
-void WaitLock :: RefleshRejectRate(const int iUseTimeMs)
-{
-    if (m_iLockWaitTimeThresholdMS == -1)
+    if (m_bIsDropping && iWaitLockCount > 0)
     {
-        return;
+        //waiters wait too long, shed new one until queue drain.
+        return false;
     }
 
+    return true;
+}
+
+void WaitLock :: RefleshWaitStat(const int iUseTimeMs, const uint64_t llNowTime)
+{
     m_iLockUseTimeSum += iUseTimeMs;
     m_iLockUseTimeCount++;
     if (m_iLockUseTimeCount >= WAIT_LOCK_USERTIME_AVG_INTERVAL)
     {
         m_iAvgLockUseTime = m_iLockUseTimeSum / m_iLockUseTimeCount;
+        m_iRejectRate = m_iRejectCount * 100 / (m_iRejectCount + m_iLockUseTimeCount);
         m_iLockUseTimeSum = 0;
         m_iLockUseTimeCount = 0;
+        m_iRejectCount = 0;
+    }
 
-        if (m_iAvgLockUseTime > m_iLockWaitTimeThresholdMS)
-        {
-            if (m_iRejectRate != 98)
-            {
-                m_iRejectRate = m_iRejectRate + 3 > 98 ? 98 : m_iRejectRate + 3;
-            }
-        }
-        else
-        {
-            if (m_iRejectRate != 0)
-            {
-                m_iRejectRate = m_iRejectRate - 3 < 0 ? 0 : m_iRejectRate - 3;
-            }
-        }
+    if (m_iLockWaitTimeThresholdMS == -1)
+    {
+        return;
+    }
+
+    if (iUseTimeMs < m_iLockWaitTimeThresholdMS)
+    {
+        m_llFirstAboveTime = 0;
+        m_bIsDropping = false;
+    }
+    else if (m_llFirstAboveTime == 0)
+    {
+        m_llFirstAboveTime = llNowTime + WAIT_LOCK_CODEL_INTERVAL_MS;
+    }
+    else if (llNowTime >= m_llFirstAboveTime)
+    {
+        m_bIsDropping = true;
     }
 }
 
@@ -102,67 +119,94 @@ bool WaitLock :: Lock(const int iTimeoutMs, int & iUseTimeMs)
 {
     uint64_t llBeginTime = Time::GetSteadyClockMS();
 
-    m_oSerialLock.Lock();
-    if (!CanLock())
+    std::unique_lock<std::mutex> oLock(m_oMutex);
+    if (!CanLock(iTimeoutMs))
     {
-        //printf("reject, now rate %d\n", m_iRejectRate);
         iUseTimeMs = 0;
-        m_oSerialLock.UnLock();
+        m_iRejectCount++;
         return false;
     }
 
-    m_iWaitLockCount++;
-    bool bGetLock = true;;
+    bool bGetLock = true;
 
-    while (m_bIsLockUsing)
+    if (!m_bIsLockUsing)
     {
-        if (iTimeoutMs == -1)
+        m_bIsLockUsing = true;
+    }
+    else
+    {
+        WaitLockWaiter oWaiter;
+        oWaiter.bIsGranted = false;
+        m_dequeWaiter.push_back(&oWaiter);
+
+        auto tDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(iTimeoutMs);
+        while (!oWaiter.bIsGranted)
         {
-            m_oSerialLock.WaitTime(1000);
-            continue;
+            if (iTimeoutMs == -1)
+            {
+                oWaiter.oCond.wait(oLock);
+            }
+            else if (oWaiter.oCond.wait_until(oLock, tDeadline) == std::cv_status::timeout)
+            {
+                break;
+            }
         }
-        else
+
+        if (!oWaiter.bIsGranted)
         {
-            if (!m_oSerialLock.WaitTime(iTimeoutMs))
+            //lock timeout
+            for (auto it = m_dequeWaiter.begin(); it != m_dequeWaiter.end(); it++)
             {
-                //lock timeout
-                bGetLock = false;
-                break;
+                if (*it == &oWaiter)
+                {
+                    m_dequeWaiter.erase(it);
+                    break;
+                }
             }
+            bGetLock = false;
         }
     }
 
-    m_iWaitLockCount--;
-
     uint64_t llEndTime = Time::GetSteadyClockMS();
     iUseTimeMs = llEndTime > llBeginTime ? (int)(llEndTime - llBeginTime) : 0;
 
-    RefleshRejectRate(iUseTimeMs);
+    RefleshWaitStat(iUseTimeMs, llEndTime);
 
     if (bGetLock)
     {
-        m_bIsLockUsing = true;
+        m_llLockTimeUS = Time::GetSteadyClockUS();
     }
-    m_oSerialLock.UnLock();
 
     return bGetLock;
 }
 
 void WaitLock :: UnLock()
 {
-    m_oSerialLock.Lock();
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+
+    uint64_t llNowTime = Time::GetSteadyClockUS();
+    uint64_t llHoldTimeUS = llNowTime > m_llLockTimeUS ? llNowTime - m_llLockTimeUS : 0;
+    m_llAvgHoldTimeUS = (m_llAvgHoldTimeUS * 7 + llHoldTimeUS) / 8;
 
-    m_bIsLockUsing = false;
-    m_oSerialLock.Interupt();
+    if (m_dequeWaiter.empty())
+    {
+        m_bIsLockUsing = false;
+        return;
+    }
 
-    m_oSerialLock.UnLock();
+    //hand over to the first waiter, lock keep using.
+    WaitLockWaiter * poWaiter = m_dequeWaiter.front();
+    m_dequeWaiter.pop_front();
+    poWaiter->bIsGranted = true;
+    poWaiter->oCond.notify_one();
 }
 
 ////////////////////////////////////////////
 
 int WaitLock :: GetNowHoldThreadCount()
 {
-    return m_iWaitLockCount;
+    std::lock_guard<std::mutex> oLock(m_oMutex);
+    return (int)m_dequeWaiter.size();
 }
 
 int WaitLock :: GetNowAvgThreadWaitTime()
@@ -177,4 +221,3 @@ int WaitLock :: GetNowRejectRate()
 
 }
 
-
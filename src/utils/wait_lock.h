@@ -21,13 +21,28 @@ See the AUTHORS file for names of contributors.
 
 #pragma once
 
-#include "serial_lock.h"
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
 
 namespace phxpaxos
 {
 
 #define WAIT_LOCK_USERTIME_AVG_INTERVAL 250
+#define WAIT_LOCK_CODEL_INTERVAL_MS 100
 
+class WaitLockWaiter
+{
+public:
+    std::condition_variable oCond;
+    bool bIsGranted;
+};
+
+//Fifo lock, UnLock hand the lock to the first waiter directly.
+//With a wait time threshold set, new waiters are rejected early if they would 
+//time out before their turn, or waiters have been waiting longer than threshold 
+//for a whole interval(like CoDel).
 class WaitLock
 {
 public:
@@ -51,23 +66,31 @@ public:
     int GetNowRejectRate();
 
 private:
-    void RefleshRejectRate(const int iUseTimeMs);
+    void RefleshWaitStat(const int iUseTimeMs, const uint64_t llNowTime);
 
-    bool CanLock();
+    bool CanLock(const int iTimeoutMs);
 
 private:
-    SerialLock m_oSerialLock;
+    std::mutex m_oMutex;
     bool m_bIsLockUsing;
+    std::deque<WaitLockWaiter *> m_dequeWaiter;
 
-    int m_iWaitLockCount;
     int m_iMaxWaitLockCount;
 
+    uint64_t m_llLockTimeUS;
+    uint64_t m_llAvgHoldTimeUS;
+
     int m_iLockUseTimeSum;
     int m_iAvgLockUseTime;
     int m_iLockUseTimeCount;
 
+    int m_iRejectCount;
     int m_iRejectRate;
+
     int m_iLockWaitTimeThresholdMS;
+    uint64_t m_llFirstAboveTime;
+    bool m_bIsDropping;
 };
     
 }
+